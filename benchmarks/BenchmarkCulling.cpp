@@ -0,0 +1,110 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Math/Frustum.h"
+//=============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const uint32_t box_count     = 100000;
+    const uint32_t cascade_count = 4;
+
+    // a camera in the middle of a 1 km square, looking along z
+    Frustum create_frustum(const float far_plane)
+    {
+        const Matrix view       = Matrix::CreateLookAtLH(Vector3(0.0f, 10.0f, 0.0f), Vector3(0.0f, 10.0f, 1.0f), Vector3::Up);
+        const Matrix projection = Matrix::CreatePerspectiveFieldOfViewLH(Helper::DEG_TO_RAD * 75.0f, 16.0f / 9.0f, 0.1f, far_plane);
+        return Frustum(view, projection, far_plane);
+    }
+}
+
+SP_BENCHMARK(culling)
+{
+    // props scattered around the camera, about a quarter of them in view
+    mt19937 engine(1337);
+    uniform_real_distribution<float> position(-500.0f, 500.0f);
+    uniform_real_distribution<float> extent(0.5f, 4.0f);
+    vector<BoundingBox> boxes(box_count);
+    AabbSoA boxes_soa;
+    boxes_soa.Reserve(box_count);
+    for (BoundingBox& box : boxes)
+    {
+        const Vector3 center = Vector3(position(engine), position(engine) * 0.05f, position(engine));
+        const Vector3 size   = Vector3(extent(engine), extent(engine), extent(engine));
+        box                  = BoundingBox(center - size, center + size);
+        boxes_soa.Add(box);
+    }
+
+    const Frustum frustum = create_frustum(1000.0f);
+    vector<uint8_t> mask(box_count);
+
+    // the camera pass
+    Benchmarks::measure("one box at a time, 100k", 20, [&]()
+    {
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            mask[i] = frustum.IsVisible(boxes[i].GetCenter(), boxes[i].GetExtents()) ? 1 : 0;
+        }
+        Benchmarks::consume(mask[box_count / 2]);
+    });
+
+    Benchmarks::measure("batched, 100k", 20, [&]()
+    {
+        frustum.CullBoxes(boxes_soa, mask.data());
+        Benchmarks::consume(mask[box_count / 2]);
+    });
+
+    // the shadow pass, cascades of growing depth
+    Frustum cascades[cascade_count];
+    for (uint32_t i = 0; i < cascade_count; i++)
+    {
+        cascades[i] = create_frustum(50.0f * static_cast<float>(1 << (i * 2)));
+    }
+
+    Benchmarks::measure("4 cascades, one box at a time, 100k", 20, [&]()
+    {
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            uint8_t bits = 0;
+            for (uint32_t cascade = 0; cascade < cascade_count; cascade++)
+            {
+                bits |= cascades[cascade].IsVisible(boxes[i].GetCenter(), boxes[i].GetExtents(), true) ? (1 << cascade) : 0;
+            }
+            mask[i] = bits;
+        }
+        Benchmarks::consume(mask[box_count / 2]);
+    });
+
+    Benchmarks::measure("4 cascades, batched in one pass, 100k", 20, [&]()
+    {
+        Frustum::CullBoxes(cascades, cascade_count, boxes_soa, mask.data(), true);
+        Benchmarks::consume(mask[box_count / 2]);
+    });
+}
@@ -0,0 +1,115 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Rendering/InstanceClustering.h"
+//===============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    // vegetation the way the forest world places it, in patches over a few km of terrain, with random yaw and scale
+    // the forest's own terrain needs its height map, so the placement is synthesized instead
+    vector<Matrix> create_vegetation(const uint32_t count, const float terrain_size)
+    {
+        mt19937 engine(1337);
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+        normal_distribution<float> spread(0.0f, 20.0f);
+
+        vector<Vector3> patches(max(1u, count / 200));
+        for (Vector3& patch : patches)
+        {
+            patch = Vector3((unit(engine) - 0.5f) * terrain_size, 0.0f, (unit(engine) - 0.5f) * terrain_size);
+        }
+
+        vector<Matrix> instances(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Vector3& patch   = patches[i % patches.size()];
+            const Vector3 position = Vector3(patch.x + spread(engine), unit(engine) * 30.0f, patch.z + spread(engine));
+            instances[i]           = Matrix(position, Quaternion::FromEulerAngles(0.0f, unit(engine) * 360.0f, 0.0f), Vector3(0.5f + unit(engine)));
+        }
+
+        return instances;
+    }
+
+    vector<BoundingBox> compute_instance_bounds(const vector<Matrix>& instances)
+    {
+        const BoundingBox mesh_bounds = BoundingBox(Vector3(-1.0f, 0.0f, -1.0f), Vector3(1.0f, 6.0f, 1.0f));
+
+        vector<BoundingBox> bounds(instances.size());
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            bounds[i] = mesh_bounds.Transform(instances[i]);
+        }
+
+        return bounds;
+    }
+}
+
+SP_BENCHMARK(instance_clustering)
+{
+    // the forest's trees and plants, and a scene with a lot more of them
+    const pair<const char*, uint32_t> scenes[] =
+    {
+        { "forest trees, 5k",   5000 },
+        { "forest plants, 20k", 20000 },
+        { "dense, 400k",        400000 }
+    };
+
+    for (const auto& [name, count] : scenes)
+    {
+        const vector<Matrix> vegetation = create_vegetation(count, 4000.0f);
+        vector<Matrix> instances;
+        vector<uint32_t> group_end_indices;
+
+        Benchmarks::measure((string("cluster, ") + name).c_str(), 10, [&]() { instances = vegetation; }, [&]()
+        {
+            instance_clustering::cluster(instances, group_end_indices);
+            Benchmarks::consume(group_end_indices.size());
+        });
+
+        // what SetInstances() does after clustering, and what UpdateInstances() does when a few of them move
+        const vector<BoundingBox> instance_bounds = compute_instance_bounds(instances);
+        vector<BoundingBox> group_bounds;
+        Benchmarks::measure((string("group bounds, ") + name).c_str(), 10, [&]() { group_bounds.clear(); }, [&]()
+        {
+            const BoundingBox bounds = instance_clustering::compute_group_bounds(instance_bounds, group_end_indices, group_bounds);
+            Benchmarks::consume(static_cast<uint64_t>(bounds.GetSize().x));
+        });
+
+        Benchmarks::measure((string("group bounds, 64 moved, ") + name).c_str(), 10, [&]()
+        {
+            const uint32_t start     = count / 2;
+            const BoundingBox bounds = instance_clustering::compute_group_bounds(instance_bounds, group_end_indices, group_bounds, start, start + 64);
+            Benchmarks::consume(static_cast<uint64_t>(bounds.GetSize().x));
+        });
+
+        printf("    %u instances in %zu groups\n", count, group_end_indices.size());
+    }
+}
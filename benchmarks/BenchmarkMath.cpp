@@ -0,0 +1,161 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Math/Simd.h"
+//==========================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const uint32_t element_count = 100000;
+
+    Matrix random_transform(mt19937& engine)
+    {
+        uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+        const Quaternion rotation = Quaternion::FromEulerAngles(distribution(engine) * 18.0f, distribution(engine) * 18.0f, distribution(engine) * 18.0f);
+        return Matrix(Vector3(distribution(engine), distribution(engine), distribution(engine)), rotation, Vector3(1.0f + fabsf(distribution(engine)) * 0.1f));
+    }
+
+    // the scalar code the simd backend replaced, kept here as the baseline
+    Matrix multiply_scalar(const Matrix& lhs, const Matrix& rhs)
+    {
+        Matrix result;
+        const float* a = lhs.Data();
+        const float* b = rhs.Data();
+        float* out     = &result.m00;
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            for (uint32_t row = 0; row < 4; row++)
+            {
+                out[column * 4 + row] = a[0 * 4 + row] * b[column * 4 + 0] + a[1 * 4 + row] * b[column * 4 + 1] + a[2 * 4 + row] * b[column * 4 + 2] + a[3 * 4 + row] * b[column * 4 + 3];
+            }
+        }
+
+        return result;
+    }
+}
+
+SP_BENCHMARK(math)
+{
+    mt19937 engine(1337);
+    vector<Matrix> matrices(element_count);
+    vector<Vector3> points(element_count);
+    vector<BoundingBox> boxes(element_count);
+    for (uint32_t i = 0; i < element_count; i++)
+    {
+        matrices[i] = random_transform(engine);
+        points[i]   = Vector3(static_cast<float>(i % 97), static_cast<float>(i % 89), static_cast<float>(i % 83));
+        boxes[i]    = BoundingBox(points[i] - Vector3(0.5f), points[i] + Vector3(0.5f));
+    }
+    vector<Matrix> matrices_out(element_count);
+
+    // matrix products, e.g. local to world in Entity::UpdateTransform
+    Benchmarks::measure("matrix multiply, scalar, 100k", 20, [&]()
+    {
+        for (uint32_t i = 1; i < element_count; i++)
+        {
+            matrices_out[i] = multiply_scalar(matrices[i - 1], matrices[i]);
+        }
+        Benchmarks::consume(static_cast<uint64_t>(matrices_out.back().m00));
+    });
+
+    Benchmarks::measure("matrix multiply, simd, 100k", 20, [&]()
+    {
+        for (uint32_t i = 1; i < element_count; i++)
+        {
+            matrices_out[i] = matrices[i - 1] * matrices[i];
+        }
+        Benchmarks::consume(static_cast<uint64_t>(matrices_out.back().m00));
+    });
+
+    // inverses, e.g. view matrices and world to local
+    Benchmarks::measure("matrix invert, scalar, 100k", 20, [&]()
+    {
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            matrices_out[i] = Matrix::InvertScalar(matrices[i]);
+        }
+        Benchmarks::consume(static_cast<uint64_t>(matrices_out.back().m00));
+    });
+
+    Benchmarks::measure("matrix invert, simd, 100k", 20, [&]()
+    {
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            matrices_out[i] = Matrix::Invert(matrices[i]);
+        }
+        Benchmarks::consume(static_cast<uint64_t>(matrices_out.back().m00));
+    });
+
+    // point transforms, with and without the perspective divide
+    Benchmarks::measure("point transform, with divide, 100k", 20, [&]()
+    {
+        Vector3 sum = Vector3::Zero;
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            sum += points[i] * matrices[i];
+        }
+        Benchmarks::consume(static_cast<uint64_t>(sum.x));
+    });
+
+    Benchmarks::measure("point transform, affine, 100k", 20, [&]()
+    {
+        Vector3 sum = Vector3::Zero;
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            sum += matrices[i].TransformPoint(points[i]);
+        }
+        Benchmarks::consume(static_cast<uint64_t>(sum.x));
+    });
+
+    // what culling and bounds updates do per renderable
+    Benchmarks::measure("bounding box transform, 100k", 20, [&]()
+    {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            sum += boxes[i].Transform(matrices[i]).GetMax().x;
+        }
+        Benchmarks::consume(static_cast<uint64_t>(sum));
+    });
+
+    Benchmarks::measure("matrix decompose, 100k", 20, [&]()
+    {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            Vector3 scale;
+            Quaternion rotation;
+            Vector3 translation;
+            matrices[i].Decompose(scale, rotation, translation);
+            sum += scale.x + rotation.w + translation.x;
+        }
+        Benchmarks::consume(static_cast<uint64_t>(sum));
+    });
+}
@@ -0,0 +1,109 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Resource/Import/MipGenerator.h"
+//============================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    const uint32_t image_size = 2048;
+    const uint32_t channels   = 4;
+    const uint32_t mip_count  = 12;
+
+    // noise on top of smooth gradients, with alpha cut out in places, like foliage
+    vector<std::byte> create_image()
+    {
+        mt19937 engine(1337);
+        uniform_int_distribution<int> noise(-16, 16);
+
+        vector<std::byte> image(image_size * image_size * channels);
+        for (uint32_t y = 0; y < image_size; y++)
+        {
+            for (uint32_t x = 0; x < image_size; x++)
+            {
+                const float u = static_cast<float>(x) / image_size;
+                const float v = static_cast<float>(y) / image_size;
+                const float values[channels] =
+                {
+                    0.5f + 0.4f * sinf(u * 40.0f),
+                    0.5f + 0.4f * cosf(v * 30.0f),
+                    0.5f + 0.4f * sinf((u + v) * 20.0f),
+                    sinf(u * 90.0f) * cosf(v * 70.0f) > 0.0f ? 1.0f : 0.0f
+                };
+
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    const int value = static_cast<int>(values[c] * 255.0f) + (c < 3 ? noise(engine) : 0);
+                    image[(y * image_size + x) * channels + c] = static_cast<std::byte>(clamp(value, 0, 255));
+                }
+            }
+        }
+
+        return image;
+    }
+}
+
+SP_BENCHMARK(mip_generator)
+{
+    const vector<std::byte> image = create_image();
+    vector<vector<std::byte>> mips;
+
+    // a full chain for a 2k albedo with every filter, and then the same with what the other texture types ask for
+    const pair<const char*, MipSettings> presets[] =
+    {
+        { "2k rgba8, box",                 { MipFilter::Box,     false, false, 0.0f } },
+        { "2k rgba8, kaiser",              { MipFilter::Kaiser,  false, false, 0.0f } },
+        { "2k rgba8, lanczos",             { MipFilter::Lanczos, false, false, 0.0f } },
+        { "2k rgba8, kaiser, srgb",        { MipFilter::Kaiser,  true,  false, 0.0f } },
+        { "2k rgba8, kaiser, normal",      { MipFilter::Kaiser,  false, true,  0.0f } },
+        { "2k rgba8, kaiser, srgb, alpha", { MipFilter::Kaiser,  true,  false, 0.5f } }
+    };
+
+    for (const auto& [name, settings] : presets)
+    {
+        Benchmarks::measure(name, 5, [&mips]() { mips.clear(); }, [&]()
+        {
+            MipGenerator::Generate(image.data(), image_size, image_size, image_size * channels, channels, 8, mip_count, settings, &mips);
+            Benchmarks::consume(mips.back().size());
+        });
+    }
+
+    // a single channel mask of the same size, what roughness and occlusion maps are
+    vector<std::byte> mask(image_size * image_size);
+    for (uint32_t i = 0; i < image_size * image_size; i++)
+    {
+        mask[i] = image[i * channels];
+    }
+
+    Benchmarks::measure("2k r8, kaiser", 5, [&mips]() { mips.clear(); }, [&]()
+    {
+        MipGenerator::Generate(mask.data(), image_size, image_size, image_size, 1, 8, mip_count, MipSettings(), &mips);
+        Benchmarks::consume(mips.back().size());
+    });
+}
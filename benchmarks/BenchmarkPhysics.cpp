@@ -0,0 +1,347 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =============================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Core/ThreadPool.h"
+#include "Physics/Car.h"
+#include "Physics/Physics.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Components/PhysicsBody.h"
+//========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    // the world owns the entity, holding on to a shared pointer would keep the body simulating past World::New()
+    PhysicsBody* create_body(const Vector3& position, const Vector3& scale, const PhysicsShape shape, const float mass)
+    {
+        // the shape is sized by the scale of the entity, so the transform goes first
+        shared_ptr<Entity> entity = World::CreateEntity();
+        entity->SetPosition(position);
+        entity->SetScale(scale);
+
+        PhysicsBody* body = entity->AddComponent<PhysicsBody>().get();
+        body->SetShapeType(shape);
+        body->SetMass(mass);
+
+        return body;
+    }
+
+    // 100 columns of 20 boxes on a ground plane, every column is an island of its own once they settle
+    vector<PhysicsBody*> create_stacks()
+    {
+        World::New();
+        Physics::SetStepRate(60.0f);
+
+        create_body(Vector3(0.0f, -0.5f, 0.0f), Vector3(100.0f, 1.0f, 100.0f), PhysicsShape::Box, 0.0f);
+
+        vector<PhysicsBody*> boxes;
+        for (uint32_t column = 0; column < 100; column++)
+        {
+            for (uint32_t level = 0; level < 20; level++)
+            {
+                const Vector3 position = Vector3(static_cast<float>(column % 10) * 3.0f, 0.5f + static_cast<float>(level) * 1.01f, static_cast<float>(column / 10) * 3.0f);
+                boxes.emplace_back(create_body(position, Vector3::One, PhysicsShape::Box, 1.0f));
+            }
+        }
+
+        return boxes;
+    }
+
+    // a car the way the car world sets it up, driven by its own control
+    Car* create_car(const Vector3& position, const float steering)
+    {
+        shared_ptr<Entity> entity = World::CreateEntity();
+        entity->SetPosition(position);
+
+        PhysicsBody* body = entity->AddComponent<PhysicsBody>().get();
+        body->SetBodyType(PhysicsBodyType::Vehicle);
+        body->SetCenterOfMass(Vector3(0.0f, 1.2f, 0.0f));
+        body->SetBoundingBox(Vector3(3.0f, 1.9f, 7.0f));
+        body->SetMass(960.0f);
+
+        CarControl control;
+        control.throttle = 1.0f;
+        control.steering = steering;
+        body->GetCar()->SetPlayerControlled(false);
+        body->GetCar()->SetControl(control);
+
+        return body->GetCar().get();
+    }
+
+    // cars on a ground plane, spread out so that they don't collide
+    vector<Car*> create_cars(const uint32_t car_count)
+    {
+        World::New();
+        Physics::SetStepRate(60.0f);
+
+        create_body(Vector3(0.0f, -0.5f, 0.0f), Vector3(1000.0f, 1.0f, 1000.0f), PhysicsShape::Box, 0.0f);
+
+        vector<Car*> cars;
+        for (uint32_t i = 0; i < car_count; i++)
+        {
+            const Vector3 position = Vector3(static_cast<float>(i % 8) * 20.0f, 1.5f, static_cast<float>(i / 8) * 40.0f);
+            cars.emplace_back(create_car(position, static_cast<float>(i % 5) * 0.5f - 1.0f));
+        }
+
+        return cars;
+    }
+
+    // a typical scene, a pile of props, maybe a car, and a few thrown props fast enough to cross a thin wall in less than a step
+    vector<PhysicsBody*> create_scene(const float step_rate, const bool with_car)
+    {
+        World::New();
+        Physics::SetStepRate(step_rate);
+
+        create_body(Vector3(0.0f, -0.5f, 0.0f), Vector3(200.0f, 1.0f, 200.0f), PhysicsShape::Box, 0.0f);
+        create_body(Vector3(0.0f, 5.0f, 20.0f), Vector3(40.0f, 10.0f, 0.2f), PhysicsShape::Box, 0.0f);
+
+        for (uint32_t i = 0; i < 500; i++)
+        {
+            const Vector3 position = Vector3(-40.0f + static_cast<float>(i % 25) * 1.2f, 0.5f + static_cast<float>(i / 25) * 1.05f, -20.0f);
+            create_body(position, Vector3::One, PhysicsShape::Box, 1.0f);
+        }
+
+        if (with_car)
+        {
+            create_car(Vector3(30.0f, 1.5f, -20.0f), 0.5f);
+        }
+
+        vector<PhysicsBody*> props_thrown;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            PhysicsBody* prop = create_body(Vector3(-15.0f + static_cast<float>(i) * 2.0f, 2.0f, 0.0f), Vector3(0.2f), (i & 1) ? PhysicsShape::Box : PhysicsShape::Sphere, 1.0f);
+            prop->SetUseGravity(false);
+            prop->SetLinearVelocity(Vector3(0.0f, 0.0f, 80.0f));
+            props_thrown.emplace_back(prop);
+        }
+
+        return props_thrown;
+    }
+
+    // boxes on a ground plane, with a cloth patch dropped on each of them, or nothing but the boxes
+    vector<btSoftBody*> create_cloth_scene(const uint32_t patch_count)
+    {
+        World::New();
+        Physics::SetStepRate(60.0f);
+
+        create_body(Vector3(0.0f, -0.5f, 0.0f), Vector3(400.0f, 1.0f, 400.0f), PhysicsShape::Box, 0.0f);
+
+        vector<btSoftBody*> patches;
+        for (uint32_t i = 0; i < max(patch_count, 16u); i++)
+        {
+            const Vector3 position = Vector3(static_cast<float>(i % 16) * 6.0f, 0.5f, static_cast<float>(i / 16) * 6.0f);
+            create_body(position, Vector3::One, PhysicsShape::Box, 0.0f);
+
+            if (i < patch_count)
+            {
+                patches.emplace_back(Physics::CreateCloth(position + Vector3(0.0f, 1.5f, 0.0f), 2.0f, 24));
+            }
+        }
+
+        return patches;
+    }
+
+    float get_highest(const vector<PhysicsBody*>& bodies)
+    {
+        float height = numeric_limits<float>::lowest();
+        for (const PhysicsBody* body : bodies)
+        {
+            height = max(height, body->GetPosition().y);
+        }
+
+        return height;
+    }
+}
+
+SP_BENCHMARK(physics_stacks)
+{
+    vector<PhysicsBody*> boxes;
+
+    // a second of settling, every body is awake and in contact
+    Benchmarks::measure("2k boxes in stacks, settling, 60 steps", 3, [&boxes]() { boxes = create_stacks(); }, []()
+    {
+        Physics::Step(60);
+        Benchmarks::consume(Physics::GetStepCount());
+    });
+
+    // the same stacks once they are at rest, their islands sleep
+    Physics::Step(120);
+    Benchmarks::measure("2k boxes in stacks, at rest, 60 steps", 3, []()
+    {
+        Physics::Step(60);
+        Benchmarks::consume(Physics::GetStepCount());
+    });
+
+    // a column which held up is 20 boxes tall
+    printf("    highest box at %.2f m, %u pool threads\n", get_highest(boxes), ThreadPool::GetThreadCount());
+
+    World::New();
+}
+
+SP_BENCHMARK(physics_queries)
+{
+    const uint32_t query_count = 10000;
+
+    // a static scene, a ground plane with a thousand props of both shapes on it
+    World::New();
+    mt19937 engine(1337);
+    uniform_real_distribution<float> position(-100.0f, 100.0f);
+    uniform_real_distribution<float> extent(0.5f, 3.0f);
+    create_body(Vector3(0.0f, -0.5f, 0.0f), Vector3(200.0f, 1.0f, 200.0f), PhysicsShape::Box, 0.0f);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        const float size = extent(engine);
+        create_body(Vector3(position(engine), size * 0.5f, position(engine)), Vector3(size), (i & 1) ? PhysicsShape::Box : PhysicsShape::Sphere, 0.0f);
+    }
+    Physics::Step(1);
+
+    // rays straight down and at grazing angles, the way suspension and visibility checks cast them
+    vector<PhysicsRay> rays(query_count);
+    vector<PhysicsSweep> sweeps(query_count);
+    vector<PhysicsOverlap> overlaps(query_count);
+    for (uint32_t i = 0; i < query_count; i++)
+    {
+        const Vector3 start = Vector3(position(engine), 10.0f, position(engine));
+        const Vector3 end   = (i & 1) ? Vector3(start.x, -1.0f, start.z) : Vector3(position(engine), 0.5f, position(engine));
+        rays[i]             = { start, end, nullptr };
+        sweeps[i]           = { PhysicsQueryShape::Sphere, Vector3(0.5f), start, end, nullptr };
+        overlaps[i]         = { PhysicsQueryShape::Box, Vector3(2.0f), Vector3(start.x, 1.0f, start.z), nullptr };
+    }
+    vector<PhysicsHit> hits(query_count);
+    vector<btRigidBody*> overlap_bodies(query_count * 8);
+    vector<uint32_t> overlap_counts(query_count);
+
+    // what gameplay code did before, one query and one vector of every hit at a time
+    Benchmarks::measure("10k rays, one at a time", 10, [&rays]()
+    {
+        uint64_t hit_count = 0;
+        for (const PhysicsRay& ray : rays)
+        {
+            hit_count += Physics::RayCast(ray.start, ray.end).size();
+        }
+        Benchmarks::consume(hit_count);
+    });
+
+    Benchmarks::measure("10k rays, batched", 10, [&rays, &hits]()
+    {
+        Physics::RayCast(rays, hits);
+        Benchmarks::consume(count_if(hits.begin(), hits.end(), [](const PhysicsHit& hit) { return hit.body != nullptr; }));
+    });
+
+    Benchmarks::measure("10k sphere sweeps, batched", 10, [&sweeps, &hits]()
+    {
+        Physics::Sweep(sweeps, hits);
+        Benchmarks::consume(count_if(hits.begin(), hits.end(), [](const PhysicsHit& hit) { return hit.body != nullptr; }));
+    });
+
+    Benchmarks::measure("10k box overlaps, batched", 10, [&overlaps, &overlap_bodies, &overlap_counts]()
+    {
+        Physics::Overlap(overlaps, overlap_bodies, overlap_counts);
+        Benchmarks::consume(overlap_counts[query_count / 2]);
+    });
+
+    World::New();
+}
+
+SP_BENCHMARK(physics_cars)
+{
+    // one car as the baseline, and 64 of them, each accelerating and steering, timed once they are on their way
+    vector<Car*> cars;
+    for (const uint32_t car_count : { 1u, 64u })
+    {
+        const string label = to_string(car_count) + (car_count == 1 ? " car" : " cars") + ", 60 steps";
+        Benchmarks::measure(label.c_str(), 5, [&cars, car_count]() { cars = create_cars(car_count); Physics::Step(120); }, []()
+        {
+            Physics::Step(60);
+            Benchmarks::consume(Physics::GetStepCount());
+        });
+    }
+
+    // they should be moving by now
+    float speed = 0.0f;
+    for (const Car* car : cars)
+    {
+        speed += car->GetSpeedKilometersPerHour() / static_cast<float>(cars.size());
+    }
+    printf("    average speed %.1f km/h\n", speed);
+
+    World::New();
+}
+
+SP_BENCHMARK(physics_step_rate)
+{
+    // a simulated second at each rate, the thrown props are kept from tunnelling by ccd and substeps instead of the rate
+    // a car substeps the whole world to its own rate, so the scene is measured with and without one
+    for (const bool with_car : { false, true })
+    {
+        for (const uint32_t step_rate : { 60u, 120u, 200u })
+        {
+            vector<PhysicsBody*> props_thrown;
+            const string label = "1 second at " + to_string(step_rate) + " hz" + (with_car ? ", with a car" : "");
+            Benchmarks::measure(label.c_str(), 5, [&props_thrown, step_rate, with_car]() { props_thrown = create_scene(static_cast<float>(step_rate), with_car); }, [step_rate]()
+            {
+                Physics::Step(step_rate);
+                Benchmarks::consume(Physics::GetStepCount());
+            });
+
+            const uint32_t tunnelled = static_cast<uint32_t>(count_if(props_thrown.begin(), props_thrown.end(), [](const PhysicsBody* prop) { return prop->GetPosition().z > 20.0f; }));
+            printf("    %u of %zu thrown props went through the wall, %u substeps in the last step\n", tunnelled, props_thrown.size(), Physics::GetSubstepCount());
+        }
+    }
+
+    World::New();
+}
+
+SP_BENCHMARK(physics_cloth)
+{
+    // 24x24 patches falling on boxes, headless there is no camera, so they all step at full detail
+    vector<btSoftBody*> patches;
+    auto remove_patches = [&patches]()
+    {
+        for (btSoftBody*& patch : patches)
+        {
+            Physics::RemoveBody(patch);
+        }
+        patches.clear();
+    };
+
+    for (const uint32_t patch_count : { 0u, 16u, 64u, 256u })
+    {
+        const string label = patch_count == 0 ? string("rigid only, 10 steps") : to_string(patch_count) + " cloth patches, 10 steps";
+        Benchmarks::measure(label.c_str(), 3, [&]() { remove_patches(); patches = create_cloth_scene(patch_count); }, []()
+        {
+            Physics::Step(10);
+            Benchmarks::consume(Physics::GetStepCount());
+        });
+    }
+
+    remove_patches();
+    World::New();
+}
@@ -0,0 +1,174 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Rendering/Material.h"
+#include "Resource/ResourceCache.h"
+//==================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    const uint32_t resource_count = 10000;
+    const uint32_t thread_count   = 16;
+
+    // runs function(thread_index) on thread_count threads and waits for all of them
+    template<typename Function>
+    void run_threads(Function&& function)
+    {
+        vector<thread> threads;
+        for (uint32_t i = 0; i < thread_count; i++)
+        {
+            threads.emplace_back([&function, i]() { function(i); });
+        }
+
+        for (thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // materials are the cheapest resources to create without a device, and they don't need a file on the drive
+    vector<shared_ptr<Material>> create_materials()
+    {
+        vector<shared_ptr<Material>> materials(resource_count);
+        for (uint32_t i = 0; i < resource_count; i++)
+        {
+            materials[i] = make_shared<Material>();
+            materials[i]->SetResourceFilePath("project/benchmark/material_" + to_string(i) + EXTENSION_MATERIAL);
+        }
+
+        return materials;
+    }
+
+    // the cache as it used to be, a vector which every probe scans under one mutex
+    struct LinearCache
+    {
+        mutex lock;
+        vector<shared_ptr<IResource>> resources;
+
+        shared_ptr<IResource> get_by_path(const string& path)
+        {
+            lock_guard<mutex> guard(lock);
+            for (const shared_ptr<IResource>& resource : resources)
+            {
+                if (resource->GetResourceFilePathNative() == path)
+                    return resource;
+            }
+
+            return nullptr;
+        }
+
+        void insert(const shared_ptr<IResource>& resource)
+        {
+            if (get_by_path(resource->GetResourceFilePathNative()))
+                return;
+
+            lock_guard<mutex> guard(lock);
+            resources.emplace_back(resource);
+        }
+    };
+}
+
+SP_BENCHMARK(resource_cache)
+{
+    const vector<shared_ptr<Material>> materials = create_materials();
+    vector<string> paths(resource_count);
+    vector<string> names(resource_count);
+    for (uint32_t i = 0; i < resource_count; i++)
+    {
+        paths[i] = materials[i]->GetResourceFilePathNative();
+        names[i] = materials[i]->GetObjectName();
+    }
+
+    // every loader inserts its share of the resources, after probing for each one like ResourceCache::Load() does
+    auto insert = [&materials](const uint32_t thread_index)
+    {
+        for (uint32_t i = thread_index; i < resource_count; i += thread_count)
+        {
+            if (!ResourceCache::GetByPath<Material>(materials[i]->GetResourceFilePathNative()))
+            {
+                ResourceCache::Cache(materials[i]);
+            }
+        }
+    };
+
+    Benchmarks::measure("insert 10k, 16 threads", 10, []() { ResourceCache::Shutdown(); }, [&insert]()
+    {
+        run_threads(insert);
+        Benchmarks::consume(ResourceCache::GetResourceCount());
+    });
+
+    LinearCache linear_cache;
+    Benchmarks::measure("insert 10k, 16 threads, linear cache", 3, [&linear_cache]() { linear_cache.resources.clear(); }, [&]()
+    {
+        run_threads([&](const uint32_t thread_index)
+        {
+            for (uint32_t i = thread_index; i < resource_count; i += thread_count)
+            {
+                linear_cache.insert(materials[i]);
+            }
+        });
+        Benchmarks::consume(linear_cache.resources.size());
+    });
+
+    // lookups into the full cache, by path and by name, from every thread at once
+    const uint32_t lookup_count = 100000;
+    Benchmarks::measure("lookup 1.6m by path and name, 16 threads", 10, [&]()
+    {
+        atomic<uint32_t> found = 0;
+        run_threads([&](const uint32_t thread_index)
+        {
+            uint32_t found_local = 0;
+            for (uint32_t i = 0; i < lookup_count; i++)
+            {
+                const uint32_t index = (i * 7919 + thread_index * 104729) % resource_count;
+                found_local += (i & 1) ? (ResourceCache::GetByPath<Material>(paths[index]) != nullptr) : (ResourceCache::GetByName<Material>(names[index]) != nullptr);
+            }
+            found += found_local;
+        });
+        Benchmarks::consume(found);
+    });
+
+    // the same probes scan the whole vector, so a hundredth of them is plenty to tell
+    Benchmarks::measure("lookup 16k by path, 16 threads, linear cache", 3, [&]()
+    {
+        atomic<uint32_t> found = 0;
+        run_threads([&](const uint32_t thread_index)
+        {
+            uint32_t found_local = 0;
+            for (uint32_t i = 0; i < lookup_count / 100; i++)
+            {
+                found_local += linear_cache.get_by_path(paths[(i * 7919 + thread_index * 104729) % resource_count]) != nullptr;
+            }
+            found += found_local;
+        });
+        Benchmarks::consume(found);
+    });
+
+    ResourceCache::Shutdown();
+}
@@ -0,0 +1,160 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "RHI/RHI_Texture.h"
+#include "Resource/Import/MipGenerator.h"
+//============================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    const uint32_t image_size = 1024;
+    const uint32_t channels   = 4;
+
+    // albedo is smooth color with noise, a normal map is a bumpy height field, a mask is a smooth single channel
+    vector<std::byte> create_image(const uint32_t flags)
+    {
+        mt19937 engine(1337);
+        uniform_int_distribution<int> noise(-12, 12);
+
+        vector<std::byte> image(image_size * image_size * channels);
+        for (uint32_t y = 0; y < image_size; y++)
+        {
+            for (uint32_t x = 0; x < image_size; x++)
+            {
+                const float u = static_cast<float>(x) / image_size;
+                const float v = static_cast<float>(y) / image_size;
+
+                float values[channels] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                if (flags & RHI_Texture_Normal)
+                {
+                    const float dx     = 0.5f * cosf(u * 60.0f) * cosf(v * 40.0f);
+                    const float dy     = -0.5f * sinf(u * 60.0f) * sinf(v * 40.0f);
+                    const float length = sqrtf(dx * dx + dy * dy + 1.0f);
+                    values[0] = 0.5f + 0.5f * dx / length;
+                    values[1] = 0.5f + 0.5f * dy / length;
+                    values[2] = 0.5f + 0.5f / length;
+                }
+                else if (flags & RHI_Texture_Greyscale)
+                {
+                    const float value = 0.5f + 0.4f * sinf(u * 30.0f + cosf(v * 20.0f));
+                    values[0] = values[1] = values[2] = value;
+                }
+                else
+                {
+                    values[0] = 0.5f + 0.4f * sinf(u * 40.0f);
+                    values[1] = 0.5f + 0.4f * cosf(v * 30.0f);
+                    values[2] = 0.5f + 0.4f * sinf((u + v) * 20.0f);
+                }
+
+                const int grain = (flags & RHI_Texture_Normal) ? 0 : noise(engine);
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    const int value = static_cast<int>(values[c] * 255.0f) + (c < 3 ? grain : 0);
+                    image[(y * image_size + x) * channels + c] = static_cast<std::byte>(clamp(value, 0, 255));
+                }
+            }
+        }
+
+        return image;
+    }
+
+    // the first channel_count channels of an rgba image, the ones the format stores
+    vector<std::byte> extract_channels(const vector<std::byte>& image, const uint32_t channel_count)
+    {
+        vector<std::byte> extracted(image_size * image_size * channel_count);
+        for (uint32_t i = 0; i < image_size * image_size; i++)
+        {
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                extracted[i * channel_count + c] = image[i * channels + c];
+            }
+        }
+
+        return extracted;
+    }
+
+    uint32_t get_stored_channel_count(const RHI_Format format)
+    {
+        if (format == RHI_Format::BC4_Unorm)
+            return 1;
+
+        if (format == RHI_Format::BC5_Unorm)
+            return 2;
+
+        return 4;
+    }
+}
+
+SP_BENCHMARK(texture_compression)
+{
+    // every usage, at both qualities, on a 1k image
+    const pair<const char*, uint32_t> usages[] =
+    {
+        { "albedo", 0 },
+        { "normal", RHI_Texture_Normal },
+        { "mask",   RHI_Texture_Greyscale }
+    };
+
+    const pair<const char*, RHI_Texture_Compression> qualities[] =
+    {
+        { "production", RHI_Texture_Compression::Production },
+        { "preview",    RHI_Texture_Compression::Preview }
+    };
+
+    for (const auto& [usage_name, flags] : usages)
+    {
+        const vector<std::byte> image = create_image(flags);
+
+        for (const auto& [quality_name, quality] : qualities)
+        {
+            const string label = string("1k ") + usage_name + ", " + quality_name;
+            vector<std::byte> compressed;
+            RHI_Format format = RHI_Format::Max;
+            Benchmarks::measure(label.c_str(), 3, [&]()
+            {
+                format = RHI_Texture::Compress(image.data(), image_size, image_size, flags, quality, &compressed);
+                Benchmarks::consume(compressed.size());
+            });
+
+            // the quality, measured on the channels the format keeps
+            vector<std::byte> decompressed;
+            if (format == RHI_Format::Max || !RHI_Texture::Decompress(compressed.data(), image_size, image_size, format, &decompressed))
+            {
+                printf("    %s failed to compress\n", label.c_str());
+                continue;
+            }
+
+            const uint32_t channel_count = get_stored_channel_count(format);
+            const vector<std::byte> a    = extract_channels(image, channel_count);
+            const vector<std::byte> b    = extract_channels(decompressed, channel_count);
+            const float psnr             = MipGenerator::ComputePsnr(a.data(), b.data(), image_size, image_size, channel_count, 8);
+            printf("    %-48s %s, psnr %.2f db\n", label.c_str(), rhi_format_to_string(format), psnr);
+        }
+    }
+}
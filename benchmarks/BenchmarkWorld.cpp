@@ -0,0 +1,99 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Prefab.h"
+//================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const uint32_t instance_count = 10000;
+
+    // a small tree, the way props usually are: a root with a few parts under it
+    shared_ptr<Prefab> create_prefab(const string& file_path)
+    {
+        shared_ptr<Entity> root = World::CreateEntity();
+        root->SetObjectName("prop");
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            shared_ptr<Entity> part = World::CreateEntity();
+            part->SetObjectName("part_" + to_string(i));
+            part->SetParent(root);
+            part->SetPositionLocal(Vector3(0.0f, static_cast<float>(i), 0.0f));
+        }
+
+        shared_ptr<Prefab> prefab = Prefab::Create(root.get(), file_path);
+        World::RemoveEntity(root.get());
+
+        return prefab;
+    }
+}
+
+SP_BENCHMARK(world_spawn_prefab_instances)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_benchmarks").generic_string() + "/";
+    FileSystem::CreateDirectory(directory);
+
+    World::New();
+    shared_ptr<Prefab> prefab = create_prefab(directory + "prop" + EXTENSION_PREFAB);
+    if (!prefab)
+        return;
+
+    vector<Vector3> positions(instance_count);
+    for (uint32_t i = 0; i < instance_count; i++)
+    {
+        positions[i] = Vector3(static_cast<float>(i % 100) * 2.0f, 0.0f, static_cast<float>(i / 100) * 2.0f);
+    }
+
+    // what the entities alone cost, one heap allocation each
+    Benchmarks::measure("make_shared, 40k entities", 5, []()
+    {
+        vector<shared_ptr<Entity>> entities(instance_count * 4);
+        for (shared_ptr<Entity>& entity : entities)
+        {
+            entity = make_shared<Entity>();
+        }
+        Benchmarks::consume(entities.size());
+    });
+
+    // the instances (and their 40k entities) are removed between runs, so each one spawns into an empty world
+    Benchmarks::measure("instantiate, 10k instances of 4 entities", 5, []() { World::New(); }, [&prefab, &positions]()
+    {
+        vector<shared_ptr<Entity>> roots = prefab->Instantiate(positions);
+        Benchmarks::consume(roots.size());
+    });
+
+    World::New();
+    FileSystem::Delete(directory);
+}
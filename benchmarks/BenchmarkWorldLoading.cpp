@@ -0,0 +1,120 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/Material.h"
+#include "Resource/ResourceCache.h"
+#include "World/World.h"
+#include "World/Entity.h"
+//==================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const uint32_t entity_count   = 20000;
+    const uint32_t material_count = 2000;
+
+    // the project directory is relative to the working directory, so the benchmark's own lives there too
+    const string directory_project = "spartan_benchmark_project/";
+
+    // props the way the default worlds have them, a root with a few parts under it, and materials for them to use
+    // sponza and bistro need their assets and a device, so this is a synthetic world of a similar size
+    void create_world()
+    {
+        World::New();
+
+        for (uint32_t i = 0; i < entity_count / 4; i++)
+        {
+            shared_ptr<Entity> root = World::CreateEntity();
+            root->SetObjectName("prop_" + to_string(i));
+            root->SetPosition(Vector3(static_cast<float>(i % 100) * 2.0f, 0.0f, static_cast<float>(i / 100) * 2.0f));
+            for (uint32_t part_index = 0; part_index < 3; part_index++)
+            {
+                shared_ptr<Entity> part = World::CreateEntity();
+                part->SetObjectName("part_" + to_string(part_index));
+                part->SetParent(root);
+                part->SetPositionLocal(Vector3(0.0f, static_cast<float>(part_index), 0.0f));
+            }
+        }
+
+        for (uint32_t i = 0; i < material_count; i++)
+        {
+            shared_ptr<Material> material = make_shared<Material>();
+            material->SetResourceFilePath(directory_project + "material_" + to_string(i) + EXTENSION_MATERIAL);
+            material->SetProperty(MaterialProperty::Roughness, static_cast<float>(i % 100) / 100.0f);
+            ResourceCache::Cache(material);
+        }
+    }
+}
+
+SP_BENCHMARK(world_load)
+{
+    // the cache saves and loads its manifest when the world does, and initializing it is what subscribes it to that
+    const bool had_default_project = FileSystem::Exists("project\\");
+    ResourceCache::Initialize();
+    ResourceCache::SetProjectDirectory(directory_project);
+
+    create_world();
+    const string file_path = directory_project + "benchmark" + EXTENSION_WORLD;
+    if (!World::SaveToFile(file_path))
+        return;
+
+    // the entities and the manifest, the materials load in parallel on the thread pool
+    Benchmarks::measure("load, 20k entities and 2k materials", 5, [&file_path]()
+    {
+        World::LoadFromFile(file_path);
+        Benchmarks::consume(static_cast<uint32_t>(World::GetAllEntities().size()) + ResourceCache::GetResourceCount());
+    });
+
+    // the same materials, loaded one by one on the calling thread, which is how the manifest used to be loaded
+    vector<string> material_paths;
+    for (const shared_ptr<IResource>& resource : ResourceCache::GetByType(ResourceType::Material))
+    {
+        material_paths.emplace_back(resource->GetResourceFilePathNative());
+    }
+
+    Benchmarks::measure("load 2k materials one by one", 5, []() { ResourceCache::Shutdown(); }, [&material_paths]()
+    {
+        for (const string& path : material_paths)
+        {
+            ResourceCache::Load<Material>(path);
+        }
+        Benchmarks::consume(ResourceCache::GetResourceCount());
+    });
+
+    printf("    %u entities, %u resources, %u pool threads\n", static_cast<uint32_t>(World::GetAllEntities().size()), ResourceCache::GetResourceCount(), ThreadPool::GetThreadCount());
+
+    World::New();
+    ResourceCache::SetProjectDirectory("project\\");
+    FileSystem::Delete(directory_project);
+    if (!had_default_project)
+    {
+        FileSystem::Delete("project\\");
+    }
+}
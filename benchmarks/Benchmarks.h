@@ -0,0 +1,86 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ======
+#include <vector>
+#include <chrono>
+#include <algorithm>
+//=================
+
+// a minimal benchmark harness, each benchmark registers itself and times what it's interested in with measure()
+namespace Spartan::Benchmarks
+{
+    struct Benchmark
+    {
+        const char* name   = nullptr;
+        void (*function)() = nullptr;
+    };
+
+    std::vector<Benchmark>& get_benchmarks();
+
+    struct Registration
+    {
+        Registration(const char* name, void (*function)()) { get_benchmarks().push_back({ name, function }); }
+    };
+
+    // runs setup (untimed) and then function, iteration_count times, and prints the fastest and the average run in milliseconds
+    template<typename Setup, typename Function>
+    void measure(const char* label, const uint32_t iteration_count, Setup&& setup, Function&& function);
+
+    template<typename Function>
+    void measure(const char* label, const uint32_t iteration_count, Function&& function)
+    {
+        measure(label, iteration_count, []() {}, function);
+    }
+
+    void report(const char* label, const float time_fastest_ms, const float time_average_ms);
+
+    // keeps a result alive, so that the work which produced it isn't optimized away
+    void consume(const uint64_t value);
+}
+
+template<typename Setup, typename Function>
+void Spartan::Benchmarks::measure(const char* label, const uint32_t iteration_count, Setup&& setup, Function&& function)
+{
+    float time_fastest_ms = 0.0f;
+    float time_total_ms   = 0.0f;
+    for (uint32_t i = 0; i < iteration_count; i++)
+    {
+        setup();
+
+        const auto start   = std::chrono::high_resolution_clock::now();
+        function();
+        const float time_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        time_fastest_ms = i == 0 ? time_ms : std::min(time_fastest_ms, time_ms);
+        time_total_ms  += time_ms;
+    }
+
+    report(label, time_fastest_ms, time_total_ms / static_cast<float>(iteration_count > 0 ? iteration_count : 1));
+}
+
+#define SP_BENCHMARK(name)                                                                          \
+    static void benchmark_##name();                                                                 \
+    static const Spartan::Benchmarks::Registration registration_##name(#name, benchmark_##name);   \
+    static void benchmark_##name()
@@ -0,0 +1,90 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "Benchmarks.h"
+#include "Core/ThreadPool.h"
+#include "Physics/Physics.h"
+#include "World/World.h"
+//================================
+
+//= NAMESPACES ========
+using namespace std;
+using namespace Spartan;
+//=====================
+
+namespace
+{
+    atomic<uint64_t> consumed = 0;
+}
+
+namespace Spartan::Benchmarks
+{
+    vector<Benchmark>& get_benchmarks()
+    {
+        static vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    void report(const char* label, const float time_fastest_ms, const float time_average_ms)
+    {
+        printf("    %-48s fastest %10.3f ms, average %10.3f ms\n", label, time_fastest_ms, time_average_ms);
+    }
+
+    void consume(const uint64_t value)
+    {
+        consumed.fetch_add(value, memory_order_relaxed);
+    }
+}
+
+// a headless tool which times the hot paths of the runtime, it initializes only what they need, no window and no device
+// usage: benchmarks [name filter], a benchmark runs if its name contains the filter
+int main(int argc, char** argv)
+{
+    const string filter = argc > 1 ? argv[1] : "";
+
+    Log::Initialize();
+    ThreadPool::Initialize();
+    Physics::Initialize();
+
+    uint32_t benchmark_count = 0;
+    for (const Benchmarks::Benchmark& benchmark : Benchmarks::get_benchmarks())
+    {
+        if (!filter.empty() && string(benchmark.name).find(filter) == string::npos)
+            continue;
+
+        printf("%s\n", benchmark.name);
+        benchmark.function();
+        benchmark_count++;
+    }
+
+    printf("%u benchmarks ran (%llu)\n", benchmark_count, static_cast<unsigned long long>(consumed.load()));
+
+    World::Shutdown();
+    Physics::Shutdown();
+    ThreadPool::Shutdown();
+
+    return 0;
+}
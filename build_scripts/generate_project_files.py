@@ -165,9 +165,9 @@ def copy_assets():
 def generate_project_files():
     print("\n5. Generating project files...")
     cmd = (
-        f"build_scripts\\premake5.exe --file=build_scripts\\premake.lua {sys.argv[1]} {sys.argv[2]}"
+        f"build_scripts\\premake5.exe --file=build_scripts\\premake.lua {sys.argv[1]} {sys.argv[2]} {' '.join(sys.argv[3:])}"
         if sys.argv[1] == "vs2022"
-        else f"premake5 --file=build_scripts/premake.lua {sys.argv[1]} {sys.argv[2]}"
+        else f"premake5 --file=build_scripts/premake.lua {sys.argv[1]} {sys.argv[2]} {' '.join(sys.argv[3:])}"
     )
     subprocess.Popen(cmd, shell=True).communicate()
     
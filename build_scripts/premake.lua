@@ -17,18 +17,37 @@
 -- IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 -- CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
-CPP_VERSION          = "C++20"
-SOLUTION_NAME        = "spartan"
-EDITOR_PROJECT_NAME  = "editor"
-RUNTIME_PROJECT_NAME = "runtime"
-EXECUTABLE_NAME      = "spartan"
-EDITOR_DIR           = "../" .. EDITOR_PROJECT_NAME
-RUNTIME_DIR          = "../" .. RUNTIME_PROJECT_NAME
-LIBRARY_DIR          = "../third_party/libraries"
-OBJ_DIR              = "../binaries/obj"
-TARGET_DIR           = "../binaries"
+CPP_VERSION             = "C++20"
+SOLUTION_NAME           = "spartan"
+EDITOR_PROJECT_NAME     = "editor"
+RUNTIME_PROJECT_NAME    = "runtime"
+COOKER_PROJECT_NAME     = "cooker"
+TESTS_PROJECT_NAME      = "tests"
+BENCHMARKS_PROJECT_NAME = "benchmarks"
+EXECUTABLE_NAME         = "spartan"
+EDITOR_DIR              = "../" .. EDITOR_PROJECT_NAME
+RUNTIME_DIR             = "../" .. RUNTIME_PROJECT_NAME
+COOKER_DIR              = "../" .. COOKER_PROJECT_NAME
+TESTS_DIR               = "../" .. TESTS_PROJECT_NAME
+BENCHMARKS_DIR          = "../" .. BENCHMARKS_PROJECT_NAME
+LIBRARY_DIR             = "../third_party/libraries"
+OBJ_DIR                 = "../binaries/obj"
+TARGET_DIR              = "../binaries"
 API_CPP_DEFINE		 = ""
-ARG_API_GRAPHICS     = _ARGS[1]
+ARG_API_GRAPHICS        = _ARGS[1]
+
+newoption
+{
+    trigger     = "avx2",
+    description = "Require AVX2 and FMA (Haswell or newer), the math library then uses fused multiply-add"
+}
+
+-- the bullet libraries in third_party/libraries are built without BT_THREADSAFE, pass this when linking ones that were built with it
+newoption
+{
+    trigger     = "bullet_threadsafe",
+    description = "Link against Bullet libraries built with BT_THREADSAFE, physics then steps on the thread pool"
+}
 
 API_INCLUDES = {
 	vulkan_windows = {
@@ -123,6 +142,22 @@ function solution_configuration()
         language "C++"
         configurations { "debug", "release" }
 
+        -- simd, the math library selects its backend at compile time (see Math/Simd.h)
+        -- sse 4.2 runs on any x64 cpu from the last decade, avx2 and fma have to be asked for since older cpus crash on them
+        if _OPTIONS["avx2"] then
+            vectorextensions "AVX2"
+            if os.target() == "linux" then
+                buildoptions { "-mfma" }
+            end
+        else
+            vectorextensions "SSE4.2"
+        end
+
+        -- bullet, has to match how the libraries were built since it changes what its headers compile to
+        if _OPTIONS["bullet_threadsafe"] then
+            defines { "BT_THREADSAFE=1" }
+        end
+
         -- platforms
         if os.target() == "windows" then
             platforms { "windows" }
@@ -328,7 +363,136 @@ function editor_project_configuration()
             end
 end
 
+-- headless, imports a directory of assets into the derived data cache without creating a window or a device
+function cooker_project_configuration()
+    project (COOKER_PROJECT_NAME)
+        location (COOKER_DIR)
+        links (RUNTIME_PROJECT_NAME)
+        dependson (RUNTIME_PROJECT_NAME)
+        objdir (OBJ_DIR)
+        cppdialect (CPP_VERSION)
+        kind "ConsoleApp"
+        staticruntime "On"
+        defines{ API_CPP_DEFINE }
+        if os.target() == "windows" then
+            conformancemode "On"
+        end
+
+        -- Files
+        files
+        {
+            COOKER_DIR .. "/**.h",
+            COOKER_DIR .. "/**.cpp"
+        }
+
+        -- Includes
+        includedirs { RUNTIME_DIR }
+        includedirs { RUNTIME_DIR .. "/Core" } -- This is here because the runtime uses it
+
+        -- Libraries
+        libdirs (LIBRARY_DIR)
+
+        -- "Release"
+        filter "configurations:release"
+            targetname ( COOKER_PROJECT_NAME )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+
+        -- "Debug"
+        filter "configurations:debug"
+            targetname ( COOKER_PROJECT_NAME .. "_debug" )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+end
+
+-- headless, runs the tests of the runtime and returns non-zero if any of them failed
+function tests_project_configuration()
+    project (TESTS_PROJECT_NAME)
+        location (TESTS_DIR)
+        links (RUNTIME_PROJECT_NAME)
+        dependson (RUNTIME_PROJECT_NAME)
+        objdir (OBJ_DIR)
+        cppdialect (CPP_VERSION)
+        kind "ConsoleApp"
+        staticruntime "On"
+        defines{ API_CPP_DEFINE }
+        if os.target() == "windows" then
+            conformancemode "On"
+        end
+
+        -- Files
+        files
+        {
+            TESTS_DIR .. "/**.h",
+            TESTS_DIR .. "/**.cpp"
+        }
+
+        -- Includes
+        includedirs { RUNTIME_DIR }
+        includedirs { RUNTIME_DIR .. "/Core" } -- This is here because the runtime uses it
+
+        -- Libraries
+        libdirs (LIBRARY_DIR)
+
+        -- "Release"
+        filter "configurations:release"
+            targetname ( TESTS_PROJECT_NAME )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+
+        -- "Debug"
+        filter "configurations:debug"
+            targetname ( TESTS_PROJECT_NAME .. "_debug" )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+end
+
+-- headless, times the hot paths of the runtime (loading, spawning, physics, culling and so on)
+function benchmarks_project_configuration()
+    project (BENCHMARKS_PROJECT_NAME)
+        location (BENCHMARKS_DIR)
+        links (RUNTIME_PROJECT_NAME)
+        dependson (RUNTIME_PROJECT_NAME)
+        objdir (OBJ_DIR)
+        cppdialect (CPP_VERSION)
+        kind "ConsoleApp"
+        staticruntime "On"
+        defines{ API_CPP_DEFINE }
+        if os.target() == "windows" then
+            conformancemode "On"
+        end
+
+        -- Files
+        files
+        {
+            BENCHMARKS_DIR .. "/**.h",
+            BENCHMARKS_DIR .. "/**.cpp"
+        }
+
+        -- Includes
+        includedirs { RUNTIME_DIR }
+        includedirs { RUNTIME_DIR .. "/Core" } -- This is here because the runtime uses it
+
+        -- Libraries
+        libdirs (LIBRARY_DIR)
+
+        -- "Release"
+        filter "configurations:release"
+            targetname ( BENCHMARKS_PROJECT_NAME )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+
+        -- "Debug"
+        filter "configurations:debug"
+            targetname ( BENCHMARKS_PROJECT_NAME .. "_debug" )
+            targetdir (TARGET_DIR)
+            debugdir (TARGET_DIR)
+end
+
 configure_graphics_api()
 solution_configuration()
 runtime_project_configuration()
 editor_project_configuration()
+cooker_project_configuration()
+tests_project_configuration()
+benchmarks_project_configuration()
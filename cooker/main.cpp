@@ -0,0 +1,146 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===================================
+#include "pch.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/Mesh.h"
+#include "Resource/DerivedDataCache.h"
+#include "Resource/Import/ImageImporterExporter.h"
+#include "Resource/Import/ModelImporter.h"
+#include "RHI/RHI_Texture.h"
+//==============================================
+
+//= NAMESPACES ========
+using namespace std;
+using namespace Spartan;
+//=====================
+
+// a headless tool which imports every image and model in a directory into the derived data cache,
+// so that the editor (or a build machine) doesn't have to pay for decoding, compression and post-processing on first load
+// usage: cooker <directory> [derived data directory] [--preview]
+int main(int argc, char** argv)
+{
+    // --preview trades compression quality for speed, which is handy while iterating on assets
+    bool preview = false;
+    vector<const char*> arguments;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--preview")
+        {
+            preview = true;
+        }
+        else
+        {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+
+    if (arguments.empty() || !FileSystem::IsDirectory(arguments[0]))
+    {
+        printf("usage: cooker <directory> [derived data directory] [--preview]\n");
+        return 1;
+    }
+
+    // only what the importers need, no window and no device
+    Log::Initialize();
+    ImageImporterExporter::Initialize();
+    ModelImporter::Initialize();
+    ThreadPool::Initialize();
+
+    if (arguments.size() > 1)
+    {
+        DerivedDataCache::SetDirectory(arguments[1]);
+    }
+
+    RHI_Texture::SetCompressionQuality(preview ? RHI_Texture_Compression::Preview : RHI_Texture_Compression::Production);
+
+    // gather
+    vector<string> images;
+    vector<string> models;
+    for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(arguments[0], filesystem::directory_options::skip_permission_denied))
+    {
+        if (!entry.is_regular_file())
+            continue;
+
+        const string file_path = entry.path().generic_string();
+        if (FileSystem::IsSupportedImageFile(file_path))
+        {
+            images.emplace_back(file_path);
+        }
+        else if (FileSystem::IsSupportedModelFile(file_path))
+        {
+            models.emplace_back(file_path);
+        }
+    }
+
+    // cook, models cook their textures with the flags of the material slots they are in, so they are done first
+    const Stopwatch timer;
+    uint32_t failed_count = 0;
+    vector<string> model_textures;
+    for (const string& file_path : models)
+    {
+        printf("cooking \"%s\"\n", file_path.c_str());
+        failed_count += ModelImporter::Cook(file_path, Mesh::GetDefaultFlags(), &model_textures) ? 0 : 1;
+    }
+
+    // the remaining images are cooked with the flags their names suggest (srgb for colors, normal for normal maps and so on)
+    unordered_set<string> model_textures_canonical;
+    for (const string& file_path : model_textures)
+    {
+        error_code error;
+        model_textures_canonical.insert(filesystem::weakly_canonical(file_path, error).generic_string());
+    }
+    images.erase(remove_if(images.begin(), images.end(), [&model_textures_canonical](const string& file_path)
+    {
+        error_code error;
+        return model_textures_canonical.count(filesystem::weakly_canonical(file_path, error).generic_string()) != 0;
+    }), images.end());
+
+    atomic<uint32_t> failed_count_images = 0;
+    auto cook_images = [&images, &failed_count_images](uint32_t work_index_start, uint32_t work_index_end)
+    {
+        for (uint32_t i = work_index_start; i < work_index_end; i++)
+        {
+            if (!RHI_Texture::Cook(images[i], ModelImporter::GetTextureImportFlags(images[i])))
+            {
+                failed_count_images++;
+            }
+        }
+    };
+
+    ThreadPool::ParallelLoop(cook_images, static_cast<uint32_t>(images.size()));
+    failed_count += failed_count_images;
+
+    printf("cooked %u models and %u images into \"%s\" in %.1f s, %u failed\n",
+        static_cast<uint32_t>(models.size()),
+        static_cast<uint32_t>(images.size()),
+        DerivedDataCache::GetDirectory().c_str(),
+        timer.GetElapsedTimeSec(),
+        failed_count
+    );
+
+    ThreadPool::Shutdown();
+    ImageImporterExporter::Shutdown();
+
+    return failed_count == 0 ? 0 : 1;
+}
@@ -110,9 +110,9 @@ gbuffer main_ps(gbuffer_vertex vertex)
         {
             // get tangent space normal and apply the user defined intensity, then transform it to world space
             float3 normal_sample  = sampling::smart(surface, vertex, material_normal).xyz;
-            float3 tangent_normal = normalize(unpack(normal_sample));
+            float3 tangent_normal = float3(unpack(normal_sample.xy), 0.0f);
         
-            // reconstruct z-component as this can be a BC5 two channel normal map
+            // reconstruct z-component as this can be a BC5 two channel normal map (blue reads as zero, so it can't take part in normalization)
             tangent_normal.z = sqrt(max(0.0, 1.0 - tangent_normal.x * tangent_normal.x - tangent_normal.y * tangent_normal.y));
         
             float normal_intensity     = max(0.012f, GetMaterial().normal);
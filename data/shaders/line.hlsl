@@ -29,6 +29,33 @@ struct vertex
     float4 color    : COLOR0;
 };
 
+#ifdef INSTANCED
+// the same line geometry drawn with many transforms (e.g. physics shapes)
+struct vertex_instanced
+{
+    float4 position           : POSITION0;
+    float4 color              : COLOR0;
+    matrix instance_transform : INSTANCE_TRANSFORM0;
+};
+
+vertex main_vs(vertex_instanced input)
+{
+    // the last column of an affine transform is always (0, 0, 0, 1), so it carries the color the lines are tinted with
+    matrix transform = input.instance_transform;
+    float3 tint      = float3(transform[0][3], transform[1][3], transform[2][3]);
+    transform[0][3]  = 0.0f;
+    transform[1][3]  = 0.0f;
+    transform[2][3]  = 0.0f;
+
+    vertex output;
+    output.position = float4(input.position.xyz, 1.0f);
+    output.position = mul(output.position, transform);
+    output.position = mul(output.position, buffer_frame.view_projection_unjittered);
+    output.color    = float4(input.color.rgb * tint, input.color.a);
+
+    return output;
+}
+#else
 vertex main_vs(vertex input)
 {
     input.position.w = 1.0f;
@@ -37,6 +64,7 @@ vertex main_vs(vertex input)
     
     return input;
 }
+#endif
 
 float4 main_ps(vertex input) : SV_TARGET
 {
@@ -441,6 +441,7 @@ void Properties::ShowPhysicsBody(shared_ptr<PhysicsBody> body) const
         float restitution      = body->GetRestitution();
         bool use_gravity       = body->GetUseGravity();
         bool is_kinematic      = body->GetIsKinematic();
+        bool ccd               = body->GetCcd();
         bool freeze_pos_x      = static_cast<bool>(body->GetPositionLock().x);
         bool freeze_pos_y      = static_cast<bool>(body->GetPositionLock().y);
         bool freeze_pos_z      = static_cast<bool>(body->GetPositionLock().z);
@@ -492,6 +493,10 @@ void Properties::ShowPhysicsBody(shared_ptr<PhysicsBody> body) const
         ImGui::Text("Is Kinematic");
         ImGui::SameLine(column_pos_x); ImGui::Checkbox("##physics_body_is_kinematic", &is_kinematic);
 
+        // continuous collision detection
+        ImGui::Text("Continuous Collision");
+        ImGui::SameLine(column_pos_x); ImGui::Checkbox("##physics_body_ccd", &ccd);
+
         // freeze position
         ImGui::Text("Freeze Position");
         ImGui::SameLine(column_pos_x); ImGui::Text("X");
@@ -524,7 +529,8 @@ void Properties::ShowPhysicsBody(shared_ptr<PhysicsBody> body) const
                 "Cone",
                 "Terrain",
                 "Mesh Convex Hull (Cheap)",
-                "Mesh (Expensive)"
+                "Mesh (Expensive)",
+                "Mesh Convex Decomposition (Dynamic)"
             };
 
             ImGui::Text("Shape Type");
@@ -555,6 +561,7 @@ void Properties::ShowPhysicsBody(shared_ptr<PhysicsBody> body) const
         if (restitution != body->GetRestitution())                        body->SetRestitution(restitution);
         if (use_gravity != body->GetUseGravity())                         body->SetUseGravity(use_gravity);
         if (is_kinematic != body->GetIsKinematic())                       body->SetIsKinematic(is_kinematic);
+        if (ccd != body->GetCcd())                                        body->SetCcd(ccd);
         if (freeze_pos_x != static_cast<bool>(body->GetPositionLock().x)) body->SetPositionLock(Vector3(static_cast<float>(freeze_pos_x), static_cast<float>(freeze_pos_y), static_cast<float>(freeze_pos_z)));
         if (freeze_pos_y != static_cast<bool>(body->GetPositionLock().y)) body->SetPositionLock(Vector3(static_cast<float>(freeze_pos_x), static_cast<float>(freeze_pos_y), static_cast<float>(freeze_pos_z)));
         if (freeze_pos_z != static_cast<bool>(body->GetPositionLock().z)) body->SetPositionLock(Vector3(static_cast<float>(freeze_pos_x), static_cast<float>(freeze_pos_y), static_cast<float>(freeze_pos_z)));
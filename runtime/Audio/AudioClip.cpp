@@ -119,7 +119,7 @@ namespace Spartan
 
         // load
         loaded        = (m_playMode == PlayMode::Memory) ? CreateSound(GetResourceFilePath()) : CreateStream(GetResourceFilePath());
-        m_object_size = estimate_memory_usage(static_cast<FMOD::Sound*>(m_fmod_sound));
+        SetResourceSize(estimate_memory_usage(static_cast<FMOD::Sound*>(m_fmod_sound)));
 
         #endif
 
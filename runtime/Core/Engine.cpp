@@ -121,7 +121,9 @@ namespace Spartan
         Audio::Tick();
         Physics::Tick();
         World::Tick();
+        Physics::Simulate(); // steps on the physics thread while the renderer ticks
         Renderer::Tick();
+        Physics::Synchronize();
 
         // post-tick
         Timer::PostTick();
@@ -153,4 +155,15 @@ namespace Spartan
 
         return false;
     }
+
+    string Engine::GetArgumentValue(const string& argument)
+    {
+        for (size_t i = 0; i + 1 < arguments.size(); i++)
+        {
+            if (arguments[i] == argument)
+                return arguments[i + 1];
+        }
+
+        return "";
+    }
 }
@@ -43,5 +43,6 @@ namespace Spartan
         static void SetFlag(const EngineMode flag, const bool enabled);
         static void ToggleFlag(const EngineMode flag);
         static bool HasArgument(const std::string& argument);
+        static std::string GetArgumentValue(const std::string& argument); // the argument that follows, empty if there is none
     };
 }
@@ -91,15 +91,18 @@ namespace Spartan
         static bool CopyFileFromTo(const std::string& source, const std::string& destination);
     };
 
-    static const char* EXTENSION_WORLD    = ".world";
-    static const char* EXTENSION_MATERIAL = ".xml";
-    static const char* EXTENSION_MODEL    = ".model";
-    static const char* EXTENSION_PREFAB   = ".prefab";
-    static const char* EXTENSION_SHADER   = ".shader";
-    static const char* EXTENSION_FONT     = ".font";
-    static const char* EXTENSION_TEXTURE  = ".texture";
-    static const char* EXTENSION_MESH     = ".mesh";
-    static const char* EXTENSION_AUDIO    = ".audio";
+    static const char* EXTENSION_WORLD      = ".world";
+    static const char* EXTENSION_WORLD_CELL = ".cell";
+    static const char* EXTENSION_MATERIAL   = ".xml";
+    static const char* EXTENSION_MODEL      = ".model";
+    static const char* EXTENSION_PREFAB     = ".prefab";
+    static const char* EXTENSION_SHADER     = ".shader";
+    static const char* EXTENSION_FONT       = ".font";
+    static const char* EXTENSION_TEXTURE    = ".texture";
+    static const char* EXTENSION_MESH       = ".mesh";
+    static const char* EXTENSION_MESH_BVH   = ".bvh";
+    static const char* EXTENSION_MESH_HULLS = ".hulls";
+    static const char* EXTENSION_AUDIO      = ".audio";
 
     static const std::vector<std::string> supported_formats_image
     {
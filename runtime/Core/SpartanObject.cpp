@@ -39,7 +39,8 @@ namespace Spartan
 
     uint64_t SpartanObject::GenerateObjectId()
     {
-        static mt19937_64 eng{ random_device{}() };
+        // per thread, objects can be created concurrently (e.g. when a world loads)
+        thread_local mt19937_64 eng{ random_device{}() };
 
         auto time_now     = chrono::high_resolution_clock::now().time_since_epoch().count();
         auto thread_id    = hash<thread::id>()(this_thread::get_id());
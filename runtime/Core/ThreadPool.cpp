@@ -135,44 +135,67 @@ namespace Spartan
         condition_var.notify_one();
     }
 
-    void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total)
+    void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total, const uint32_t work_per_task_min /*= 1*/)
     {
-        SP_ASSERT_MSG(work_total > 1, "A parallel loop can't have a range of 1 or smaller");
-
-        uint32_t available_threads = GetIdleThreadCount();
-        uint32_t work_per_thread   = work_total / available_threads;
-        uint32_t work_remainder    = work_total % available_threads;
-        uint32_t work_index        = 0;
-        atomic<uint32_t> work_done = 0;
-        condition_variable cv;
-        mutex cv_m;
-
-        // split work into multiple tasks
-        while (work_index < work_total)
+        // small loops, or no idle threads, run inline
+        const uint32_t task_count_max = work_total / max(work_per_task_min, 1u);
+        const uint32_t helper_count   = min(GetIdleThreadCount(), task_count_max > 0 ? task_count_max - 1 : 0);
+        if (helper_count == 0)
         {
-            uint32_t work_to_do = work_per_thread;
-
-            // if the work doesn't divide evenly across threads, add the remainder work to the first thread.
-            if (work_remainder != 0)
+            if (work_total > 0)
             {
-                work_to_do     += work_remainder;
-                work_remainder = 0;
+                function(0, work_total);
             }
 
-            AddTask([&function, &work_done, &cv, work_index, work_to_do]()
-            {
-                function(work_index, work_index + work_to_do);
-                work_done += work_to_do;
+            return;
+        }
 
-                cv.notify_one(); // notify that a thread has finished its work
-            });
+        // the state outlives this call, helpers which start after all the work is taken return without touching the function
+        struct State
+        {
+            atomic<uint32_t> next = 0;
+            atomic<uint32_t> done = 0;
+            uint32_t total        = 0;
+            uint32_t chunk        = 0;
+            const std::function<void(uint32_t, uint32_t)>* function = nullptr;
+            mutex mutex_done;
+            condition_variable condition_done;
+        };
+
+        shared_ptr<State> state = make_shared<State>();
+        state->total            = work_total;
+        state->chunk            = max(work_per_task_min, work_total / ((helper_count + 1) * 4)); // a few chunks per thread to balance uneven work
+        state->function         = &function;
+
+        auto work = [state]()
+        {
+            while (true)
+            {
+                const uint32_t start = state->next.fetch_add(state->chunk);
+                if (start >= state->total)
+                    return;
+
+                const uint32_t end = min(start + state->chunk, state->total);
+                (*state->function)(start, end);
+
+                if (state->done.fetch_add(end - start) + (end - start) == state->total)
+                {
+                    lock_guard<mutex> lock(state->mutex_done);
+                    state->condition_done.notify_all();
+                }
+            }
+        };
 
-            work_index += work_to_do;
+        for (uint32_t i = 0; i < helper_count; i++)
+        {
+            AddTask(work);
         }
 
-        // wait for threads to finish work
-        unique_lock<mutex> lk(cv_m);
-        cv.wait(lk, [&]() { return work_done == work_total; });
+        // the calling thread works too, so nested loops can't starve waiting on busy threads
+        work();
+
+        unique_lock<mutex> lock(state->mutex_done);
+        state->condition_done.wait(lock, [&state]() { return state->done.load() == state->total; });
     }
 
     void ThreadPool::Flush(bool remove_queued /*= false*/)
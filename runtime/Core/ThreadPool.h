@@ -39,8 +39,9 @@ namespace Spartan
         // add a task
         static void AddTask(Task&& task);
 
-        // spread execution of a given function across all available threads
-        static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total);
+        // spread execution of a given function across all available threads, the calling thread takes part as well
+        // so it's safe to call from within a task, ranges are never shorter than work_per_task_min (except for the last one)
+        static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total, const uint32_t work_per_task_min = 1);
 
         // wait for all threads to finish work
         static void Flush(bool remove_queued = false);
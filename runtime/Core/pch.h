@@ -47,6 +47,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstdarg>
 #include <thread>
 #include <condition_variable>
+#include <shared_mutex>
 #include <set>
 #include <variant>
 #include <cstring>
@@ -0,0 +1,299 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==============
+#include "pch.h"
+#include "AssetContainer.h"
+#if defined(_MSC_VER) // windows
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        const uint32_t magic = asset_chunk_id("SPAC");
+
+        struct Header
+        {
+            uint32_t magic       = 0;
+            uint32_t version     = 0;
+            uint32_t chunk_count = 0;
+            uint32_t alignment   = 0;
+            uint64_t toc_offset  = 0;
+            uint64_t reserved    = 0;
+        };
+        static_assert(sizeof(Header) == 32);
+        static_assert(sizeof(AssetChunk) == 24);
+
+        uint64_t align(const uint64_t value)
+        {
+            return (value + AssetContainer::alignment - 1) & ~static_cast<uint64_t>(AssetContainer::alignment - 1);
+        }
+
+        bool chunk_less(const AssetChunk& a, const AssetChunk& b)
+        {
+            return a.id != b.id ? a.id < b.id : a.index < b.index;
+        }
+    }
+
+    void AssetContainerWriter::AddChunk(const uint32_t id, const uint32_t index, const void* data, const uint64_t size)
+    {
+        SP_ASSERT(data != nullptr || size == 0);
+        m_chunks.push_back({ id, index, data, size });
+    }
+
+    bool AssetContainerWriter::Write(const string& file_path) const
+    {
+        ofstream file(file_path, ios::binary | ios::trunc);
+        if (!file.is_open())
+        {
+            SP_LOG_ERROR("Failed to open \"%s\" for writing", file_path.c_str());
+            return false;
+        }
+
+        // lay out the chunks after the header, each one aligned
+        vector<AssetChunk> toc(m_chunks.size());
+        uint64_t offset = align(sizeof(Header));
+        for (size_t i = 0; i < m_chunks.size(); i++)
+        {
+            toc[i].id     = m_chunks[i].id;
+            toc[i].index  = m_chunks[i].index;
+            toc[i].offset = offset;
+            toc[i].size   = m_chunks[i].size;
+            offset        = align(offset + m_chunks[i].size);
+        }
+
+        Header header;
+        header.magic       = magic;
+        header.version     = AssetContainer::version;
+        header.chunk_count = static_cast<uint32_t>(toc.size());
+        header.alignment   = AssetContainer::alignment;
+        header.toc_offset  = offset;
+
+        // write everything in order, padding with zeros up to each offset
+        static const char padding[AssetContainer::alignment] = {};
+        uint64_t position = 0;
+        auto write = [&](const void* data, const uint64_t size)
+        {
+            file.write(static_cast<const char*>(data), static_cast<streamsize>(size));
+            position += size;
+        };
+        auto pad_to = [&](const uint64_t target)
+        {
+            write(padding, target - position);
+        };
+
+        write(&header, sizeof(header));
+        for (size_t i = 0; i < m_chunks.size(); i++)
+        {
+            pad_to(toc[i].offset);
+            write(m_chunks[i].data, m_chunks[i].size);
+        }
+        pad_to(header.toc_offset);
+        write(toc.data(), toc.size() * sizeof(AssetChunk));
+
+        if (file.fail())
+        {
+            SP_LOG_ERROR("Failed to write \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    AssetContainer::~AssetContainer()
+    {
+        Close();
+    }
+
+    bool AssetContainer::Open(const string& file_path)
+    {
+        Close();
+
+        #if defined(_MSC_VER)
+        HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size = {};
+        GetFileSizeEx(file, &size);
+        HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        void* data     = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!data)
+        {
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file    = file;
+        m_mapping = mapping;
+        m_size    = static_cast<uint64_t>(size.QuadPart);
+        #else
+        int file = open(file_path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+
+        struct stat stats = {};
+        fstat(file, &stats);
+        void* data = stats.st_size > 0 ? mmap(nullptr, static_cast<size_t>(stats.st_size), PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+        close(file); // the mapping keeps the file alive
+        if (data == MAP_FAILED)
+            return false;
+
+        m_size = static_cast<uint64_t>(stats.st_size);
+        #endif
+
+        m_data = static_cast<const std::byte*>(data);
+
+        // validate the header and the table of contents, a truncated or foreign file must not be trusted
+        Header header;
+        bool valid = m_size >= sizeof(Header);
+        if (valid)
+        {
+            memcpy(&header, m_data, sizeof(Header));
+            valid = header.magic == magic && header.version <= version && header.alignment == alignment;
+            valid = valid && header.toc_offset <= m_size && (m_size - header.toc_offset) / sizeof(AssetChunk) >= header.chunk_count;
+        }
+
+        if (valid)
+        {
+            m_chunks.resize(header.chunk_count);
+            memcpy(m_chunks.data(), m_data + header.toc_offset, header.chunk_count * sizeof(AssetChunk));
+
+            for (const AssetChunk& chunk : m_chunks)
+            {
+                valid = valid && chunk.offset <= header.toc_offset && chunk.size <= header.toc_offset - chunk.offset;
+            }
+
+            sort(m_chunks.begin(), m_chunks.end(), chunk_less);
+        }
+
+        if (!valid)
+        {
+            SP_LOG_ERROR("\"%s\" is not a valid asset container", file_path.c_str());
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void AssetContainer::Close()
+    {
+        if (!m_data)
+            return;
+
+        #if defined(_MSC_VER)
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+        CloseHandle(static_cast<HANDLE>(m_file));
+        #else
+        munmap(const_cast<std::byte*>(m_data), static_cast<size_t>(m_size));
+        #endif
+
+        m_data    = nullptr;
+        m_size    = 0;
+        m_file    = nullptr;
+        m_mapping = nullptr;
+        m_chunks.clear();
+    }
+
+    void AssetContainer::Prefetch() const
+    {
+        // touching a byte of every page makes the os read the file now, on the calling thread
+        const uint64_t page_size = 4096;
+        uint8_t sum              = 0;
+        for (uint64_t offset = 0; offset < m_size; offset += page_size)
+        {
+            sum += static_cast<uint8_t>(m_data[offset]);
+        }
+
+        // keep the reads from being optimized away
+        static atomic<uint8_t> sink = 0;
+        sink.fetch_add(sum, memory_order_relaxed);
+    }
+
+    bool AssetContainer::IsContainer(const string& file_path)
+    {
+        ifstream file(file_path, ios::binary);
+        Header header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+        return file.gcount() == sizeof(Header) && header.magic == magic;
+    }
+
+    const AssetChunk* AssetContainer::GetChunk(const uint32_t id, const uint32_t index) const
+    {
+        AssetChunk key;
+        key.id    = id;
+        key.index = index;
+
+        auto it = lower_bound(m_chunks.begin(), m_chunks.end(), key, chunk_less);
+        if (it == m_chunks.end() || it->id != id || it->index != index)
+            return nullptr;
+
+        return &(*it);
+    }
+
+    const std::byte* AssetContainer::GetChunkData(const uint32_t id, const uint32_t index, uint64_t* size) const
+    {
+        const AssetChunk* chunk = GetChunk(id, index);
+        if (!chunk)
+            return nullptr;
+
+        *size = chunk->size;
+        return m_data + chunk->offset;
+    }
+
+    uint32_t AssetContainer::GetChunkCount(const uint32_t id) const
+    {
+        auto range = equal_range(m_chunks.begin(), m_chunks.end(), AssetChunk{ id, 0 }, [](const AssetChunk& a, const AssetChunk& b) { return a.id < b.id; });
+        return static_cast<uint32_t>(distance(range.first, range.second));
+    }
+
+    bool AssetContainer::ReadChunk(const uint32_t id, const uint32_t index, string* text) const
+    {
+        uint64_t size = 0;
+        const std::byte* data = GetChunkData(id, index, &size);
+        if (!data)
+            return false;
+
+        text->assign(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+        return true;
+    }
+}
@@ -0,0 +1,141 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <string>
+#include "../Core/Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // four character code which identifies what a chunk holds, e.g. asset_chunk_id("TMIP")
+    constexpr uint32_t asset_chunk_id(const char (&code)[5])
+    {
+        return static_cast<uint32_t>(code[0]) | (static_cast<uint32_t>(code[1]) << 8) | (static_cast<uint32_t>(code[2]) << 16) | (static_cast<uint32_t>(code[3]) << 24);
+    }
+
+    // an entry of the table of contents
+    struct AssetChunk
+    {
+        uint32_t id     = 0;
+        uint32_t index  = 0; // distinguishes chunks of the same kind, e.g. a mip level or a lod
+        uint64_t offset = 0; // from the start of the file, always a multiple of AssetContainer::alignment
+        uint64_t size   = 0;
+    };
+
+    class SP_CLASS AssetContainerWriter
+    {
+    public:
+        // the data is referenced, not copied, so it has to stay alive until Write() returns
+        void AddChunk(const uint32_t id, const uint32_t index, const void* data, const uint64_t size);
+        void AddChunk(const uint32_t id, const uint32_t index, const std::string& text) { AddChunk(id, index, text.data(), text.size()); }
+
+        template<typename T>
+        void AddChunk(const uint32_t id, const uint32_t index, const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Chunk data must be trivially copyable");
+            AddChunk(id, index, values.data(), values.size() * sizeof(T));
+        }
+
+        bool Write(const std::string& file_path) const;
+
+    private:
+        struct PendingChunk
+        {
+            uint32_t id      = 0;
+            uint32_t index   = 0;
+            const void* data = nullptr;
+            uint64_t size    = 0;
+        };
+
+        std::vector<PendingChunk> m_chunks;
+    };
+
+    // a versioned file made of aligned chunks and a table of contents, it's memory mapped so chunks
+    // can be read on their own and handed straight to whatever consumes them, without intermediate copies
+    class SP_CLASS AssetContainer
+    {
+    public:
+        static constexpr uint32_t version   = 1;
+        static constexpr uint32_t alignment = 256; // enough for gpu buffer copies and any element type
+
+        AssetContainer() = default;
+        ~AssetContainer();
+        AssetContainer(const AssetContainer&) = delete;
+        AssetContainer& operator=(const AssetContainer&) = delete;
+
+        bool Open(const std::string& file_path);
+        void Close();
+        bool IsOpen() const { return m_data != nullptr; }
+        void Prefetch() const; // pages the whole file in, so that whoever reads the chunks later doesn't wait on the drive
+
+        // cheap check which only reads the header, used to tell containers apart from older formats
+        static bool IsContainer(const std::string& file_path);
+
+        // chunks
+        const AssetChunk* GetChunk(const uint32_t id, const uint32_t index = 0) const;
+        const std::byte* GetChunkData(const uint32_t id, const uint32_t index, uint64_t* size) const;
+        uint32_t GetChunkCount(const uint32_t id) const;
+        const std::vector<AssetChunk>& GetChunks() const { return m_chunks; }
+
+        template<typename T>
+        bool ReadChunk(const uint32_t id, const uint32_t index, T* value) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Chunk data must be trivially copyable");
+
+            uint64_t size = 0;
+            const std::byte* data = GetChunkData(id, index, &size);
+            if (!data || size != sizeof(T))
+                return false;
+
+            memcpy(value, data, sizeof(T));
+            return true;
+        }
+
+        template<typename T>
+        bool ReadChunk(const uint32_t id, const uint32_t index, std::vector<T>* values) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Chunk data must be trivially copyable");
+
+            uint64_t size = 0;
+            const std::byte* data = GetChunkData(id, index, &size);
+            if (!data || size % sizeof(T) != 0)
+                return false;
+
+            values->resize(size / sizeof(T));
+            memcpy(values->data(), data, size);
+            return true;
+        }
+
+        bool ReadChunk(const uint32_t id, const uint32_t index, std::string* text) const;
+
+    private:
+        const std::byte* m_data = nullptr;
+        uint64_t m_size         = 0;
+        std::vector<AssetChunk> m_chunks; // sorted by id and index
+        void* m_file            = nullptr;
+        void* m_mapping         = nullptr;
+    };
+}
@@ -0,0 +1,209 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===========
+#include "pch.h"
+#include "Compression.h"
+//======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        // a sequence is a token (literal length << 4 | match length - match_min), the literals, and a 16-bit offset
+        const uint32_t match_min     = 4;
+        const uint32_t offset_max    = 65535;
+        const uint32_t tail_literals = 5; // matches stop short of the end, so the last sequence is always literals
+        const uint32_t hash_bits     = 16;
+
+        uint32_t read_32(const uint8_t* data)
+        {
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint32_t hash(const uint32_t sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - hash_bits);
+        }
+
+        void write_length(vector<std::byte>* output, uint64_t length)
+        {
+            while (length >= 255)
+            {
+                output->emplace_back(static_cast<std::byte>(255));
+                length -= 255;
+            }
+            output->emplace_back(static_cast<std::byte>(length));
+        }
+
+        void write_sequence(vector<std::byte>* output, const uint8_t* literals, const uint64_t literal_count, const uint32_t offset, const uint64_t match_length)
+        {
+            const uint64_t match_code = match_length != 0 ? match_length - match_min : 0;
+            const uint8_t token       = static_cast<uint8_t>((min<uint64_t>(literal_count, 15) << 4) | min<uint64_t>(match_code, 15));
+            output->emplace_back(static_cast<std::byte>(token));
+
+            if (literal_count >= 15)
+            {
+                write_length(output, literal_count - 15);
+            }
+
+            const std::byte* literals_bytes = reinterpret_cast<const std::byte*>(literals);
+            output->insert(output->end(), literals_bytes, literals_bytes + literal_count);
+
+            // the last sequence has no match
+            if (match_length == 0)
+                return;
+
+            output->emplace_back(static_cast<std::byte>(offset & 0xFF));
+            output->emplace_back(static_cast<std::byte>(offset >> 8));
+
+            if (match_code >= 15)
+            {
+                write_length(output, match_code - 15);
+            }
+        }
+
+        bool read_length(const uint8_t*& input, const uint8_t* input_end, uint64_t* length)
+        {
+            uint8_t value = 0;
+            do
+            {
+                if (input >= input_end)
+                    return false;
+
+                value    = *input++;
+                *length += value;
+            } while (value == 255);
+
+            return true;
+        }
+    }
+
+    void Compression::Compress(const void* data, const uint64_t size, vector<std::byte>* compressed)
+    {
+        SP_ASSERT(compressed != nullptr);
+
+        const uint8_t* input = static_cast<const uint8_t*>(data);
+        compressed->clear();
+        compressed->reserve(size + size / 255 + 16);
+
+        uint64_t anchor = 0;
+        if (size > match_min + tail_literals)
+        {
+            vector<int64_t> table(static_cast<size_t>(1) << hash_bits, -1);
+            const uint64_t match_end = size - tail_literals;
+
+            uint64_t position = 0;
+            while (position + match_min <= match_end)
+            {
+                const uint32_t sequence = read_32(input + position);
+                const uint32_t slot     = hash(sequence);
+                const int64_t candidate = table[slot];
+                table[slot]             = static_cast<int64_t>(position);
+
+                if (candidate < 0 || position - candidate > offset_max || read_32(input + candidate) != sequence)
+                {
+                    position++;
+                    continue;
+                }
+
+                uint64_t match_length = match_min;
+                while (position + match_length < match_end && input[candidate + match_length] == input[position + match_length])
+                {
+                    match_length++;
+                }
+
+                write_sequence(compressed, input + anchor, position - anchor, static_cast<uint32_t>(position - candidate), match_length);
+                position += match_length;
+                anchor    = position;
+            }
+        }
+
+        write_sequence(compressed, input + anchor, size - anchor, 0, 0);
+    }
+
+    bool Compression::Decompress(const void* data, const uint64_t size, void* decompressed, const uint64_t decompressed_size)
+    {
+        const uint8_t* input     = static_cast<const uint8_t*>(data);
+        const uint8_t* input_end = input + size;
+        uint8_t* output          = static_cast<uint8_t*>(decompressed);
+        uint8_t* output_begin    = output;
+        uint8_t* output_end      = output + decompressed_size;
+
+        while (input < input_end)
+        {
+            const uint8_t token = *input++;
+
+            // literals
+            uint64_t literal_count = token >> 4;
+            if (literal_count == 15 && !read_length(input, input_end, &literal_count))
+                return false;
+
+            if (literal_count > static_cast<uint64_t>(input_end - input) || literal_count > static_cast<uint64_t>(output_end - output))
+                return false;
+
+            if (literal_count != 0)
+            {
+                memcpy(output, input, literal_count);
+            }
+            input  += literal_count;
+            output += literal_count;
+
+            // the last sequence ends with its literals
+            if (input == input_end)
+                break;
+
+            // match
+            if (input_end - input < 2)
+                return false;
+
+            const uint32_t offset = input[0] | (input[1] << 8);
+            input += 2;
+            if (offset == 0 || offset > static_cast<uint64_t>(output - output_begin))
+                return false;
+
+            uint64_t match_length = token & 0x0F;
+            if (match_length == 15 && !read_length(input, input_end, &match_length))
+                return false;
+            match_length += match_min;
+
+            if (match_length > static_cast<uint64_t>(output_end - output))
+                return false;
+
+            // byte by byte since the source can overlap the destination (that's how runs are encoded)
+            const uint8_t* source = output - offset;
+            for (uint64_t i = 0; i < match_length; i++)
+            {
+                output[i] = source[i];
+            }
+            output += match_length;
+        }
+
+        return output == output_end;
+    }
+}
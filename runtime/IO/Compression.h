@@ -0,0 +1,42 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include "../Core/Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // a byte oriented lz77 block codec, in the spirit of lz4, it's fast to decode and does well on serialized data
+    class SP_CLASS Compression
+    {
+    public:
+        // always succeeds, incompressible data grows by less than 1%
+        static void Compress(const void* data, const uint64_t size, std::vector<std::byte>* compressed);
+
+        // the decompressed size has to be known up front, returns false on malformed input
+        static bool Decompress(const void* data, const uint64_t size, void* decompressed, const uint64_t decompressed_size);
+    };
+}
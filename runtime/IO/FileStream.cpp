@@ -43,26 +43,41 @@ namespace Spartan
 
         if (m_flags & FileStream_Write)
         {
-            out.open(path, ios_flags);
-            if (out.fail())
+            if (!m_buffer_file.open(path, ios_flags))
             {
                 SP_LOG_ERROR("Failed to open \"%s\" for writing", path.c_str());
                 return;
             }
+            out.rdbuf(&m_buffer_file);
         }
         else if (m_flags & FileStream_Read)
         {
-            in.open(path, ios_flags);
-            if(in.fail())
+            if (!m_buffer_file.open(path, ios_flags))
             {
                 SP_LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
                 return;
             }
+            in.rdbuf(&m_buffer_file);
         }
 
         m_is_open = true;
     }
 
+    FileStream::FileStream(const std::byte* data, const uint64_t size)
+    {
+        m_flags            = FileStream_Read;
+        m_buffer_memory_in = make_unique<MemoryBuffer>(data, size);
+        in.rdbuf(m_buffer_memory_in.get());
+        m_is_open          = true;
+    }
+
+    FileStream::FileStream()
+    {
+        m_flags   = FileStream_Write;
+        out.rdbuf(&m_buffer_memory_out);
+        m_is_open = true;
+    }
+
     FileStream::~FileStream()
     {
         Close();
@@ -73,12 +88,15 @@ namespace Spartan
         if (m_flags & FileStream_Write)
         {
             out.flush();
-            out.close();
         }
         else if (m_flags & FileStream_Read)
         {
             in.clear();
-            in.close();
+        }
+
+        if (m_buffer_file.is_open())
+        {
+            m_buffer_file.close();
         }
     }
 
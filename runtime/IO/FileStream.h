@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <memory>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -45,8 +47,13 @@ namespace Spartan
     {
     public:
         FileStream(const std::string& path, uint32_t flags);
+        FileStream(const std::byte* data, const uint64_t size); // reads from memory, which has to outlive the stream
+        FileStream();                                            // writes to memory, see GetWrittenData()
         ~FileStream();
 
+        // what was written to a memory stream
+        std::string GetWrittenData() const { return m_buffer_memory_out.str(); }
+
         auto IsOpen() const { return m_is_open; }
         void Close();
 
@@ -155,8 +162,22 @@ namespace Spartan
         //=====================================================
 
     private:
-        std::ofstream out;
-        std::ifstream in;
+        // a read only view of memory
+        struct MemoryBuffer : std::streambuf
+        {
+            MemoryBuffer(const std::byte* data, const uint64_t size)
+            {
+                char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+                setg(begin, begin, begin + size);
+            }
+        };
+
+        // the streams write to a file or to memory depending on the buffer they are given
+        std::filebuf m_buffer_file;
+        std::stringbuf m_buffer_memory_out;
+        std::unique_ptr<MemoryBuffer> m_buffer_memory_in;
+        std::ostream out{ nullptr };
+        std::istream in{ nullptr };
         uint32_t m_flags;
         bool m_is_open;
     };
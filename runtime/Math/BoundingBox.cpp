@@ -111,16 +111,27 @@ namespace Spartan::Math
 
     BoundingBox BoundingBox::Transform(const Matrix& transform) const
     {
-        const Vector3 center_new = transform * GetCenter();
+        Simd::vec4 row_0, row_1, row_2, row_3;
+        transform.GetRows(row_0, row_1, row_2, row_3);
+
+        // transform the center as a point, transforms are affine so there is no perspective divide
+        const Vector3 center     = GetCenter();
+        Simd::vec4 center_new    = Simd::madd(row_0, Simd::splat(center.x), row_3);
+        center_new               = Simd::madd(row_1, Simd::splat(center.y), center_new);
+        center_new               = Simd::madd(row_2, Simd::splat(center.z), center_new);
+
+        // project the extent onto the absolute basis vectors
         const Vector3 extent_old = GetExtents();
-        const Vector3 extend_new = Vector3
-        (
-            Helper::Abs(transform.m00) * extent_old.x + Helper::Abs(transform.m10) * extent_old.y + Helper::Abs(transform.m20) * extent_old.z,
-            Helper::Abs(transform.m01) * extent_old.x + Helper::Abs(transform.m11) * extent_old.y + Helper::Abs(transform.m21) * extent_old.z,
-            Helper::Abs(transform.m02) * extent_old.x + Helper::Abs(transform.m12) * extent_old.y + Helper::Abs(transform.m22) * extent_old.z
-        );
-
-        return BoundingBox(center_new - extend_new, center_new + extend_new);
+        Simd::vec4 extent_new    = Simd::mul(Simd::abs(row_0), Simd::splat(extent_old.x));
+        extent_new               = Simd::madd(Simd::abs(row_1), Simd::splat(extent_old.y), extent_new);
+        extent_new               = Simd::madd(Simd::abs(row_2), Simd::splat(extent_old.z), extent_new);
+
+        float min[4];
+        float max[4];
+        Simd::store(min, Simd::sub(center_new, extent_new));
+        Simd::store(max, Simd::add(center_new, extent_new));
+
+        return BoundingBox(Vector3(min[0], min[1], min[2]), Vector3(max[0], max[1], max[2]));
     }
 
     void BoundingBox::Merge(const BoundingBox& box)
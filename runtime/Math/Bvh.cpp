@@ -0,0 +1,403 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======
+#include "pch.h"
+#include "Bvh.h"
+//==================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+    namespace
+    {
+        float surface_area(const BoundingBox& box)
+        {
+            const Vector3 size = box.GetSize();
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+        {
+            BoundingBox result = a;
+            result.Merge(b);
+            return result;
+        }
+
+        BoundingBox fatten(const BoundingBox& box)
+        {
+            // a small absolute margin plus a fraction of the size, so both tiny and large objects can move a bit
+            const Vector3 margin = box.GetSize() * 0.1f + Vector3(0.1f, 0.1f, 0.1f);
+            return BoundingBox(box.GetMin() - margin, box.GetMax() + margin);
+        }
+
+        bool contains(const BoundingBox& outer, const BoundingBox& inner)
+        {
+            return inner.GetMin().x >= outer.GetMin().x && inner.GetMin().y >= outer.GetMin().y && inner.GetMin().z >= outer.GetMin().z &&
+                   inner.GetMax().x <= outer.GetMax().x && inner.GetMax().y <= outer.GetMax().y && inner.GetMax().z <= outer.GetMax().z;
+        }
+    }
+
+    int32_t Bvh::Insert(const BoundingBox& box, void* user_data)
+    {
+        const int32_t proxy       = AllocateNode();
+        m_nodes[proxy].box_tight  = box;
+        m_nodes[proxy].box        = fatten(box);
+        m_nodes[proxy].user_data  = user_data;
+        m_nodes[proxy].height     = 0;
+
+        InsertLeaf(proxy);
+        m_proxy_count++;
+
+        return proxy;
+    }
+
+    void Bvh::Remove(const int32_t proxy)
+    {
+        SP_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()));
+        SP_ASSERT(m_nodes[proxy].IsLeaf());
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_proxy_count--;
+    }
+
+    bool Bvh::Update(const int32_t proxy, const BoundingBox& box)
+    {
+        SP_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()));
+        SP_ASSERT(m_nodes[proxy].IsLeaf());
+
+        // still within the fattened box, the tree doesn't have to change
+        m_nodes[proxy].box_tight = box;
+        if (contains(m_nodes[proxy].box, box))
+            return false;
+
+        RemoveLeaf(proxy);
+        m_nodes[proxy].box = fatten(box);
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    void Bvh::Clear()
+    {
+        m_nodes.clear();
+        m_root        = null_node;
+        m_free_list   = null_node;
+        m_proxy_count = 0;
+    }
+
+    float Bvh::HitDistance(const BoundingBox& box, const Vector3& origin, const Vector3& direction_inv)
+    {
+        const Vector3& box_min = box.GetMin();
+        const Vector3& box_max = box.GetMax();
+
+        // undefined boxes would otherwise produce an infinite slab
+        if (box_min.x > box_max.x)
+            return Helper::INFINITY_;
+
+        const float t1_x = (box_min.x - origin.x) * direction_inv.x;
+        const float t2_x = (box_max.x - origin.x) * direction_inv.x;
+        const float t1_y = (box_min.y - origin.y) * direction_inv.y;
+        const float t2_y = (box_max.y - origin.y) * direction_inv.y;
+        const float t1_z = (box_min.z - origin.z) * direction_inv.z;
+        const float t2_z = (box_max.z - origin.z) * direction_inv.z;
+
+        const float t_near = max(max(min(t1_x, t2_x), min(t1_y, t2_y)), min(t1_z, t2_z));
+        const float t_far  = min(min(max(t1_x, t2_x), max(t1_y, t2_y)), max(t1_z, t2_z));
+
+        if (t_far < 0.0f || t_near > t_far)
+            return Helper::INFINITY_;
+
+        return max(t_near, 0.0f);
+    }
+
+    float Bvh::DistanceSquared(const BoundingBox& box, const Vector3& point)
+    {
+        const Vector3 closest = Vector3(
+            Helper::Clamp(point.x, box.GetMin().x, box.GetMax().x),
+            Helper::Clamp(point.y, box.GetMin().y, box.GetMax().y),
+            Helper::Clamp(point.z, box.GetMin().z, box.GetMax().z)
+        );
+
+        return (closest - point).LengthSquared();
+    }
+
+    int32_t Bvh::AllocateNode()
+    {
+        if (m_free_list == null_node)
+        {
+            m_nodes.emplace_back();
+            return static_cast<int32_t>(m_nodes.size() - 1);
+        }
+
+        const int32_t node   = m_free_list;
+        m_free_list          = m_nodes[node].parent;
+        m_nodes[node]        = Node();
+        return node;
+    }
+
+    void Bvh::FreeNode(const int32_t node)
+    {
+        m_nodes[node].parent    = m_free_list;
+        m_nodes[node].height    = -1;
+        m_nodes[node].user_data = nullptr;
+        m_free_list             = node;
+    }
+
+    void Bvh::InsertLeaf(const int32_t leaf)
+    {
+        if (m_root == null_node)
+        {
+            m_root                = leaf;
+            m_nodes[leaf].parent  = null_node;
+            return;
+        }
+
+        // find the best sibling by walking down the tree and estimating the surface area cost
+        const BoundingBox box_leaf = m_nodes[leaf].box;
+        int32_t index              = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node            = m_nodes[index];
+            const float area            = surface_area(node.box);
+            const float area_combined   = surface_area(merge(node.box, box_leaf));
+
+            // cost of creating a new parent for this node and the new leaf
+            const float cost = 2.0f * area_combined;
+
+            // minimum cost of pushing the leaf further down the tree
+            const float cost_inheritance = 2.0f * (area_combined - area);
+
+            auto cost_descend = [&](const int32_t child)
+            {
+                const Node& child_node = m_nodes[child];
+                const float area_new   = surface_area(merge(box_leaf, child_node.box));
+                return child_node.IsLeaf() ? area_new + cost_inheritance : (area_new - surface_area(child_node.box)) + cost_inheritance;
+            };
+
+            const float cost_left  = cost_descend(node.child_left);
+            const float cost_right = cost_descend(node.child_right);
+
+            if (cost < cost_left && cost < cost_right)
+                break;
+
+            index = cost_left < cost_right ? node.child_left : node.child_right;
+        }
+
+        // create a new parent for the sibling and the leaf
+        const int32_t sibling    = index;
+        const int32_t parent_old = m_nodes[sibling].parent;
+        const int32_t parent_new = AllocateNode();
+
+        m_nodes[parent_new].parent      = parent_old;
+        m_nodes[parent_new].box         = merge(box_leaf, m_nodes[sibling].box);
+        m_nodes[parent_new].height      = m_nodes[sibling].height + 1;
+        m_nodes[parent_new].child_left  = sibling;
+        m_nodes[parent_new].child_right = leaf;
+        m_nodes[sibling].parent         = parent_new;
+        m_nodes[leaf].parent            = parent_new;
+
+        if (parent_old != null_node)
+        {
+            if (m_nodes[parent_old].child_left == sibling)
+            {
+                m_nodes[parent_old].child_left = parent_new;
+            }
+            else
+            {
+                m_nodes[parent_old].child_right = parent_new;
+            }
+        }
+        else
+        {
+            m_root = parent_new;
+        }
+
+        RefitAncestors(m_nodes[leaf].parent);
+    }
+
+    void Bvh::RemoveLeaf(const int32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null_node;
+            return;
+        }
+
+        const int32_t parent       = m_nodes[leaf].parent;
+        const int32_t grand_parent = m_nodes[parent].parent;
+        const int32_t sibling      = m_nodes[parent].child_left == leaf ? m_nodes[parent].child_right : m_nodes[parent].child_left;
+
+        // the sibling takes the place of the parent
+        if (grand_parent != null_node)
+        {
+            if (m_nodes[grand_parent].child_left == parent)
+            {
+                m_nodes[grand_parent].child_left = sibling;
+            }
+            else
+            {
+                m_nodes[grand_parent].child_right = sibling;
+            }
+
+            m_nodes[sibling].parent = grand_parent;
+            FreeNode(parent);
+            RefitAncestors(grand_parent);
+        }
+        else
+        {
+            m_root                  = sibling;
+            m_nodes[sibling].parent = null_node;
+            FreeNode(parent);
+        }
+    }
+
+    void Bvh::RefitAncestors(int32_t index)
+    {
+        while (index != null_node)
+        {
+            index = Balance(index);
+
+            Node& node              = m_nodes[index];
+            const Node& child_left  = m_nodes[node.child_left];
+            const Node& child_right = m_nodes[node.child_right];
+
+            node.height = 1 + max(child_left.height, child_right.height);
+            node.box    = merge(child_left.box, child_right.box);
+
+            index = node.parent;
+        }
+    }
+
+    int32_t Bvh::Balance(const int32_t index_a)
+    {
+        // performs a left or right rotation if node a is imbalanced, returns the new root of the subtree
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+            return index_a;
+
+        const int32_t index_b = a.child_left;
+        const int32_t index_c = a.child_right;
+        Node& b               = m_nodes[index_b];
+        Node& c               = m_nodes[index_c];
+
+        auto replace_in_parent = [this, index_a](Node& node, const int32_t index)
+        {
+            if (node.parent != null_node)
+            {
+                if (m_nodes[node.parent].child_left == index_a)
+                {
+                    m_nodes[node.parent].child_left = index;
+                }
+                else
+                {
+                    m_nodes[node.parent].child_right = index;
+                }
+            }
+            else
+            {
+                m_root = index;
+            }
+        };
+
+        const int32_t balance = c.height - b.height;
+
+        // rotate c up
+        if (balance > 1)
+        {
+            const int32_t index_f = c.child_left;
+            const int32_t index_g = c.child_right;
+            Node& f               = m_nodes[index_f];
+            Node& g               = m_nodes[index_g];
+
+            c.child_left = index_a;
+            c.parent     = a.parent;
+            a.parent     = index_c;
+            replace_in_parent(c, index_c);
+
+            if (f.height > g.height)
+            {
+                c.child_right = index_f;
+                a.child_right = index_g;
+                g.parent      = index_a;
+                a.box         = merge(b.box, g.box);
+                c.box         = merge(a.box, f.box);
+                a.height      = 1 + max(b.height, g.height);
+                c.height      = 1 + max(a.height, f.height);
+            }
+            else
+            {
+                c.child_right = index_g;
+                a.child_right = index_f;
+                f.parent      = index_a;
+                a.box         = merge(b.box, f.box);
+                c.box         = merge(a.box, g.box);
+                a.height      = 1 + max(b.height, f.height);
+                c.height      = 1 + max(a.height, g.height);
+            }
+
+            return index_c;
+        }
+
+        // rotate b up
+        if (balance < -1)
+        {
+            const int32_t index_d = b.child_left;
+            const int32_t index_e = b.child_right;
+            Node& d               = m_nodes[index_d];
+            Node& e               = m_nodes[index_e];
+
+            b.child_left = index_a;
+            b.parent     = a.parent;
+            a.parent     = index_b;
+            replace_in_parent(b, index_b);
+
+            if (d.height > e.height)
+            {
+                b.child_right = index_d;
+                a.child_left  = index_e;
+                e.parent      = index_a;
+                a.box         = merge(c.box, e.box);
+                b.box         = merge(a.box, d.box);
+                a.height      = 1 + max(c.height, e.height);
+                b.height      = 1 + max(a.height, d.height);
+            }
+            else
+            {
+                b.child_right = index_e;
+                a.child_left  = index_d;
+                d.parent      = index_a;
+                a.box         = merge(c.box, d.box);
+                b.box         = merge(a.box, e.box);
+                a.height      = 1 + max(c.height, d.height);
+                b.height      = 1 + max(a.height, e.height);
+            }
+
+            return index_b;
+        }
+
+        return index_a;
+    }
+}
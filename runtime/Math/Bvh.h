@@ -0,0 +1,236 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ============
+#include <vector>
+#include "BoundingBox.h"
+#include "Frustum.h"
+#include "Ray.h"
+#include "Sphere.h"
+//=======================
+
+namespace Spartan::Math
+{
+    // a dynamic bounding volume hierarchy, leaves are stored with a fattened box so that objects
+    // which move a little don't have to be re-inserted, the tree is kept balanced with rotations
+    class Bvh
+    {
+    public:
+        static constexpr int32_t null_node = -1;
+
+        Bvh() = default;
+        ~Bvh() = default;
+
+        // returns a proxy which identifies the leaf
+        int32_t Insert(const BoundingBox& box, void* user_data);
+        void Remove(const int32_t proxy);
+
+        // call when the object has moved, only re-inserts when the box has left its fattened box
+        // returns true if the proxy was re-inserted
+        bool Update(const int32_t proxy, const BoundingBox& box);
+
+        void Clear();
+        void* GetUserData(const int32_t proxy) const   { return m_nodes[proxy].user_data; }
+        const BoundingBox& GetBox(const int32_t proxy) const { return m_nodes[proxy].box_tight; }
+        uint32_t GetProxyCount() const                 { return m_proxy_count; }
+        uint32_t GetHeight() const                     { return m_root == null_node ? 0 : m_nodes[m_root].height; }
+
+        // queries invoke callback(void* user_data) for every leaf whose exact box passes the test
+        template<typename Callback>
+        void QueryBox(const BoundingBox& box, Callback&& callback) const
+        {
+            Traverse(
+                [&box](const BoundingBox& node_box) { return node_box.Intersects(box) != Intersection::Outside; },
+                [&box, &callback](const Node& leaf)
+                {
+                    if (leaf.box_tight.Intersects(box) != Intersection::Outside)
+                    {
+                        callback(leaf.user_data);
+                    }
+                }
+            );
+        }
+
+        template<typename Callback>
+        void QuerySphere(const Sphere& sphere, Callback&& callback) const
+        {
+            const float radius_squared = sphere.radius * sphere.radius;
+            Traverse(
+                [&](const BoundingBox& node_box) { return DistanceSquared(node_box, sphere.center) <= radius_squared; },
+                [&](const Node& leaf)
+                {
+                    if (DistanceSquared(leaf.box_tight, sphere.center) <= radius_squared)
+                    {
+                        callback(leaf.user_data);
+                    }
+                }
+            );
+        }
+
+        // subtrees that are fully inside the frustum are accepted without testing their children
+        template<typename Callback>
+        void QueryFrustum(const Frustum& frustum, Callback&& callback, const bool ignore_depth = false) const
+        {
+            if (m_root == null_node)
+                return;
+
+            int32_t stack[stack_size];
+            uint32_t stack_count = 0;
+            stack[stack_count++] = m_root;
+            while (stack_count > 0)
+            {
+                const Node& node = m_nodes[stack[--stack_count]];
+
+                const BoundingBox& box    = node.IsLeaf() ? node.box_tight : node.box;
+                Intersection intersection = frustum.GetIntersection(box.GetCenter(), box.GetExtents(), ignore_depth);
+                if (intersection == Intersection::Outside)
+                    continue;
+
+                if (intersection == Intersection::Inside)
+                {
+                    ForEachLeaf(node, callback);
+                    continue;
+                }
+
+                if (node.IsLeaf())
+                {
+                    callback(node.user_data);
+                }
+                else
+                {
+                    SP_ASSERT(stack_count + 2 <= stack_size);
+                    stack[stack_count++] = node.child_left;
+                    stack[stack_count++] = node.child_right;
+                }
+            }
+        }
+
+        // invokes callback(void* user_data, float distance) for every leaf the ray hits within max_distance
+        // the callback returns the new max distance, return the hit distance to only keep looking for closer hits
+        template<typename Callback>
+        void QueryRay(const Ray& ray, float max_distance, Callback&& callback) const
+        {
+            const Vector3& origin        = ray.GetStart();
+            const Vector3& direction     = ray.GetDirection();
+            const Vector3 direction_inv  = Vector3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+            Traverse(
+                [&](const BoundingBox& node_box) { return HitDistance(node_box, origin, direction_inv) <= max_distance; },
+                [&](const Node& leaf)
+                {
+                    const float distance = HitDistance(leaf.box_tight, origin, direction_inv);
+                    if (distance <= max_distance)
+                    {
+                        max_distance = callback(leaf.user_data, distance);
+                    }
+                }
+            );
+        }
+
+        // slab test, returns 0 if the origin is inside the box and infinity if there is no hit
+        static float HitDistance(const BoundingBox& box, const Vector3& origin, const Vector3& direction_inv);
+        static float DistanceSquared(const BoundingBox& box, const Vector3& point);
+
+    private:
+        static constexpr uint32_t stack_size = 256;
+
+        struct Node
+        {
+            bool IsLeaf() const { return child_left == null_node; }
+
+            BoundingBox box;       // fattened for leaves, union of the children for internal nodes
+            BoundingBox box_tight; // the actual box of a leaf
+            void* user_data     = nullptr;
+            int32_t parent      = null_node; // doubles as the next free node when the node is unused
+            int32_t child_left  = null_node;
+            int32_t child_right = null_node;
+            int32_t height      = 0;   // leaf = 0, free node = -1
+        };
+
+        int32_t AllocateNode();
+        void FreeNode(const int32_t node);
+        void InsertLeaf(const int32_t leaf);
+        void RemoveLeaf(const int32_t leaf);
+        int32_t Balance(const int32_t node);
+        void RefitAncestors(int32_t node);
+
+        template<typename Test, typename Visit>
+        void Traverse(Test&& test, Visit&& visit) const
+        {
+            if (m_root == null_node)
+                return;
+
+            int32_t stack[stack_size];
+            uint32_t stack_count = 0;
+            stack[stack_count++] = m_root;
+            while (stack_count > 0)
+            {
+                const Node& node = m_nodes[stack[--stack_count]];
+                if (!test(node.box))
+                    continue;
+
+                if (node.IsLeaf())
+                {
+                    visit(node);
+                }
+                else
+                {
+                    SP_ASSERT(stack_count + 2 <= stack_size);
+                    stack[stack_count++] = node.child_left;
+                    stack[stack_count++] = node.child_right;
+                }
+            }
+        }
+
+        template<typename Callback>
+        void ForEachLeaf(const Node& root, Callback& callback) const
+        {
+            int32_t stack[stack_size];
+            uint32_t stack_count = 0;
+            const Node* node     = &root;
+            while (true)
+            {
+                if (node->IsLeaf())
+                {
+                    callback(node->user_data);
+                }
+                else
+                {
+                    SP_ASSERT(stack_count + 2 <= stack_size);
+                    stack[stack_count++] = node->child_left;
+                    stack[stack_count++] = node->child_right;
+                }
+
+                if (stack_count == 0)
+                    break;
+
+                node = &m_nodes[stack[--stack_count]];
+            }
+        }
+
+        std::vector<Node> m_nodes;
+        int32_t m_root         = null_node;
+        int32_t m_free_list    = null_node;
+        uint32_t m_proxy_count = 0;
+    };
+}
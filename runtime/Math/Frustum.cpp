@@ -94,6 +94,112 @@ namespace Spartan::Math
         return CheckCube(center, extent, ignore_depth) != Intersection::Outside;
     }
 
+    void AabbSoA::Clear()
+    {
+        center_x.clear(); center_y.clear(); center_z.clear();
+        extent_x.clear(); extent_y.clear(); extent_z.clear();
+    }
+
+    void AabbSoA::Reserve(const uint32_t count)
+    {
+        center_x.reserve(count); center_y.reserve(count); center_z.reserve(count);
+        extent_x.reserve(count); extent_y.reserve(count); extent_z.reserve(count);
+    }
+
+    void AabbSoA::Add(const BoundingBox& box)
+    {
+        // undefined boxes produce nan centers, these fail every plane test and end up culled
+        const Vector3 center = box.GetCenter();
+        const Vector3 extent = box.GetExtents();
+
+        center_x.push_back(center.x); center_y.push_back(center.y); center_z.push_back(center.z);
+        extent_x.push_back(extent.x); extent_y.push_back(extent.y); extent_z.push_back(extent.z);
+    }
+
+    void Frustum::CullBoxes(const AabbSoA& boxes, uint8_t* out_mask, bool ignore_depth /*= false*/) const
+    {
+        CullBoxes(this, 1, boxes, out_mask, ignore_depth);
+    }
+
+    void Frustum::CullBoxes(const Frustum* frustums, const uint32_t frustum_count, const AabbSoA& boxes, uint8_t* out_masks, bool ignore_depth /*= false*/)
+    {
+        SP_ASSERT(frustum_count <= 8);
+
+        const uint32_t box_count = boxes.GetCount();
+        memset(out_masks, 0, box_count);
+
+        // skip near and far plane checks if depth is to be ignored
+        const uint32_t plane_start = ignore_depth ? 2 : 0;
+
+        for (uint32_t frustum_index = 0; frustum_index < frustum_count; frustum_index++)
+        {
+            const Plane* planes = frustums[frustum_index].m_planes;
+            const uint8_t bit   = static_cast<uint8_t>(1u << frustum_index);
+
+            // splat the planes once, they are reused for every group of 4 boxes
+            Simd::vec4 n_x[6], n_y[6], n_z[6], n_abs_x[6], n_abs_y[6], n_abs_z[6], d[6];
+            for (uint32_t i = plane_start; i < 6; i++)
+            {
+                n_x[i]     = Simd::splat(planes[i].normal.x);
+                n_y[i]     = Simd::splat(planes[i].normal.y);
+                n_z[i]     = Simd::splat(planes[i].normal.z);
+                n_abs_x[i] = Simd::splat(Helper::Abs(planes[i].normal.x));
+                n_abs_y[i] = Simd::splat(Helper::Abs(planes[i].normal.y));
+                n_abs_z[i] = Simd::splat(Helper::Abs(planes[i].normal.z));
+                d[i]       = Simd::splat(planes[i].d);
+            }
+
+            // 4 boxes at a time, a box is visible if it isn't fully behind any plane
+            const Simd::vec4 zero = Simd::splat(0.0f);
+            uint32_t box_index    = 0;
+            for (; box_index + 4 <= box_count; box_index += 4)
+            {
+                const Simd::vec4 c_x = Simd::load(&boxes.center_x[box_index]);
+                const Simd::vec4 c_y = Simd::load(&boxes.center_y[box_index]);
+                const Simd::vec4 c_z = Simd::load(&boxes.center_z[box_index]);
+                const Simd::vec4 e_x = Simd::load(&boxes.extent_x[box_index]);
+                const Simd::vec4 e_y = Simd::load(&boxes.extent_y[box_index]);
+                const Simd::vec4 e_z = Simd::load(&boxes.extent_z[box_index]);
+
+                Simd::vec4 visible = Simd::greater_equal(zero, zero);
+                for (uint32_t i = plane_start; i < 6; i++)
+                {
+                    // signed distance of the center plus the projected radius of the box
+                    Simd::vec4 distance = Simd::madd(c_x, n_x[i], d[i]);
+                    distance            = Simd::madd(c_y, n_y[i], distance);
+                    distance            = Simd::madd(c_z, n_z[i], distance);
+                    distance            = Simd::madd(e_x, n_abs_x[i], distance);
+                    distance            = Simd::madd(e_y, n_abs_y[i], distance);
+                    distance            = Simd::madd(e_z, n_abs_z[i], distance);
+                    visible             = Simd::bit_and(visible, Simd::greater_equal(distance, zero));
+                }
+
+                const uint32_t mask = Simd::move_mask(visible);
+                out_masks[box_index + 0] |= (mask & 1) ? bit : 0;
+                out_masks[box_index + 1] |= (mask & 2) ? bit : 0;
+                out_masks[box_index + 2] |= (mask & 4) ? bit : 0;
+                out_masks[box_index + 3] |= (mask & 8) ? bit : 0;
+            }
+
+            // remainder
+            for (; box_index < box_count; box_index++)
+            {
+                bool visible = true;
+                for (uint32_t i = plane_start; i < 6 && visible; i++)
+                {
+                    const Plane& plane = planes[i];
+                    const float distance =
+                        boxes.center_x[box_index] * plane.normal.x + boxes.center_y[box_index] * plane.normal.y + boxes.center_z[box_index] * plane.normal.z +
+                        boxes.extent_x[box_index] * Helper::Abs(plane.normal.x) + boxes.extent_y[box_index] * Helper::Abs(plane.normal.y) + boxes.extent_z[box_index] * Helper::Abs(plane.normal.z);
+
+                    visible = distance + plane.d >= 0.0f;
+                }
+
+                out_masks[box_index] |= visible ? bit : 0;
+            }
+        }
+    }
+
     Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth /*= false*/) const
     {
         SP_ASSERT(!center.IsNaN() && !extent.IsNaN());
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../Math/Plane.h"
 #include "Matrix.h"
 #include "Vector3.h"
@@ -29,6 +30,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan::Math
 {
+    class BoundingBox;
+
+    // axis-aligned boxes stored as a structure of arrays (center/extent), this is the layout the batched culling consumes
+    class AabbSoA
+    {
+    public:
+        void Clear();
+        void Reserve(const uint32_t count);
+        void Add(const BoundingBox& box);
+        uint32_t GetCount() const { return static_cast<uint32_t>(center_x.size()); }
+
+        std::vector<float> center_x, center_y, center_z;
+        std::vector<float> extent_x, extent_y, extent_z;
+    };
+
     class Frustum
     {
     public:
@@ -38,6 +54,16 @@ namespace Spartan::Math
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_depth = false) const;
 
+        // distinguishes between fully inside and intersecting, useful for hierarchical culling
+        Intersection GetIntersection(const Vector3& center, const Vector3& extent, bool ignore_depth = false) const { return CheckCube(center, extent, ignore_depth); }
+
+        // tests many boxes at once, out_mask[i] is 1 if box i is visible and 0 if it's not
+        void CullBoxes(const AabbSoA& boxes, uint8_t* out_mask, bool ignore_depth = false) const;
+
+        // tests many boxes against several frustums (e.g. shadow cascades) in one pass
+        // bit j of out_masks[i] is set if box i is visible from frustums[j], up to 8 frustums
+        static void CullBoxes(const Frustum* frustums, const uint32_t frustum_count, const AabbSoA& boxes, uint8_t* out_masks, bool ignore_depth = false);
+
     private:
         Intersection CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth = false) const;
         Intersection CheckSphere(const Vector3& center, float radius, float ignore_depth = false) const;
@@ -25,11 +25,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "Simd.h"
 //=====================
 
 namespace Spartan::Math
 {
-    class SP_CLASS Matrix
+    // 16 byte aligned so that each column can be loaded straight into a simd register
+    class SP_CLASS alignas(16) Matrix
     {
     public:
         Matrix()
@@ -121,10 +123,11 @@ namespace Spartan::Math
             );
         }
 
-        [[nodiscard]] Quaternion GetRotation() const
-        {
-            const Vector3 scale = GetScale();
+        [[nodiscard]] Quaternion GetRotation() const { return GetRotation(GetScale()); }
 
+        // same as above but with the scale provided, avoids extracting it twice when decomposing
+        [[nodiscard]] Quaternion GetRotation(const Vector3& scale) const
+        {
             // avoid division by zero (division is needed to remove scaling)
             if (scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f)
                 return Quaternion::Identity;
@@ -280,6 +283,16 @@ namespace Spartan::Math
 
         [[nodiscard]] Matrix Inverted() const { return Invert(*this); }
         static inline Matrix Invert(const Matrix& matrix)
+        {
+        #if defined(SP_SIMD_SSE)
+            return InvertSse(matrix);
+        #else
+            return InvertScalar(matrix);
+        #endif
+        }
+
+        // reference implementation, also used by the backends that don't have a dedicated path
+        static inline Matrix InvertScalar(const Matrix& matrix)
         {
             float v0 = matrix.m20 * matrix.m31 - matrix.m21 * matrix.m30;
             float v1 = matrix.m20 * matrix.m32 - matrix.m22 * matrix.m30;
@@ -336,11 +349,79 @@ namespace Spartan::Math
                 i30, i31, i32, i33);
         }
 
+    #if defined(SP_SIMD_SSE)
+        // block-wise inverse using 2x2 sub-matrices, since inverse(transpose(m)) = transpose(inverse(m))
+        // it operates on the columns directly and the result comes out in the same memory layout
+        static inline Matrix InvertSse(const Matrix& matrix)
+        {
+            // 2x2 matrix helpers, a 2x2 matrix is packed as (m00, m01, m10, m11)
+            #define SP_SWIZZLE(v, x, y, z, w)    _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x)))
+            #define SP_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+            auto mat2_mul     = [](__m128 a, __m128 b) { return _mm_add_ps(_mm_mul_ps(a, SP_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SP_SWIZZLE(a, 1, 0, 3, 2), SP_SWIZZLE(b, 2, 1, 2, 1))); };
+            auto mat2_adj_mul = [](__m128 a, __m128 b) { return _mm_sub_ps(_mm_mul_ps(SP_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SP_SWIZZLE(a, 1, 1, 2, 2), SP_SWIZZLE(b, 2, 3, 0, 1))); };
+            auto mat2_mul_adj = [](__m128 a, __m128 b) { return _mm_sub_ps(_mm_mul_ps(a, SP_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SP_SWIZZLE(a, 1, 0, 3, 2), SP_SWIZZLE(b, 2, 1, 2, 1))); };
+
+            const float* data = matrix.Data();
+            const __m128 c0   = _mm_load_ps(data + 0);
+            const __m128 c1   = _mm_load_ps(data + 4);
+            const __m128 c2   = _mm_load_ps(data + 8);
+            const __m128 c3   = _mm_load_ps(data + 12);
+
+            // sub-matrices
+            const __m128 a = _mm_movelh_ps(c0, c1);
+            const __m128 b = _mm_movehl_ps(c1, c0);
+            const __m128 c = _mm_movelh_ps(c2, c3);
+            const __m128 d = _mm_movehl_ps(c3, c2);
+
+            // determinants of the sub-matrices
+            const __m128 det_sub = _mm_sub_ps(
+                _mm_mul_ps(SP_SHUFFLE(c0, c2, 0, 2, 0, 2), SP_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+                _mm_mul_ps(SP_SHUFFLE(c0, c2, 1, 3, 1, 3), SP_SHUFFLE(c1, c3, 0, 2, 0, 2))
+            );
+            const __m128 det_a = SP_SWIZZLE(det_sub, 0, 0, 0, 0);
+            const __m128 det_b = SP_SWIZZLE(det_sub, 1, 1, 1, 1);
+            const __m128 det_c = SP_SWIZZLE(det_sub, 2, 2, 2, 2);
+            const __m128 det_d = SP_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+            const __m128 d_c = mat2_adj_mul(d, c);
+            const __m128 a_b = mat2_adj_mul(a, b);
+            __m128 x         = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul(b, d_c));
+            __m128 w         = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_mul(c, a_b));
+            __m128 y         = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj(d, a_b));
+            __m128 z         = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj(a, d_c));
+
+            // determinant of the whole matrix
+            __m128 det = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+            __m128 tr  = _mm_mul_ps(a_b, SP_SWIZZLE(d_c, 0, 2, 1, 3));
+            tr         = _mm_add_ps(tr, SP_SWIZZLE(tr, 2, 3, 0, 1));
+            tr         = _mm_add_ps(tr, SP_SWIZZLE(tr, 1, 0, 3, 2));
+            det        = _mm_sub_ps(det, tr);
+
+            const __m128 det_inv = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+            x = _mm_mul_ps(x, det_inv);
+            y = _mm_mul_ps(y, det_inv);
+            z = _mm_mul_ps(z, det_inv);
+            w = _mm_mul_ps(w, det_inv);
+
+            Matrix result;
+            float* data_out = &result.m00;
+            _mm_store_ps(data_out + 0,  SP_SHUFFLE(x, y, 3, 1, 3, 1));
+            _mm_store_ps(data_out + 4,  SP_SHUFFLE(x, y, 2, 0, 2, 0));
+            _mm_store_ps(data_out + 8,  SP_SHUFFLE(z, w, 3, 1, 3, 1));
+            _mm_store_ps(data_out + 12, SP_SHUFFLE(z, w, 2, 0, 2, 0));
+
+            #undef SP_SWIZZLE
+            #undef SP_SHUFFLE
+
+            return result;
+        }
+    #endif
+
         void Decompose(Vector3& scale, Quaternion& rotation, Vector3& translation) const
         {
             translation = GetTranslation();
             scale       = GetScale();
-            rotation    = GetRotation();
+            rotation    = GetRotation(scale);
         }
 
         void SetIdentity()
@@ -353,55 +434,79 @@ namespace Spartan::Math
 
         Matrix operator*(const Matrix& rhs) const
         {
-            return Matrix(
-                m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20 + m03 * rhs.m30,
-                m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21 + m03 * rhs.m31,
-                m00 * rhs.m02 + m01 * rhs.m12 + m02 * rhs.m22 + m03 * rhs.m32,
-                m00 * rhs.m03 + m01 * rhs.m13 + m02 * rhs.m23 + m03 * rhs.m33,
-                m10 * rhs.m00 + m11 * rhs.m10 + m12 * rhs.m20 + m13 * rhs.m30,
-                m10 * rhs.m01 + m11 * rhs.m11 + m12 * rhs.m21 + m13 * rhs.m31,
-                m10 * rhs.m02 + m11 * rhs.m12 + m12 * rhs.m22 + m13 * rhs.m32,
-                m10 * rhs.m03 + m11 * rhs.m13 + m12 * rhs.m23 + m13 * rhs.m33,
-                m20 * rhs.m00 + m21 * rhs.m10 + m22 * rhs.m20 + m23 * rhs.m30,
-                m20 * rhs.m01 + m21 * rhs.m11 + m22 * rhs.m21 + m23 * rhs.m31,
-                m20 * rhs.m02 + m21 * rhs.m12 + m22 * rhs.m22 + m23 * rhs.m32,
-                m20 * rhs.m03 + m21 * rhs.m13 + m22 * rhs.m23 + m23 * rhs.m33,
-                m30 * rhs.m00 + m31 * rhs.m10 + m32 * rhs.m20 + m33 * rhs.m30,
-                m30 * rhs.m01 + m31 * rhs.m11 + m32 * rhs.m21 + m33 * rhs.m31,
-                m30 * rhs.m02 + m31 * rhs.m12 + m32 * rhs.m22 + m33 * rhs.m32,
-                m30 * rhs.m03 + m31 * rhs.m13 + m32 * rhs.m23 + m33 * rhs.m33
-            );
+            // each column of the result is a linear combination of the columns of this matrix
+            const float* data_lhs = Data();
+            const float* data_rhs = rhs.Data();
+            const Simd::vec4 c0   = Simd::load(data_lhs + 0);
+            const Simd::vec4 c1   = Simd::load(data_lhs + 4);
+            const Simd::vec4 c2   = Simd::load(data_lhs + 8);
+            const Simd::vec4 c3   = Simd::load(data_lhs + 12);
+
+            Matrix result;
+            float* data_out = &result.m00;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                const Simd::vec4 column = Simd::load(data_rhs + i * 4);
+                Simd::vec4 value        = Simd::mul(c0, Simd::splat_lane<0>(column));
+                value                   = Simd::madd(c1, Simd::splat_lane<1>(column), value);
+                value                   = Simd::madd(c2, Simd::splat_lane<2>(column), value);
+                value                   = Simd::madd(c3, Simd::splat_lane<3>(column), value);
+                Simd::store(data_out + i * 4, value);
+            }
+
+            return result;
         }
 
         void operator*=(const Matrix& rhs) { (*this) = (*this) * rhs; }
 
+        // transforms a point, including the perspective divide, use TransformPoint() for affine matrices
         Vector3 operator*(const Vector3& rhs) const
         {
-            float x = (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + m30;
-            float y = (rhs.x * m01) + (rhs.y * m11) + (rhs.z * m21) + m31;
-            float z = (rhs.x * m02) + (rhs.y * m12) + (rhs.z * m22) + m32;
-            float w = (rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + m33;
+            float result[4];
+            Simd::store(result, TransformRows(rhs.x, rhs.y, rhs.z, 1.0f));
 
             // to ensure the perspective divide, divide each component by w
-            if (w != 1.0f)
+            if (result[3] != 1.0f)
             {
-                x /= w;
-                y /= w;
-                z /= w;
+                const float w_inv = 1.0f / result[3];
+                return Vector3(result[0] * w_inv, result[1] * w_inv, result[2] * w_inv);
             }
 
-            return Vector3(x, y, z);
+            return Vector3(result[0], result[1], result[2]);
         }
 
         Vector4 operator*(const Vector4& rhs) const
         {
-            return Vector4
-            (
-                (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + (rhs.w * m30),
-                (rhs.x * m01) + (rhs.y * m11) + (rhs.z * m21) + (rhs.w * m31),
-                (rhs.x * m02) + (rhs.y * m12) + (rhs.z * m22) + (rhs.w * m32),
-                (rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + (rhs.w * m33)
-            );
+            float result[4];
+            Simd::store(result, TransformRows(rhs.x, rhs.y, rhs.z, rhs.w));
+            return Vector4(result[0], result[1], result[2], result[3]);
+        }
+
+        // transforms a point by an affine matrix (rotation, scale, translation), there is no perspective divide
+        [[nodiscard]] Vector3 TransformPoint(const Vector3& point) const
+        {
+            float result[4];
+            Simd::store(result, TransformRows(point.x, point.y, point.z, 1.0f));
+            return Vector3(result[0], result[1], result[2]);
+        }
+
+        // transforms a direction, translation is ignored
+        [[nodiscard]] Vector3 TransformDirection(const Vector3& direction) const
+        {
+            float result[4];
+            Simd::store(result, TransformRows(direction.x, direction.y, direction.z, 0.0f));
+            return Vector3(result[0], result[1], result[2]);
+        }
+
+        // returns the rows of the matrix as simd registers, useful when transforming many points by the same matrix
+        void GetRows(Simd::vec4& row_0, Simd::vec4& row_1, Simd::vec4& row_2, Simd::vec4& row_3) const
+        {
+            const float* data = Data();
+            row_0 = Simd::load(data + 0);
+            row_1 = Simd::load(data + 4);
+            row_2 = Simd::load(data + 8);
+            row_3 = Simd::load(data + 12);
+            Simd::transpose(row_0, row_1, row_2, row_3);
         }
 
         bool operator==(const Matrix& rhs) const
@@ -445,8 +550,22 @@ namespace Spartan::Math
         float m03 = 0.0f, m13 = 0.0f, m23 = 0.0f, m33 = 0.0f;
 
         static const Matrix Identity;
+
+    private:
+        Simd::vec4 TransformRows(float x, float y, float z, float w) const
+        {
+            Simd::vec4 row_0, row_1, row_2, row_3;
+            GetRows(row_0, row_1, row_2, row_3);
+
+            Simd::vec4 result = Simd::mul(row_0, Simd::splat(x));
+            result            = Simd::madd(row_1, Simd::splat(y), result);
+            result            = Simd::madd(row_2, Simd::splat(z), result);
+            return Simd::madd(row_3, Simd::splat(w), result);
+        }
     };
 
+    static_assert(sizeof(Matrix) == 64, "Matrix is uploaded to the gpu as 16 tightly packed floats");
+
     // reverse order operators
     inline SP_CLASS Vector3 operator*(const Vector3& lhs, const Matrix& rhs) { return rhs * lhs; }
     inline SP_CLASS Vector4 operator*(const Vector4& lhs, const Matrix& rhs) { return rhs * lhs; }
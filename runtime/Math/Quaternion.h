@@ -23,11 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =======
 #include "Vector3.h"
+#include "Simd.h"
 //==================
 
 namespace Spartan::Math
 {
-    class SP_CLASS Quaternion
+    class SP_CLASS alignas(16) Quaternion
     {
     public:
         // Constructs an identity quaternion
@@ -185,25 +186,18 @@ namespace Spartan::Math
 
         static inline Quaternion Multiply(const Quaternion& Qa, const Quaternion& Qb)
         {
-            const float x     = Qa.x;
-            const float y     = Qa.y;
-            const float z     = Qa.z;
-            const float w     = Qa.w;
-            const float num4  = Qb.x;
-            const float num3  = Qb.y;
-            const float num2  = Qb.z;
-            const float num   = Qb.w;
-            const float num12 = (y * num2) - (z * num3);
-            const float num11 = (z * num4) - (x * num2);
-            const float num10 = (x * num3) - (y * num4);
-            const float num9  = ((x * num4) + (y * num3)) + (z * num2);
+            // hamilton product, written as qa.w * qb plus three sign-flipped swizzles of qb
+            const Simd::vec4 a = Simd::load(&Qa.x);
+            const Simd::vec4 b = Simd::load(&Qb.x);
 
-            return Quaternion(
-                ((x * num) + (num4 * w)) + num12,
-                ((y * num) + (num3 * w)) + num11,
-                ((z * num) + (num2 * w)) + num10,
-                (w * num) - num9
-            );
+            Simd::vec4 result = Simd::mul(Simd::splat_lane<3>(a), b);
+            result = Simd::madd(Simd::splat_lane<0>(a), Simd::mul(Simd::swizzle<3, 2, 1, 0>(b), Simd::set( 1.0f, -1.0f,  1.0f, -1.0f)), result);
+            result = Simd::madd(Simd::splat_lane<1>(a), Simd::mul(Simd::swizzle<2, 3, 0, 1>(b), Simd::set( 1.0f,  1.0f, -1.0f, -1.0f)), result);
+            result = Simd::madd(Simd::splat_lane<2>(a), Simd::mul(Simd::swizzle<1, 0, 3, 2>(b), Simd::set(-1.0f,  1.0f,  1.0f, -1.0f)), result);
+
+            Quaternion quaternion;
+            Simd::store(&quaternion.x, result);
+            return quaternion;
         }
 
         auto Conjugate() const      { return Quaternion(-x, -y, -z, w); }
@@ -0,0 +1,306 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====
+#include <cstdint>
+#include <cmath>
+//===============
+
+//= BACKEND SELECTION ==================================================================
+// the backend is picked at compile time, defining SP_SIMD_DISABLED forces the scalar
+// path which is also the reference implementation that the other backends must match
+// fma is only used when the build targets it (the avx2 premake option), sse is the default
+#if defined(SP_SIMD_DISABLED)
+    #define SP_SIMD_SCALAR
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+    #define SP_SIMD_SSE
+    #include <immintrin.h>
+    #if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+        #define SP_SIMD_FMA
+    #endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define SP_SIMD_NEON
+    #include <arm_neon.h>
+#else
+    #define SP_SIMD_SCALAR
+#endif
+//======================================================================================
+
+namespace Spartan::Math::Simd
+{
+    // a 4-wide float register, all functions below operate on it lane-wise
+#if defined(SP_SIMD_SSE)
+    using vec4 = __m128;
+#elif defined(SP_SIMD_NEON)
+    using vec4 = float32x4_t;
+#else
+    struct vec4 { float v[4]; };
+#endif
+
+    inline vec4 load(const float* p)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_loadu_ps(p);
+    #elif defined(SP_SIMD_NEON)
+        return vld1q_f32(p);
+    #else
+        return { p[0], p[1], p[2], p[3] };
+    #endif
+    }
+
+    // loads x, y, z and sets w to the provided value, doesn't read past p[2]
+    inline vec4 load3(const float* p, float w)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_setr_ps(p[0], p[1], p[2], w);
+    #elif defined(SP_SIMD_NEON)
+        const float tmp[4] = { p[0], p[1], p[2], w };
+        return vld1q_f32(tmp);
+    #else
+        return { p[0], p[1], p[2], w };
+    #endif
+    }
+
+    inline void store(float* p, vec4 v)
+    {
+    #if defined(SP_SIMD_SSE)
+        _mm_storeu_ps(p, v);
+    #elif defined(SP_SIMD_NEON)
+        vst1q_f32(p, v);
+    #else
+        p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3];
+    #endif
+    }
+
+    inline vec4 set(float x, float y, float z, float w)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_setr_ps(x, y, z, w);
+    #elif defined(SP_SIMD_NEON)
+        const float tmp[4] = { x, y, z, w };
+        return vld1q_f32(tmp);
+    #else
+        return { x, y, z, w };
+    #endif
+    }
+
+    inline vec4 splat(float value)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_set1_ps(value);
+    #elif defined(SP_SIMD_NEON)
+        return vdupq_n_f32(value);
+    #else
+        return { value, value, value, value };
+    #endif
+    }
+
+    // broadcasts one lane of v to all lanes
+    template<int lane>
+    inline vec4 splat_lane(vec4 v)
+    {
+        static_assert(lane >= 0 && lane < 4, "invalid lane");
+    #if defined(SP_SIMD_SSE)
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane));
+    #elif defined(SP_SIMD_NEON)
+        return vdupq_laneq_f32(v, lane);
+    #else
+        return { v.v[lane], v.v[lane], v.v[lane], v.v[lane] };
+    #endif
+    }
+
+    template<int lane>
+    inline float get_lane(vec4 v)
+    {
+        static_assert(lane >= 0 && lane < 4, "invalid lane");
+    #if defined(SP_SIMD_SSE)
+        return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane)));
+    #elif defined(SP_SIMD_NEON)
+        return vgetq_lane_f32(v, lane);
+    #else
+        return v.v[lane];
+    #endif
+    }
+
+    // returns (v[x], v[y], v[z], v[w])
+    template<int x, int y, int z, int w>
+    inline vec4 swizzle(vec4 v)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x));
+    #elif defined(SP_SIMD_NEON)
+        return set(vgetq_lane_f32(v, x), vgetq_lane_f32(v, y), vgetq_lane_f32(v, z), vgetq_lane_f32(v, w));
+    #else
+        return { v.v[x], v.v[y], v.v[z], v.v[w] };
+    #endif
+    }
+
+    inline vec4 add(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_add_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vaddq_f32(a, b);
+    #else
+        return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] };
+    #endif
+    }
+
+    inline vec4 sub(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_sub_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vsubq_f32(a, b);
+    #else
+        return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] };
+    #endif
+    }
+
+    inline vec4 mul(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_mul_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vmulq_f32(a, b);
+    #else
+        return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] };
+    #endif
+    }
+
+    inline vec4 div(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_div_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vdivq_f32(a, b);
+    #else
+        return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] };
+    #endif
+    }
+
+    // returns a * b + c, fused when the target supports it
+    inline vec4 madd(vec4 a, vec4 b, vec4 c)
+    {
+    #if defined(SP_SIMD_FMA)
+        return _mm_fmadd_ps(a, b, c);
+    #elif defined(SP_SIMD_SSE)
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    #elif defined(SP_SIMD_NEON)
+        return vmlaq_f32(c, a, b);
+    #else
+        return add(mul(a, b), c);
+    #endif
+    }
+
+    inline vec4 min(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_min_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vminq_f32(a, b);
+    #else
+        return { fminf(a.v[0], b.v[0]), fminf(a.v[1], b.v[1]), fminf(a.v[2], b.v[2]), fminf(a.v[3], b.v[3]) };
+    #endif
+    }
+
+    inline vec4 max(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_max_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vmaxq_f32(a, b);
+    #else
+        return { fmaxf(a.v[0], b.v[0]), fmaxf(a.v[1], b.v[1]), fmaxf(a.v[2], b.v[2]), fmaxf(a.v[3], b.v[3]) };
+    #endif
+    }
+
+    inline vec4 abs(vec4 v)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    #elif defined(SP_SIMD_NEON)
+        return vabsq_f32(v);
+    #else
+        return { fabsf(v.v[0]), fabsf(v.v[1]), fabsf(v.v[2]), fabsf(v.v[3]) };
+    #endif
+    }
+
+    // lane-wise a >= b, returns a mask that can be combined with bit_and() and read with move_mask()
+    inline vec4 greater_equal(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_cmpge_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vreinterpretq_f32_u32(vcgeq_f32(a, b));
+    #else
+        return { a.v[0] >= b.v[0] ? 1.0f : 0.0f, a.v[1] >= b.v[1] ? 1.0f : 0.0f, a.v[2] >= b.v[2] ? 1.0f : 0.0f, a.v[3] >= b.v[3] ? 1.0f : 0.0f };
+    #endif
+    }
+
+    inline vec4 bit_and(vec4 a, vec4 b)
+    {
+    #if defined(SP_SIMD_SSE)
+        return _mm_and_ps(a, b);
+    #elif defined(SP_SIMD_NEON)
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    #else
+        return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] };
+    #endif
+    }
+
+    // packs a comparison mask into the low 4 bits of an integer, bit i is set if lane i passed
+    inline uint32_t move_mask(vec4 mask)
+    {
+    #if defined(SP_SIMD_SSE)
+        return static_cast<uint32_t>(_mm_movemask_ps(mask));
+    #elif defined(SP_SIMD_NEON)
+        const uint32x4_t bits  = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+        const uint32x4_t shift = { 0, 1, 2, 3 };
+        return vaddvq_u32(vshlq_u32(bits, vreinterpretq_s32_u32(shift)));
+    #else
+        return (mask.v[0] != 0.0f ? 1u : 0u) | (mask.v[1] != 0.0f ? 2u : 0u) | (mask.v[2] != 0.0f ? 4u : 0u) | (mask.v[3] != 0.0f ? 8u : 0u);
+    #endif
+    }
+
+    // in-place 4x4 transpose, used to go from the column-major memory layout of Matrix to rows
+    inline void transpose(vec4& r0, vec4& r1, vec4& r2, vec4& r3)
+    {
+    #if defined(SP_SIMD_SSE)
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    #elif defined(SP_SIMD_NEON)
+        const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    #else
+        vec4 t0 = { r0.v[0], r1.v[0], r2.v[0], r3.v[0] };
+        vec4 t1 = { r0.v[1], r1.v[1], r2.v[1], r3.v[1] };
+        vec4 t2 = { r0.v[2], r1.v[2], r2.v[2], r3.v[2] };
+        vec4 t3 = { r0.v[3], r1.v[3], r2.v[3], r3.v[3] };
+        r0 = t0; r1 = t1; r2 = t2; r3 = t3;
+    #endif
+    }
+}
@@ -0,0 +1,180 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "pch.h"
+#include "TriangleBvh.h"
+#include "Bvh.h"
+#include "../RHI/RHI_Vertex.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+    namespace
+    {
+        const uint32_t triangles_per_leaf = 4;
+        const uint32_t stack_size         = 64;
+
+        Vector3 get_position(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t triangle, const uint32_t corner)
+        {
+            const float* pos = vertices[indices[triangle * 3 + corner]].pos;
+            return Vector3(pos[0], pos[1], pos[2]);
+        }
+    }
+
+    void TriangleBvh::Build(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count)
+    {
+        SP_ASSERT(index_count % 3 == 0);
+
+        m_nodes.clear();
+        m_triangles.clear();
+
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        // per triangle bounds and centroids
+        vector<BoundingBox> triangle_boxes(triangle_count);
+        vector<Vector3> centroids(triangle_count);
+        m_triangles.resize(triangle_count);
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            const Vector3 points[3] =
+            {
+                get_position(vertices, indices, i, 0),
+                get_position(vertices, indices, i, 1),
+                get_position(vertices, indices, i, 2)
+            };
+
+            triangle_boxes[i] = BoundingBox(points, 3);
+            centroids[i]      = triangle_boxes[i].GetCenter();
+            m_triangles[i]    = i;
+        }
+
+        // a median split gives a balanced tree, so the node count is known upfront
+        m_nodes.reserve(2 * (triangle_count / triangles_per_leaf + 1));
+
+        // recursion depth is logarithmic because of the median split
+        auto build = [&](auto& self, const uint32_t begin, const uint32_t end) -> uint32_t
+        {
+            const uint32_t node_index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+
+            BoundingBox box;
+            BoundingBox box_centroids;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                box.Merge(triangle_boxes[m_triangles[i]]);
+                box_centroids.Merge(BoundingBox(centroids[m_triangles[i]], centroids[m_triangles[i]]));
+            }
+            m_nodes[node_index].box = box;
+
+            const uint32_t count = end - begin;
+            if (count <= triangles_per_leaf)
+            {
+                m_nodes[node_index].first = begin;
+                m_nodes[node_index].count = count;
+                return node_index;
+            }
+
+            // split along the axis where the centroids are spread the most
+            const Vector3 size = box_centroids.GetSize();
+            const uint32_t axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z ? 1 : 2);
+            const uint32_t mid  = begin + count / 2;
+            nth_element(m_triangles.begin() + begin, m_triangles.begin() + mid, m_triangles.begin() + end, [&](const uint32_t a, const uint32_t b)
+            {
+                return centroids[a].Data()[axis] < centroids[b].Data()[axis];
+            });
+
+            self(self, begin, mid); // the left child is always node_index + 1
+            const uint32_t right = self(self, mid, end);
+
+            m_nodes[node_index].first = right;
+            m_nodes[node_index].count = 0;
+            return node_index;
+        };
+
+        build(build, 0, triangle_count);
+    }
+
+    float TriangleBvh::HitDistance(const Ray& ray, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices) const
+    {
+        if (m_nodes.empty())
+            return Helper::INFINITY_;
+
+        const Vector3& origin       = ray.GetStart();
+        const Vector3& direction    = ray.GetDirection();
+        const Vector3 direction_inv = Vector3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        float distance_min = Helper::INFINITY_;
+
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = 0;
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+            if (Bvh::HitDistance(node.box, origin, direction_inv) >= distance_min)
+                continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    const uint32_t triangle = m_triangles[i];
+                    const float distance    = ray.HitDistance(
+                        get_position(vertices, indices, triangle, 0),
+                        get_position(vertices, indices, triangle, 1),
+                        get_position(vertices, indices, triangle, 2)
+                    );
+
+                    distance_min = min(distance_min, distance);
+                }
+
+                continue;
+            }
+
+            // visit the closer child first so that the far one is more likely to be rejected
+            const uint32_t child_left  = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+            const uint32_t child_right = node.first;
+            const float distance_left  = Bvh::HitDistance(m_nodes[child_left].box,  origin, direction_inv);
+            const float distance_right = Bvh::HitDistance(m_nodes[child_right].box, origin, direction_inv);
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            if (distance_left < distance_right)
+            {
+                stack[stack_count++] = child_right;
+                stack[stack_count++] = child_left;
+            }
+            else
+            {
+                stack[stack_count++] = child_left;
+                stack[stack_count++] = child_right;
+            }
+        }
+
+        return distance_min;
+    }
+}
@@ -0,0 +1,60 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ============
+#include <vector>
+#include "BoundingBox.h"
+#include "Ray.h"
+//=======================
+
+namespace Spartan::Math
+{
+    // a static bvh over the triangles of a mesh, built once in the mesh's local space
+    // it only stores triangle indices, the vertices and indices are passed in when querying
+    class TriangleBvh
+    {
+    public:
+        TriangleBvh() = default;
+        ~TriangleBvh() = default;
+
+        // indices are relative to vertices, index_count must be a multiple of 3
+        void Build(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count);
+
+        // returns the distance to the closest triangle or infinity if there is no hit
+        float HitDistance(const Ray& ray, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices) const;
+
+        bool IsBuilt() const { return !m_nodes.empty(); }
+        uint64_t GetMemoryUsage() const { return m_nodes.size() * sizeof(Node) + m_triangles.size() * sizeof(uint32_t); }
+
+    private:
+        struct Node
+        {
+            BoundingBox box;
+            uint32_t first = 0; // first triangle for leaves, right child for internal nodes (the left child is always the next node)
+            uint32_t count = 0; // triangle count, 0 for internal nodes
+        };
+
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_triangles;
+    };
+}
@@ -32,7 +32,7 @@ namespace Spartan::Math
     class Vector3;
     class Matrix;
 
-    class SP_CLASS Vector4
+    class SP_CLASS alignas(16) Vector4
     {
     public:
         Vector4()
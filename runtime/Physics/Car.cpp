@@ -25,9 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Physics.h"
 #include "BulletPhysicsHelper.h"
 #include "../Rendering/Renderer.h"
-#include "../Input/Input.h"
 #include "../World/Entity.h"
 #include "../World/Components/AudioSource.h"
+#include "ThreadPool.h"
 SP_WARNINGS_OFF
 #include <BulletDynamics/Vehicle/btRaycastVehicle.h>
 #include "LinearMath/btVector3.h"
@@ -45,6 +45,7 @@ namespace Spartan
     // 1. the simulation relies on bullet physics but can be transfered elsewhere
     // 2. the simulation needs to run at a high frame rate (we are doing 200 hz) to avoid precision issues (especially with the tire friction model)
     // 3. the tire friction model is key to improving the handling beyond what physics libraries are capable off
+    // 4. every car is simulated at once on each physics step, the main thread only feeds the controls in and reads the transforms out
 
     namespace tuning
     {
@@ -143,7 +144,7 @@ namespace Spartan
 
             oss << "Wheel: " << wheel_name << "\n";
             oss << "Steering: " << static_cast<float>(wheel_info.m_steering) * Math::Helper::RAD_TO_DEG << " deg\n";
-            oss << "Angular velocity: " << static_cast<float>(wheel_info.m_deltaRotation * 0.5f) / static_cast<float>(Physics::GetTimeStepInternalSec()) << " rad/s\n";
+            oss << "Angular velocity: " << static_cast<float>(wheel_info.m_deltaRotation * 0.5f) / Math::Helper::Max(parameters.step_duration_sec, Math::Helper::EPSILON) << " rad/s\n";
             oss << "Torque: " << wheel_info.m_engineForce << " N\n";
             oss << "Suspension length: " << wheel_info.m_raycastInfo.m_suspensionLength << " m\n";
             oss << "Slip ratio: " << parameters.pacejka_slip_ratio[wheel_index] << " ( Fz: " << parameters.pacejka_fz[wheel_index] << " N ) \n";
@@ -161,6 +162,27 @@ namespace Spartan
             Renderer::DrawString("Take control! Use the arrow keys to steer the car and space for handbreak.", Vector2(0.005f, -0.96f));
         }
 
+        void draw_tire_forces(CarParameters& parameters)
+        {
+            const float arrow_size = 0.02f;
+
+            for (uint8_t wheel_index : { tuning::wheel_fl, tuning::wheel_fr })
+            {
+                if (!parameters.vehicle->getWheelInfo(wheel_index).m_raycastInfo.m_isInContact)
+                    continue;
+
+                const Vector3& start = parameters.wheel_contact[wheel_index];
+
+                // draw fz force
+                Vector3 fz_end = start + parameters.wheel_forward[wheel_index] * parameters.pacejka_fz[wheel_index] * 0.2f;
+                Renderer::DrawDirectionalArrow(start, fz_end, arrow_size, Color(0.0f, 1.0f, 0.0f, 1.0f), 0.0, false);
+
+                // draw fx force
+                Vector3 fx_end = start + parameters.wheel_right[wheel_index] * parameters.pacejka_fx[wheel_index] * 0.2f;
+                Renderer::DrawDirectionalArrow(start, fx_end, arrow_size, Color(1.0f, 0.0f, 0.0f, 1.0f), 0.0, false);
+            }
+        }
+
         void draw_info_general(CarParameters& parameters, const float speed)
         {
             // setup ostringstream
@@ -193,14 +215,37 @@ namespace Spartan
         // 1. all computations are done in world space
         // 2. the y axis of certain vectors is zeroed out, this is because pacejka's formula is only concerned with forward and side slip
         // 3. precision issues and fuzziness, in various math/vectors, can be reduced by increasing the physics simulation rate, we are doing 200hz (aided by clamping and small float additions)
+        // 4. the model runs over the wheels of every car at once, each quantity is kept in its own array so that the loops stay tight
+
+        // the wheels of every car, one array per quantity
+        struct Wheels
+        {
+            vector<float> velocity_forward; // vehicle velocity along the direction of the wheel
+            vector<float> velocity_side;    // vehicle velocity perpendicular to the direction of the wheel
+            vector<float> velocity_wheel;   // velocity of the tire's surface, from the rotation of the wheel
+            vector<float> normal_load;      // zero when the wheel isn't in contact with the ground
+            vector<float> slipping;         // one when the wheel is in contact with the ground and the vehicle is moving, zero otherwise
+            vector<float> slip_ratio;
+            vector<float> slip_angle;
+            vector<float> force_forward;    // pacejka fz
+            vector<float> force_side;       // pacejka fx
+
+            void resize(const size_t count)
+            {
+                for (vector<float>* quantity : { &velocity_forward, &velocity_side, &velocity_wheel, &normal_load, &slipping, &slip_ratio, &slip_angle, &force_forward, &force_side })
+                {
+                    quantity->assign(count, 0.0f);
+                }
+            }
+        };
 
-        btVector3 compute_wheel_direction_forward(const btWheelInfo* wheel_info)
+        btVector3 compute_wheel_direction_forward(const btWheelInfo& wheel_info)
         {
-            btVector3 forward_right_handed = wheel_info->m_worldTransform.getBasis().getColumn(0).normalized();
+            btVector3 forward_right_handed = wheel_info.m_worldTransform.getBasis().getColumn(0).normalized();
             return btVector3(forward_right_handed.z(), -forward_right_handed.y(), -forward_right_handed.x());
         }
 
-        float compute_slip_ratio(const btWheelInfo* wheel_info, const btVector3& wheel_forward, const btVector3& vehicle_velocity)
+        void compute_slip_ratios(Wheels& wheels, const uint32_t start, const uint32_t end)
         {
             // value meaning:
             // a measure of tire deformation or how much slower/faster it's rotating compared to the vehicle speed
@@ -208,31 +253,21 @@ namespace Spartan
             //  0 to 1:  the tire is rotating slower than the speed of the vehicle, so there is braking or gaining traction
             //  0 to -1: the tire is rotating faster than the speed of the vehicle, so the car is sliding or losing traction
 
-            if (vehicle_velocity.length() < 0.05f)
-                return 0.0f;
-
             // slip ratio as defined by Springer Handbook of Robotics
-            float velocity_wheel    = wheel_info->m_deltaRotation / static_cast<float>(Physics::GetTimeStepInternalSec());
-            velocity_wheel         *= 0.5f; // the fact that this is needed indicates an error with bullet physics or my code
-            float velocity_vehicle  = vehicle_velocity.dot(wheel_forward);
-            float numerator         = 0.0f;
-            if (velocity_vehicle >= 0) // forward
+            for (uint32_t i = start; i < end; i++)
             {
-                numerator = velocity_vehicle - velocity_wheel;
-            }
-            else // reverse
-            {
-                // in reverse, both velocities are negative, so we take their absolute values
-                numerator = Math::Helper::Abs(velocity_vehicle) - Math::Helper::Abs(velocity_wheel);
-            }
+                const float velocity_vehicle = wheels.velocity_forward[i];
+                const float velocity_wheel   = wheels.velocity_wheel[i];
 
-            float denominator      = Math::Helper::Max(Math::Helper::Abs(velocity_wheel), Math::Helper::SMALL_FLOAT);
-            float slip_ratio       = numerator / denominator;
+                // in reverse, both velocities are negative, so we take their absolute values
+                const float numerator   = velocity_vehicle >= 0.0f ? (velocity_vehicle - velocity_wheel) : (fabsf(velocity_vehicle) - fabsf(velocity_wheel));
+                const float denominator = Math::Helper::Max(fabsf(velocity_wheel), Math::Helper::SMALL_FLOAT);
 
-            return Math::Helper::Clamp<float>(slip_ratio, -1.0f, 1.0f);
+                wheels.slip_ratio[i] = Math::Helper::Clamp<float>(numerator / denominator, -1.0f, 1.0f) * wheels.slipping[i];
+            }
         }
 
-        float compute_slip_angle(const btVector3& wheel_forward, const btVector3& wheel_side, const btVector3& vehicle_velocity)
+        void compute_slip_angles(Wheels& wheels, const uint32_t start, const uint32_t end)
         {
             // value meaning:
             // a measure of the angle between the direction in which a wheel is pointed and the direction in which the tire is actually moving
@@ -240,118 +275,60 @@ namespace Spartan
             // 0° to 30° : understeer - the tire moving more straight ahead than where it's pointed
             // 0° to -30°: oversteer  - the tire is turning more sharply than where it's pointed
 
-            if (vehicle_velocity.length() < 0.05f)
-                return 0.0f;
-
-            float v_z        = Math::Helper::Abs(vehicle_velocity.dot(wheel_forward));
-            float v_x        = Math::Helper::Abs(vehicle_velocity.dot(wheel_side));
-            float slip_angle = atan2(v_x, v_z + Math::Helper::SMALL_FLOAT);
+            for (uint32_t i = start; i < end; i++)
+            {
+                const float v_z = fabsf(wheels.velocity_forward[i]);
+                const float v_x = fabsf(wheels.velocity_side[i]);
 
-            return slip_angle;
+                wheels.slip_angle[i] = atan2(v_x, v_z + Math::Helper::SMALL_FLOAT) * wheels.slipping[i];
+            }
         }
 
-        float compute_pacejka_force(float slip, float normal_load, bool is_slip_ratio)
+        void compute_pacejka_forces(const float* slip, const float* normal_load, float* force, const uint32_t start, const uint32_t end, const bool is_slip_ratio)
         {
             // some useful references:
             // https://en.wikipedia.org/wiki/Hans_B._Pacejka
             // https://www.edy.es/dev/docs/pacejka-94-parameters-explained-a-comprehensive-guide/
 
-            // performance some unit conversions that the formula expects
-            normal_load *= 0.001f; // to kilonewtons
-            if (is_slip_ratio)
-            {
-                slip *= 100.0f; // to percentage
-            }
-            else // slip angle
-            {
-                slip *= Math::Helper::RAD_TO_DEG; // to degrees
-            }
-
             // coefficients from the pacejka '94 model
             // b0, b2, b4, b8 are the most relevant parameters that define the curve’s shape
-            float b0  = 1.5f;
-            float b1  = 0.0f;
-            float b2  = 1.0f;
-            float b3  = 0.0f;
-            float b4  = 300.0f;
-            float b5  = 0.0f;
-            float b6  = 0.0f;
-            float b7  = 0.0f;
-            float b8  = -2.0f;
-            float b9  = 0.0f;
-            float b10 = 0.0f;
-            float b11 = 0.0f;
-            float b12 = 0.0f;
-            float b13 = 0.0f;
-
-            // compute the parameters for the Pacejka ’94 formula
-            float Fz  = normal_load;
-            float C   = b0;
-            float D   = Fz * (b1 * Fz + b2) + Math::Helper::SMALL_FLOAT;
-            float BCD = (b3 * Fz * Fz + b4 * Fz) * exp(-b5 * Fz);
-            float B   = BCD / (C * D);
-            float E   = (b6 * Fz * Fz + b7 * Fz + b8) * (1 - b13 * Math::Helper::Sign(slip + (b9 * Fz + b10)));
-            float H   = b9 * Fz + b10;
-            float V   = b11 * Fz + b12;
-            float Bx1 = B * (slip + H);
-
-            // pacejka ’94 longitudinal formula (output is in newtons)
-            float force = D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V;
-
-            SP_ASSERT(!isnan(force));
-
-            return force * 10.0f;
-        }
-
-        void compute_tire_force(CarParameters& parameters, const uint32_t wheel_index, const btVector3& vehicle_velocity, btVector3* force, btVector3* force_position)
-        {
-            // the slip ratio and slip angle have the most influence, it's crucial that their
-            // computation is accurate, otherwise the tire forces will be wrong and/or erratic
-
-            // only compute friction for wheels that are in contact with the ground
-            btWheelInfo* wheel_info = &parameters.vehicle->getWheelInfo(wheel_index);
-            if (!wheel_info->m_raycastInfo.m_isInContact)
+            const float b0  = 1.5f;
+            const float b1  = 0.0f;
+            const float b2  = 1.0f;
+            const float b3  = 0.0f;
+            const float b4  = 300.0f;
+            const float b5  = 0.0f;
+            const float b6  = 0.0f;
+            const float b7  = 0.0f;
+            const float b8  = -2.0f;
+            const float b9  = 0.0f;
+            const float b10 = 0.0f;
+            const float b11 = 0.0f;
+            const float b12 = 0.0f;
+            const float b13 = 0.0f;
+
+            // the formula expects a percentage for the slip ratio and degrees for the slip angle
+            const float slip_scale = is_slip_ratio ? 100.0f : Math::Helper::RAD_TO_DEG;
+
+            for (uint32_t i = start; i < end; i++)
             {
-                parameters.pacejka_slip_ratio[wheel_index] = 0.0f;
-                parameters.pacejka_slip_angle[wheel_index] = 0.0f;
-                parameters.pacejka_fz[wheel_index]         = 0.0f;
-                parameters.pacejka_fx[wheel_index]         = 0.0f;
-                *force                                     = btVector3(0.0f, 0.0f, 0.0f);
-                *force_position                            = wheel_info->m_raycastInfo.m_contactPointWS;
-                return;
-            }
-
-            // compute wheel information
-            btVector3 wheel_forward_dir = compute_wheel_direction_forward(wheel_info);
-            btVector3 wheel_right_dir   = wheel_forward_dir.cross(btVector3(0, 1, 0));
-            float normal_load           = wheel_info->m_wheelsSuspensionForce;
-
-            // a measure of how much a wheel is slipping along the direction of the vehicle travel
-            parameters.pacejka_slip_ratio[wheel_index] = compute_slip_ratio(wheel_info, wheel_forward_dir, vehicle_velocity);
-            // the angle between the direction in which a wheel is pointed and the direction in which the vehicle is actually traveling
-            parameters.pacejka_slip_angle[wheel_index] = compute_slip_angle(wheel_forward_dir, wheel_right_dir, vehicle_velocity);
-            // the force that the tire can exert parallel to its direction of travel
-            parameters.pacejka_fz[wheel_index]         = compute_pacejka_force(parameters.pacejka_slip_ratio[wheel_index], normal_load, true);
-            // the force that the tire can exert perpendicular to its direction of travel
-            parameters.pacejka_fx[wheel_index]         = compute_pacejka_force(parameters.pacejka_slip_angle[wheel_index], normal_load, false);
-            // compute the total force
-            btVector3 wheel_force                      = (parameters.pacejka_fx[wheel_index] * wheel_right_dir) + (parameters.pacejka_fz[wheel_index] * wheel_forward_dir);
-
-            *force          = btVector3(wheel_force.x(), 0.0f, wheel_force.z());
-            *force_position = wheel_info->m_raycastInfo.m_contactPointWS;
-
-            if (debug::enabled && wheel_info->m_bIsFrontWheel)
-            {
-                const float arrow_size = 0.02f;
-                Vector3 start          = ToVector3(*force_position);
-
-                // draw fz force
-                Math::Vector3 fz_end = start + Math::Vector3(parameters.pacejka_fz[wheel_index] * wheel_forward_dir) * 0.2f;
-                Renderer::DrawDirectionalArrow(start, fz_end, arrow_size, Color(0.0f, 1.0f, 0.0f, 1.0f), 0.0, false);
-
-                // draw fx force
-                Math::Vector3 fx_end = start + Math::Vector3(parameters.pacejka_fx[wheel_index] * wheel_right_dir) * 0.2f;
-                Renderer::DrawDirectionalArrow(start, fx_end, arrow_size, Color(1.0f, 0.0f, 0.0f, 1.0f), 0.0, false);
+                const float x = slip[i] * slip_scale;
+
+                // compute the parameters for the Pacejka ’94 formula
+                float Fz  = normal_load[i] * 0.001f; // to kilonewtons
+                float C   = b0;
+                float D   = Fz * (b1 * Fz + b2) + Math::Helper::SMALL_FLOAT;
+                float BCD = (b3 * Fz * Fz + b4 * Fz) * exp(-b5 * Fz);
+                float B   = BCD / (C * D);
+                float E   = (b6 * Fz * Fz + b7 * Fz + b8) * (1 - b13 * Math::Helper::Sign(x + (b9 * Fz + b10)));
+                float H   = b9 * Fz + b10;
+                float V   = b11 * Fz + b12;
+                float Bx1 = B * (x + H);
+
+                // pacejka ’94 longitudinal formula (output is in newtons)
+                force[i] = (D * sin(C * atan(Bx1 - E * (Bx1 - atan(Bx1)))) + V) * 10.0f;
+
+                SP_ASSERT(!isnan(force[i]));
             }
         }
     }
@@ -377,18 +354,19 @@ namespace Spartan
                 btVector3 chassis_center = chassis->getCenterOfMassPosition();
                 btVector3 roll_axis      = (wheel_info2.m_raycastInfo.m_contactPointWS - wheel_info1.m_raycastInfo.m_contactPointWS).normalized();
 
+                // applyForce() expects the position relative to the center of mass
                 if (wheel_info1.m_raycastInfo.m_isInContact)
                 {
                     btVector3 force_position         = wheel_info1.m_raycastInfo.m_contactPointWS + roll_axis * (chassis_center - wheel_info1.m_raycastInfo.m_contactPointWS).dot(roll_axis);
                     btVector3 anti_roll_force_vector = -roll_axis * anti_roll_force;
-                    chassis->applyForce(anti_roll_force_vector, force_position);
+                    chassis->applyForce(anti_roll_force_vector, force_position - chassis_center);
                 }
 
                 if (wheel_info2.m_raycastInfo.m_isInContact)
                 {
                     btVector3 force_position         = wheel_info2.m_raycastInfo.m_contactPointWS + roll_axis * (chassis_center - wheel_info2.m_raycastInfo.m_contactPointWS).dot(roll_axis);
                     btVector3 anti_roll_force_vector = roll_axis * anti_roll_force;
-                    chassis->applyForce(anti_roll_force_vector, force_position);
+                    chassis->applyForce(anti_roll_force_vector, force_position - chassis_center);
                 }
             }
         }
@@ -439,10 +417,8 @@ namespace Spartan
             return torque;
         }
 
-        void compute_gear_and_gear_ratio(CarParameters& parameters)
+        void compute_gear_and_gear_ratio(CarParameters& parameters, const float delta_time_seconds)
         {
-            float delta_time_seconds = static_cast<float>(Timer::GetDeltaTimeSec());
-
             if (!parameters.is_shifting)
             {
                 // compute the current gear based on the throttle input
@@ -490,14 +466,14 @@ namespace Spartan
             }
         }
 
-        float compute_torque(CarParameters& parameters)
+        float compute_torque(CarParameters& parameters, const float delta_time_sec)
         {
-            compute_gear_and_gear_ratio(parameters);
+            compute_gear_and_gear_ratio(parameters, delta_time_sec);
 
             // compute engine rpm
             {
                 btWheelInfo* wheel_info       = &parameters.vehicle->getWheelInfo(0);
-                float wheel_angular_velocity  = wheel_info->m_deltaRotation / static_cast<float>(Timer::GetDeltaTimeSec());
+                float wheel_angular_velocity  = wheel_info->m_deltaRotation / delta_time_sec;
                 float wheel_rpm               = (wheel_angular_velocity * 60.0f) / (2.0f * Math::Helper::PI);
                 float target_rpm              = tuning::engine_idle_rpm + wheel_rpm * parameters.gear_ratio * tuning::gearbox_final_drive;
                 target_rpm                   *= Math::Helper::Abs<float>(parameters.throttle);
@@ -535,20 +511,225 @@ namespace Spartan
         }
     }
 
+    namespace simulation
+    {
+        // description:
+        // every car is stepped at once, in phases which each cover all the cars before the next one starts
+        // 1. the wheel raycasts of every car are cast as a single batch
+        // 2. bullet updates the vehicles (suspension and its own friction) in parallel, picking up the raycast results instead of casting its own
+        // 3. the tire friction model runs over the wheels of every car
+        // 4. the controls and forces are applied in parallel, each car only touches its own chassis
+
+        // hands out the batched results, in the order that the vehicle asks for them (one per wheel, in wheel order)
+        class BatchedVehicleRaycaster : public btVehicleRaycaster
+        {
+        public:
+            void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result) override
+            {
+                // the vehicle casts the same rays that were batched, anything else is cast on its own
+                PhysicsHit hit;
+                if (cursor < count && rays[cursor].start == ToVector3(from) && rays[cursor].end == ToVector3(to))
+                {
+                    hit = hits[cursor];
+                }
+                else
+                {
+                    // this can be a pool thread while the stepping thread holds the world lock, so it mustn't take it
+                    const PhysicsRay ray = { ToVector3(from), ToVector3(to), ignore };
+                    hit = Physics::RayCastInStep(ray);
+                }
+                cursor++;
+
+                if (!hit.body || !hit.body->hasContactResponse())
+                    return nullptr;
+
+                result.m_hitPointInWorld  = ToBtVector3(hit.position);
+                result.m_hitNormalInWorld = ToBtVector3(hit.normal).normalized();
+                result.m_distFraction     = hit.fraction;
+
+                return hit.body;
+            }
+
+            const PhysicsRay* rays    = nullptr;
+            const PhysicsHit* hits    = nullptr;
+            uint32_t count            = 0;
+            uint32_t cursor           = 0;
+            const btRigidBody* ignore = nullptr;
+        };
+
+        // cars are light work, so a task takes a few of them
+        const uint32_t cars_per_task_min   = 4;
+        const uint32_t wheels_per_task_min = 64;
+
+        // only touched while physics holds its world lock, so one set is enough
+        vector<PhysicsRay> rays;
+        vector<PhysicsHit> hits;
+        vector<uint32_t> wheel_offsets;
+        vector<btRaycastVehicle*> vehicles_independent;
+        vector<btRaycastVehicle*> vehicles_dependent;
+        tire_friction_model::Wheels wheels;
+
+        float get_speed_meters_per_second(const CarParameters& parameters)
+        {
+            return parameters.vehicle->getCurrentSpeedKmHour() * (1000.0f / 3600.0f);
+        }
+
+        void apply_control(CarParameters& parameters, const float delta_time_sec)
+        {
+            const CarControl& control = parameters.control;
+            const float speed         = get_speed_meters_per_second(parameters);
+
+            // compute movement state
+            if (speed > 0.1f)
+            {
+                parameters.movement_direction = CarMovementState::Forward;
+            }
+            else if (speed < -0.1f)
+            {
+                parameters.movement_direction = CarMovementState::Backward;
+            }
+            else
+            {
+                parameters.movement_direction = CarMovementState::Stationary;
+            }
+
+            // compute engine torque and/or breaking force
+            {
+                // determine when to stop breaking
+                if (Math::Helper::Abs<float>(speed) < 0.1f)
+                {
+                    parameters.break_until_opposite_torque = false;
+                }
+
+                if (control.throttle > 0.0f)
+                {
+                    if (parameters.movement_direction == CarMovementState::Backward)
+                    {
+                        parameters.break_until_opposite_torque = true;
+                    }
+                    else
+                    {
+                        parameters.throttle = control.throttle;
+                    }
+                }
+                else if (control.throttle < 0.0f)
+                {
+                    if (parameters.movement_direction == CarMovementState::Forward)
+                    {
+                        parameters.break_until_opposite_torque = true;
+                    }
+                    else
+                    {
+                        parameters.throttle = control.throttle;
+                    }
+                }
+                else
+                {
+                    parameters.break_until_opposite_torque = false;
+                    parameters.throttle                    = 0.0f;
+                }
+
+                parameters.engine_torque = gearbox::compute_torque(parameters, delta_time_sec);
+            }
+
+            // steer the front wheels
+            {
+                float steering_angle_target = Math::Helper::Clamp<float>(control.steering, -1.0f, 1.0f) * tuning::steering_angle_max;
+
+                // lerp to new steering angle - real life vehicles don't snap their wheels to the target angle
+                parameters.steering_angle = Math::Helper::Lerp<float>(parameters.steering_angle, steering_angle_target, tuning::steering_return_speed * delta_time_sec);
+
+                // set the steering angle
+                parameters.vehicle->setSteeringValue(parameters.steering_angle, tuning::wheel_fl);
+                parameters.vehicle->setSteeringValue(parameters.steering_angle, tuning::wheel_fr);
+            }
+        }
+
+        void apply_forces(CarParameters& parameters, const uint32_t wheel_offset, const float delta_time_sec)
+        {
+            btRaycastVehicle* vehicle     = parameters.vehicle;
+            btRigidBody* body             = parameters.body;
+            float speed_meters_per_second = get_speed_meters_per_second(parameters);
+
+            // engine torque (front-wheel drive), negative is forward
+            {
+                float torque = -parameters.engine_torque * parameters.throttle;
+
+                vehicle->applyEngineForce(torque, tuning::wheel_fl);
+                vehicle->applyEngineForce(torque, tuning::wheel_fr);
+            }
+
+            // tire friction model, computed for the wheels of every car at once
+            for (uint32_t i = 0; i < static_cast<uint32_t>(vehicle->getNumWheels()); i++)
+            {
+                const uint32_t index = wheel_offset + i;
+                parameters.pacejka_slip_ratio[i] = wheels.slip_ratio[index];
+                parameters.pacejka_slip_angle[i] = wheels.slip_angle[index];
+                parameters.pacejka_fz[i]         = wheels.force_forward[index];
+                parameters.pacejka_fx[i]         = wheels.force_side[index];
+
+                const btWheelInfo& wheel_info = vehicle->getWheelInfo(i);
+                if (!wheel_info.m_raycastInfo.m_isInContact)
+                    continue;
+
+                btVector3 wheel_force = (parameters.pacejka_fx[i] * ToBtVector3(parameters.wheel_right[i])) + (parameters.pacejka_fz[i] * ToBtVector3(parameters.wheel_forward[i]));
+                btVector3 force       = btVector3(wheel_force.x(), 0.0f, wheel_force.z());
+
+                // applyForce() expects the position relative to the center of mass
+                body->applyForce(force, wheel_info.m_raycastInfo.m_contactPointWS - body->getCenterOfMassPosition());
+            }
+
+            // anti-roll bar
+            suspension::apply_antiroll_bar(vehicle, body, tuning::wheel_fl, tuning::wheel_fr, tuning::suspension_antiroll_bar_stiffness_front);
+            suspension::apply_antiroll_bar(vehicle, body, tuning::wheel_rl, tuning::wheel_rr, tuning::suspension_antiroll_bar_stiffness_rear);
+
+            // aerodynamics
+            {
+                parameters.aerodynamics_downforce = aerodynamics::compute_downforce(speed_meters_per_second);
+                parameters.aerodynamics_drag      = aerodynamics::compute_drag(speed_meters_per_second);
+
+                // transform the forces into bullet's right-handed coordinate system
+                btMatrix3x3 orientation    = body->getWorldTransform().getBasis();
+                btVector3 downforce_bullet = orientation * btVector3(0, -parameters.aerodynamics_downforce, 0);
+                btVector3 drag_bullet      = orientation * btVector3(0, 0, -parameters.aerodynamics_drag);
+
+                // apply the transformed forces
+                body->applyCentralForce(downforce_bullet);
+                body->applyCentralForce(drag_bullet);
+            }
+
+            // breaking
+            {
+                float breaking = parameters.control.brake ? 1.0f : 0.0f;
+                breaking       = parameters.break_until_opposite_torque ? 1.0f : breaking;
+
+                if (breaking > 0.0f)
+                {
+                    parameters.break_force = Math::Helper::Min<float>(parameters.break_force + tuning::brake_ramp_speed * delta_time_sec * breaking, tuning::brake_force_max);
+                }
+                else
+                {
+                    parameters.break_force = Math::Helper::Max<float>(parameters.break_force - tuning::brake_ramp_speed * delta_time_sec, 0.0f);
+                }
+
+                float bullet_brake_force = parameters.break_force * 0.03f;
+                vehicle->setBrake(bullet_brake_force, tuning::wheel_fl);
+                vehicle->setBrake(bullet_brake_force, tuning::wheel_fr);
+                vehicle->setBrake(bullet_brake_force, tuning::wheel_rl);
+                vehicle->setBrake(bullet_brake_force, tuning::wheel_rr);
+            }
+        }
+    }
+
     void Car::Create(btRigidBody* chassis, Entity* entity)
     {
+        Destroy();
+
         m_parameters.body = chassis;
 
         // vehicle
         btRaycastVehicle::btVehicleTuning vehicle_tuning;
         {
-            if (m_parameters.vehicle != nullptr)
-            {
-                Physics::RemoveBody(m_parameters.vehicle);
-                delete m_parameters.vehicle;
-                m_parameters.vehicle = nullptr;
-            }
-
             vehicle_tuning.m_suspensionStiffness   = tuning::suspension_stiffness;
             vehicle_tuning.m_suspensionCompression = tuning::suspension_compression;
             vehicle_tuning.m_suspensionDamping     = tuning::suspension_damping;
@@ -556,13 +737,11 @@ namespace Spartan
             vehicle_tuning.m_maxSuspensionTravelCm = tuning::suspension_travel_max * 1000.0f;
             vehicle_tuning.m_frictionSlip          = tuning::tire_friction;
 
-            btVehicleRaycaster* vehicle_ray_caster = new btDefaultVehicleRaycaster(static_cast<btDynamicsWorld*>(Physics::GetWorld()));
-            m_parameters.vehicle = new btRaycastVehicle(vehicle_tuning, m_parameters.body, vehicle_ray_caster);
+            m_parameters.vehicle_raycaster = new simulation::BatchedVehicleRaycaster();
+            m_parameters.vehicle           = new btRaycastVehicle(vehicle_tuning, m_parameters.body, m_parameters.vehicle_raycaster);
 
             // this is crucial to get right
             m_parameters.vehicle->setCoordinateSystem(0, 1, 2); // X is right, Y is up, Z is forward
-
-            Physics::AddBody(m_parameters.vehicle);
         }
 
         // wheels
@@ -603,6 +782,9 @@ namespace Spartan
             }
         }
 
+        // physics steps it from now on, so it has to be complete
+        Physics::AddBody(this);
+
         // add basic audio
         {
             ///shared_ptr<AudioSource> audio_source = entity->AddComponent<AudioSource>();
@@ -611,190 +793,188 @@ namespace Spartan
         }
     }
 
+    void Car::Destroy()
+    {
+        if (!m_parameters.vehicle)
+            return;
+
+        Physics::RemoveBody(this);
+
+        delete m_parameters.vehicle;
+        delete m_parameters.vehicle_raycaster;
+        m_parameters.vehicle           = nullptr;
+        m_parameters.vehicle_raycaster = nullptr;
+        m_parameters.body              = nullptr;
+    }
+
     void Car::Tick()
     {
         if (!m_parameters.vehicle)
             return;
 
-        // compute movement state
-        if (GetSpeedMetersPerSecond() > 0.1f)
+        // the player's input comes from physics, which records and replays it along with everything else
+        if (m_parameters.is_player_controlled)
         {
-            m_parameters.movement_direction = CarMovementState::Forward;
-        }
-        else if (GetSpeedMetersPerSecond() < -0.1f)
-        {
-            m_parameters.movement_direction = CarMovementState::Backward;
-        }
-        else
-        {
-            m_parameters.movement_direction = CarMovementState::Stationary;
+            const PhysicsInput& input = Physics::GetInput();
+
+            m_parameters.control.throttle = input.accelerate ? 1.0f : (input.reverse ? -1.0f : 0.0f);
+            m_parameters.control.steering = input.steer_left ? -1.0f : (input.steer_right ? 1.0f : 0.0f);
+            m_parameters.control.brake    = input.brake;
         }
 
-        HandleInput();
-        ApplyForces();
         UpdateTransforms();
 
-        if (debug::enabled)
+        if (debug::enabled && m_parameters.is_player_controlled)
         {
+            debug::draw_tire_forces(m_parameters);
             debug::draw_info_wheel(m_parameters);
+            debug::draw_info_general(m_parameters, GetSpeedKilometersPerHour());
         }
     }
 
-    void Car::SetWheelTransform(Entity* transform, uint32_t wheel_index)
+    void Car::Step(const vector<Car*>& cars, const float delta_time_sec)
     {
-        if (wheel_index >= m_parameters.transform_wheels.size())
+        using namespace simulation;
+
+        const uint32_t car_count = static_cast<uint32_t>(cars.size());
+
+        // 1. wheel raycasts, the same rays that btRaycastVehicle::rayCast() would cast
+        rays.clear();
+        wheel_offsets.resize(car_count + 1);
+        for (uint32_t car_index = 0; car_index < car_count; car_index++)
         {
-            m_parameters.transform_wheels.resize(wheel_index + 1);
-        }
+            CarParameters& parameters = cars[car_index]->m_parameters;
+            SP_ASSERT(parameters.vehicle->getNumWheels() <= 4);
+            parameters.step_duration_sec = delta_time_sec;
 
-        m_parameters.transform_wheels[wheel_index] = transform;
-    }
+            wheel_offsets[car_index] = static_cast<uint32_t>(rays.size());
+            for (int i = 0; i < parameters.vehicle->getNumWheels(); i++)
+            {
+                btWheelInfo& wheel_info = parameters.vehicle->getWheelInfo(i);
+                parameters.vehicle->updateWheelTransformsWS(wheel_info, false);
 
-    float Car::GetSpeedKilometersPerHour() const
-    {
-        return m_parameters.vehicle->getCurrentSpeedKmHour();
-    }
+                const btScalar length = wheel_info.getSuspensionRestLength() + wheel_info.m_wheelsRadius;
 
-    float Car::GetSpeedMetersPerSecond() const
-    {
-        return GetSpeedKilometersPerHour() * (1000.0f / 3600.0f);
-    }
+                PhysicsRay ray;
+                ray.start  = ToVector3(wheel_info.m_raycastInfo.m_hardPointWS);
+                ray.end    = ToVector3(wheel_info.m_raycastInfo.m_hardPointWS + wheel_info.m_raycastInfo.m_wheelDirectionWS * length);
+                ray.ignore = parameters.body;
+                rays.emplace_back(ray);
+            }
+        }
+        wheel_offsets[car_count] = static_cast<uint32_t>(rays.size());
 
-    void Car::HandleInput()
-    {
-        float delta_time_sec = static_cast<float>(Timer::GetDeltaTimeSec());
+        hits.resize(rays.size());
+        Physics::RayCast(rays, hits);
 
-        // compute engine torque and/or breaking force
+        // 2. bullet's vehicle update, cars that rest on other dynamic bodies push them around, so those go one at a time
+        vehicles_independent.clear();
+        vehicles_dependent.clear();
+        for (uint32_t car_index = 0; car_index < car_count; car_index++)
         {
-            // determine when to stop breaking
-            if (Math::Helper::Abs<float>(GetSpeedMetersPerSecond()) < 0.1f)
-            {
-                m_parameters.break_until_opposite_torque = false;
-            }
+            CarParameters& parameters = cars[car_index]->m_parameters;
+            const uint32_t offset     = wheel_offsets[car_index];
+            const uint32_t count      = wheel_offsets[car_index + 1] - offset;
 
-            if (Input::GetKey(KeyCode::Arrow_Up) || Input::GetGamepadTriggerRight() != 0.0f)
-            {
-                if (m_parameters.movement_direction == CarMovementState::Backward)
-                {
-                    m_parameters.break_until_opposite_torque = true;
-                }
-                else
-                {
-                    m_parameters.throttle = 1.0f;
-                }
-            }
-            else if (Input::GetKey(KeyCode::Arrow_Down) || Input::GetGamepadTriggerLeft() != 0.0f)
-            {
-                if (m_parameters.movement_direction == CarMovementState::Forward)
-                {
-                    m_parameters.break_until_opposite_torque = true;
-                }
-                else
-                {
-                    m_parameters.throttle = -1.0f;
-                }
-            }
-            else
+            BatchedVehicleRaycaster* raycaster = static_cast<BatchedVehicleRaycaster*>(parameters.vehicle_raycaster);
+            raycaster->rays                    = &rays[offset];
+            raycaster->hits                    = &hits[offset];
+            raycaster->count                   = count;
+            raycaster->cursor                  = 0;
+            raycaster->ignore                  = parameters.body;
+
+            bool is_dependent = false;
+            for (uint32_t i = offset; i < offset + count; i++)
             {
-                m_parameters.break_until_opposite_torque = false;
-                m_parameters.throttle                    = 0.0f;
+                is_dependent |= hits[i].body && !hits[i].body->isStaticOrKinematicObject();
             }
-
-            m_parameters.engine_torque = gearbox::compute_torque(m_parameters);
+            (is_dependent ? vehicles_dependent : vehicles_independent).emplace_back(parameters.vehicle);
         }
 
-        // steer the front wheels
+        ThreadPool::ParallelLoop([delta_time_sec](uint32_t start, uint32_t end)
         {
-            float steering_angle_target = 0.0f;
-
-            if (Input::GetKey(KeyCode::Arrow_Left) || Input::GetGamepadThumbStickLeft().x < 0.0f)
-            {
-                steering_angle_target = -tuning::steering_angle_max;
-            }
-            else if (Input::GetKey(KeyCode::Arrow_Right) || Input::GetGamepadThumbStickLeft().x > 0.0f)
+            for (uint32_t i = start; i < end; i++)
             {
-                steering_angle_target = tuning::steering_angle_max;
+                vehicles_independent[i]->updateVehicle(delta_time_sec);
             }
+        }, static_cast<uint32_t>(vehicles_independent.size()), cars_per_task_min);
 
-            // lerp to new steering angle - real life vehicles don't snap their wheels to the target angle
-            m_parameters.steering_angle = Math::Helper::Lerp<float>(m_parameters.steering_angle, steering_angle_target, tuning::steering_return_speed * delta_time_sec);
-
-            // set the steering angle
-            m_parameters.vehicle->setSteeringValue(m_parameters.steering_angle, tuning::wheel_fl);
-            m_parameters.vehicle->setSteeringValue(m_parameters.steering_angle, tuning::wheel_fr);
-        }
-    }
-
-    void Car::ApplyForces()
-    {
-        float delta_time_sec          = static_cast<float>(Timer::GetDeltaTimeSec());
-        float speed_meters_per_second = GetSpeedMetersPerSecond();
-        btVector3 velocity_vehicle    = btVector3(m_parameters.body->getLinearVelocity().x(), 0.0f, m_parameters.body->getLinearVelocity().z());
-
-        // engine torque (front-wheel drive)
+        for (btRaycastVehicle* vehicle : vehicles_dependent)
         {
-            float torque_sign = m_parameters.throttle >= 0.0f ? -1.0f : 1.0f;
-            float torque      = m_parameters.throttle ? (m_parameters.engine_torque * torque_sign) : 0.0f;
-
-            m_parameters.vehicle->applyEngineForce(torque, tuning::wheel_fl);
-            m_parameters.vehicle->applyEngineForce(torque, tuning::wheel_fr);
+            vehicle->updateVehicle(delta_time_sec);
         }
 
-        // tire friction model
-        for (uint32_t i = 0; i < static_cast<uint32_t>(m_parameters.vehicle->getNumWheels()); i++)
+        // 3. tire friction model, gather the state of every wheel and then run the model over all of them
+        wheels.resize(rays.size());
+        ThreadPool::ParallelLoop([&cars, delta_time_sec](uint32_t start, uint32_t end)
         {
-            btVector3 force;
-            btVector3 force_position;
-            tire_friction_model::compute_tire_force(m_parameters, i, velocity_vehicle, &force, &force_position);
-
-            m_parameters.body->applyForce(force, force_position);
-        }
+            for (uint32_t car_index = start; car_index < end; car_index++)
+            {
+                CarParameters& parameters = cars[car_index]->m_parameters;
+                const btVector3 velocity  = btVector3(parameters.body->getLinearVelocity().x(), 0.0f, parameters.body->getLinearVelocity().z());
+                const bool is_moving      = velocity.length() >= 0.05f;
 
-        // anti-roll bar
-        suspension::apply_antiroll_bar(m_parameters.vehicle, m_parameters.body, tuning::wheel_fl, tuning::wheel_fr, tuning::suspension_antiroll_bar_stiffness_front);
-        suspension::apply_antiroll_bar(m_parameters.vehicle, m_parameters.body, tuning::wheel_rl, tuning::wheel_rr, tuning::suspension_antiroll_bar_stiffness_rear);
+                for (int i = 0; i < parameters.vehicle->getNumWheels(); i++)
+                {
+                    const btWheelInfo& wheel_info = parameters.vehicle->getWheelInfo(i);
+                    const bool is_in_contact      = wheel_info.m_raycastInfo.m_isInContact;
+                    const btVector3 forward       = tire_friction_model::compute_wheel_direction_forward(wheel_info);
+                    const btVector3 right         = forward.cross(btVector3(0, 1, 0));
+                    const uint32_t index          = wheel_offsets[car_index] + i;
+
+                    wheels.velocity_forward[index] = velocity.dot(forward);
+                    wheels.velocity_side[index]    = velocity.dot(right);
+                    wheels.velocity_wheel[index]   = wheel_info.m_deltaRotation / delta_time_sec * 0.5f; // the fact that halving is needed indicates an error with bullet physics or my code
+                    wheels.normal_load[index]      = is_in_contact ? static_cast<float>(wheel_info.m_wheelsSuspensionForce) : 0.0f;
+                    wheels.slipping[index]         = (is_in_contact && is_moving) ? 1.0f : 0.0f;
+
+                    parameters.wheel_contact[i] = ToVector3(wheel_info.m_raycastInfo.m_contactPointWS);
+                    parameters.wheel_forward[i] = ToVector3(forward);
+                    parameters.wheel_right[i]   = ToVector3(right);
+                }
+            }
+        }, car_count, cars_per_task_min);
 
-        // aerodynamics
+        ThreadPool::ParallelLoop([](uint32_t start, uint32_t end)
         {
-            m_parameters.aerodynamics_downforce = aerodynamics::compute_downforce(speed_meters_per_second);
-            m_parameters.aerodynamics_drag      = aerodynamics::compute_drag(speed_meters_per_second);
-
-            // transform the forces into bullet's right-handed coordinate system
-            btMatrix3x3 orientation    = m_parameters.body->getWorldTransform().getBasis();
-            btVector3 downforce_bullet = orientation * btVector3(0, -m_parameters.aerodynamics_downforce, 0);
-            btVector3 drag_bullet      = orientation * btVector3(0, 0, -m_parameters.aerodynamics_drag);
-
-            // apply the transformed forces
-            m_parameters.body->applyCentralForce(downforce_bullet);
-            m_parameters.body->applyCentralForce(drag_bullet);
-        }
+            // the force that the tire can exert parallel to its direction of travel, from how much it's slipping along it
+            // and the force it can exert perpendicular to it, from the angle between where it's pointed and where it's going
+            tire_friction_model::compute_slip_ratios(wheels, start, end);
+            tire_friction_model::compute_slip_angles(wheels, start, end);
+            tire_friction_model::compute_pacejka_forces(wheels.slip_ratio.data(), wheels.normal_load.data(), wheels.force_forward.data(), start, end, true);
+            tire_friction_model::compute_pacejka_forces(wheels.slip_angle.data(), wheels.normal_load.data(), wheels.force_side.data(), start, end, false);
+        }, static_cast<uint32_t>(rays.size()), wheels_per_task_min);
 
-        // breaking
+        // 4. controls and forces
+        ThreadPool::ParallelLoop([&cars, delta_time_sec](uint32_t start, uint32_t end)
         {
-            float breaking = Input::GetKey(KeyCode::Space) ? 1.0f : 0.0f;
-            breaking       = m_parameters.break_until_opposite_torque ? 1.0f : breaking;
-
-            if (breaking > 0.0f)
-            {
-                m_parameters.break_force = Math::Helper::Min<float>(m_parameters.break_force + tuning::brake_ramp_speed * delta_time_sec * breaking, tuning::brake_force_max);
-            }
-            else
+            for (uint32_t car_index = start; car_index < end; car_index++)
             {
-                m_parameters.break_force = Math::Helper::Max<float>(m_parameters.break_force - tuning::brake_ramp_speed * delta_time_sec, 0.0f);
+                CarParameters& parameters = cars[car_index]->m_parameters;
+                apply_control(parameters, delta_time_sec);
+                apply_forces(parameters, wheel_offsets[car_index], delta_time_sec);
             }
+        }, car_count, cars_per_task_min);
+    }
 
-            float bullet_brake_force = m_parameters.break_force * 0.03f;
-            m_parameters.vehicle->setBrake(bullet_brake_force, tuning::wheel_fl);
-            m_parameters.vehicle->setBrake(bullet_brake_force, tuning::wheel_fr);
-            m_parameters.vehicle->setBrake(bullet_brake_force, tuning::wheel_rl);
-            m_parameters.vehicle->setBrake(bullet_brake_force, tuning::wheel_rr);
-
-        }
-
-        if (debug::enabled)
+    void Car::SetWheelTransform(Entity* transform, uint32_t wheel_index)
+    {
+        if (wheel_index >= m_parameters.transform_wheels.size())
         {
-            debug::draw_info_general(m_parameters, GetSpeedKilometersPerHour());
+            m_parameters.transform_wheels.resize(wheel_index + 1);
         }
+
+        m_parameters.transform_wheels[wheel_index] = transform;
+    }
+
+    float Car::GetSpeedKilometersPerHour() const
+    {
+        return m_parameters.vehicle->getCurrentSpeedKmHour();
+    }
+
+    float Car::GetSpeedMetersPerSecond() const
+    {
+        return GetSpeedKilometersPerHour() * (1000.0f / 3600.0f);
     }
 
     void Car::UpdateTransforms()
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= FORWARD DECLARATIONS =
 class btRaycastVehicle;
 class btRigidBody;
+class btVehicleRaycaster;
 //========================
 
 namespace Spartan
@@ -39,6 +40,14 @@ namespace Spartan
         Stationary
     };
 
+    // what drives a car, each one has its own so that the player, ai and replays can drive different cars
+    struct CarControl
+    {
+        float throttle = 0.0f; // -1 (full reverse) to 1 (full forward)
+        float steering = 0.0f; // -1 (full left) to 1 (full right)
+        bool brake     = false;
+    };
+
     struct CarParameters
     {
         // engine
@@ -64,14 +73,23 @@ namespace Spartan
         std::array<float, 4> pacejka_slip_ratio = { 0.0f, 0.0f, 0.0f, 0.0f };
         std::array<float, 4> pacejka_fz         = { 0.0f, 0.0f, 0.0f, 0.0f };
         std::array<float, 4> pacejka_fx         = { 0.0f, 0.0f, 0.0f, 0.0f };
+        std::array<Math::Vector3, 4> wheel_contact; // kept for debug drawing, which happens on the main thread
+        std::array<Math::Vector3, 4> wheel_forward;
+        std::array<Math::Vector3, 4> wheel_right;
+
+        // control
+        CarControl control;
+        bool is_player_controlled             = true;
 
         // misc
-        float steering_angle                = 0.0f;
-        float throttle                      = 0.0f;
-        CarMovementState movement_direction = CarMovementState::Stationary;
-        btRaycastVehicle* vehicle           = nullptr;
-        btRigidBody* body                   = nullptr;
-        Entity* transform_steering_wheel    = nullptr;
+        float steering_angle                  = 0.0f;
+        float throttle                        = 0.0f;
+        CarMovementState movement_direction   = CarMovementState::Stationary;
+        float step_duration_sec               = 0.0f; // of the last step, the wheel rotations are per step
+        btRaycastVehicle* vehicle             = nullptr;
+        btVehicleRaycaster* vehicle_raycaster = nullptr;
+        btRigidBody* body                     = nullptr;
+        Entity* transform_steering_wheel      = nullptr;
         std::vector<Entity*> transform_wheels;
     };
 
@@ -79,12 +97,21 @@ namespace Spartan
     {
     public:
         Car() = default;
-        ~Car() = default;
+        ~Car() { Destroy(); }
 
         // main
         void Create(btRigidBody* chassis, Entity* entity);
+        void Destroy();
         void Tick();
 
+        // steps every car at once, physics calls this ahead of each of its own steps
+        static void Step(const std::vector<Car*>& cars, const float delta_time_sec);
+
+        // control, a player controlled car takes it from the input every frame
+        void SetControl(const CarControl& control)                { m_parameters.control = control; }
+        const CarControl& GetControl() const                      { return m_parameters.control; }
+        void SetPlayerControlled(const bool is_player_controlled) { m_parameters.is_player_controlled = is_player_controlled; }
+
         // transforms
         void SetWheelTransform(Entity* transform, uint32_t wheel_index);
         void SetSteeringWheelTransform(Entity* transform) { m_parameters.transform_steering_wheel = transform; }
@@ -94,8 +121,6 @@ namespace Spartan
         float GetSpeedMetersPerSecond() const;
 
     private:
-        void HandleInput();
-        void ApplyForces();
         void UpdateTransforms();
 
         CarParameters m_parameters;
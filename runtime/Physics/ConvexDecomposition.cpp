@@ -0,0 +1,726 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ================================
+#include "pch.h"
+#include "ConvexDecomposition.h"
+#include "BulletPhysicsHelper.h"
+#include "ThreadPool.h"
+SP_WARNINGS_OFF
+#include <LinearMath/btConvexHullComputer.h>
+SP_WARNINGS_ON
+//===========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    namespace
+    {
+        enum Voxel : uint8_t
+        {
+            voxel_unknown = 0,
+            voxel_surface = 1,
+            voxel_outside = 2,
+            voxel_inside  = 3
+        };
+
+        // the candidates of a split only need a rough hull, the final hull of a part uses more of its voxels
+        const uint32_t hull_voxel_count_evaluate = 2048;
+        const uint32_t hull_voxel_count_final    = 65536;
+        const uint32_t split_candidates_per_axis = 8;
+        const float split_balance_weight         = 0.15f; // prefers cuts through the middle when the concavities are close
+
+        struct VoxelGrid
+        {
+            uint32_t size[3] = { 0, 0, 0 };
+            Vector3 origin   = Vector3::Zero;
+            float voxel_size = 0.0f;
+            vector<uint8_t> voxels;
+
+            uint32_t index(const uint32_t x, const uint32_t y, const uint32_t z) const { return x + size[0] * (y + size[1] * z); }
+            bool is_solid(const uint32_t x, const uint32_t y, const uint32_t z) const
+            {
+                const uint8_t voxel = voxels[index(x, y, z)];
+                return voxel == voxel_surface || voxel == voxel_inside;
+            }
+
+            // in halves of a voxel, surface voxels straddle the surface so on average half of them is inside
+            uint32_t get_volume(const uint32_t x, const uint32_t y, const uint32_t z) const
+            {
+                const uint8_t voxel = voxels[index(x, y, z)];
+                return voxel == voxel_inside ? 2 : (voxel == voxel_surface ? 1 : 0);
+            }
+
+            float get_volume_half() const { return voxel_size * voxel_size * voxel_size * 0.5f; }
+        };
+
+        // an axis aligned box of the grid, the part is whatever is solid inside of it
+        struct Part
+        {
+            uint32_t min[3]      = { 0, 0, 0 };
+            uint32_t max[3]      = { 0, 0, 0 }; // inclusive
+            uint32_t volume      = 0;           // in halves of a voxel
+            float concavity      = 0.0f;
+        };
+
+        struct VoxelCoord
+        {
+            uint16_t c[3] = { 0, 0, 0 };
+        };
+
+        Vector3 get_position(const float* positions, const uint32_t stride, const uint32_t index)
+        {
+            const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + static_cast<size_t>(index) * stride);
+            return Vector3(position[0], position[1], position[2]);
+        }
+
+        Vector3 min_per_component(const Vector3& a, const Vector3& b)
+        {
+            return Vector3(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
+        }
+
+        Vector3 max_per_component(const Vector3& a, const Vector3& b)
+        {
+            return Vector3(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z));
+        }
+
+        // separating axis test of a triangle against a cube, relative to the cube's center
+        bool triangle_overlaps_cube(const Vector3 (&triangle)[3], const Vector3& center, const float extent_half)
+        {
+            const Vector3 v[3]    = { triangle[0] - center, triangle[1] - center, triangle[2] - center };
+            const Vector3 e[3]    = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+            const Vector3 axes[3] = { Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f) };
+
+            auto separated = [&v, extent_half](const Vector3& axis)
+            {
+                const float p0 = axis.Dot(v[0]);
+                const float p1 = axis.Dot(v[1]);
+                const float p2 = axis.Dot(v[2]);
+                const float r  = extent_half * (fabsf(axis.x) + fabsf(axis.y) + fabsf(axis.z));
+
+                return min({ p0, p1, p2 }) > r || max({ p0, p1, p2 }) < -r;
+            };
+
+            for (const Vector3& axis : axes)
+            {
+                if (separated(axis))
+                    return false;
+            }
+
+            if (separated(e[0].Cross(e[1])))
+                return false;
+
+            for (const Vector3& axis : axes)
+            {
+                for (const Vector3& edge : e)
+                {
+                    if (separated(axis.Cross(edge)))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        VoxelGrid voxelize(const float* positions, const uint32_t stride, const uint32_t vertex_count, const uint32_t* indices, const uint32_t index_count, const uint32_t resolution)
+        {
+            VoxelGrid grid;
+
+            Vector3 bounds_min = Vector3::Infinity;
+            Vector3 bounds_max = Vector3::InfinityNeg;
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                const Vector3 position = get_position(positions, stride, i);
+                bounds_min = min_per_component(bounds_min, position);
+                bounds_max = max_per_component(bounds_max, position);
+            }
+
+            const Vector3 extent = bounds_max - bounds_min;
+            const float longest  = max({ extent.x, extent.y, extent.z });
+            if (vertex_count == 0 || longest <= 0.0f)
+                return grid;
+
+            // a layer of padding all around, so that the outside is connected and neighbours of solid voxels are always in the grid
+            // the mesh spans up to floor(extent / voxel size) + 1 voxels, the maximum lands on a voxel boundary when the extent is a multiple of it
+            grid.voxel_size = longest / static_cast<float>(resolution);
+            grid.origin     = bounds_min - Vector3(grid.voxel_size);
+            const float extents[3] = { extent.x, extent.y, extent.z };
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                grid.size[axis] = static_cast<uint32_t>(floorf(extents[axis] / grid.voxel_size)) + 3;
+            }
+            grid.voxels.assign(static_cast<size_t>(grid.size[0]) * grid.size[1] * grid.size[2], voxel_unknown);
+
+            // surface
+            const float extent_half = grid.voxel_size * 0.5f;
+            for (uint32_t i = 0; i + 2 < index_count; i += 3)
+            {
+                const Vector3 triangle[3] =
+                {
+                    get_position(positions, stride, indices[i]),
+                    get_position(positions, stride, indices[i + 1]),
+                    get_position(positions, stride, indices[i + 2])
+                };
+
+                const Vector3 triangle_min = (min_per_component(min_per_component(triangle[0], triangle[1]), triangle[2]) - grid.origin) / grid.voxel_size;
+                const Vector3 triangle_max = (max_per_component(max_per_component(triangle[0], triangle[1]), triangle[2]) - grid.origin) / grid.voxel_size;
+                // clamped to the inside of the padding, rounding can put a vertex on the boundary a voxel off
+                const uint32_t start[3]    =
+                {
+                    clamp(static_cast<uint32_t>(max(triangle_min.x, 0.0f)), 1u, grid.size[0] - 2),
+                    clamp(static_cast<uint32_t>(max(triangle_min.y, 0.0f)), 1u, grid.size[1] - 2),
+                    clamp(static_cast<uint32_t>(max(triangle_min.z, 0.0f)), 1u, grid.size[2] - 2)
+                };
+                const uint32_t end[3]      =
+                {
+                    clamp(static_cast<uint32_t>(max(triangle_max.x, 0.0f)), 1u, grid.size[0] - 2),
+                    clamp(static_cast<uint32_t>(max(triangle_max.y, 0.0f)), 1u, grid.size[1] - 2),
+                    clamp(static_cast<uint32_t>(max(triangle_max.z, 0.0f)), 1u, grid.size[2] - 2)
+                };
+
+                for (uint32_t z = start[2]; z <= end[2]; z++)
+                for (uint32_t y = start[1]; y <= end[1]; y++)
+                for (uint32_t x = start[0]; x <= end[0]; x++)
+                {
+                    uint8_t& voxel = grid.voxels[grid.index(x, y, z)];
+                    if (voxel == voxel_surface)
+                        continue;
+
+                    const Vector3 center = grid.origin + Vector3(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, static_cast<float>(z) + 0.5f) * grid.voxel_size;
+                    if (triangle_overlaps_cube(triangle, center, extent_half))
+                    {
+                        voxel = voxel_surface;
+                    }
+                }
+            }
+
+            // flood the outside from a padding corner, whatever it can't reach is inside
+            // meshes which aren't closed leak, they end up as a shell of surface voxels
+            vector<uint32_t> stack = { 0 };
+            grid.voxels[0]         = voxel_outside;
+            while (!stack.empty())
+            {
+                const uint32_t index = stack.back();
+                stack.pop_back();
+
+                const uint32_t x = index % grid.size[0];
+                const uint32_t y = (index / grid.size[0]) % grid.size[1];
+                const uint32_t z = index / (grid.size[0] * grid.size[1]);
+
+                auto visit = [&grid, &stack](const uint32_t x, const uint32_t y, const uint32_t z)
+                {
+                    uint8_t& voxel = grid.voxels[grid.index(x, y, z)];
+                    if (voxel == voxel_unknown)
+                    {
+                        voxel = voxel_outside;
+                        stack.push_back(grid.index(x, y, z));
+                    }
+                };
+
+                if (x > 0)                visit(x - 1, y, z);
+                if (x + 1 < grid.size[0]) visit(x + 1, y, z);
+                if (y > 0)                visit(x, y - 1, z);
+                if (y + 1 < grid.size[1]) visit(x, y + 1, z);
+                if (z > 0)                visit(x, y, z - 1);
+                if (z + 1 < grid.size[2]) visit(x, y, z + 1);
+            }
+
+            for (uint8_t& voxel : grid.voxels)
+            {
+                if (voxel == voxel_unknown)
+                {
+                    voxel = voxel_inside;
+                }
+            }
+
+            return grid;
+        }
+
+        // shrinks the box around its solid voxels, false if it has none
+        bool tighten(const VoxelGrid& grid, Part* part)
+        {
+            uint32_t min[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+            uint32_t max[3] = { 0, 0, 0 };
+            uint32_t volume = 0;
+
+            for (uint32_t z = part->min[2]; z <= part->max[2]; z++)
+            for (uint32_t y = part->min[1]; y <= part->max[1]; y++)
+            for (uint32_t x = part->min[0]; x <= part->max[0]; x++)
+            {
+                if (!grid.is_solid(x, y, z))
+                    continue;
+
+                const uint32_t c[3] = { x, y, z };
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    min[axis] = std::min(min[axis], c[axis]);
+                    max[axis] = std::max(max[axis], c[axis]);
+                }
+                volume += grid.get_volume(x, y, z);
+            }
+
+            if (volume == 0)
+                return false;
+
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                part->min[axis] = min[axis];
+                part->max[axis] = max[axis];
+            }
+            part->volume = volume;
+
+            return true;
+        }
+
+        // solid voxels with a face on the outside of the part, only they can contribute to its hull
+        vector<VoxelCoord> gather_boundary(const VoxelGrid& grid, const Part& part)
+        {
+            vector<VoxelCoord> boundary;
+
+            for (uint32_t z = part.min[2]; z <= part.max[2]; z++)
+            for (uint32_t y = part.min[1]; y <= part.max[1]; y++)
+            for (uint32_t x = part.min[0]; x <= part.max[0]; x++)
+            {
+                if (!grid.is_solid(x, y, z))
+                    continue;
+
+                const bool is_boundary =
+                    x == part.min[0] || x == part.max[0] || !grid.is_solid(x - 1, y, z) || !grid.is_solid(x + 1, y, z) ||
+                    y == part.min[1] || y == part.max[1] || !grid.is_solid(x, y - 1, z) || !grid.is_solid(x, y + 1, z) ||
+                    z == part.min[2] || z == part.max[2] || !grid.is_solid(x, y, z - 1) || !grid.is_solid(x, y, z + 1);
+
+                if (is_boundary)
+                {
+                    VoxelCoord coord;
+                    coord.c[0] = static_cast<uint16_t>(x);
+                    coord.c[1] = static_cast<uint16_t>(y);
+                    coord.c[2] = static_cast<uint16_t>(z);
+                    boundary.emplace_back(coord);
+                }
+            }
+
+            return boundary;
+        }
+
+        // the center of a boundary voxel, surface voxels straddle the surface so their centers lie on it on average,
+        // voxels along a cut sit against the cut plane instead, so they are moved onto it
+        Vector3 get_hull_point(const VoxelGrid& grid, const Part& part, const VoxelCoord& coord)
+        {
+            float position[3];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                uint32_t below[3] = { coord.c[0], coord.c[1], coord.c[2] };
+                uint32_t above[3] = { coord.c[0], coord.c[1], coord.c[2] };
+                below[axis]--;
+                above[axis]++;
+
+                position[axis] = static_cast<float>(coord.c[axis]) + 0.5f;
+                if (coord.c[axis] == part.min[axis] && grid.is_solid(below[0], below[1], below[2]))
+                {
+                    position[axis] -= 0.5f;
+                }
+                if (coord.c[axis] == part.max[axis] && grid.is_solid(above[0], above[1], above[2]))
+                {
+                    position[axis] += 0.5f;
+                }
+            }
+
+            return grid.origin + Vector3(position[0], position[1], position[2]) * grid.voxel_size;
+        }
+
+        bool compute_hull(const vector<Vector3>& points, btConvexHullComputer* hull)
+        {
+            if (points.size() < 4)
+                return false;
+
+            hull->compute(&points[0].x, static_cast<int>(sizeof(Vector3)), static_cast<int>(points.size()), 0.0f, 0.0f);
+            return hull->vertices.size() >= 4 && hull->faces.size() >= 4;
+        }
+
+        float compute_hull_volume(const btConvexHullComputer& hull)
+        {
+            if (hull.vertices.size() < 4)
+                return 0.0f;
+
+            btVector3 center(0.0f, 0.0f, 0.0f);
+            for (int i = 0; i < hull.vertices.size(); i++)
+            {
+                center += hull.vertices[i];
+            }
+            center /= static_cast<btScalar>(hull.vertices.size());
+
+            // a fan of tetrahedra from the center to every face
+            float volume = 0.0f;
+            for (int i = 0; i < hull.faces.size(); i++)
+            {
+                const btConvexHullComputer::Edge* edge_first = &hull.edges[hull.faces[i]];
+                const btVector3 a                            = hull.vertices[edge_first->getSourceVertex()] - center;
+                const btConvexHullComputer::Edge* edge       = edge_first->getNextEdgeOfFace();
+                while (edge->getTargetVertex() != edge_first->getSourceVertex())
+                {
+                    const btVector3 b = hull.vertices[edge->getSourceVertex()] - center;
+                    const btVector3 c = hull.vertices[edge->getTargetVertex()] - center;
+                    volume += fabsf(a.dot(b.cross(c))) / 6.0f;
+                    edge    = edge->getNextEdgeOfFace();
+                }
+            }
+
+            return volume;
+        }
+
+        // keeps the hull vertices which add the most volume, starting from the extremes along each axis
+        vector<Vector3> simplify_hull(const btConvexHullComputer& hull, const uint32_t vertex_count_max)
+        {
+            vector<Vector3> vertices;
+            for (int i = 0; i < hull.vertices.size(); i++)
+            {
+                vertices.emplace_back(ToVector3(hull.vertices[i]));
+            }
+
+            if (vertices.size() <= vertex_count_max)
+                return vertices;
+
+            vector<bool> is_selected(vertices.size(), false);
+            vector<Vector3> selected;
+            auto select = [&](const size_t index)
+            {
+                if (!is_selected[index])
+                {
+                    is_selected[index] = true;
+                    selected.emplace_back(vertices[index]);
+                }
+            };
+
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                size_t index_min = 0;
+                size_t index_max = 0;
+                for (size_t i = 1; i < vertices.size(); i++)
+                {
+                    index_min = vertices[i].Data()[axis] < vertices[index_min].Data()[axis] ? i : index_min;
+                    index_max = vertices[i].Data()[axis] > vertices[index_max].Data()[axis] ? i : index_max;
+                }
+                select(index_min);
+                select(index_max);
+            }
+
+            while (selected.size() < vertex_count_max)
+            {
+                // the vertex furthest outside of the hull of the selection
+                btConvexHullComputer hull_selected;
+                const bool has_volume = compute_hull(selected, &hull_selected);
+
+                Vector3 center = Vector3::Zero;
+                for (const Vector3& point : selected)
+                {
+                    center += point;
+                }
+                center /= static_cast<float>(selected.size());
+
+                size_t index_best    = vertices.size();
+                float distance_best  = 0.0f;
+                for (size_t i = 0; i < vertices.size(); i++)
+                {
+                    if (is_selected[i])
+                        continue;
+
+                    float distance = 0.0f;
+                    if (has_volume)
+                    {
+                        distance = -FLT_MAX;
+                        for (int face = 0; face < hull_selected.faces.size(); face++)
+                        {
+                            const btConvexHullComputer::Edge* edge = &hull_selected.edges[hull_selected.faces[face]];
+                            const btVector3& a = hull_selected.vertices[edge->getSourceVertex()];
+                            const btVector3& b = hull_selected.vertices[edge->getTargetVertex()];
+                            const btVector3& c = hull_selected.vertices[edge->getNextEdgeOfFace()->getTargetVertex()];
+
+                            btVector3 normal = (b - a).cross(c - a);
+                            if (normal.fuzzyZero())
+                                continue;
+
+                            normal.normalize();
+                            if (normal.dot(ToBtVector3(center) - a) > 0.0f)
+                            {
+                                normal = -normal;
+                            }
+
+                            distance = max(distance, normal.dot(ToBtVector3(vertices[i]) - a));
+                        }
+                    }
+                    else
+                    {
+                        distance = (vertices[i] - center).Length();
+                    }
+
+                    if (distance > distance_best)
+                    {
+                        distance_best = distance;
+                        index_best    = i;
+                    }
+                }
+
+                if (index_best == vertices.size())
+                    break;
+
+                select(index_best);
+            }
+
+            return selected;
+        }
+
+        // the hull points of the boundary voxels, sparser when there are many
+        void gather_points(const VoxelGrid& grid, const Part& part, const vector<VoxelCoord>& voxels, const uint32_t voxel_count_max, vector<Vector3>* points)
+        {
+            const size_t stride = max<size_t>(1, (voxels.size() + voxel_count_max - 1) / voxel_count_max);
+            for (size_t i = 0; i < voxels.size(); i += stride)
+            {
+                points->emplace_back(get_hull_point(grid, part, voxels[i]));
+            }
+        }
+
+        float compute_concavity(const VoxelGrid& grid, const Part& part, const vector<VoxelCoord>& boundary, const uint32_t volume, const float volume_total, const uint32_t voxel_count_max)
+        {
+            vector<Vector3> points;
+            gather_points(grid, part, boundary, voxel_count_max, &points);
+
+            btConvexHullComputer hull;
+            if (!compute_hull(points, &hull))
+                return 0.0f;
+
+            return max(0.0f, compute_hull_volume(hull) - static_cast<float>(volume) * grid.get_volume_half()) / volume_total;
+        }
+
+        struct Split
+        {
+            uint32_t axis     = 0;
+            uint32_t position = 0; // the first layer of the second half
+            float cost        = FLT_MAX;
+        };
+
+        Split find_split(const VoxelGrid& grid, const Part& part, const float volume_total)
+        {
+            const vector<VoxelCoord> boundary = gather_boundary(grid, part);
+
+            // volume per layer along each axis
+            vector<uint32_t> layers[3];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                layers[axis].assign(part.max[axis] - part.min[axis] + 1, 0);
+            }
+            for (uint32_t z = part.min[2]; z <= part.max[2]; z++)
+            for (uint32_t y = part.min[1]; y <= part.max[1]; y++)
+            for (uint32_t x = part.min[0]; x <= part.max[0]; x++)
+            {
+                const uint32_t volume = grid.get_volume(x, y, z);
+                layers[0][x - part.min[0]] += volume;
+                layers[1][y - part.min[1]] += volume;
+                layers[2][z - part.min[2]] += volume;
+            }
+
+            vector<Split> candidates;
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                const uint32_t extent = part.max[axis] - part.min[axis] + 1;
+                if (extent < 2)
+                    continue;
+
+                const uint32_t count = min(split_candidates_per_axis, extent - 1);
+                for (uint32_t i = 1; i <= count; i++)
+                {
+                    Split split;
+                    split.axis     = axis;
+                    split.position = part.min[axis] + (i * extent) / (count + 1);
+                    if (candidates.empty() || candidates.back().axis != axis || candidates.back().position != split.position)
+                    {
+                        candidates.emplace_back(split);
+                    }
+                }
+            }
+
+            ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    Split& split = candidates[i];
+
+                    // the halves keep their share of the boundary, and the voxels along the cut become boundary too
+                    vector<VoxelCoord> halves[2];
+                    for (const VoxelCoord& coord : boundary)
+                    {
+                        halves[coord.c[split.axis] < split.position ? 0 : 1].emplace_back(coord);
+                    }
+
+                    const uint32_t axis_u = (split.axis + 1) % 3;
+                    const uint32_t axis_v = (split.axis + 2) % 3;
+                    for (uint32_t side = 0; side < 2; side++)
+                    {
+                        uint32_t c[3];
+                        c[split.axis] = side == 0 ? split.position - 1 : split.position;
+                        for (c[axis_v] = part.min[axis_v]; c[axis_v] <= part.max[axis_v]; c[axis_v]++)
+                        for (c[axis_u] = part.min[axis_u]; c[axis_u] <= part.max[axis_u]; c[axis_u]++)
+                        {
+                            if (grid.is_solid(c[0], c[1], c[2]))
+                            {
+                                VoxelCoord coord;
+                                coord.c[0] = static_cast<uint16_t>(c[0]);
+                                coord.c[1] = static_cast<uint16_t>(c[1]);
+                                coord.c[2] = static_cast<uint16_t>(c[2]);
+                                halves[side].emplace_back(coord);
+                            }
+                        }
+                    }
+
+                    uint32_t volumes[2] = { 0, 0 };
+                    for (uint32_t layer = 0; layer < static_cast<uint32_t>(layers[split.axis].size()); layer++)
+                    {
+                        volumes[part.min[split.axis] + layer < split.position ? 0 : 1] += layers[split.axis][layer];
+                    }
+
+                    Part half_parts[2] = { part, part };
+                    half_parts[0].max[split.axis] = split.position - 1;
+                    half_parts[1].min[split.axis] = split.position;
+
+                    const float concavity =
+                        compute_concavity(grid, half_parts[0], halves[0], volumes[0], volume_total, hull_voxel_count_evaluate) +
+                        compute_concavity(grid, half_parts[1], halves[1], volumes[1], volume_total, hull_voxel_count_evaluate);
+
+                    const float imbalance = fabsf(static_cast<float>(volumes[0]) - static_cast<float>(volumes[1])) * grid.get_volume_half() / volume_total;
+                    split.cost            = concavity + split_balance_weight * imbalance;
+                }
+            }, static_cast<uint32_t>(candidates.size()));
+
+            Split best;
+            for (const Split& split : candidates)
+            {
+                best = split.cost < best.cost ? split : best;
+            }
+
+            return best;
+        }
+    }
+
+    vector<vector<Vector3>> ConvexDecomposition::Compute(
+        const float* positions,
+        const uint32_t position_stride,
+        const uint32_t vertex_count,
+        const uint32_t* indices,
+        const uint32_t index_count,
+        const ConvexDecompositionSettings& settings
+    )
+    {
+        SP_ASSERT(settings.resolution >= 2 && settings.resolution <= 1024);
+
+        vector<vector<Vector3>> hulls;
+
+        const VoxelGrid grid = voxelize(positions, position_stride, vertex_count, indices, index_count, settings.resolution);
+        if (grid.voxels.empty())
+            return hulls;
+
+        Part root;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            root.max[axis] = grid.size[axis] - 1;
+        }
+        if (!tighten(grid, &root))
+            return hulls;
+
+        const float volume_total = static_cast<float>(root.volume) * grid.get_volume_half();
+        root.concavity           = compute_concavity(grid, root, gather_boundary(grid, root), root.volume, volume_total, hull_voxel_count_evaluate);
+
+        // split the most concave part until they are all convex enough, or there are enough of them
+        vector<Part> parts = { root };
+        while (parts.size() < settings.hull_count_max)
+        {
+            auto it = max_element(parts.begin(), parts.end(), [](const Part& a, const Part& b) { return a.concavity < b.concavity; });
+            if (it->concavity <= settings.concavity_max)
+                break;
+
+            const Split split = find_split(grid, *it, volume_total);
+            if (split.cost == FLT_MAX)
+            {
+                it->concavity = 0.0f; // a single voxel thick, it can't be split
+                continue;
+            }
+
+            Part halves[2] = { *it, *it };
+            halves[0].max[split.axis] = split.position - 1;
+            halves[1].min[split.axis] = split.position;
+
+            parts.erase(it);
+            for (Part& half : halves)
+            {
+                if (tighten(grid, &half))
+                {
+                    half.concavity = compute_concavity(grid, half, gather_boundary(grid, half), half.volume, volume_total, hull_voxel_count_evaluate);
+                    parts.emplace_back(half);
+                }
+            }
+        }
+
+        // the final hulls, in parallel since each one is independent
+        hulls.resize(parts.size());
+        ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                vector<Vector3> points;
+                gather_points(grid, parts[i], gather_boundary(grid, parts[i]), hull_voxel_count_final, &points);
+
+                btConvexHullComputer hull;
+                if (compute_hull(points, &hull))
+                {
+                    hulls[i] = simplify_hull(hull, max(settings.hull_vertex_count_max, 4u));
+                }
+            }
+        }, static_cast<uint32_t>(parts.size()));
+
+        hulls.erase(remove_if(hulls.begin(), hulls.end(), [](const vector<Vector3>& hull) { return hull.empty(); }), hulls.end());
+
+        return hulls;
+    }
+
+    float ConvexDecomposition::ComputeHullVolume(const vector<Vector3>& points)
+    {
+        btConvexHullComputer hull;
+        return compute_hull(points, &hull) ? compute_hull_volume(hull) : 0.0f;
+    }
+
+    float ConvexDecomposition::ComputeMeshVolume(const float* positions, const uint32_t position_stride, const uint32_t* indices, const uint32_t index_count)
+    {
+        // signed tetrahedra from the origin, the outside cancels out
+        float volume = 0.0f;
+        for (uint32_t i = 0; i + 2 < index_count; i += 3)
+        {
+            const Vector3 a = get_position(positions, position_stride, indices[i]);
+            const Vector3 b = get_position(positions, position_stride, indices[i + 1]);
+            const Vector3 c = get_position(positions, position_stride, indices[i + 2]);
+            volume += a.Dot(b.Cross(c)) / 6.0f;
+        }
+
+        return fabsf(volume);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include "Definitions.h"
+#include "../Math/Vector3.h"
+//=============================
+
+namespace Spartan
+{
+    struct ConvexDecompositionSettings
+    {
+        uint32_t resolution            = 64;    // voxels along the longest side of the mesh
+        uint32_t hull_count_max        = 16;
+        uint32_t hull_vertex_count_max = 32;
+        float concavity_max            = 0.01f; // hull volume the part doesn't fill, as a fraction of the mesh volume, parts above it are split
+    };
+
+    // approximates a concave mesh with a few convex hulls that don't overlap, so that it can be simulated as a dynamic body
+    // the mesh is voxelized and then cut by axis aligned planes, each cut goes where it lowers the concavity of the two halves the most
+    class SP_CLASS ConvexDecomposition
+    {
+    public:
+        // returns the points of each hull, in the space of the mesh
+        static std::vector<std::vector<Math::Vector3>> Compute(
+            const float* positions,
+            const uint32_t position_stride, // in bytes
+            const uint32_t vertex_count,
+            const uint32_t* indices,
+            const uint32_t index_count,
+            const ConvexDecompositionSettings& settings = ConvexDecompositionSettings()
+        );
+
+        // volume of the convex hull of the points
+        static float ComputeHullVolume(const std::vector<Math::Vector3>& points);
+
+        // volume enclosed by a closed triangle mesh
+        static float ComputeMeshVolume(const float* positions, const uint32_t position_stride, const uint32_t* indices, const uint32_t index_count);
+    };
+}
@@ -0,0 +1,738 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =================================================================
+#include "pch.h"
+#include "MeshShapeCache.h"
+#include "BulletPhysicsHelper.h"
+#include "ConvexDecomposition.h"
+#include "ThreadPool.h"
+#include "../Rendering/Mesh.h"
+#include "../IO/AssetContainer.h"
+SP_WARNINGS_OFF
+#include <BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
+SP_WARNINGS_ON
+//============================================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    namespace
+    {
+        const uint32_t chunk_bvh_record  = asset_chunk_id("CBVR");
+        const uint32_t chunk_bvh_data    = asset_chunk_id("CBVD");
+        const uint32_t chunk_hull_record = asset_chunk_id("CHLR");
+        const uint32_t chunk_hull_data   = asset_chunk_id("CHLD");
+
+        // bump when the decomposition changes, so hulls saved by an older version are recomputed
+        const uint64_t hulls_version = 1;
+
+        struct ShapeKey
+        {
+            Mesh* mesh             = nullptr;
+            uint32_t index_offset  = 0;
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+            MeshShapeType type     = MeshShapeType::Triangles;
+            Vector3 scale          = Vector3::One;
+            uint64_t detached      = 0; // set once the mesh was invalidated, such shapes are no longer handed out, only released
+
+            bool operator==(const ShapeKey& other) const
+            {
+                return mesh == other.mesh && detached == other.detached && index_offset == other.index_offset && index_count == other.index_count &&
+                       vertex_offset == other.vertex_offset && vertex_count == other.vertex_count && type == other.type && scale == other.scale;
+            }
+        };
+
+        uint64_t hash_combine(const uint64_t seed, const uint64_t value)
+        {
+            return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+        }
+
+        struct ShapeKeyHasher
+        {
+            size_t operator()(const ShapeKey& key) const
+            {
+                uint64_t hash = reinterpret_cast<uint64_t>(key.mesh);
+                hash = hash_combine(hash, key.detached);
+                hash = hash_combine(hash, (static_cast<uint64_t>(key.index_offset) << 32) | key.index_count);
+                hash = hash_combine(hash, (static_cast<uint64_t>(key.vertex_offset) << 32) | key.vertex_count);
+                hash = hash_combine(hash, static_cast<uint64_t>(key.type));
+                hash = hash_combine(hash, static_cast<uint64_t>(std::hash<float>{}(key.scale.x)));
+                hash = hash_combine(hash, static_cast<uint64_t>(std::hash<float>{}(key.scale.y)));
+                hash = hash_combine(hash, static_cast<uint64_t>(std::hash<float>{}(key.scale.z)));
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        // identifies a bvh or a decomposition in the file next to the mesh, the hash catches geometry that changed since it was saved
+        struct GeometryRecord
+        {
+            uint32_t index_offset  = 0;
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+            uint64_t geometry_hash = 0;
+        };
+        static_assert(sizeof(GeometryRecord) == 24);
+
+        struct GeometryPending
+        {
+            GeometryRecord record;
+            vector<byte> data;
+        };
+
+        // the unscaled bvh shape of a mesh range, every scale wraps the same one
+        struct TriangleMesh
+        {
+            btTriangleIndexVertexArray* mesh_interface = nullptr;
+            btBvhTriangleMeshShape* shape              = nullptr;
+            void* bvh_buffer                           = nullptr; // set when the bvh was loaded, it lives inside this buffer
+            uint64_t bvh_size                          = 0;
+            uint32_t references                        = 0;
+            vector<uint32_t> indices;                             // a copy of the geometry, made once the mesh was invalidated
+            vector<float> positions;
+        };
+
+        // the unscaled hulls of a mesh range, every scale builds its own compound from them since bullet scales compounds in place
+        struct DecomposedMesh
+        {
+            vector<vector<Vector3>> hulls;
+            uint32_t references = 0;
+        };
+
+        struct Shape
+        {
+            btCollisionShape* shape = nullptr;
+            uint32_t references     = 0;
+        };
+
+        mutex mutex_cache;
+        mutex mutex_save;
+        unordered_map<ShapeKey, TriangleMesh, ShapeKeyHasher> triangle_meshes;
+        unordered_map<ShapeKey, DecomposedMesh, ShapeKeyHasher> decomposed_meshes;
+        unordered_map<ShapeKey, Shape, ShapeKeyHasher> shapes;
+        unordered_map<btCollisionShape*, ShapeKey> shape_keys;
+        unordered_map<Mesh*, uint32_t> mesh_shape_counts;             // so that invalidating a mesh without shapes costs nothing
+        unordered_map<string, vector<GeometryPending>> bvhs_pending;  // keyed by file path
+        unordered_map<string, vector<GeometryPending>> hulls_pending; // keyed by file path
+        uint64_t detached_count = 0;
+
+        string get_sidecar_path(Mesh* mesh, const char* extension)
+        {
+            const string& path = mesh->GetResourceFilePathNative();
+            return path.empty() ? path : FileSystem::ReplaceExtension(path, extension);
+        }
+
+        // fnv-1a, the hash is saved next to the mesh and std::hash differs between standard libraries
+        uint64_t hash_bytes(const void* data, const size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+
+            return hash;
+        }
+
+        // only what collides, a change to the uvs or normals doesn't make the saved data stale
+        uint64_t compute_geometry_hash(Mesh* mesh, const ShapeKey& key)
+        {
+            uint64_t hash = hash_bytes(&mesh->GetIndices()[key.index_offset], key.index_count * sizeof(uint32_t));
+            for (uint32_t i = 0; i < key.vertex_count; i++)
+            {
+                hash = hash_bytes(mesh->GetVertices()[key.vertex_offset + i].pos, 3 * sizeof(float), hash);
+            }
+
+            return hash;
+        }
+
+        bool records_match(const GeometryRecord& a, const GeometryRecord& b)
+        {
+            return a.index_offset == b.index_offset && a.index_count == b.index_count && a.vertex_offset == b.vertex_offset && a.vertex_count == b.vertex_count;
+        }
+
+        // the saved data of a mesh range, if there is any and its geometry hasn't changed since
+        bool load_sidecar(const string& path, const uint32_t chunk_record, const uint32_t chunk_data, const GeometryRecord& record, vector<byte>* data)
+        {
+            AssetContainer container;
+            if (!FileSystem::Exists(path) || !container.Open(path))
+                return false;
+
+            for (uint32_t i = 0; i < container.GetChunkCount(chunk_record); i++)
+            {
+                GeometryRecord record_saved;
+                if (!container.ReadChunk(chunk_record, i, &record_saved) || !records_match(record_saved, record) || record_saved.geometry_hash != record.geometry_hash)
+                    continue;
+
+                return container.ReadChunk(chunk_data, i, data) && !data->empty();
+            }
+
+            return false;
+        }
+
+        void write_sidecar(const string& path, const uint32_t chunk_record, const uint32_t chunk_data, vector<GeometryPending>& entries)
+        {
+            // keep what's already in the file, unless it's being replaced
+            {
+                AssetContainer container;
+                if (FileSystem::Exists(path) && container.Open(path))
+                {
+                    for (uint32_t i = 0; i < container.GetChunkCount(chunk_record); i++)
+                    {
+                        GeometryPending existing;
+                        if (!container.ReadChunk(chunk_record, i, &existing.record) || !container.ReadChunk(chunk_data, i, &existing.data))
+                            continue;
+
+                        if (none_of(entries.begin(), entries.end(), [&existing](const GeometryPending& entry) { return records_match(entry.record, existing.record); }))
+                        {
+                            entries.push_back(move(existing));
+                        }
+                    }
+                }
+            }
+
+            AssetContainerWriter writer;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(entries.size()); i++)
+            {
+                writer.AddChunk(chunk_record, i, &entries[i].record, sizeof(GeometryRecord));
+                writer.AddChunk(chunk_data,   i, entries[i].data);
+            }
+
+            if (!writer.Write(path))
+            {
+                SP_LOG_WARNING("Failed to save collision geometry to \"%s\"", path.c_str());
+            }
+        }
+
+        btOptimizedBvh* load_bvh(const string& path, const GeometryRecord& record, void** buffer_out, uint64_t* size_out)
+        {
+            vector<byte> data;
+            if (!load_sidecar(path, chunk_bvh_record, chunk_bvh_data, record, &data))
+                return nullptr;
+
+            // the bvh is fixed up in place, so it needs a writable and aligned copy which outlives it
+            void* buffer = btAlignedAlloc(data.size(), 16);
+            memcpy(buffer, data.data(), data.size());
+            btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(buffer, static_cast<unsigned int>(data.size()), false);
+            if (!bvh)
+            {
+                btAlignedFree(buffer);
+                return nullptr;
+            }
+
+            *buffer_out = buffer;
+            *size_out   = data.size();
+            return bvh;
+        }
+
+        TriangleMesh* acquire_triangle_mesh(const ShapeKey& key)
+        {
+            TriangleMesh& triangle_mesh = triangle_meshes[key];
+            triangle_mesh.references++;
+            if (triangle_mesh.shape)
+                return &triangle_mesh;
+
+            // reference the mesh's own arrays, the indices are relative to the vertex offset
+            btIndexedMesh part;
+            part.m_numTriangles        = static_cast<int>(key.index_count / 3);
+            part.m_triangleIndexBase   = reinterpret_cast<const unsigned char*>(&key.mesh->GetIndices()[key.index_offset]);
+            part.m_triangleIndexStride = 3 * sizeof(uint32_t);
+            part.m_numVertices         = static_cast<int>(key.vertex_count);
+            part.m_vertexBase          = reinterpret_cast<const unsigned char*>(&key.mesh->GetVertices()[key.vertex_offset].pos[0]);
+            part.m_vertexStride        = sizeof(RHI_Vertex_PosTexNorTan);
+            part.m_indexType           = PHY_INTEGER;
+            part.m_vertexType          = PHY_FLOAT;
+
+            triangle_mesh.mesh_interface = new btTriangleIndexVertexArray();
+            triangle_mesh.mesh_interface->addIndexedMesh(part, PHY_INTEGER);
+
+            // try the saved bvh first, building one is the bulk of the cost
+            const string path     = get_sidecar_path(key.mesh, EXTENSION_MESH_BVH);
+            GeometryRecord record = { key.index_offset, key.index_count, key.vertex_offset, key.vertex_count, 0 };
+            btOptimizedBvh* bvh = nullptr;
+            if (!path.empty())
+            {
+                record.geometry_hash = compute_geometry_hash(key.mesh, key);
+                bvh = load_bvh(path, record, &triangle_mesh.bvh_buffer, &triangle_mesh.bvh_size);
+            }
+
+            if (bvh)
+            {
+                triangle_mesh.shape = new btBvhTriangleMeshShape(triangle_mesh.mesh_interface, true, false);
+                triangle_mesh.shape->setOptimizedBvh(bvh);
+            }
+            else
+            {
+                triangle_mesh.shape    = new btBvhTriangleMeshShape(triangle_mesh.mesh_interface, true, true);
+                triangle_mesh.bvh_size = triangle_mesh.shape->getOptimizedBvh()->calculateSerializeBufferSize();
+
+                if (!path.empty())
+                {
+                    GeometryPending pending;
+                    pending.record = record;
+                    pending.data.resize(static_cast<size_t>(triangle_mesh.bvh_size));
+
+                    void* buffer = btAlignedAlloc(static_cast<size_t>(triangle_mesh.bvh_size), 16);
+                    if (triangle_mesh.shape->getOptimizedBvh()->serializeInPlace(buffer, static_cast<unsigned int>(triangle_mesh.bvh_size), false))
+                    {
+                        memcpy(pending.data.data(), buffer, pending.data.size());
+                        bvhs_pending[path].push_back(move(pending));
+                    }
+                    btAlignedFree(buffer);
+                }
+            }
+
+            return &triangle_mesh;
+        }
+
+        void release_triangle_mesh(const ShapeKey& key)
+        {
+            auto it = triangle_meshes.find(key);
+            if (it == triangle_meshes.end() || --it->second.references != 0)
+                return;
+
+            TriangleMesh& triangle_mesh = it->second;
+            btOptimizedBvh* bvh         = triangle_mesh.shape->getOptimizedBvh();
+            delete triangle_mesh.shape;
+            if (triangle_mesh.bvh_buffer)
+            {
+                // loaded bvhs aren't owned by the shape and don't own their arrays, they live in the buffer
+                bvh->~btOptimizedBvh();
+                btAlignedFree(triangle_mesh.bvh_buffer);
+            }
+            delete triangle_mesh.mesh_interface;
+
+            triangle_meshes.erase(it);
+        }
+
+        // hulls are packed as [hull count][point count of each hull][points]
+        vector<byte> pack_hulls(const vector<vector<Vector3>>& hulls)
+        {
+            vector<uint32_t> header = { static_cast<uint32_t>(hulls.size()) };
+            vector<Vector3> points;
+            for (const vector<Vector3>& hull : hulls)
+            {
+                header.push_back(static_cast<uint32_t>(hull.size()));
+                points.insert(points.end(), hull.begin(), hull.end());
+            }
+
+            vector<byte> data(header.size() * sizeof(uint32_t) + points.size() * sizeof(Vector3));
+            memcpy(data.data(), header.data(), header.size() * sizeof(uint32_t));
+            memcpy(data.data() + header.size() * sizeof(uint32_t), points.data(), points.size() * sizeof(Vector3));
+            return data;
+        }
+
+        bool unpack_hulls(const vector<byte>& data, vector<vector<Vector3>>* hulls)
+        {
+            uint32_t hull_count = 0;
+            if (data.size() < sizeof(uint32_t))
+                return false;
+            memcpy(&hull_count, data.data(), sizeof(uint32_t));
+
+            size_t offset_points = (static_cast<size_t>(hull_count) + 1) * sizeof(uint32_t);
+            if (data.size() < offset_points)
+                return false;
+
+            hulls->resize(hull_count);
+            for (uint32_t i = 0; i < hull_count; i++)
+            {
+                uint32_t point_count = 0;
+                memcpy(&point_count, data.data() + (static_cast<size_t>(i) + 1) * sizeof(uint32_t), sizeof(uint32_t));
+                if (data.size() < offset_points + point_count * sizeof(Vector3))
+                    return false;
+
+                (*hulls)[i].resize(point_count);
+                memcpy((*hulls)[i].data(), data.data() + offset_points, point_count * sizeof(Vector3));
+                offset_points += point_count * sizeof(Vector3);
+            }
+
+            return offset_points == data.size();
+        }
+
+        DecomposedMesh* acquire_decomposed_mesh(const ShapeKey& key)
+        {
+            DecomposedMesh& decomposed_mesh = decomposed_meshes[key];
+            decomposed_mesh.references++;
+            if (!decomposed_mesh.hulls.empty())
+                return &decomposed_mesh;
+
+            // try the saved hulls first, the decomposition takes a while
+            const string path     = get_sidecar_path(key.mesh, EXTENSION_MESH_HULLS);
+            GeometryRecord record = { key.index_offset, key.index_count, key.vertex_offset, key.vertex_count, 0 };
+            if (!path.empty())
+            {
+                record.geometry_hash = hash_combine(compute_geometry_hash(key.mesh, key), hulls_version);
+
+                vector<byte> data;
+                if (load_sidecar(path, chunk_hull_record, chunk_hull_data, record, &data) && unpack_hulls(data, &decomposed_mesh.hulls))
+                    return &decomposed_mesh;
+
+                decomposed_mesh.hulls.clear();
+            }
+
+            // the indices are relative to the vertex offset
+            const float* positions  = &key.mesh->GetVertices()[key.vertex_offset].pos[0];
+            const uint32_t* indices = &key.mesh->GetIndices()[key.index_offset];
+            decomposed_mesh.hulls   = ConvexDecomposition::Compute(positions, sizeof(RHI_Vertex_PosTexNorTan), key.vertex_count, indices, key.index_count);
+
+            if (decomposed_mesh.hulls.empty())
+            {
+                SP_LOG_WARNING("Failed to decompose \"%s\", falling back to a single convex hull", key.mesh->GetObjectName().c_str());
+                decomposed_mesh.hulls.emplace_back();
+                for (uint32_t i = 0; i < key.vertex_count; i++)
+                {
+                    const float* position = key.mesh->GetVertices()[key.vertex_offset + i].pos;
+                    decomposed_mesh.hulls.back().emplace_back(position[0], position[1], position[2]);
+                }
+            }
+            else
+            {
+                float volume = 0.0f;
+                for (const vector<Vector3>& hull : decomposed_mesh.hulls)
+                {
+                    volume += ConvexDecomposition::ComputeHullVolume(hull);
+                }
+                const float volume_mesh = ConvexDecomposition::ComputeMeshVolume(positions, sizeof(RHI_Vertex_PosTexNorTan), indices, key.index_count);
+
+                SP_LOG_INFO("Decomposed \"%s\" into %u convex hulls, %.0f%% of its volume",
+                    key.mesh->GetObjectName().c_str(), static_cast<uint32_t>(decomposed_mesh.hulls.size()), volume_mesh > 0.0f ? 100.0f * volume / volume_mesh : 0.0f);
+
+                if (!path.empty())
+                {
+                    GeometryPending pending;
+                    pending.record = record;
+                    pending.data   = pack_hulls(decomposed_mesh.hulls);
+                    hulls_pending[path].push_back(move(pending));
+                }
+            }
+
+            return &decomposed_mesh;
+        }
+
+        void release_decomposed_mesh(const ShapeKey& key)
+        {
+            auto it = decomposed_meshes.find(key);
+            if (it != decomposed_meshes.end() && --it->second.references == 0)
+            {
+                decomposed_meshes.erase(it);
+            }
+        }
+    }
+
+    btCollisionShape* MeshShapeCache::Acquire(
+        Mesh* mesh,
+        const uint32_t index_offset,
+        const uint32_t index_count,
+        const uint32_t vertex_offset,
+        const uint32_t vertex_count,
+        const Vector3& scale,
+        const MeshShapeType type
+    )
+    {
+        SP_ASSERT(mesh != nullptr);
+
+        lock_guard<mutex> lock(mutex_cache);
+
+        const ShapeKey key = { mesh, index_offset, index_count, vertex_offset, vertex_count, type, scale };
+        auto it = shapes.find(key);
+        if (it != shapes.end())
+        {
+            it->second.references++;
+            return it->second.shape;
+        }
+
+        // the cpu data can be released after the gpu buffers are created (e.g. terrain)
+        const bool needs_indices = type == MeshShapeType::Triangles || type == MeshShapeType::ConvexDecomposition;
+        if (vertex_count == 0 || mesh->GetVertices().size() < static_cast<size_t>(vertex_offset) + vertex_count ||
+            (needs_indices && (index_count < 3 || mesh->GetIndices().size() < static_cast<size_t>(index_offset) + index_count)))
+        {
+            SP_LOG_WARNING("A shape can't be constructed without geometry");
+            return nullptr;
+        }
+
+        Shape shape;
+        shape.references = 1;
+        if (type == MeshShapeType::Triangles)
+        {
+            ShapeKey key_unscaled = key;
+            key_unscaled.scale    = Vector3::One;
+
+            TriangleMesh* triangle_mesh = acquire_triangle_mesh(key_unscaled);
+            shape.shape                 = new btScaledBvhTriangleMeshShape(triangle_mesh->shape, ToBtVector3(scale));
+        }
+        else if (type == MeshShapeType::ConvexDecomposition)
+        {
+            ShapeKey key_unscaled = key;
+            key_unscaled.scale    = Vector3::One;
+
+            DecomposedMesh* decomposed_mesh = acquire_decomposed_mesh(key_unscaled);
+            btCompoundShape* compound       = new btCompoundShape(true, static_cast<int>(decomposed_mesh->hulls.size()));
+            for (const vector<Vector3>& hull : decomposed_mesh->hulls)
+            {
+                btConvexHullShape* child = new btConvexHullShape(&hull[0].x, static_cast<int>(hull.size()), static_cast<int>(sizeof(Vector3)));
+                child->optimizeConvexHull();
+                compound->addChildShape(btTransform::getIdentity(), child);
+            }
+
+            // scales the children in place, which is why they aren't shared between scales
+            compound->setLocalScaling(ToBtVector3(scale));
+            shape.shape = compound;
+        }
+        else
+        {
+            btConvexHullShape* hull = new btConvexHullShape(
+                &mesh->GetVertices()[vertex_offset].pos[0],         // points
+                static_cast<int>(vertex_count),                     // point count
+                static_cast<int>(sizeof(RHI_Vertex_PosTexNorTan))); // stride
+
+            hull->setLocalScaling(ToBtVector3(scale));
+
+            // turn it into a proper convex hull since btConvexHullShape is an approximation
+            hull->optimizeConvexHull();
+            shape.shape = hull;
+        }
+
+        shapes[key]             = shape;
+        shape_keys[shape.shape] = key;
+        mesh_shape_counts[mesh]++;
+
+        return shape.shape;
+    }
+
+    bool MeshShapeCache::Release(btCollisionShape* shape)
+    {
+        if (!shape)
+            return true;
+
+        lock_guard<mutex> lock(mutex_cache);
+
+        auto it_key = shape_keys.find(shape);
+        if (it_key == shape_keys.end())
+            return false;
+
+        const ShapeKey key = it_key->second;
+        auto it            = shapes.find(key);
+        if (--it->second.references != 0)
+            return true;
+
+        // compounds don't own their children
+        if (key.type == MeshShapeType::ConvexDecomposition)
+        {
+            btCompoundShape* compound = static_cast<btCompoundShape*>(shape);
+            for (int i = compound->getNumChildShapes() - 1; i >= 0; i--)
+            {
+                btCollisionShape* child = compound->getChildShape(i);
+                compound->removeChildShapeByIndex(i);
+                delete child;
+            }
+        }
+
+        // the scaled wrapper goes first, it references the unscaled shape
+        delete shape;
+        shapes.erase(it);
+        shape_keys.erase(it_key);
+        if (key.detached == 0)
+        {
+            auto it_count = mesh_shape_counts.find(key.mesh);
+            if (--it_count->second == 0)
+            {
+                mesh_shape_counts.erase(it_count);
+            }
+        }
+
+        ShapeKey key_unscaled = key;
+        key_unscaled.scale    = Vector3::One;
+        if (key.type == MeshShapeType::Triangles)
+        {
+            release_triangle_mesh(key_unscaled);
+        }
+        else if (key.type == MeshShapeType::ConvexDecomposition)
+        {
+            release_decomposed_mesh(key_unscaled);
+        }
+
+        return true;
+    }
+
+    void MeshShapeCache::Invalidate(Mesh* mesh)
+    {
+        lock_guard<mutex> lock(mutex_cache);
+
+        auto it_count = mesh_shape_counts.find(mesh);
+        if (it_count == mesh_shape_counts.end())
+            return;
+        mesh_shape_counts.erase(it_count);
+
+        // the shapes stay with the bodies that hold them, but under a key that no acquire can produce, so the next one builds from the new geometry
+        const uint64_t detached = ++detached_count;
+        auto detach = [mesh, detached](auto& map, auto on_detach)
+        {
+            vector<typename remove_reference_t<decltype(map)>::node_type> nodes;
+            for (auto it = map.begin(); it != map.end();)
+            {
+                if (it->first.mesh == mesh && it->first.detached == 0)
+                {
+                    nodes.push_back(map.extract(it++));
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            for (auto& node : nodes)
+            {
+                on_detach(node.key(), node.mapped());
+                node.key().detached = detached;
+                map.insert(move(node));
+            }
+        };
+
+        // triangle shapes reference the mesh's arrays, so they get their own copy of the part they use
+        detach(triangle_meshes, [mesh](const ShapeKey& key, TriangleMesh& triangle_mesh)
+        {
+            triangle_mesh.indices.assign(mesh->GetIndices().begin() + key.index_offset, mesh->GetIndices().begin() + key.index_offset + key.index_count);
+            triangle_mesh.positions.resize(static_cast<size_t>(key.vertex_count) * 3);
+            for (uint32_t i = 0; i < key.vertex_count; i++)
+            {
+                memcpy(&triangle_mesh.positions[static_cast<size_t>(i) * 3], mesh->GetVertices()[key.vertex_offset + i].pos, 3 * sizeof(float));
+            }
+
+            btIndexedMesh& part      = triangle_mesh.mesh_interface->getIndexedMeshArray()[0];
+            part.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(triangle_mesh.indices.data());
+            part.m_vertexBase        = reinterpret_cast<const unsigned char*>(triangle_mesh.positions.data());
+            part.m_vertexStride      = 3 * sizeof(float);
+        });
+        detach(decomposed_meshes, [](const ShapeKey&, DecomposedMesh&) {});
+        detach(shapes, [](const ShapeKey&, Shape&) {});
+
+        for (auto& [shape, key] : shape_keys)
+        {
+            if (key.mesh == mesh && key.detached == 0)
+            {
+                key.detached = detached;
+            }
+        }
+    }
+
+    void MeshShapeCache::Save()
+    {
+        unordered_map<string, vector<GeometryPending>> bvhs;
+        unordered_map<string, vector<GeometryPending>> hulls;
+        {
+            lock_guard<mutex> lock(mutex_cache);
+            if (bvhs_pending.empty() && hulls_pending.empty())
+                return;
+
+            bvhs.swap(bvhs_pending);
+            hulls.swap(hulls_pending);
+        }
+
+        // off the calling thread, some of these are megabytes
+        ThreadPool::AddTask([bvhs = move(bvhs), hulls = move(hulls)]() mutable
+        {
+            lock_guard<mutex> lock(mutex_save);
+
+            for (auto& [path, entries] : bvhs)
+            {
+                write_sidecar(path, chunk_bvh_record, chunk_bvh_data, entries);
+            }
+
+            for (auto& [path, entries] : hulls)
+            {
+                write_sidecar(path, chunk_hull_record, chunk_hull_data, entries);
+            }
+        });
+    }
+
+    void MeshShapeCache::Shutdown()
+    {
+        lock_guard<mutex> lock(mutex_save);
+
+        // whatever is still referenced belongs to bodies which outlived the physics world
+        vector<btCollisionShape*> shapes_remaining;
+        for (const auto& [shape, key] : shape_keys)
+        {
+            shapes_remaining.push_back(shape);
+        }
+
+        for (btCollisionShape* shape : shapes_remaining)
+        {
+            while (shape_keys.count(shape) != 0)
+            {
+                Release(shape);
+            }
+        }
+
+        bvhs_pending.clear();
+        hulls_pending.clear();
+    }
+
+    uint64_t MeshShapeCache::GetMemoryUsage()
+    {
+        lock_guard<mutex> lock(mutex_cache);
+
+        uint64_t size = 0;
+        for (const auto& [key, triangle_mesh] : triangle_meshes)
+        {
+            size += triangle_mesh.bvh_size;
+        }
+
+        for (const auto& [key, shape] : shapes)
+        {
+            if (key.type == MeshShapeType::ConvexHull)
+            {
+                size += static_cast<btConvexHullShape*>(shape.shape)->getNumPoints() * sizeof(btVector3);
+            }
+            else if (key.type == MeshShapeType::ConvexDecomposition)
+            {
+                const btCompoundShape* compound = static_cast<btCompoundShape*>(shape.shape);
+                for (int i = 0; i < compound->getNumChildShapes(); i++)
+                {
+                    size += static_cast<const btConvexHullShape*>(compound->getChildShape(i))->getNumPoints() * sizeof(btVector3);
+                }
+            }
+        }
+
+        for (const auto& [key, decomposed_mesh] : decomposed_meshes)
+        {
+            for (const vector<Vector3>& hull : decomposed_mesh.hulls)
+            {
+                size += hull.size() * sizeof(Vector3);
+            }
+        }
+
+        return size;
+    }
+}
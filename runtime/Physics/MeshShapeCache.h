@@ -0,0 +1,74 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===========
+#include "Definitions.h"
+//======================
+
+//= FORWARD DECLARATIONS =
+class btCollisionShape;
+//========================
+
+namespace Spartan
+{
+    //= FORWARD DECLARATIONS =
+    class Mesh;
+    //========================
+
+    enum class MeshShapeType
+    {
+        Triangles,          // static geometry, a bvh over the mesh's own index and vertex arrays
+        ConvexHull,
+        ConvexDecomposition // dynamic concave geometry, a compound of convex hulls
+    };
+
+    // collision shapes shared by every body that uses the same mesh range, shape type and scale
+    // triangle shapes reference the mesh's cpu geometry without copying it, the mesh invalidates them before that geometry changes
+    class SP_CLASS MeshShapeCache
+    {
+    public:
+        static btCollisionShape* Acquire(
+            Mesh* mesh,
+            const uint32_t index_offset,
+            const uint32_t index_count,
+            const uint32_t vertex_offset,
+            const uint32_t vertex_count,
+            const Math::Vector3& scale,
+            const MeshShapeType type
+        );
+
+        // returns false if the shape didn't come from the cache, in which case the caller still owns it
+        static bool Release(btCollisionShape* shape);
+
+        // call before the geometry of a mesh changes or the mesh is destroyed, bodies that hold one of its
+        // shapes keep it (with a copy of the geometry it references), but it's no longer handed out
+        static void Invalidate(Mesh* mesh);
+
+        // triangle bvhs and convex decompositions are saved next to the mesh file, so they don't have to be rebuilt the next time it's loaded
+        static void Save();
+
+        static void Shutdown();
+        static uint64_t GetMemoryUsage();
+    };
+}
@@ -24,11 +24,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Physics.h"
 #include "PhysicsDebugDraw.h"
 #include "BulletPhysicsHelper.h"
+#include "MeshShapeCache.h"
+#include "Car.h"
 #include "ProgressTracker.h"
+#include "ThreadPool.h"
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
 #include "../Input/Input.h"
+#include "../World/Entity.h"
 #include "../World/Components/Camera.h"
+#include "../World/Components/PhysicsBody.h"
+#include "../IO/AssetContainer.h"
 SP_WARNINGS_OFF
 #include <btBulletDynamicsCommon.h>
 #include <BulletDynamics/ConstraintSolver/btPoint2PointConstraint.h>
@@ -36,7 +42,17 @@ SP_WARNINGS_OFF
 #include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
 #include <BulletCollision/NarrowPhaseCollision/btRaycastCallback.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
-#include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
+#include <BulletSoftBody/btDefaultSoftBodySolver.h>
+#include <BulletSoftBody/btSoftBody.h>
+#include <BulletSoftBody/btSoftBodyHelpers.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <LinearMath/btThreads.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
+#include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
+#include <BulletCollision/CollisionShapes/btTriangleShape.h>
 SP_WARNINGS_ON
 //==============================================================================
 
@@ -51,17 +67,46 @@ namespace Spartan
     { 
         btBroadphaseInterface* broadphase                        = nullptr;
         btCollisionDispatcher* collision_dispatcher              = nullptr;
-        btSequentialImpulseConstraintSolver* constraint_solver   = nullptr;
+        btConstraintSolver* constraint_solver                    = nullptr;
+        btConstraintSolverPoolMt* constraint_solver_pool         = nullptr;
         btDefaultCollisionConfiguration* collision_configuration = nullptr;
         btDiscreteDynamicsWorld* world                           = nullptr;
         btSoftBodyWorldInfo* world_info                          = nullptr;
         PhysicsDebugDraw* debug_draw                             = nullptr;
 
         // world properties
-        int max_solve_iterations       = 256;
-        const float internal_time_step = 1.0f / 200.0f; // 200 Hz - needed for car simulation
-        float accumulator              = 0.0f;
-        Math::Vector3 gravity          = Math::Vector3(0.0f, -9.81f, 0.0f);
+        const uint32_t min_solve_iterations = 8;
+        const uint32_t max_solve_iterations = 256;
+        uint32_t solve_iterations           = max_solve_iterations;
+        float time_step                     = 1.0f / 60.0f; // every body steps at this rate, ccd keeps fast ones from tunnelling
+        const uint32_t max_steps_per_tick   = 8;            // bounds the catch-up after a slow frame, the rest of the time is dropped
+        float accumulator                   = 0.0f;
+        float pose_alpha                    = 0.0f;
+        PhysicsPoseSmoothing pose_smoothing = PhysicsPoseSmoothing::Interpolate;
+        Math::Vector3 gravity               = Math::Vector3(0.0f, -9.81f, 0.0f);
+
+        // sleeping, an island sleeps once all of its bodies stayed below these velocities for deactivation_time
+        const float sleep_threshold_linear  = 0.4f;  // m/s
+        const float sleep_threshold_angular = 0.5f;  // rad/s
+        const float deactivation_time       = 1.0f;  // seconds
+
+        // simulation thread
+        thread simulation_thread;
+        mutex simulation_mutex;
+        condition_variable simulation_condition;
+        uint32_t simulation_steps_pending = 0;
+        bool simulation_exit              = false;
+        atomic<uint64_t> steps_simulated  = 0;
+        recursive_mutex world_mutex; // held while stepping and while bodies or constraints are added or removed (streaming does that from other threads),
+                                     // recursive since cars query the world from within a step
+
+        // cars are stepped together, ahead of the rigid bodies, so that their wheel raycasts can be batched
+        vector<Car*> cars;
+
+        // substeps, taken only when something in the world can't be simulated at the step rate
+        const float car_step_rate   = 200.0f; // Hz, the tire model needs it
+        const uint32_t max_substeps = 8;
+        uint32_t substeps           = 1;      // of the last step
 
         // picking
         btRigidBody* picked_body                = nullptr;
@@ -71,46 +116,948 @@ namespace Spartan
         Math::Vector3 picking_position_previous = Math::Vector3::Zero;
         float picking_distance_previous         = 0.0f;
 
-        const bool soft_body_support = true;
-    }
+        // soft bodies, btSoftRigidDynamicsWorld can't use the multithreaded rigid body pipeline, so they stay out of the world
+        // and are stepped around it, what they need is only created with the first one so that rigid only worlds don't pay for it
+        btSoftBodyRigidBodyCollisionConfiguration* soft_body_collision_configuration = nullptr;
+        btCollisionDispatcher* soft_body_dispatcher                                  = nullptr;
+        btDefaultSoftBodySolver* soft_body_solver                                    = nullptr;
+
+        // soft body level of detail, by distance to the camera, the nearest bodies keep full detail until the budget runs out
+        const float soft_body_lod_distances[] = { 15.0f, 40.0f }; // where lod 1 and 2 begin, in meters
+        const uint32_t soft_body_lod_count    = 3;                // each level drops the bending links, halves the iterations and steps half as often
+        const uint32_t soft_body_node_budget  = 16384;            // nodes simulated per step, bodies that don't fit drop a level or sleep
+
+        struct SoftBodyPair
+        {
+            btCollisionAlgorithm* algorithm = nullptr; // persists while the bodies overlap, it caches triangles
+            bool touched                    = false;
+        };
+
+        struct SoftBody
+        {
+            btSoftBody* body        = nullptr;
+            int position_iterations = 1;     // as the body was configured
+            uint32_t lod            = 0;
+            bool asleep             = false;
+            bool stepping           = false; // during the current step
+            uint32_t step_index     = 0;
+            float time_pending      = 0.0f;  // of the steps that a lower rate skipped
+            btAlignedObjectArray<btSoftBody::Link> links;                // all of them, the body itself keeps fewer when it's far
+            unordered_map<const btCollisionObject*, SoftBodyPair> pairs; // with the rigid bodies it touches
+        };
+        vector<SoftBody> soft_bodies;
+        vector<pair<float, uint32_t>> soft_body_order; // by distance, reused every frame
+
+        // bullet's parallel loops, backed by the engine's thread pool instead of bullet's own threads
+        class TaskScheduler : public btITaskScheduler
+        {
+        public:
+            TaskScheduler() : btITaskScheduler("Spartan") {}
+
+            // bullet sizes per-thread data with this and indexes it with whatever thread index it handed out,
+            // since any engine thread can end up touching bullet, cover them all
+            int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+            int getNumThreads() const override    { return BT_MAX_THREAD_COUNT; }
+            void setNumThreads(int) override      {}
+
+            void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+            {
+                ThreadPool::ParallelLoop([iBegin, &body](uint32_t start, uint32_t end)
+                {
+                    body.forLoop(iBegin + static_cast<int>(start), iBegin + static_cast<int>(end));
+                }, static_cast<uint32_t>(max(iEnd - iBegin, 0)), static_cast<uint32_t>(max(grainSize, 1)));
+            }
+
+            btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+            {
+                mutex mutex_sum;
+                btScalar sum = 0.0f;
+
+                ThreadPool::ParallelLoop([iBegin, &body, &mutex_sum, &sum](uint32_t start, uint32_t end)
+                {
+                    const btScalar sum_partial = body.sumLoop(iBegin + static_cast<int>(start), iBegin + static_cast<int>(end));
+
+                    lock_guard<mutex> lock(mutex_sum);
+                    sum += sum_partial;
+                }, static_cast<uint32_t>(max(iEnd - iBegin, 0)), static_cast<uint32_t>(max(grainSize, 1)));
+
+                return sum;
+            }
+        };
+        TaskScheduler* task_scheduler = nullptr;
+
+        // the solver stops early once it converges, this lowers the cap further when steps can't keep up with real time
+        void adapt_solve_iterations(const float step_duration_sec)
+        {
+            // leave the step half of its real time slot, the rest belongs to the game thread's synchronization and to spikes
+            const float budget_sec = time_step * 0.5f;
+
+            if (step_duration_sec > budget_sec)
+            {
+                solve_iterations = max(min_solve_iterations, solve_iterations * 3 / 4);
+            }
+            else if (step_duration_sec < budget_sec * 0.5f)
+            {
+                solve_iterations = min(max_solve_iterations, solve_iterations + 8);
+            }
+
+            world->getSolverInfo().m_numIterations = static_cast<int>(solve_iterations);
+        }
+
+        // record and replay
+        namespace playback
+        {
+            const uint32_t chunk_header = asset_chunk_id("PRCH");
+            const uint32_t chunk_frames = asset_chunk_id("PRCF");
+            const uint32_t version      = 3; // 3 hashes with fnv-1a, the same on every platform
+
+            enum InputFlags : uint32_t
+            {
+                input_accelerate  = 1U << 0,
+                input_reverse     = 1U << 1,
+                input_steer_left  = 1U << 2,
+                input_steer_right = 1U << 3,
+                input_brake       = 1U << 4
+            };
+
+            struct Header
+            {
+                uint32_t version     = playback::version;
+                float time_step      = 0.0f;
+                uint32_t frame_count = 0;
+                uint32_t padding     = 0;
+                uint64_t state_hash  = 0; // of the world when the recording started
+            };
+
+            struct Frame
+            {
+                float delta_time_sec      = 0.0f;
+                uint32_t input_flags      = 0;
+                uint32_t steps            = 0;
+                uint32_t solve_iterations = 0;
+                uint32_t bodies_added     = 0;
+                uint32_t bodies_removed   = 0;
+                uint64_t state_hash       = 0; // of the world before the frame's steps
+            };
+
+            PhysicsPlayback mode = PhysicsPlayback::Off;
+            PhysicsInput input;
+            string file_path;
+            Header header;
+            vector<Frame> frames;
+            uint32_t frame_index            = 0;
+            uint32_t frame_diverged         = numeric_limits<uint32_t>::max();
+            atomic<uint32_t> bodies_added   = 0;
+            atomic<uint32_t> bodies_removed = 0;
+            float step_duration_max         = 0.0f;  // slowest step of the frame, the solver iterations adapt to it once per frame
+            double step_duration_total      = 0.0;
+            uint64_t step_count_total       = 0;
+
+            // engine arguments start a playback on the first frame that simulates
+            PhysicsPlayback pending_mode = PhysicsPlayback::Off;
+            string pending_file_path;
+
+            uint64_t hash_combine(const uint64_t seed, const uint64_t value)
+            {
+                return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+            }
+
+            // fnv-1a, std::hash is implementation defined and a recording has to verify anywhere
+            uint64_t hash_bytes(const void* data, const size_t size)
+            {
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                uint64_t hash        = 0xcbf29ce484222325ull;
+                for (size_t i = 0; i < size; i++)
+                {
+                    hash ^= bytes[i];
+                    hash *= 0x100000001b3ull;
+                }
+
+                return hash;
+            }
+
+            // the bits of everything that moves, in bullet's own order, any divergence shows up here
+            uint64_t compute_state_hash()
+            {
+                uint64_t hash = 0;
+
+                const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+                for (int i = 0; i < objects.size(); i++)
+                {
+                    const btRigidBody* body = btRigidBody::upcast(objects[i]);
+                    if (!body || body->isStaticObject())
+                        continue;
+
+                    // only the components that are simulated, the padding of bullet's vectors isn't guaranteed to be anything
+                    const btTransform& transform = body->getWorldTransform();
+                    const btMatrix3x3& basis     = transform.getBasis();
+                    const btVector3 vectors[6]   = { basis[0], basis[1], basis[2], transform.getOrigin(), body->getLinearVelocity(), body->getAngularVelocity() };
+                    float values[6 * 3]          = {};
+                    for (uint32_t v = 0; v < 6; v++)
+                    {
+                        values[v * 3 + 0] = static_cast<float>(vectors[v].x());
+                        values[v * 3 + 1] = static_cast<float>(vectors[v].y());
+                        values[v * 3 + 2] = static_cast<float>(vectors[v].z());
+                    }
+
+                    hash = hash_combine(hash, hash_bytes(values, sizeof(values)));
+                    hash = hash_combine(hash, static_cast<uint64_t>(body->getActivationState()));
+                }
+
+                return hash;
+            }
+
+            uint32_t pack_input(const PhysicsInput& sample)
+            {
+                return (sample.accelerate  ? input_accelerate  : 0U) |
+                       (sample.reverse     ? input_reverse     : 0U) |
+                       (sample.steer_left  ? input_steer_left  : 0U) |
+                       (sample.steer_right ? input_steer_right : 0U) |
+                       (sample.brake       ? input_brake       : 0U);
+            }
+
+            void unpack_input(const Frame& frame, PhysicsInput* sample)
+            {
+                sample->delta_time_sec = frame.delta_time_sec;
+                sample->accelerate     = (frame.input_flags & input_accelerate)  != 0;
+                sample->reverse        = (frame.input_flags & input_reverse)     != 0;
+                sample->steer_left     = (frame.input_flags & input_steer_left)  != 0;
+                sample->steer_right    = (frame.input_flags & input_steer_right) != 0;
+                sample->brake          = (frame.input_flags & input_brake)       != 0;
+            }
+
+            void sample_input()
+            {
+                input.delta_time_sec = static_cast<float>(Timer::GetDeltaTimeSec());
+                input.accelerate     = Input::GetKey(KeyCode::Arrow_Up)    || Input::GetGamepadTriggerRight() != 0.0f;
+                input.reverse        = Input::GetKey(KeyCode::Arrow_Down)  || Input::GetGamepadTriggerLeft() != 0.0f;
+                input.steer_left     = Input::GetKey(KeyCode::Arrow_Left)  || Input::GetGamepadThumbStickLeft().x < 0.0f;
+                input.steer_right    = Input::GetKey(KeyCode::Arrow_Right) || Input::GetGamepadThumbStickLeft().x > 0.0f;
+                input.brake          = Input::GetKey(KeyCode::Space);
+            }
+
+            // the multithreaded dispatcher collects contact manifolds in whatever order the workers finish,
+            // which changes the order constraints are solved in, so playback steps everything on the physics thread
+            void set_deterministic(const bool deterministic)
+            {
+                if (task_scheduler)
+                {
+                    btSetTaskScheduler(deterministic ? btGetSequentialTaskScheduler() : static_cast<btITaskScheduler*>(task_scheduler));
+                }
+
+                world->getDispatchInfo().m_deterministicOverlappingPairs = deterministic;
+            }
+
+            // removed bodies leave their traces in the broadphase tree and in the order contacts are found, so every
+            // body is taken out and added back in the same order, two runs of the same world then start out identical
+            void rebuild_broadphase()
+            {
+                lock_guard<recursive_mutex> lock(world_mutex);
+
+                struct Proxy
+                {
+                    btCollisionObject* object = nullptr;
+                    int group                 = 0;
+                    int mask                  = 0;
+                };
+
+                vector<Proxy> proxies;
+                btCollisionObjectArray& objects = world->getCollisionObjectArray();
+                for (int i = 0; i < objects.size(); i++)
+                {
+                    const btBroadphaseProxy* handle = objects[i]->getBroadphaseHandle();
+                    proxies.push_back({ objects[i], handle->m_collisionFilterGroup, handle->m_collisionFilterMask });
+                }
+
+                for (const Proxy& proxy : proxies)
+                {
+                    if (btRigidBody* body = btRigidBody::upcast(proxy.object))
+                    {
+                        world->removeRigidBody(body);
+                    }
+                    else
+                    {
+                        world->removeCollisionObject(proxy.object);
+                    }
+                }
+
+                world->getBroadphase()->resetPool(world->getDispatcher());
+
+                for (const Proxy& proxy : proxies)
+                {
+                    if (btRigidBody* body = btRigidBody::upcast(proxy.object))
+                    {
+                        world->addRigidBody(body, proxy.group, proxy.mask);
+                    }
+                    else
+                    {
+                        world->addCollisionObject(proxy.object, proxy.group, proxy.mask);
+                    }
+                }
+            }
+
+            void reset()
+            {
+                frames.clear();
+                frame_index         = 0;
+                frame_diverged      = numeric_limits<uint32_t>::max();
+                bodies_added        = 0;
+                bodies_removed      = 0;
+                step_duration_max   = 0.0f;
+                step_duration_total = 0.0;
+                step_count_total    = 0;
+                accumulator         = 0.0f;
+            }
+
+            void diverged(const char* what)
+            {
+                if (frame_diverged != numeric_limits<uint32_t>::max())
+                    return;
+
+                frame_diverged = frame_index;
+                SP_LOG_WARNING("Replay of \"%s\" diverged at frame %u, %s differ", file_path.c_str(), frame_index, what);
+            }
+
+            // called once per simulated frame, before the steps are kicked off, headless
+            // steps have no frame time to fit in, so they don't adapt the iteration cap
+            void end_frame(const uint32_t step_count, const bool adapt)
+            {
+                Frame frame;
+                frame.delta_time_sec = input.delta_time_sec;
+                frame.input_flags    = pack_input(input);
+                frame.steps          = step_count;
+                frame.bodies_added   = bodies_added.exchange(0);
+                frame.bodies_removed = bodies_removed.exchange(0);
+                {
+                    lock_guard<recursive_mutex> lock(world_mutex);
+                    frame.state_hash = compute_state_hash();
+                }
+
+                if (mode == PhysicsPlayback::Recording)
+                {
+                    if (adapt)
+                    {
+                        adapt_solve_iterations(step_duration_max);
+                    }
+                    frame.solve_iterations = solve_iterations;
+                    frames.emplace_back(frame);
+                }
+                else
+                {
+                    // stepping on past the end of a replay
+                    if (frame_index >= static_cast<uint32_t>(frames.size()))
+                    {
+                        diverged("the frame counts");
+                        return;
+                    }
+
+                    const Frame& recorded = frames[frame_index];
+
+                    if (frame.steps != recorded.steps)
+                    {
+                        diverged("the step counts");
+                    }
+                    else if (frame.bodies_added != recorded.bodies_added || frame.bodies_removed != recorded.bodies_removed)
+                    {
+                        diverged("the spawned or removed bodies");
+                    }
+                    else if (frame.state_hash != recorded.state_hash)
+                    {
+                        diverged("the body states");
+                    }
+
+                    // the iteration cap is part of the recording, it was measured on a different run
+                    solve_iterations = recorded.solve_iterations;
+                    world->getSolverInfo().m_numIterations = static_cast<int>(solve_iterations);
+
+                    frame_index++;
+                }
+
+                step_duration_max = 0.0f;
+            }
+        }
+
+        // scene queries
+        const uint32_t queries_per_task_min = 64;
+        thread_local btAlignedObjectArray<const btDbvtNode*> query_stack; // per thread, so queries can run in parallel without allocating
+
+        bool query_needs_collision(const btBroadphaseProxy* proxy, const btRigidBody* ignore)
+        {
+            const btCollisionObject* object = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+            return object != ignore && btRigidBody::upcast(object) != nullptr;
+        }
+
+        struct RayCallback : public btCollisionWorld::ClosestRayResultCallback
+        {
+            RayCallback(const btVector3& from, const btVector3& to, const btRigidBody* ignore) : ClosestRayResultCallback(from, to), m_ignore(ignore) {}
+
+            bool needsCollision(btBroadphaseProxy* proxy) const override
+            {
+                return query_needs_collision(proxy, m_ignore) && ClosestRayResultCallback::needsCollision(proxy);
+            }
+
+            const btRigidBody* m_ignore;
+        };
+
+        struct SweepCallback : public btCollisionWorld::ClosestConvexResultCallback
+        {
+            SweepCallback(const btVector3& from, const btVector3& to, const btRigidBody* ignore) : ClosestConvexResultCallback(from, to), m_ignore(ignore) {}
+
+            bool needsCollision(btBroadphaseProxy* proxy) const override
+            {
+                return query_needs_collision(proxy, m_ignore) && ClosestConvexResultCallback::needsCollision(proxy);
+            }
+
+            const btRigidBody* m_ignore;
+        };
+
+        // hands every broadphase leaf that the traversal reaches to a function
+        template<typename Function>
+        struct LeafVisitor : public btDbvt::ICollide
+        {
+            LeafVisitor(Function& function) : m_function(function) {}
+
+            void Process(const btDbvtNode* leaf) override
+            {
+                m_function(static_cast<btCollisionObject*>(static_cast<btBroadphaseProxy*>(leaf->data)->m_clientObject));
+            }
+
+            Function& m_function;
+        };
+
+        // the broadphase's own ray test allocates a stack per call in thread safe builds, this walks its trees directly
+        template<typename Function>
+        void query_broadphase_ray(const btVector3& from, const btVector3& to, const btVector3& aabb_min, const btVector3& aabb_max, Function&& function)
+        {
+            const btVector3 direction_unnormalized = to - from;
+            const btVector3 direction              = direction_unnormalized.fuzzyZero() ? btVector3(0.0f, 0.0f, 0.0f) : direction_unnormalized.normalized();
+            const btScalar lambda_max              = direction.dot(direction_unnormalized);
+
+            btVector3 direction_inverse;
+            unsigned int signs[3];
+            for (int i = 0; i < 3; i++)
+            {
+                direction_inverse[i] = direction[i] == 0.0f ? BT_LARGE_FLOAT : 1.0f / direction[i];
+                signs[i]             = direction_inverse[i] < 0.0f;
+            }
+
+            LeafVisitor<Function> visitor(function);
+            for (btDbvt& tree : static_cast<btDbvtBroadphase*>(broadphase)->m_sets)
+            {
+                tree.rayTestInternal(tree.m_root, from, to, direction_inverse, signs, lambda_max, aabb_min, aabb_max, query_stack, visitor);
+            }
+        }
+
+        template<typename Function>
+        void query_broadphase_aabb(const btVector3& aabb_min, const btVector3& aabb_max, Function&& function)
+        {
+            const btDbvtVolume volume = btDbvtVolume::FromMM(aabb_min, aabb_max);
+
+            LeafVisitor<Function> visitor(function);
+            for (btDbvt& tree : static_cast<btDbvtBroadphase*>(broadphase)->m_sets)
+            {
+                if (tree.m_root)
+                {
+                    tree.collideTVNoStackAlloc(tree.m_root, volume, query_stack, visitor);
+                }
+            }
+        }
+
+        // the query shapes live on the stack, only the one that was asked for is used
+        struct QueryShape
+        {
+            QueryShape(const PhysicsQueryShape type, const Vector3& size)
+                : sphere(max(size.x, Helper::SMALL_FLOAT)), box(ToBtVector3(Vector3(max(size.x, Helper::SMALL_FLOAT), max(size.y, Helper::SMALL_FLOAT), max(size.z, Helper::SMALL_FLOAT))))
+            {
+                shape = type == PhysicsQueryShape::Sphere ? static_cast<btConvexShape*>(&sphere) : static_cast<btConvexShape*>(&box);
+            }
+
+            btSphereShape sphere;
+            btBoxShape box;
+            btConvexShape* shape = nullptr;
+        };
+
+        PhysicsHit query_ray(const PhysicsRay& ray)
+        {
+            const btVector3 from = ToBtVector3(ray.start);
+            const btVector3 to   = ToBtVector3(ray.end);
+            const btTransform transform_from(btQuaternion::getIdentity(), from);
+            const btTransform transform_to(btQuaternion::getIdentity(), to);
+
+            RayCallback callback(from, to, ray.ignore);
+            query_broadphase_ray(from, to, btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f), [&](btCollisionObject* object)
+            {
+                if (callback.m_closestHitFraction == 0.0f || !callback.needsCollision(object->getBroadphaseHandle()))
+                    return;
+
+                btCollisionWorld::rayTestSingle(transform_from, transform_to, object, object->getCollisionShape(), object->getWorldTransform(), callback);
+            });
+
+            PhysicsHit hit;
+            if (callback.hasHit())
+            {
+                hit.body     = const_cast<btRigidBody*>(btRigidBody::upcast(callback.m_collisionObject));
+                hit.position = ToVector3(callback.m_hitPointWorld);
+                hit.normal   = ToVector3(callback.m_hitNormalWorld);
+                hit.fraction = callback.m_closestHitFraction;
+            }
+
+            return hit;
+        }
+
+        PhysicsHit query_sweep(const PhysicsSweep& sweep)
+        {
+            const QueryShape query_shape(sweep.shape, sweep.size);
+            const btVector3 from = ToBtVector3(sweep.start);
+            const btVector3 to   = ToBtVector3(sweep.end);
+            const btTransform transform_from(btQuaternion::getIdentity(), from);
+            const btTransform transform_to(btQuaternion::getIdentity(), to);
+
+            // the traversal treats the sweep as a ray with the shape's bounds around it
+            btVector3 aabb_min, aabb_max;
+            query_shape.shape->getAabb(btTransform::getIdentity(), aabb_min, aabb_max);
+
+            SweepCallback callback(from, to, sweep.ignore);
+            query_broadphase_ray(from, to, aabb_min, aabb_max, [&](btCollisionObject* object)
+            {
+                if (callback.m_closestHitFraction == 0.0f || !callback.needsCollision(object->getBroadphaseHandle()))
+                    return;
+
+                btCollisionWorld::objectQuerySingle(query_shape.shape, transform_from, transform_to, object, object->getCollisionShape(), object->getWorldTransform(), callback, 0.0f);
+            });
+
+            PhysicsHit hit;
+            if (callback.hasHit())
+            {
+                hit.body     = const_cast<btRigidBody*>(btRigidBody::upcast(callback.m_hitCollisionObject));
+                hit.position = ToVector3(callback.m_hitPointWorld);
+                hit.normal   = ToVector3(callback.m_hitNormalWorld);
+                hit.fraction = callback.m_closestHitFraction;
+            }
+
+            return hit;
+        }
+
+        bool overlaps_convex(const btConvexShape* a, const btTransform& transform_a, const btConvexShape* b, const btTransform& transform_b)
+        {
+            btVoronoiSimplexSolver simplex_solver;
+            btGjkEpaPenetrationDepthSolver penetration_solver;
+            btGjkPairDetector detector(a, b, &simplex_solver, &penetration_solver);
+
+            btGjkPairDetector::ClosestPointInput input;
+            input.m_transformA = transform_a;
+            input.m_transformB = transform_b;
+
+            btPointCollector output;
+            detector.getClosestPoints(input, output, nullptr);
+
+            return output.m_hasResult && output.m_distance <= 0.0f;
+        }
+
+        struct TriangleOverlapCallback : public btTriangleCallback
+        {
+            void processTriangle(btVector3* triangle, int, int) override
+            {
+                if (overlap)
+                    return;
+
+                btTriangleShape triangle_shape(triangle[0], triangle[1], triangle[2]);
+                triangle_shape.setMargin(margin);
+                overlap = overlaps_convex(shape, transform, &triangle_shape, btTransform::getIdentity());
+            }
+
+            const btConvexShape* shape = nullptr;
+            btTransform transform;             // of the query shape, in the space of the triangles
+            btScalar margin            = 0.0f; // of the mesh, the triangles inherit it
+            bool overlap               = false;
+        };
+
+        bool overlaps(const btConvexShape* query, const btTransform& query_transform, const btCollisionShape* shape, const btTransform& transform)
+        {
+            if (shape->isConvex())
+                return overlaps_convex(query, query_transform, static_cast<const btConvexShape*>(shape), transform);
+
+            if (shape->isCompound())
+            {
+                const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+                for (int i = 0; i < compound->getNumChildShapes(); i++)
+                {
+                    if (overlaps(query, query_transform, compound->getChildShape(i), transform * compound->getChildTransform(i)))
+                        return true;
+                }
+
+                return false;
+            }
+
+            if (shape->isConcave())
+            {
+                TriangleOverlapCallback callback;
+                callback.shape     = query;
+                callback.transform = transform.inverse() * query_transform;
+                callback.margin    = shape->getMargin();
+
+                btVector3 aabb_min, aabb_max;
+                query->getAabb(callback.transform, aabb_min, aabb_max);
+                static_cast<const btConcaveShape*>(shape)->processAllTriangles(&callback, aabb_min, aabb_max);
+
+                return callback.overlap;
+            }
+
+            return false;
+        }
+
+        uint32_t query_overlap(const PhysicsOverlap& overlap, btRigidBody** bodies, const uint32_t capacity)
+        {
+            const QueryShape query_shape(overlap.shape, overlap.size);
+            const btTransform transform(btQuaternion::getIdentity(), ToBtVector3(overlap.position));
+
+            btVector3 aabb_min, aabb_max;
+            query_shape.shape->getAabb(transform, aabb_min, aabb_max);
+
+            uint32_t count = 0;
+            query_broadphase_aabb(aabb_min, aabb_max, [&](btCollisionObject* object)
+            {
+                if (count == capacity || !query_needs_collision(object->getBroadphaseHandle(), overlap.ignore))
+                    return;
+
+                if (overlaps(query_shape.shape, transform, object->getCollisionShape(), object->getWorldTransform()))
+                {
+                    bodies[count++] = btRigidBody::upcast(object);
+                }
+            });
+
+            return count;
+        }
+
+        // bullet steps the whole world at once, so a step is split when anything in it needs a finer one: a car, or a body
+        // that ccd can't protect, the sweep only covers translation and only convex shapes, so spinning or compound bodies
+        // are held to moving less than their swept sphere per substep
+        uint32_t compute_substeps()
+        {
+            float rate = cars.empty() ? 0.0f : car_step_rate;
+
+            const btAlignedObjectArray<btRigidBody*>& bodies = world->getNonStaticRigidBodies();
+            for (int i = 0; i < bodies.size(); i++)
+            {
+                const btRigidBody* body = bodies[i];
+                const float tolerance   = body->getCcdSweptSphereRadius();
+                if (!body->isActive() || body->isKinematicObject() || tolerance == 0.0f)
+                    continue;
+
+                // a spinning sphere sweeps nothing new, anything else swings its far points around
+                const btCollisionShape* shape = body->getCollisionShape();
+                float speed                   = 0.0f;
+                if (shape->getShapeType() != SPHERE_SHAPE_PROXYTYPE)
+                {
+                    btVector3 center;
+                    btScalar radius;
+                    shape->getBoundingSphere(center, radius);
+                    speed = body->getAngularVelocity().length() * radius;
+                }
+
+                if (!shape->isConvex())
+                {
+                    speed += body->getLinearVelocity().length();
+                }
+
+                rate = max(rate, speed / tolerance);
+            }
+
+            return clamp(static_cast<uint32_t>(ceil(rate * time_step)), 1U, max_substeps);
+        }
+
+        void soft_body_release_pair(SoftBodyPair& pair)
+        {
+            pair.algorithm->~btCollisionAlgorithm();
+            soft_body_dispatcher->freeCollisionAlgorithm(pair.algorithm);
+            pair.algorithm = nullptr;
+        }
+
+        // soft bodies are outside of the broadphase, so they find the rigid bodies they touch themselves, then the contacts
+        // are made by the same algorithms that btSoftRigidDynamicsWorld would use, one body at a time since they write to it
+        void soft_body_collide(SoftBody& soft_body)
+        {
+            btSoftBody* body = soft_body.body;
+            const btCollisionObjectWrapper body_wrapper(nullptr, body->getCollisionShape(), body, body->getWorldTransform(), -1, -1);
+
+            for (auto& [object, pair] : soft_body.pairs)
+            {
+                pair.touched = false;
+            }
+
+            query_broadphase_aabb(body->m_bounds[0], body->m_bounds[1], [&](btCollisionObject* object)
+            {
+                if (!btRigidBody::upcast(object))
+                    return;
+
+                const btCollisionObjectWrapper object_wrapper(nullptr, object->getCollisionShape(), object, object->getWorldTransform(), -1, -1);
+
+                SoftBodyPair& pair = soft_body.pairs[object];
+                if (!pair.algorithm)
+                {
+                    pair.algorithm = soft_body_dispatcher->findAlgorithm(&body_wrapper, &object_wrapper, nullptr, BT_CONTACT_POINT_ALGORITHMS);
+                }
+
+                pair.algorithm->processCollision(&body_wrapper, &object_wrapper, world->getDispatchInfo(), nullptr);
+                pair.touched = true;
+            });
+
+            for (auto it = soft_body.pairs.begin(); it != soft_body.pairs.end();)
+            {
+                if (!it->second.touched)
+                {
+                    if (it->second.algorithm)
+                    {
+                        soft_body_release_pair(it->second);
+                    }
+                    it = soft_body.pairs.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // before the rigid bodies move, the soft bodies move freely and find their contacts
+        void soft_bodies_step_begin(const float delta_time)
+        {
+            for (SoftBody& soft_body : soft_bodies)
+            {
+                // a body that wakes up continues from where it was, the time it slept through is dropped
+                if (soft_body.asleep || !soft_body.body->isActive())
+                {
+                    soft_body.stepping     = false;
+                    soft_body.time_pending = 0.0f;
+                    continue;
+                }
+
+                soft_body.time_pending += delta_time;
+                soft_body.stepping      = (soft_body.step_index++ % (1U << soft_body.lod)) == 0;
+                if (!soft_body.stepping)
+                    continue;
+
+                soft_body.body->predictMotion(soft_body.time_pending);
+                soft_body.time_pending = 0.0f;
+                soft_body_collide(soft_body);
+            }
+        }
+
+        // after, the contacts are resolved and their impulses reach the rigid bodies on the next step
+        void soft_bodies_step_end()
+        {
+            for (SoftBody& soft_body : soft_bodies)
+            {
+                if (!soft_body.stepping)
+                    continue;
+
+                soft_body.body->solveConstraints();
+                soft_body.body->defaultCollisionHandler(soft_body.body); // self collision, when the body asks for it
+                soft_body.body->integrateMotion();
+            }
+        }
+
+        void soft_body_set_lod(SoftBody& soft_body, const uint32_t lod)
+        {
+            if (lod == soft_body.lod)
+                return;
+
+            // bending links only hold the shape of folds and creases, from a distance the structural ones are enough
+            btSoftBody* body = soft_body.body;
+            body->m_links.resize(0);
+            for (int i = 0; i < soft_body.links.size(); i++)
+            {
+                if (lod == 0 || !soft_body.links[i].m_bbending)
+                {
+                    body->m_links.push_back(soft_body.links[i]);
+                }
+            }
+            body->updateLinkConstants();
+
+            body->m_cfg.piterations = max(soft_body.position_iterations >> lod, 1);
+            soft_body.lod           = lod;
+        }
+
+        // once per frame, on the game thread, while the simulation is idle
+        void soft_bodies_update_lods()
+        {
+            shared_ptr<Camera> camera = Renderer::GetCamera();
+            const Vector3 view        = camera ? camera->GetEntity()->GetPosition() : Vector3::Zero;
+
+            soft_body_order.clear();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(soft_bodies.size()); i++)
+            {
+                const btSoftBody* body = soft_bodies[i].body;
+                btVector3 closest      = ToBtVector3(view);
+                closest.setMax(body->m_bounds[0]);
+                closest.setMin(body->m_bounds[1]);
+                soft_body_order.emplace_back(closest.distance(ToBtVector3(view)), i);
+            }
+            sort(soft_body_order.begin(), soft_body_order.end());
+
+            uint32_t node_count = 0;
+            for (const auto& [distance, index] : soft_body_order)
+            {
+                SoftBody& soft_body    = soft_bodies[index];
+                const btSoftBody* body = soft_body.body;
+
+                // the camera isn't part of a recording, so playback steps everything at full detail
+                if (playback::mode != PhysicsPlayback::Off || !camera)
+                {
+                    soft_body.asleep = false;
+                    soft_body_set_lod(soft_body, 0);
+                    continue;
+                }
+
+                uint32_t lod = 0;
+                while (lod < soft_body_lod_count - 1 && distance >= soft_body_lod_distances[lod])
+                {
+                    lod++;
+                }
+
+                // off-screen bodies sleep, the rest share the budget, nearest first
+                const uint32_t nodes = static_cast<uint32_t>(body->m_nodes.size());
+                bool asleep          = !camera->IsInViewFrustum(BoundingBox(ToVector3(body->m_bounds[0]), ToVector3(body->m_bounds[1])));
+                while (!asleep && node_count + (nodes >> lod) > soft_body_node_budget)
+                {
+                    asleep = ++lod == soft_body_lod_count;
+                }
+
+                soft_body.asleep = asleep;
+                if (!asleep)
+                {
+                    soft_body_set_lod(soft_body, lod);
+                    node_count += nodes >> lod;
+                }
+            }
+        }
+
+        // what soft bodies need, created with the first of them
+        void soft_bodies_initialize()
+        {
+            if (world_info)
+                return;
+
+            soft_body_collision_configuration = new btSoftBodyRigidBodyCollisionConfiguration();
+            soft_body_dispatcher              = new btCollisionDispatcher(soft_body_collision_configuration);
+            soft_body_solver                  = new btDefaultSoftBodySolver();
+
+            world_info = new btSoftBodyWorldInfo();
+            world_info->m_sparsesdf.Initialize();
+            world_info->m_dispatcher = soft_body_dispatcher;
+            world_info->m_broadphase = broadphase;
+            world_info->air_density  = 1.2f;
+            world_info->m_gravity    = ToBtVector3(gravity);
+        }
+
+        void step(const uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                lock_guard<recursive_mutex> lock(world_mutex);
+
+                // bump first so that the motion states can tag the poses they receive with this step
+                steps_simulated++;
 
-    void Physics::Initialize()
-    {
-        broadphase        = new btDbvtBroadphase();
-        constraint_solver = new btSequentialImpulseConstraintSolver();
+                const auto time_start = chrono::high_resolution_clock::now();
+                substeps              = compute_substeps();
+                const float substep   = time_step / static_cast<float>(substeps);
+                for (uint32_t j = 0; j < substeps; j++)
+                {
+                    if (!cars.empty())
+                    {
+                        Car::Step(cars, substep);
+                    }
 
-        if (soft_body_support)
-        {
-            // create
-            collision_configuration = new btSoftBodyRigidBodyCollisionConfiguration();
-            collision_dispatcher    = new btCollisionDispatcher(collision_configuration);
-            world                   = new btSoftRigidDynamicsWorld(collision_dispatcher, broadphase, constraint_solver, collision_configuration);
+                    soft_bodies_step_begin(substep);
+                    world->stepSimulation(substep, 1, substep);
+                    soft_bodies_step_end();
+                }
 
-            // setup         
-            world_info = new btSoftBodyWorldInfo();
-            world_info->m_sparsesdf.Initialize();
-            world->getDispatchInfo().m_enableSPU = true;
-            world_info->m_dispatcher             = collision_dispatcher;
-            world_info->m_broadphase             = broadphase;
-            world_info->air_density              = (btScalar)1.2;
-            world_info->water_density            = 0;
-            world_info->water_offset             = 0;
-            world_info->water_normal             = btVector3(0, 0, 0);
-            world_info->m_gravity                = ToBtVector3(gravity);
+                // distance fields of the shapes that soft bodies stopped touching
+                if (world_info)
+                {
+                    world_info->m_sparsesdf.GarbageCollect();
+                }
+                const float duration = chrono::duration<float>(chrono::high_resolution_clock::now() - time_start).count();
+
+                // playback pins the iteration cap per frame, so that it can be recorded
+                if (playback::mode == PhysicsPlayback::Off)
+                {
+                    adapt_solve_iterations(duration);
+                }
+                else
+                {
+                    playback::step_duration_max    = max(playback::step_duration_max, duration);
+                    playback::step_duration_total += duration;
+                    playback::step_count_total++;
+                }
+            }
         }
-        else
+
+        void simulation_loop()
         {
-            // create
-            collision_configuration = new btDefaultCollisionConfiguration();
-            collision_dispatcher    = new btCollisionDispatcher(collision_configuration);
-            world                   = new btDiscreteDynamicsWorld(collision_dispatcher, broadphase, constraint_solver, collision_configuration);
+            while (true)
+            {
+                uint32_t count = 0;
+                {
+                    unique_lock<mutex> lock(simulation_mutex);
+                    simulation_condition.wait(lock, [] { return simulation_steps_pending != 0 || simulation_exit; });
+
+                    if (simulation_exit)
+                        return;
+
+                    count = simulation_steps_pending;
+                }
+
+                step(count);
+
+                {
+                    lock_guard<mutex> lock(simulation_mutex);
+                    simulation_steps_pending = 0;
+                }
+                simulation_condition.notify_all();
+            }
         }
+    }
+
+    void Physics::Initialize()
+    {
+        broadphase = new btDbvtBroadphase();
+
+        #if BT_THREADSAFE
+        // narrow phase, islands and integration run as parallel loops on the thread pool
+        task_scheduler = new TaskScheduler();
+        btSetTaskScheduler(task_scheduler);
+
+        // create, small islands are batched and solved in parallel by the pool, large ones by the multithreaded solver
+        constraint_solver       = new btSequentialImpulseConstraintSolverMt();
+        constraint_solver_pool  = new btConstraintSolverPoolMt(static_cast<int>(ThreadPool::GetThreadCount()) + 1);
+        collision_configuration = new btDefaultCollisionConfiguration();
+        collision_dispatcher    = new btCollisionDispatcherMt(collision_configuration);
+        world                   = new btDiscreteDynamicsWorldMt(collision_dispatcher, broadphase, constraint_solver_pool, constraint_solver, collision_configuration);
+        #else
+        // bullet's parallel loops only run in parallel when it's built with BT_THREADSAFE (and assert otherwise), so it steps serially
+        constraint_solver       = new btSequentialImpulseConstraintSolver();
+        collision_configuration = new btDefaultCollisionConfiguration();
+        collision_dispatcher    = new btCollisionDispatcher(collision_configuration);
+        world                   = new btDiscreteDynamicsWorld(collision_dispatcher, broadphase, constraint_solver, collision_configuration);
+        #endif
 
         // setup
         world->setGravity(ToBtVector3(gravity));
         world->getDispatchInfo().m_useContinuous = true;
         world->getSolverInfo().m_splitImpulse    = false;
-        world->getSolverInfo().m_numIterations   = max_solve_iterations;
+        world->getSolverInfo().m_numIterations   = static_cast<int>(max_solve_iterations);
+
+        // the motion states blend the last two steps themselves, bullet's own blending would report the pose a step late
+        world->setLatencyMotionStateInterpolation(false);
+
+        // iterations stop once the residual is this small, so resting stacks don't pay for the full count
+        world->getSolverInfo().m_leastSquaresResidualThreshold = 1e-5f;
+
+        // sleeping, bullet puts whole islands to sleep, so a quicker timeout pays off in large stacks
+        gDeactivationTime = deactivation_time;
 
         // get version
         const string major = to_string(btGetVersion() / 100);
@@ -126,15 +1073,58 @@ namespace Spartan
                 world->setDebugDrawer(debug_draw);
             }
         }
+
+        simulation_exit   = false;
+        simulation_thread = thread(simulation_loop);
+
+        // -physics_record <file> or -physics_replay <file>
+        if (Engine::HasArgument("-physics_record"))
+        {
+            playback::pending_mode      = PhysicsPlayback::Recording;
+            playback::pending_file_path = Engine::GetArgumentValue("-physics_record");
+        }
+        else if (Engine::HasArgument("-physics_replay"))
+        {
+            playback::pending_mode      = PhysicsPlayback::Replaying;
+            playback::pending_file_path = Engine::GetArgumentValue("-physics_replay");
+        }
+
+        // a recording belongs to the world it was made in
+        SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear, SP_EVENT_HANDLER_STATIC(StopPlayback));
     }
 
     void Physics::Shutdown()
     {
+        StopPlayback();
+
+        {
+            lock_guard<mutex> lock(simulation_mutex);
+            simulation_exit = true;
+        }
+        simulation_condition.notify_all();
+        if (simulation_thread.joinable())
+        {
+            simulation_thread.join();
+        }
+
+        // soft bodies that are still around belong to their owners, only what was made for them goes
+        for (SoftBody& soft_body : soft_bodies)
+        {
+            for (auto& [object, pair] : soft_body.pairs)
+            {
+                soft_body_release_pair(pair);
+            }
+        }
+        soft_bodies.clear();
+
         delete world;
         world = nullptr;
     
         delete constraint_solver;
         constraint_solver = nullptr;
+
+        delete constraint_solver_pool;
+        constraint_solver_pool = nullptr;
     
         delete collision_dispatcher;
         collision_dispatcher = nullptr;
@@ -147,22 +1137,89 @@ namespace Spartan
     
         delete world_info;
         world_info = nullptr;
+
+        delete soft_body_solver;
+        soft_body_solver = nullptr;
+
+        delete soft_body_dispatcher;
+        soft_body_dispatcher = nullptr;
+
+        delete soft_body_collision_configuration;
+        soft_body_collision_configuration = nullptr;
     
         delete debug_draw;
         debug_draw = nullptr;
+
+        MeshShapeCache::Shutdown();
+
+        if (task_scheduler)
+        {
+            btSetTaskScheduler(btGetSequentialTaskScheduler());
+            delete task_scheduler;
+            task_scheduler = nullptr;
+        }
     }
 
     void Physics::Tick()
     {
         SP_PROFILE_CPU();
-;
-        // don't simulate or debug draw when loading a world (a different thread could be creating physics objects)
+
+        // the simulation normally finished at the end of the previous frame, this is just in case it didn't
+        Synchronize();
+
+        // sample the player, replays substitute what was recorded on the frames that simulate
+        playback::sample_input();
+        if (!ProgressTracker::IsLoading() && Engine::IsFlagSet(EngineMode::Playing))
+        {
+            if (playback::pending_mode != PhysicsPlayback::Off)
+            {
+                playback::pending_mode == PhysicsPlayback::Recording ? Record(playback::pending_file_path) : Replay(playback::pending_file_path);
+                playback::pending_mode = PhysicsPlayback::Off;
+            }
+
+            if (playback::mode == PhysicsPlayback::Replaying)
+            {
+                if (playback::frame_index < static_cast<uint32_t>(playback::frames.size()))
+                {
+                    playback::unpack_input(playback::frames[playback::frame_index], &playback::input);
+                }
+                else
+                {
+                    StopPlayback();
+                }
+            }
+        }
+
+        // don't debug draw when loading a world (a different thread could be creating physics objects)
         if (ProgressTracker::IsLoading())
             return;
 
+        // bvhs and decompositions built while loading are saved once it's done
+        MeshShapeCache::Save();
+
         if (Engine::IsFlagSet(EngineMode::Playing))
         {
-            // Picking
+            // bullet -> engine, blend the poses of the last two steps
+            {
+                lock_guard<recursive_mutex> lock(world_mutex);
+
+                const float alpha = pose_smoothing == PhysicsPoseSmoothing::Interpolate ? pose_alpha : 1.0f + pose_alpha;
+                btCollisionObjectArray& objects = world->getCollisionObjectArray();
+                for (int i = 0; i < objects.size(); i++)
+                {
+                    btRigidBody* body = btRigidBody::upcast(objects[i]);
+                    if (!body || body->isStaticOrKinematicObject())
+                        continue;
+
+                    if (PhysicsBody* physics_body = static_cast<PhysicsBody*>(body->getUserPointer()))
+                    {
+                        physics_body->ApplySimulatedPose(alpha);
+                    }
+                }
+            }
+
+            // picking, it isn't part of a recording
+            if (playback::mode == PhysicsPlayback::Off)
             {
                 if (Input::GetKeyDown(KeyCode::Click_Left) && Input::GetMouseIsInViewport())
                 {
@@ -175,22 +1232,249 @@ namespace Spartan
 
                 MovePickedBody();
             }
+        }
+
+        if (Renderer::GetOption<bool>(Renderer_Option::Physics))
+        {
+            shared_ptr<Camera> camera   = Renderer::GetCamera();
+            const Vector3 view_position = camera ? camera->GetEntity()->GetPosition() : Vector3::Zero;
 
-            // accumulate elapsed time
-            float freme_time  = static_cast<float>(Timer::GetDeltaTimeSec());
-            accumulator      += freme_time;
-            // update physics as many times as needed to consume the accumulator at 200 Hz rate
-            while (accumulator >= internal_time_step)
+            lock_guard<recursive_mutex> lock(world_mutex);
+            debug_draw->Draw(world, view_position);
+            for (SoftBody& soft_body : soft_bodies)
             {
-                world->stepSimulation(internal_time_step, 1, internal_time_step);
-                accumulator -= internal_time_step;
+                debug_draw->DrawSoftBody(soft_body.body, view_position);
             }
         }
+    }
 
-        if (Renderer::GetOption<bool>(Renderer_Option::Physics))
+    void Physics::Simulate()
+    {
+        SP_PROFILE_CPU();
+
+        // don't simulate when loading a world (a different thread could be creating physics objects)
+        if (ProgressTracker::IsLoading() || !Engine::IsFlagSet(EngineMode::Playing))
+            return;
+
+        // consume the accumulator at the step rate, but only up to a bound, anything more would make the next frame slower (spiral of death)
+        accumulator    += playback::input.delta_time_sec;
+        uint32_t count  = min(static_cast<uint32_t>(accumulator / time_step), max_steps_per_tick);
+        accumulator    -= static_cast<float>(count) * time_step;
+        accumulator     = fmodf(accumulator, time_step);
+        pose_alpha      = accumulator / time_step;
+
+        if (playback::mode != PhysicsPlayback::Off)
+        {
+            playback::end_frame(count, true);
+        }
+
+        if (count == 0)
+            return;
+
+        if (!soft_bodies.empty())
+        {
+            lock_guard<recursive_mutex> lock(world_mutex);
+            soft_bodies_update_lods();
+        }
+
+        {
+            lock_guard<mutex> lock(simulation_mutex);
+            simulation_steps_pending = count;
+        }
+        simulation_condition.notify_all();
+    }
+
+    void Physics::Synchronize()
+    {
+        SP_PROFILE_CPU();
+
+        unique_lock<mutex> lock(simulation_mutex);
+        simulation_condition.wait(lock, [] { return simulation_steps_pending == 0; });
+    }
+
+    void Physics::Step(const uint32_t step_count)
+    {
+        Synchronize();
+
+        // each call is a frame of a recording or a replay
+        if (playback::mode != PhysicsPlayback::Off)
+        {
+            playback::end_frame(step_count, false);
+        }
+
+        step(step_count);
+    }
+
+    uint64_t Physics::GetStepCount()
+    {
+        return steps_simulated;
+    }
+
+    void Physics::SetStepRate(const float rate_hz)
+    {
+        // a recording is only reproducible at the rate it was made at
+        if (playback::mode != PhysicsPlayback::Off)
+        {
+            SP_LOG_WARNING("The step rate can't change during a physics recording or replay");
+            return;
+        }
+
+        Synchronize();
+
+        time_step   = 1.0f / clamp(rate_hz, 10.0f, 1000.0f);
+        accumulator = 0.0f;
+    }
+
+    float Physics::GetStepRate()
+    {
+        return 1.0f / time_step;
+    }
+
+    uint32_t Physics::GetSubstepCount()
+    {
+        return substeps;
+    }
+
+    void Physics::SetPoseSmoothing(const PhysicsPoseSmoothing smoothing)
+    {
+        pose_smoothing = smoothing;
+    }
+
+    const PhysicsInput& Physics::GetInput()
+    {
+        return playback::input;
+    }
+
+    bool Physics::Record(const string& file_path)
+    {
+        StopPlayback();
+        Synchronize();
+
+        playback::reset();
+        playback::rebuild_broadphase();
+        playback::set_deterministic(true);
+        playback::mode      = PhysicsPlayback::Recording;
+        playback::file_path = file_path;
+
+        playback::header           = playback::Header();
+        playback::header.time_step = time_step;
+        {
+            lock_guard<recursive_mutex> lock(world_mutex);
+            playback::header.state_hash = playback::compute_state_hash();
+        }
+
+        SP_LOG_INFO("Recording physics to \"%s\"", file_path.c_str());
+        return true;
+    }
+
+    bool Physics::Replay(const string& file_path)
+    {
+        StopPlayback();
+        Synchronize();
+
+        AssetContainer container;
+        if (!FileSystem::Exists(file_path) || !container.Open(file_path))
+        {
+            SP_LOG_ERROR("Failed to open physics recording \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        playback::reset();
+        if (!container.ReadChunk(playback::chunk_header, 0, &playback::header) || !container.ReadChunk(playback::chunk_frames, 0, &playback::frames))
+        {
+            SP_LOG_ERROR("\"%s\" is not a physics recording", file_path.c_str());
+            return false;
+        }
+
+        if (playback::header.version != playback::version || playback::header.time_step != time_step)
+        {
+            SP_LOG_ERROR("\"%s\" was recorded with an incompatible version or at %.0f Hz", file_path.c_str(), 1.0f / playback::header.time_step);
+            return false;
+        }
+
+        {
+            lock_guard<recursive_mutex> lock(world_mutex);
+            if (playback::compute_state_hash() != playback::header.state_hash)
+            {
+                SP_LOG_WARNING("The world doesn't match the one \"%s\" was recorded in, the replay will diverge", file_path.c_str());
+            }
+        }
+
+        playback::rebuild_broadphase();
+        playback::set_deterministic(true);
+        playback::mode      = PhysicsPlayback::Replaying;
+        playback::file_path = file_path;
+
+        SP_LOG_INFO("Replaying %u physics frames from \"%s\"", static_cast<uint32_t>(playback::frames.size()), file_path.c_str());
+        return true;
+    }
+
+    bool Physics::ReplayHeadless(const string& file_path)
+    {
+        if (!Replay(file_path))
+            return false;
+
+        // the recorded input and step counts drive the steps, instead of the timer
+        while (playback::frame_index < static_cast<uint32_t>(playback::frames.size()))
+        {
+            const playback::Frame& frame = playback::frames[playback::frame_index];
+            playback::unpack_input(frame, &playback::input);
+            Step(frame.steps);
+        }
+
+        const bool bit_exact = playback::frame_diverged == numeric_limits<uint32_t>::max();
+        StopPlayback();
+
+        return bit_exact;
+    }
+
+    void Physics::StopPlayback()
+    {
+        if (playback::mode == PhysicsPlayback::Off)
+            return;
+
+        Synchronize();
+
+        const double step_duration_ms = playback::step_count_total ? playback::step_duration_total * 1000.0 / static_cast<double>(playback::step_count_total) : 0.0;
+
+        if (playback::mode == PhysicsPlayback::Recording)
+        {
+            playback::header.frame_count = static_cast<uint32_t>(playback::frames.size());
+
+            AssetContainerWriter writer;
+            writer.AddChunk(playback::chunk_header, 0, &playback::header, sizeof(playback::Header));
+            writer.AddChunk(playback::chunk_frames, 0, playback::frames);
+
+            if (writer.Write(playback::file_path))
+            {
+                SP_LOG_INFO("Recorded %u physics frames to \"%s\", %.3f ms per step", playback::header.frame_count, playback::file_path.c_str(), step_duration_ms);
+            }
+            else
+            {
+                SP_LOG_ERROR("Failed to write physics recording \"%s\"", playback::file_path.c_str());
+            }
+        }
+        else
         {
-            world->debugDrawWorld();
+            const bool diverged = playback::frame_diverged != numeric_limits<uint32_t>::max();
+            SP_LOG_INFO("Replayed %u of %u physics frames from \"%s\", %llu steps at %.3f ms per step, %s",
+                playback::frame_index,
+                static_cast<uint32_t>(playback::frames.size()),
+                playback::file_path.c_str(),
+                static_cast<unsigned long long>(playback::step_count_total),
+                step_duration_ms,
+                diverged ? "diverged" : "bit exact"
+            );
         }
+
+        playback::set_deterministic(false);
+        playback::mode = PhysicsPlayback::Off;
+        playback::frames.clear();
+    }
+
+    PhysicsPlayback Physics::GetPlayback()
+    {
+        return playback::mode;
     }
 
     vector<btRigidBody*> Physics::RayCast(const Vector3& start, const Vector3& end)
@@ -199,7 +1483,10 @@ namespace Spartan
         btVector3 bt_end   = ToBtVector3(end);
 
         btCollisionWorld::AllHitsRayResultCallback ray_callback(bt_start, bt_end);
-        world->rayTest(bt_start, bt_end, ray_callback);
+        {
+            lock_guard<recursive_mutex> lock(world_mutex);
+            world->rayTest(bt_start, bt_end, ray_callback);
+        }
 
         vector<btRigidBody*> hit_bodies;
         if (ray_callback.hasHit())
@@ -218,66 +1505,185 @@ namespace Spartan
 
     Vector3 Physics::RayCastFirstHitPosition(const Math::Vector3& start, const Math::Vector3& end)
     {
-        btVector3 bt_start = ToBtVector3(start);
-        btVector3 bt_end   = ToBtVector3(end);
+        PhysicsRay ray;
+        ray.start = start;
+        ray.end   = end;
 
-        btCollisionWorld::ClosestRayResultCallback ray_callback(bt_start, bt_end);
-        world->rayTest(bt_start, bt_end, ray_callback);
+        PhysicsHit hit;
+        RayCast(span<const PhysicsRay>(&ray, 1), span<PhysicsHit>(&hit, 1));
 
-        if (ray_callback.hasHit())
+        return hit.body ? hit.position : Vector3::Infinity;
+    }
+
+    void Physics::RayCast(span<const PhysicsRay> rays, span<PhysicsHit> hits)
+    {
+        SP_ASSERT(hits.size() >= rays.size());
+
+        // holding the lock keeps the world as it is until every query is done
+        lock_guard<recursive_mutex> lock(world_mutex);
+
+        ThreadPool::ParallelLoop([&rays, &hits](uint32_t start, uint32_t end)
         {
-            return ToVector3(ray_callback.m_hitPointWorld);
-        }
+            for (uint32_t i = start; i < end; i++)
+            {
+                hits[i] = query_ray(rays[i]);
+            }
+        }, static_cast<uint32_t>(rays.size()), queries_per_task_min);
+    }
+
+    PhysicsHit Physics::RayCastInStep(const PhysicsRay& ray)
+    {
+        return query_ray(ray);
+    }
+
+    void Physics::Sweep(span<const PhysicsSweep> sweeps, span<PhysicsHit> hits)
+    {
+        SP_ASSERT(hits.size() >= sweeps.size());
+
+        lock_guard<recursive_mutex> lock(world_mutex);
+
+        ThreadPool::ParallelLoop([&sweeps, &hits](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                hits[i] = query_sweep(sweeps[i]);
+            }
+        }, static_cast<uint32_t>(sweeps.size()), queries_per_task_min);
+    }
+
+    void Physics::Overlap(span<const PhysicsOverlap> overlaps, span<btRigidBody*> bodies, span<uint32_t> counts)
+    {
+        SP_ASSERT(counts.size() >= overlaps.size());
+        if (overlaps.empty())
+            return;
+
+        lock_guard<recursive_mutex> lock(world_mutex);
 
-        return Vector3::Infinity;
+        const uint32_t capacity = static_cast<uint32_t>(bodies.size() / overlaps.size());
+        ThreadPool::ParallelLoop([&overlaps, &bodies, &counts, capacity](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                counts[i] = query_overlap(overlaps[i], bodies.data() + i * capacity, capacity);
+            }
+        }, static_cast<uint32_t>(overlaps.size()), queries_per_task_min);
     }
 
     void Physics::AddBody(btRigidBody* body)
     {
+        lock_guard<recursive_mutex> lock(world_mutex);
+        body->setSleepingThresholds(sleep_threshold_linear, sleep_threshold_angular);
         world->addRigidBody(body);
+        playback::bodies_added++;
     }
 
     void Physics::RemoveBody(btRigidBody*& body)
     {
+        lock_guard<recursive_mutex> lock(world_mutex);
         world->removeRigidBody(body);
+        playback::bodies_removed++;
+
+        // soft bodies that touched it let go, its shape could be freed and another one allocated in its place
+        for (SoftBody& soft_body : soft_bodies)
+        {
+            auto it = soft_body.pairs.find(body);
+            if (it != soft_body.pairs.end())
+            {
+                soft_body_release_pair(it->second);
+                soft_body.pairs.erase(it);
+            }
+        }
+
+        if (world_info)
+        {
+            world_info->m_sparsesdf.RemoveReferences(body->getCollisionShape());
+        }
     }
 
-    void Physics::AddBody(btRaycastVehicle* body)
+    void Physics::AddBody(Car* car)
     {
-        world->addVehicle(body);
+        lock_guard<recursive_mutex> lock(world_mutex);
+        cars.emplace_back(car);
     }
 
-    void Physics::RemoveBody(btRaycastVehicle*& body)
+    void Physics::RemoveBody(Car* car)
     {
-        world->removeVehicle(body);
+        lock_guard<recursive_mutex> lock(world_mutex);
+        cars.erase(remove(cars.begin(), cars.end(), car), cars.end());
     }
 
     void Physics::AddConstraint(btTypedConstraint* constraint, bool collision_with_linked_body /*= true*/)
     {
+        lock_guard<recursive_mutex> lock(world_mutex);
         world->addConstraint(constraint, !collision_with_linked_body);
     }
 
     void Physics::RemoveConstraint(btTypedConstraint*& constraint)
     {
+        lock_guard<recursive_mutex> lock(world_mutex);
         world->removeConstraint(constraint);
         delete constraint;
     }
 
     void Physics::AddBody(btSoftBody* body)
     {
-        if (btSoftRigidDynamicsWorld* _world = static_cast<btSoftRigidDynamicsWorld*>(world))
-        {
-            _world->addSoftBody(body);
-        }
+        lock_guard<recursive_mutex> lock(world_mutex);
+        soft_bodies_initialize();
+        SP_ASSERT_MSG(body->getWorldInfo() == world_info, "Soft bodies have to be created with Physics::GetSoftWorldInfo()");
+
+        body->setSoftBodySolver(soft_body_solver);
+
+        SoftBody& soft_body           = soft_bodies.emplace_back();
+        soft_body.body                = body;
+        soft_body.links               = body->m_links;
+        soft_body.position_iterations = body->m_cfg.piterations;
     }
 
     void Physics::RemoveBody(btSoftBody*& body)
     {
-        if (btSoftRigidDynamicsWorld* _world = static_cast<btSoftRigidDynamicsWorld*>(world))
+        lock_guard<recursive_mutex> lock(world_mutex);
+
+        auto it = find_if(soft_bodies.begin(), soft_bodies.end(), [body](const SoftBody& soft_body) { return soft_body.body == body; });
+        if (it != soft_bodies.end())
         {
-            _world->removeSoftBody(body);
-            delete body;
+            for (auto& [object, pair] : it->pairs)
+            {
+                soft_body_release_pair(pair);
+            }
+            soft_bodies.erase(it);
         }
+
+        delete body;
+        body = nullptr;
+    }
+
+    btSoftBody* Physics::CreateCloth(const Vector3& position, const float size, const uint32_t resolution)
+    {
+        SP_ASSERT(resolution >= 2);
+
+        // diagonal links keep it from shearing
+        const float extent = size * 0.5f;
+        btSoftBody* body   = btSoftBodyHelpers::CreatePatch(
+            GetSoftWorldInfo(),
+            ToBtVector3(position + Vector3(-extent, 0.0f, -extent)),
+            ToBtVector3(position + Vector3(extent, 0.0f, -extent)),
+            ToBtVector3(position + Vector3(-extent, 0.0f, extent)),
+            ToBtVector3(position + Vector3(extent, 0.0f, extent)),
+            static_cast<int>(resolution),
+            static_cast<int>(resolution),
+            0,
+            true
+        );
+
+        // bending links hold folds and creases, they are what the level of detail drops
+        body->generateBendingConstraints(2, body->appendMaterial());
+        body->m_cfg.piterations = 4;
+        body->m_cfg.kDF         = 0.5f;
+        body->setTotalMass(1.0f);
+
+        AddBody(body);
+
+        return body;
     }
 
     Vector3& Physics::GetGravity()
@@ -287,6 +1693,8 @@ namespace Spartan
 
     btSoftBodyWorldInfo& Physics::GetSoftWorldInfo()
     {
+        lock_guard<recursive_mutex> lock(world_mutex);
+        soft_bodies_initialize();
         return *world_info;
     }
 
@@ -302,7 +1710,7 @@ namespace Spartan
 
     float Physics::GetTimeStepInternalSec()
     {
-        return 1.0f / internal_time_step;
+        return time_step;
     }
 
     void Physics::PickBody()
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ===========
+#include <span>
 #include "Definitions.h"
 //======================
 
@@ -36,11 +37,76 @@ class btRigidBody;
 class btSoftBody;
 class btTypedConstraint;
 struct btSoftBodyWorldInfo;
-class btRaycastVehicle;
 //========================================
 
 namespace Spartan
 {
+    //= FORWARD DECLARATIONS =
+    class Car;
+    //========================
+
+    enum class PhysicsPoseSmoothing
+    {
+        Interpolate, // render between the last two simulated poses, smooth but one step behind
+        Extrapolate  // render ahead of the last simulated pose, no latency but can overshoot
+    };
+
+    enum class PhysicsPlayback
+    {
+        Off,
+        Recording,
+        Replaying
+    };
+
+    // what the simulation reads from the player and the clock, sampled once per frame so that it can be recorded and replayed
+    struct PhysicsInput
+    {
+        float delta_time_sec = 0.0f;
+        bool accelerate      = false;
+        bool reverse         = false;
+        bool steer_left      = false;
+        bool steer_right     = false;
+        bool brake           = false;
+    };
+
+    enum class PhysicsQueryShape
+    {
+        Sphere, // size.x is the radius
+        Box     // size is the half extents
+    };
+
+    struct PhysicsRay
+    {
+        Math::Vector3 start       = Math::Vector3::Zero;
+        Math::Vector3 end         = Math::Vector3::Zero;
+        const btRigidBody* ignore = nullptr;
+    };
+
+    struct PhysicsSweep
+    {
+        PhysicsQueryShape shape   = PhysicsQueryShape::Sphere;
+        Math::Vector3 size        = Math::Vector3::One;
+        Math::Vector3 start       = Math::Vector3::Zero;
+        Math::Vector3 end         = Math::Vector3::Zero;
+        const btRigidBody* ignore = nullptr;
+    };
+
+    struct PhysicsOverlap
+    {
+        PhysicsQueryShape shape   = PhysicsQueryShape::Sphere;
+        Math::Vector3 size        = Math::Vector3::One;
+        Math::Vector3 position    = Math::Vector3::Zero;
+        const btRigidBody* ignore = nullptr;
+    };
+
+    struct PhysicsHit
+    {
+        btRigidBody* body      = nullptr; // null when nothing was hit
+        Math::Vector3 position = Math::Vector3::Zero;
+        Math::Vector3 normal   = Math::Vector3::Zero;
+        float fraction         = 1.0f;    // how far along the query the hit is, from 0 to 1
+    };
+
     class SP_CLASS Physics
     {
     public:
@@ -48,16 +114,41 @@ namespace Spartan
         static void Shutdown();
         static void Tick();
 
+        // simulation, runs on a dedicated thread between Simulate() and Synchronize()
+        static void Simulate();
+        static void Synchronize();
+        static void Step(const uint32_t step_count); // steps synchronously on the calling thread, for headless use, each call is a frame of a recording
+        static uint64_t GetStepCount();
+        static void SetStepRate(const float rate_hz); // bodies that can't keep up with it, like cars or fast spinners, are substepped
+        static float GetStepRate();
+        static uint32_t GetSubstepCount();            // of the last step
+        static void SetPoseSmoothing(const PhysicsPoseSmoothing smoothing);
+        static const PhysicsInput& GetInput();
+
+        // record and replay, both step deterministically so a replay of the same world reproduces the recording bit for bit
+        static bool Record(const std::string& file_path);
+        static bool Replay(const std::string& file_path);
+        static bool ReplayHeadless(const std::string& file_path); // replays every frame right away through Step(), returns false if it diverged
+        static void StopPlayback();
+        static PhysicsPlayback GetPlayback();
+
         static std::vector<btRigidBody*> RayCast(const Math::Vector3& start, const Math::Vector3& end);
         static Math::Vector3 RayCastFirstHitPosition(const Math::Vector3& start, const Math::Vector3& end);
 
+        // batched scene queries, they run in parallel against a world that can't change meanwhile and write into the caller's buffers
+        static void RayCast(std::span<const PhysicsRay> rays, std::span<PhysicsHit> hits);
+        static void Sweep(std::span<const PhysicsSweep> sweeps, std::span<PhysicsHit> hits);
+        static void Overlap(std::span<const PhysicsOverlap> overlaps, std::span<btRigidBody*> bodies, std::span<uint32_t> counts); // bodies is split evenly between the queries
+        static PhysicsHit RayCastInStep(const PhysicsRay& ray); // for code that runs inside a step (e.g. cars), on any thread, the stepping thread already holds the world
+
         // body
         static void AddBody(btRigidBody* body);
         static void RemoveBody(btRigidBody*& body);
-        static void AddBody(btSoftBody* body);
+        static void AddBody(btSoftBody* body); // stepped at a level of detail that follows the camera, off-screen ones sleep
         static void RemoveBody(btSoftBody*& body);
-        static void AddBody(btRaycastVehicle* body);
-        static void RemoveBody(btRaycastVehicle*& body);
+        static btSoftBody* CreateCloth(const Math::Vector3& position, const float size, const uint32_t resolution); // a square patch in the xz plane, already added
+        static void AddBody(Car* car);
+        static void RemoveBody(Car* car);
 
         // constraint
         static void AddConstraint(btTypedConstraint* constraint, bool collision_with_linked_body = true);
@@ -65,10 +156,10 @@ namespace Spartan
 
         // misc
         static Math::Vector3& GetGravity();
-        static btSoftBodyWorldInfo& GetSoftWorldInfo();
+        static btSoftBodyWorldInfo& GetSoftWorldInfo(); // soft bodies have to be created with it
         static void* GetPhysicsDebugDraw();
         static void* GetWorld();
-        static float GetTimeStepInternalSec();
+        static float GetTimeStepInternalSec(); // of a step, which can be split into substeps (see GetSubstepCount())
 
     private:
         // picking
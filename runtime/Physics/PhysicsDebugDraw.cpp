@@ -19,38 +19,355 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//================================
+//= INCLUDES =======================================
 #include "pch.h"
 #include "PhysicsDebugDraw.h"
 #include "BulletPhysicsHelper.h"
 #include "../Rendering/Renderer.h"
-//================================
+SP_WARNINGS_OFF
+#include <btBulletDynamicsCommon.h>
+#include <BulletSoftBody/btSoftBody.h>
+#include <BulletSoftBody/btSoftBodyHelpers.h>
+SP_WARNINGS_ON
+//==================================================
 
-//= NAMESPACES =====
+//= NAMESPACES ================
 using namespace std;
-//==================
+using namespace Spartan::Math;
+//=============================
 
 namespace Spartan
 {
     namespace
     {
         uint32_t debug_mode = 0;
+
+        // bodies further than this aren't drawn
+        const float draw_distance_max = 250.0f;
+
+        // vertices per frame, the nearest bodies are drawn first, whatever doesn't fit is skipped
+        const uint32_t vertex_budget_instanced = 4'000'000;
+        const uint32_t vertex_budget_emitted   = 131'072;
+
+        // lines of shapes that no body used for this many frames are dropped
+        const uint64_t shape_lines_lifetime = 300;
+
+        // the same colors that btCollisionWorld::debugDrawWorld() uses
+        btVector3 get_object_color(const btCollisionObject* object, const btIDebugDraw::DefaultColors& colors)
+        {
+            btVector3 color;
+            switch (object->getActivationState())
+            {
+                case ACTIVE_TAG:           color = colors.m_activeObject;               break;
+                case ISLAND_SLEEPING:      color = colors.m_deactivatedObject;          break;
+                case WANTS_DEACTIVATION:   color = colors.m_wantsDeactivationObject;    break;
+                case DISABLE_DEACTIVATION: color = colors.m_disabledDeactivationObject; break;
+                case DISABLE_SIMULATION:   color = colors.m_disabledSimulationObject;   break;
+                default:                   color = btVector3(0.3f, 0.3f, 0.3f);         break;
+            }
+            object->getCustomDebugColor(color);
+
+            return color;
+        }
+
+        // the last column of an affine transform is always (0, 0, 0, 1), so it carries the color the white lines are tinted with
+        Matrix get_instance_transform(const btCollisionObject* object, const btVector3& color)
+        {
+            const btTransform& transform = object->getWorldTransform();
+            Matrix matrix = Matrix(ToVector3(transform.getOrigin()), ToQuaternion(transform.getRotation()), Vector3::One);
+            matrix.m03    = color.x();
+            matrix.m13    = color.y();
+            matrix.m23    = color.z();
+
+            return matrix;
+        }
+
+        float get_distance_squared(const btVector3& position, const btVector3& aabb_min, const btVector3& aabb_max)
+        {
+            btVector3 closest = position;
+            closest.setMax(aabb_min);
+            closest.setMin(aabb_max);
+
+            return (position - closest).length2();
+        }
+
+        struct Visible
+        {
+            const btCollisionObject* object = nullptr;
+            float distance_squared          = 0.0f;
+            uint32_t vertex_offset          = 0;
+            uint32_t vertex_count           = 0;
+        };
+        vector<Visible> visible;
     }
 
     PhysicsDebugDraw::PhysicsDebugDraw()
     {
         debug_mode =
-            DBG_DrawFrames        | // axes of the coordinate frames 
+            DBG_DrawFrames        | // axes of the coordinate frames
             DBG_DrawWireframe     | // shapes
             DBG_DrawContactPoints |
             DBG_DrawConstraints   |
             DBG_DrawConstraintLimits;
     }
 
+    void PhysicsDebugDraw::Draw(btDiscreteDynamicsWorld* world, const Vector3& view_position)
+    {
+        SP_ASSERT(world->getDebugDrawer() == this);
+
+        m_frame++;
+        m_vertex_count_emitted   = 0;
+        m_vertex_count_instanced = 0;
+        m_instance_count_culled  = 0;
+        m_batches.clear();
+        m_transforms.clear();
+
+        const btVector3 view                     = ToBtVector3(view_position);
+        const float distance_max_squared         = draw_distance_max * draw_distance_max;
+        const btIDebugDraw::DefaultColors colors = getDefaultColors();
+
+        // shapes
+        if (debug_mode & (DBG_DrawWireframe | DBG_DrawAabb))
+        {
+            EvictShapeLines();
+
+            // distance culling
+            visible.clear();
+            const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+            for (int i = 0; i < objects.size(); i++)
+            {
+                const btCollisionObject* object = objects[i];
+                if (object->getCollisionFlags() & btCollisionObject::CF_DISABLE_VISUALIZE_OBJECT)
+                    continue;
+
+                // soft bodies deform, they are emitted by DrawSoftBody()
+                if (object->getInternalType() == btCollisionObject::CO_SOFT_BODY)
+                    continue;
+
+                btVector3 aabb_min, aabb_max;
+                object->getCollisionShape()->getAabb(object->getWorldTransform(), aabb_min, aabb_max);
+                const float distance_squared = get_distance_squared(view, aabb_min, aabb_max);
+                if (distance_squared > distance_max_squared)
+                {
+                    m_instance_count_culled++;
+                    continue;
+                }
+
+                if (debug_mode & DBG_DrawAabb)
+                {
+                    drawAabb(aabb_min, aabb_max, colors.m_aabb);
+                }
+
+                if (debug_mode & DBG_DrawWireframe)
+                {
+                    visible.push_back({ object, distance_squared });
+                }
+            }
+
+            // budget, nearest first
+            sort(visible.begin(), visible.end(), [](const Visible& a, const Visible& b) { return a.distance_squared < b.distance_squared; });
+            uint32_t visible_count = 0;
+            for (Visible& item : visible)
+            {
+                const ShapeLines* lines = GetShapeLines(world, item.object->getCollisionShape());
+                if (lines->vertex_count == 0)
+                    continue;
+
+                if (m_vertex_count_instanced + lines->vertex_count > vertex_budget_instanced)
+                {
+                    m_instance_count_culled++;
+                    continue;
+                }
+
+                m_vertex_count_instanced += lines->vertex_count;
+                item.vertex_offset        = lines->vertex_offset;
+                item.vertex_count         = lines->vertex_count;
+                visible[visible_count++]  = item;
+            }
+            visible.resize(visible_count);
+
+            // one batch per shape, with the transforms of every body that uses it
+            sort(visible.begin(), visible.end(), [](const Visible& a, const Visible& b) { return a.vertex_offset < b.vertex_offset; });
+            for (const Visible& item : visible)
+            {
+                if (m_batches.empty() || m_batches.back().vertex_offset != item.vertex_offset)
+                {
+                    Renderer_LineInstances batch;
+                    batch.vertex_offset   = item.vertex_offset;
+                    batch.vertex_count    = item.vertex_count;
+                    batch.instance_offset = static_cast<uint32_t>(m_transforms.size());
+                    m_batches.emplace_back(batch);
+                }
+
+                m_transforms.emplace_back(get_instance_transform(item.object, get_object_color(item.object, colors)));
+                m_batches.back().instance_count++;
+            }
+
+            // the axes are the same lines for every body and keep their own colors
+            if ((debug_mode & DBG_DrawFrames) && !visible.empty())
+            {
+                const ShapeLines* lines = GetShapeLines(world, nullptr);
+
+                Renderer_LineInstances batch;
+                batch.vertex_offset   = lines->vertex_offset;
+                batch.vertex_count    = lines->vertex_count;
+                batch.instance_offset = static_cast<uint32_t>(m_transforms.size());
+                batch.instance_count  = static_cast<uint32_t>(visible.size());
+                m_batches.emplace_back(batch);
+
+                for (const Visible& item : visible)
+                {
+                    m_transforms.emplace_back(get_instance_transform(item.object, btVector3(1.0f, 1.0f, 1.0f)));
+                }
+                m_vertex_count_instanced += lines->vertex_count * batch.instance_count;
+            }
+
+            Renderer::DrawLinesInstanced(m_vertices, m_vertices_version, m_batches, m_transforms);
+        }
+
+        // contacts
+        if ((debug_mode & DBG_DrawContactPoints) && world->getDispatcher())
+        {
+            btDispatcher* dispatcher = world->getDispatcher();
+            for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+            {
+                btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+                for (int j = 0; j < manifold->getNumContacts(); j++)
+                {
+                    const btManifoldPoint& point = manifold->getContactPoint(j);
+                    if ((point.m_positionWorldOnB - view).length2() <= distance_max_squared)
+                    {
+                        drawContactPoint(point.m_positionWorldOnB, point.m_normalWorldOnB, point.getDistance(), point.getLifeTime(), colors.m_contactPoint);
+                    }
+                }
+            }
+        }
+
+        // constraints
+        if (debug_mode & (DBG_DrawConstraints | DBG_DrawConstraintLimits))
+        {
+            for (int i = world->getNumConstraints() - 1; i >= 0; i--)
+            {
+                btTypedConstraint* constraint = world->getConstraint(i);
+                if ((constraint->getRigidBodyA().getWorldTransform().getOrigin() - view).length2() <= distance_max_squared)
+                {
+                    world->debugDrawConstraint(constraint);
+                }
+            }
+        }
+    }
+
+    void PhysicsDebugDraw::DrawSoftBody(btSoftBody* body, const Vector3& view_position)
+    {
+        if (!(debug_mode & DBG_DrawWireframe))
+            return;
+
+        btVector3 aabb_min, aabb_max;
+        body->getAabb(aabb_min, aabb_max);
+        if (get_distance_squared(ToBtVector3(view_position), aabb_min, aabb_max) <= draw_distance_max * draw_distance_max)
+        {
+            btSoftBodyHelpers::Draw(body, this);
+        }
+    }
+
+    PhysicsDebugDraw::ShapeLines* PhysicsDebugDraw::GetShapeLines(btDiscreteDynamicsWorld* world, const btCollisionShape* shape)
+    {
+        btVector3 aabb_min     = btVector3(0.0f, 0.0f, 0.0f);
+        btVector3 aabb_max     = btVector3(0.0f, 0.0f, 0.0f);
+        const int shape_type   = shape ? shape->getShapeType() : INVALID_SHAPE_PROXYTYPE;
+        const btVector3 scaling = shape ? shape->getLocalScaling() : btVector3(1.0f, 1.0f, 1.0f);
+        if (shape)
+        {
+            shape->getAabb(btTransform::getIdentity(), aabb_min, aabb_max);
+        }
+
+        ShapeLines& lines = m_shapes[shape];
+        lines.frame_used  = m_frame;
+
+        // already made from this very shape
+        const bool is_match =
+            lines.shape_type == shape_type &&
+            lines.scaling    == scaling    &&
+            lines.aabb_min   == aabb_min   &&
+            lines.aabb_max   == aabb_max;
+        if (is_match)
+            return &lines;
+
+        // the old lines (if any) are left in place until the next compaction
+        m_vertex_count_evicted += lines.vertex_count;
+
+        // bullet draws the shape in its local space and the lines are captured instead of drawn
+        lines.shape_type    = shape_type;
+        lines.scaling       = scaling;
+        lines.aabb_min      = aabb_min;
+        lines.aabb_max      = aabb_max;
+        lines.vertex_offset = static_cast<uint32_t>(m_vertices.size());
+        m_capturing         = true;
+        if (shape)
+        {
+            // white, so that every body can tint it, and without the axes, which are cached on their own
+            const uint32_t mode = debug_mode;
+            debug_mode         &= ~DBG_DrawFrames;
+            world->debugDrawObject(btTransform::getIdentity(), shape, btVector3(1.0f, 1.0f, 1.0f));
+            debug_mode          = mode;
+        }
+        else
+        {
+            drawTransform(btTransform::getIdentity(), 0.1f);
+        }
+        m_capturing         = false;
+        lines.vertex_count  = static_cast<uint32_t>(m_vertices.size()) - lines.vertex_offset;
+        m_vertices_version++;
+
+        return &lines;
+    }
+
+    void PhysicsDebugDraw::EvictShapeLines()
+    {
+        for (auto it = m_shapes.begin(); it != m_shapes.end();)
+        {
+            if (m_frame - it->second.frame_used > shape_lines_lifetime)
+            {
+                m_vertex_count_evicted += it->second.vertex_count;
+                it = m_shapes.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // compact once most of the vertices belong to lines that are gone
+        if (m_vertex_count_evicted == 0 || m_vertex_count_evicted < m_vertices.size() / 2)
+            return;
+
+        vector<RHI_Vertex_PosCol> vertices;
+        vertices.reserve(m_vertices.size() - m_vertex_count_evicted);
+        for (auto& [key, lines] : m_shapes)
+        {
+            const uint32_t offset = static_cast<uint32_t>(vertices.size());
+            vertices.insert(vertices.end(), m_vertices.begin() + lines.vertex_offset, m_vertices.begin() + lines.vertex_offset + lines.vertex_count);
+            lines.vertex_offset   = offset;
+        }
+        m_vertices             = move(vertices);
+        m_vertex_count_evicted = 0;
+        m_vertices_version++;
+    }
+
     void PhysicsDebugDraw::drawLine(const btVector3& from, const btVector3& to, const btVector3& color_from, const btVector3& color_to)
     {
+        if (m_capturing)
+        {
+            m_vertices.emplace_back(ToVector3(from), Color(color_from.x(), color_from.y(), color_from.z(), 1.0f));
+            m_vertices.emplace_back(ToVector3(to),   Color(color_to.x(), color_to.y(), color_to.z(), 1.0f));
+            return;
+        }
+
+        if (m_vertex_count_emitted + 2 > vertex_budget_emitted)
+            return;
+        m_vertex_count_emitted += 2;
+
         // a bit dangerous to reinterpret these parameters but this is a performance critical path
-        // a better way would be to use a custom physics debug draw since the one from Bullet is a cpu hog
         Renderer::DrawLine(
             reinterpret_cast<const Math::Vector3&>(from),
             reinterpret_cast<const Math::Vector3&>(to),
@@ -21,11 +21,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =======================
+//= INCLUDES ==================================
+#include "../RHI/RHI_Vertex.h"
+#include "../Math/Matrix.h"
+#include "../Rendering/Renderer_Definitions.h"
 SP_WARNINGS_OFF
 #include <LinearMath/btIDebugDraw.h>
 SP_WARNINGS_ON
-//==================================
+//============================================
+
+class btCollisionShape;
+class btDiscreteDynamicsWorld;
+class btSoftBody;
 
 namespace Spartan
 {
@@ -35,6 +42,19 @@ namespace Spartan
         PhysicsDebugDraw();
         ~PhysicsDebugDraw() = default;
 
+        // shapes are turned into white lines once and drawn instanced with the transforms (and colors) of their bodies,
+        // only contacts, constraints and soft bodies are emitted line by line, every frame
+        void Draw(btDiscreteDynamicsWorld* world, const Math::Vector3& view_position);
+        void DrawSoftBody(btSoftBody* body, const Math::Vector3& view_position);
+
+        // what the last Draw() produced, in vertices
+        uint32_t GetVertexCountEmitted() const   { return m_vertex_count_emitted; }
+        uint32_t GetVertexCountInstanced() const { return m_vertex_count_instanced; }
+        uint32_t GetVertexCountCached() const    { return static_cast<uint32_t>(m_vertices.size()); }
+        uint32_t GetInstanceCount() const        { return static_cast<uint32_t>(m_transforms.size()); }
+        uint32_t GetInstanceCountCulled() const  { return m_instance_count_culled; }
+
+        // btIDebugDraw
         void drawLine(const btVector3& from, const btVector3& to, const btVector3& fromColor, const btVector3& toColor) override;
         void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override { drawLine(from, to, color, color); }
         void drawContactPoint(const btVector3& PointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime, const btVector3& color) override;
@@ -42,5 +62,37 @@ namespace Spartan
         void draw3dText(const btVector3& location, const char* textString) override {}
         void setDebugMode(const int debugMode) override;
         int getDebugMode() const override;
+
+    private:
+        struct ShapeLines
+        {
+            // what the lines were made from, a shape that was freed and another one allocated in its place won't match
+            int shape_type         = -1;
+            btVector3 scaling      = btVector3(1.0f, 1.0f, 1.0f);
+            btVector3 aabb_min     = btVector3(0.0f, 0.0f, 0.0f);
+            btVector3 aabb_max     = btVector3(0.0f, 0.0f, 0.0f);
+
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+            uint64_t frame_used    = 0;
+        };
+
+        ShapeLines* GetShapeLines(btDiscreteDynamicsWorld* world, const btCollisionShape* shape); // a null shape gets the axes of a frame
+        void EvictShapeLines();
+
+        // lines of every shape, in the shape's local space, a shape shared by bodies of different colors is cached once
+        std::unordered_map<const btCollisionShape*, ShapeLines> m_shapes;
+        std::vector<RHI_Vertex_PosCol> m_vertices;
+        uint64_t m_vertices_version     = 0;
+        uint32_t m_vertex_count_evicted = 0;
+        bool m_capturing                = false;
+
+        // this frame
+        std::vector<Renderer_LineInstances> m_batches;
+        std::vector<Math::Matrix> m_transforms;
+        uint64_t m_frame                  = 0;
+        uint32_t m_vertex_count_emitted   = 0;
+        uint32_t m_vertex_count_instanced = 0;
+        uint32_t m_instance_count_culled  = 0;
     };
 }
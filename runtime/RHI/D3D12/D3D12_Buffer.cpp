@@ -44,4 +44,9 @@ namespace Spartan
     {
 
     }
+
+    void RHI_Buffer::UpdateRange(const void* data_cpu, const uint64_t offset, const uint64_t size)
+    {
+
+    }
 }
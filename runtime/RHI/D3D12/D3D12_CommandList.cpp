@@ -130,15 +130,15 @@ namespace Spartan
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
 
-    void RHI_CommandList::Draw(const uint32_t vertex_count, uint32_t vertex_start_index /*= 0*/)
+    void RHI_CommandList::Draw(const uint32_t vertex_count, uint32_t vertex_start_index /*= 0*/, const uint32_t instance_start_index /*= 0*/, const uint32_t instance_count /*= 1*/)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
 
         static_cast<ID3D12GraphicsCommandList*>(m_rhi_resource)->DrawInstanced(
-            vertex_count,       // VertexCountPerInstance
-            1,                  // InstanceCount
-            vertex_start_index, // StartVertexLocation
-            0                   // StartInstanceLocation
+            vertex_count,        // VertexCountPerInstance
+            instance_count,      // InstanceCount
+            vertex_start_index,  // StartVertexLocation
+            instance_start_index // StartInstanceLocation
         );
         Profiler::m_rhi_draw++;
     }
@@ -69,6 +69,9 @@ namespace Spartan
 
         // storage and constant buffer updating
         void Update(void* data_cpu, const uint32_t size = 0);
+
+        // overwrites a byte range in place, works for mappable and device local buffers
+        void UpdateRange(const void* data_cpu, const uint64_t offset, const uint64_t size);
         void ResetOffset() { m_offset = 0; first_update = true; }
 
         // propeties
@@ -75,7 +75,7 @@ namespace Spartan
         );
 
         // draw
-        void Draw(const uint32_t vertex_count, const uint32_t vertex_start_index = 0);
+        void Draw(const uint32_t vertex_count, const uint32_t vertex_start_index = 0, const uint32_t instance_start_index = 0, const uint32_t instance_count = 1);
         void DrawIndexed(const uint32_t index_count, const uint32_t index_offset = 0, const uint32_t vertex_offset = 0, const uint32_t instance_start_index = 0, const uint32_t instance_count = 1);
 
         // dispatch
@@ -84,6 +84,7 @@ static const DXGI_FORMAT d3d12_format[] =
     DXGI_FORMAT_BC5_UNORM,
     DXGI_FORMAT_BC7_UNORM,
     DXGI_FORMAT_UNKNOWN,
+    DXGI_FORMAT_BC4_UNORM,
     // Surface
     DXGI_FORMAT_B8G8R8A8_UNORM,
     // Unknown
@@ -220,6 +221,7 @@ static const VkFormat vulkan_format[] =
     VK_FORMAT_BC5_UNORM_BLOCK,
     VK_FORMAT_BC7_UNORM_BLOCK,
     VK_FORMAT_ASTC_4x4_UNORM_BLOCK,
+    VK_FORMAT_BC4_UNORM_BLOCK,
     // Surface
     VK_FORMAT_B8G8R8A8_UNORM,
     // Unknown
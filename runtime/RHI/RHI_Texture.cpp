@@ -25,6 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ThreadPool.h"
 #include "RHI_CommandList.h"
 #include "../IO/FileStream.h"
+#include "../IO/AssetContainer.h"
+#include "../Resource/DerivedDataCache.h"
 #include "../Resource/Import/ImageImporterExporter.h"
 SP_WARNINGS_OFF
 #include "compressonator.h"
@@ -37,9 +39,64 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace
+    {
+        const uint32_t chunk_properties = asset_chunk_id("TPRP");
+        const uint32_t chunk_path       = asset_chunk_id("PATH");
+        const uint32_t chunk_mip        = asset_chunk_id("TMIP"); // index is array_index * mip_count + mip_index
+
+        // bump when the import produces different output, older derived data will then be ignored
+        const uint32_t derived_data_version = 3;
+
+        struct TextureProperties
+        {
+            uint32_t width            = 0;
+            uint32_t height           = 0;
+            uint32_t depth            = 0;
+            uint32_t mip_count        = 0;
+            uint32_t channel_count    = 0;
+            uint32_t bits_per_channel = 0;
+            uint32_t type             = 0;
+            uint32_t format           = 0;
+            uint32_t flags            = 0;
+            uint32_t padding          = 0;
+            uint64_t object_id        = 0;
+        };
+    }
+
     namespace compressonator
     {
-        bool registered = false;
+        // textures import in parallel, each one reads the quality once so that its key and its compression agree
+        atomic<bool> registered                 = false;
+        atomic<RHI_Texture_Compression> quality = RHI_Texture_Compression::Production;
+
+        // rows of 4x4 blocks per job, enough to amortize the compressor's per call setup
+        const uint32_t job_block_rows = 16;
+
+        struct Preset
+        {
+            RHI_Format format_production;
+            RHI_Format format_preview;
+            float quality_production;
+            float quality_preview;
+        };
+
+        // bc7 is worth its cost for color, normals only need two channels and masks only one, which bc5 and bc4 store at higher precision
+        // previews fall back to bc3 for color since bc7 is slow to encode even at low quality
+        const Preset preset_color  = { RHI_Format::BC7_Unorm, RHI_Format::BC3_Unorm, 0.3f, 0.05f };
+        const Preset preset_normal = { RHI_Format::BC5_Unorm, RHI_Format::BC5_Unorm, 1.0f, 0.05f };
+        const Preset preset_mask   = { RHI_Format::BC4_Unorm, RHI_Format::BC4_Unorm, 1.0f, 0.05f };
+
+        const Preset& get_preset(const RHI_Texture* texture)
+        {
+            if (texture->IsNormalMap())
+                return preset_normal;
+
+            if (texture->IsGrayscale() && !texture->IsSemiTransparent())
+                return preset_mask;
+
+            return preset_color;
+        }
 
         CMP_FORMAT to_cmp_format(const RHI_Format format)
         {
@@ -54,6 +111,12 @@ namespace Spartan
             if (format == RHI_Format::BC3_Unorm)
                 return CMP_FORMAT::CMP_FORMAT_BC3;
 
+            if (format == RHI_Format::BC4_Unorm)
+                return CMP_FORMAT::CMP_FORMAT_BC4;
+
+            if (format == RHI_Format::BC5_Unorm)
+                return CMP_FORMAT::CMP_FORMAT_BC5;
+
             if (format == RHI_Format::BC7_Unorm)
                 return CMP_FORMAT::CMP_FORMAT_BC7;
 
@@ -61,24 +124,31 @@ namespace Spartan
             return CMP_FORMAT::CMP_FORMAT_Unknown;
         }
 
-        void compress(RHI_Texture* texture, const uint32_t mip_index, const RHI_Format destination_format)
+        struct Job
         {
-            if (!compressonator::registered)
-            {
-                string version = to_string(AMD_COMPRESS_VERSION_MAJOR) + "." + to_string(AMD_COMPRESS_VERSION_MINOR);
-                Settings::RegisterThirdPartyLib("Compressonator", version, "https://github.com/GPUOpen-Tools/compressonator");
-                compressonator::registered = true;
-            }
+            uint32_t array_index = 0;
+            uint32_t mip_index   = 0;
+            uint32_t row_start   = 0;
+            uint32_t row_end     = 0;
+        };
+
+        // compresses a band of rows, bc blocks are stored row after row so the output lands in its own slice of the mip
+        bool compress(RHI_Texture* texture, const Job& job, const RHI_Format destination_format, const float fquality, vector<std::byte>* destination)
+        {
+            const uint32_t width        = max(1u, texture->GetWidth() >> job.mip_index);
+            const uint32_t pitch        = width * texture->GetBytesPerPixel();
+            const size_t block_row_size = RHI_Texture::CalculateMipSize(width, 4, 1, destination_format, 0, 0);
+            vector<std::byte>& source   = texture->GetMip(job.array_index, job.mip_index).bytes;
 
             // source texture
             CMP_Texture source_texture = {};
             source_texture.format      = to_cmp_format(texture->GetFormat());
             source_texture.dwSize      = sizeof(CMP_Texture);
-            source_texture.dwWidth     = texture->GetWidth() >> mip_index;
-            source_texture.dwHeight    = texture->GetHeight() >> mip_index;
-            source_texture.dwPitch     = source_texture.dwWidth * texture->GetBytesPerPixel();
-            source_texture.dwDataSize  = static_cast<uint32_t>(texture->GetMip(0, mip_index).bytes.size());
-            source_texture.pData       = reinterpret_cast<uint8_t*>(texture->GetMip(0, mip_index).bytes.data());
+            source_texture.dwWidth     = width;
+            source_texture.dwHeight    = job.row_end - job.row_start;
+            source_texture.dwPitch     = pitch;
+            source_texture.dwDataSize  = pitch * source_texture.dwHeight;
+            source_texture.pData       = reinterpret_cast<uint8_t*>(source.data()) + static_cast<size_t>(job.row_start) * pitch;
 
             // destination texture
             CMP_Texture destination_texture = {};
@@ -87,36 +157,89 @@ namespace Spartan
             destination_texture.dwWidth     = source_texture.dwWidth;
             destination_texture.dwHeight    = source_texture.dwHeight;
             destination_texture.dwDataSize  = CMP_CalculateBufferSize(&destination_texture);
-            vector<std::byte> destination_data(destination_texture.dwDataSize);
-            destination_texture.pData       = reinterpret_cast<uint8_t*>(destination_data.data());
+            destination_texture.pData       = reinterpret_cast<uint8_t*>(destination->data()) + (job.row_start / 4) * block_row_size;
+            SP_ASSERT((job.row_start / 4) * block_row_size + destination_texture.dwDataSize <= destination->size());
 
-            // compress texture
-            {
-                CMP_CompressOptions options = {};
-                options.dwSize              = sizeof(CMP_CompressOptions);
-                options.fquality            = 0.05f;                            // set for lower quality, faster compression
-                options.dwnumThreads        = ThreadPool::GetIdleThreadCount(); // use all free threads
-
-                CMP_ERROR result = CMP_ConvertTexture(&source_texture, &destination_texture, &options, nullptr);
-                SP_ASSERT(result == CMP_OK);
-            }
+            // jobs already cover all threads, so the compressor itself stays single threaded
+            CMP_CompressOptions options    = {};
+            options.dwSize                 = sizeof(CMP_CompressOptions);
+            options.fquality               = fquality;
+            options.dwnumThreads           = 1;
+            options.bDisableMultiThreading = true;
 
-            // update texture with compressed data
-            texture->GetMip(0, mip_index).bytes = destination_data;
+            return CMP_ConvertTexture(&source_texture, &destination_texture, &options, nullptr) == CMP_OK;
         }
 
-        void compress(RHI_Texture* texture)
+        void compress(RHI_Texture* texture, const RHI_Texture_Compression quality)
         {
             SP_ASSERT(texture != nullptr);
 
-            RHI_Format destination_format = RHI_Format::BC3_Unorm;
+            if (!compressonator::registered.exchange(true))
+            {
+                string version = to_string(AMD_COMPRESS_VERSION_MAJOR) + "." + to_string(AMD_COMPRESS_VERSION_MINOR);
+                Settings::RegisterThirdPartyLib("Compressonator", version, "https://github.com/GPUOpen-Tools/compressonator");
+            }
 
-            for (uint32_t mip_index = 0; mip_index < texture->GetMipCount(); mip_index++)
+            // the compressor only takes 8-bit rgba, anything wider (hdr) stays uncompressed
+            if (texture->GetFormat() != RHI_Format::R8G8B8A8_Unorm)
+                return;
+
+            const Stopwatch timer;
+            const Preset& preset                = get_preset(texture);
+            const bool preview                  = quality == RHI_Texture_Compression::Preview;
+            const RHI_Format destination_format = preview ? preset.format_preview  : preset.format_production;
+            const float fquality                = preview ? preset.quality_preview : preset.quality_production;
+            const uint32_t array_length         = static_cast<uint32_t>(texture->GetData().size());
+            const uint32_t mip_count            = texture->GetMipCount();
+
+            // allocate the output and split every mip of every slice into bands, so that large mips don't serialize on a single thread
+            vector<vector<std::byte>> destination(array_length * mip_count);
+            vector<Job> jobs;
+            for (uint32_t array_index = 0; array_index < array_length; array_index++)
             {
-                compress(texture, mip_index, destination_format);
+                for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+                {
+                    const uint32_t width  = max(1u, texture->GetWidth() >> mip_index);
+                    const uint32_t height = max(1u, texture->GetHeight() >> mip_index);
+                    destination[array_index * mip_count + mip_index].resize(RHI_Texture::CalculateMipSize(width, height, 1, destination_format, 0, 0));
+
+                    for (uint32_t row = 0; row < height; row += job_block_rows * 4)
+                    {
+                        jobs.push_back({ array_index, mip_index, row, min(height, row + job_block_rows * 4) });
+                    }
+                }
             }
 
+            atomic<bool> success = true;
+            ThreadPool::ParallelLoop([&](uint32_t work_index_start, uint32_t work_index_end)
+            {
+                for (uint32_t i = work_index_start; i < work_index_end; i++)
+                {
+                    const Job& job = jobs[i];
+                    if (!compress(texture, job, destination_format, fquality, &destination[job.array_index * mip_count + job.mip_index]))
+                    {
+                        success = false;
+                    }
+                }
+            }, static_cast<uint32_t>(jobs.size()));
+
+            if (!success)
+            {
+                SP_LOG_ERROR("Failed to compress \"%s\", it will remain uncompressed", texture->GetObjectName().c_str());
+                return;
+            }
+
+            // update texture with compressed data
+            for (uint32_t array_index = 0; array_index < array_length; array_index++)
+            {
+                for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+                {
+                    texture->GetMip(array_index, mip_index).bytes.swap(destination[array_index * mip_count + mip_index]);
+                }
+            }
             texture->SetFormat(destination_format);
+
+            SP_LOG_INFO("Compressed \"%s\" to %s in %.1f ms", texture->GetObjectName().c_str(), rhi_format_to_string(destination_format), timer.GetElapsedTimeMs());
         }
     }
 
@@ -173,74 +296,54 @@ namespace Spartan
 
     bool RHI_Texture::SaveToFile(const string& file_path)
     {
-        // if a file already exists, get the byte count
-        m_object_size = 0;
+        // if the data was freed after the upload, carry over the mips which are already on the drive
+        const bool has_data = HasData();
+        unique_ptr<AssetContainer> existing;
+        if (!has_data && FileSystem::Exists(file_path))
         {
-            if (FileSystem::Exists(file_path))
-            {
-                auto file = make_unique<FileStream>(file_path, FileStream_Read);
-                if (file->IsOpen())
-                {
-                    file->Read(&m_object_size);
-                }
-            }
+            // files from before the container format can't be carried over, they keep loading as they are
+            if (!AssetContainer::IsContainer(file_path))
+                return true;
+
+            existing = make_unique<AssetContainer>();
+            if (!existing->Open(file_path))
+                return false;
         }
 
-        bool append = true;
-        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
-        if (!file->IsOpen())
+        // write next to the file and swap, since the existing file may be the source of the mips
+        const string file_path_temp = file_path + ".tmp";
+        if (!WriteContainer(file_path_temp, existing.get()))
             return false;
 
-        // if the existing file has texture data but we don't, don't overwrite them
-        bool dont_overwrite_data = m_object_size != 0 && !HasData();
-        if (dont_overwrite_data)
-        {
-            file->Skip
-            (
-                sizeof(m_object_size) + // byte count
-                sizeof(m_depth)       + // array length
-                sizeof(m_mip_count)   + // mip count
-                m_object_size           // bytes
-            );
-        }
-        else
+        existing = nullptr;
+        error_code error;
+        filesystem::rename(file_path_temp, file_path, error);
+        if (error)
         {
-            ComputeMemoryUsage();
-
-            // write mip info
-            file->Write(m_object_size);
-            file->Write(m_depth);
-            file->Write(m_mip_count);
-
-            // write mip data
-            for (RHI_Texture_Slice& slice : m_slices)
-            {
-                for (RHI_Texture_Mip& mip : slice.mips)
-                {
-                    file->Write(mip.bytes);
-                }
-            }
-
-            // the bytes have been saved, so we can now free some memory
-            m_slices.clear();
-            m_slices.shrink_to_fit();
+            SP_LOG_ERROR("Failed to replace \"%s\": %s", file_path.c_str(), error.message().c_str());
+            FileSystem::Delete(file_path_temp);
+            return false;
         }
 
-        // write properties
-        file->Write(m_width);
-        file->Write(m_height);
-        file->Write(m_channel_count);
-        file->Write(m_bits_per_channel);
-        file->Write(static_cast<uint32_t>(m_type));
-        file->Write(static_cast<uint32_t>(m_format));
-        file->Write(m_flags);
-        file->Write(GetObjectId());
-        file->Write(GetResourceFilePath());
+        // the bytes have been saved, so we can now free some memory
+        m_slices.clear();
+        m_slices.shrink_to_fit();
+        m_container = nullptr;
 
         return true;
     }
 
     bool RHI_Texture::LoadFromFile(const string& file_path)
+    {
+        return Load(file_path, nullptr);
+    }
+
+    bool RHI_Texture::LoadFromContainer(const string& file_path, const shared_ptr<AssetContainer>& container)
+    {
+        return Load(file_path, container);
+    }
+
+    bool RHI_Texture::Load(const string& file_path, shared_ptr<AssetContainer> container)
     {
         m_type         = RHI_Texture_Type::Type2D;
         m_depth        = 1;
@@ -257,12 +360,20 @@ namespace Spartan
         m_slices.shrink_to_fit();
 
         bool keep_data = (m_flags & RHI_Texture_KeepData) != 0;
-        bool compress  = (m_flags & RHI_Texture_Compress) != 0;
 
         // load from drive
         {
-            if (FileSystem::IsEngineTextureFile(file_path))
+            if (container || (FileSystem::IsEngineTextureFile(file_path) && AssetContainer::IsContainer(file_path)))
+            {
+                if (!LoadContainer(file_path, false, container))
+                {
+                    SP_LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
+                    return false;
+                }
+            }
+            else if (FileSystem::IsEngineTextureFile(file_path))
             {
+                // the format from before the asset container
                 auto file = make_unique<FileStream>(file_path, FileStream_Read);
                 if (!file->IsOpen())
                 {
@@ -299,41 +410,10 @@ namespace Spartan
             }
             else if (FileSystem::IsSupportedImageFile(file_path))
             {
-                vector<string> file_paths = { file_path };
-
-                // if this is an array, try to find all the textures
-                if (m_type == RHI_Texture_Type::Type2DArray)
+                if (!Import(file_path))
                 {
-                    string file_path_extension    = FileSystem::GetExtensionFromFilePath(file_path);
-                    string file_path_no_extension = FileSystem::GetFilePathWithoutExtension(file_path);
-                    string file_path_no_digit     = file_path_no_extension.substr(0, file_path_no_extension.size() - 1);
-
-                    uint32_t index = 1;
-                    string file_path_guess = file_path_no_digit + to_string(index) + file_path_extension;
-                    while (FileSystem::Exists(file_path_guess))
-                    {
-                        file_paths.emplace_back(file_path_guess);
-                        file_path_guess = file_path_no_digit + to_string(++index) + file_path_extension;
-                    }
-                }
-
-                // load texture
-                for (uint32_t slice_index = 0; slice_index < static_cast<uint32_t>(file_paths.size()); slice_index++)
-                {
-                    if (!ImageImporterExporter::Load(file_paths[slice_index], slice_index, this))
-                    {
-                        SP_LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
-                        return false;
-                    }
-                }
-
-                // set resource file path so it can be used by the resource cache.
-                SetResourceFilePath(file_path);
-
-                // compress texture (if not alraedy compressed)
-                if (compress && !IsCompressedFormat(m_format))
-                {
-                    compressonator::compress(this);
+                    SP_LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
+                    return false;
                 }
             }
         }
@@ -343,6 +423,7 @@ namespace Spartan
         m_is_ready_for_use = true;
 
         // clear data
+        m_container = nullptr;
         if (!keep_data)
         { 
             m_slices.clear();
@@ -354,6 +435,270 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_Texture::Cook(const string& file_path, const uint32_t flags)
+    {
+        if (!FileSystem::IsSupportedImageFile(file_path))
+            return false;
+
+        // only the cpu side of the import, no gpu resource is created so this works without a device
+        RHI_Texture texture;
+        texture.m_type        = RHI_Texture_Type::Type2D;
+        texture.m_flags       = flags;
+        texture.m_object_name = FileSystem::GetFileNameFromFilePath(file_path);
+
+        return texture.Import(file_path);
+    }
+
+    void RHI_Texture::SetCompressionQuality(const RHI_Texture_Compression quality)
+    {
+        compressonator::quality = quality;
+    }
+
+    RHI_Texture_Compression RHI_Texture::GetCompressionQuality()
+    {
+        return compressonator::quality;
+    }
+
+    RHI_Format RHI_Texture::Compress(const std::byte* data, const uint32_t width, const uint32_t height, const uint32_t flags, const RHI_Texture_Compression quality, vector<std::byte>* compressed)
+    {
+        SP_ASSERT(data != nullptr && compressed != nullptr);
+
+        // only the cpu side, like Cook()
+        RHI_Texture texture;
+        texture.m_type             = RHI_Texture_Type::Type2D;
+        texture.m_width            = width;
+        texture.m_height           = height;
+        texture.m_format           = RHI_Format::R8G8B8A8_Unorm;
+        texture.m_channel_count    = 4;
+        texture.m_bits_per_channel = 8;
+        texture.m_flags            = flags;
+        texture.m_object_name      = "compression";
+        texture.CreateMip(0).bytes.assign(data, data + static_cast<size_t>(width) * height * 4);
+
+        compressonator::compress(&texture, quality);
+        if (!IsCompressedFormat(texture.m_format))
+            return RHI_Format::Max;
+
+        compressed->swap(texture.GetMip(0, 0).bytes);
+        return texture.m_format;
+    }
+
+    bool RHI_Texture::Decompress(const std::byte* data, const uint32_t width, const uint32_t height, const RHI_Format format, vector<std::byte>* decompressed)
+    {
+        SP_ASSERT(data != nullptr && decompressed != nullptr);
+        SP_ASSERT(IsCompressedFormat(format));
+
+        CMP_Texture source_texture = {};
+        source_texture.format      = compressonator::to_cmp_format(format);
+        source_texture.dwSize      = sizeof(CMP_Texture);
+        source_texture.dwWidth     = width;
+        source_texture.dwHeight    = height;
+        source_texture.dwDataSize  = CMP_CalculateBufferSize(&source_texture);
+        source_texture.pData       = reinterpret_cast<uint8_t*>(const_cast<std::byte*>(data));
+
+        decompressed->resize(static_cast<size_t>(width) * height * 4);
+        CMP_Texture destination_texture = {};
+        destination_texture.format      = CMP_FORMAT::CMP_FORMAT_RGBA_8888;
+        destination_texture.dwSize      = sizeof(CMP_Texture);
+        destination_texture.dwWidth     = width;
+        destination_texture.dwHeight    = height;
+        destination_texture.dwPitch     = width * 4;
+        destination_texture.dwDataSize  = static_cast<uint32_t>(decompressed->size());
+        destination_texture.pData       = reinterpret_cast<uint8_t*>(decompressed->data());
+
+        CMP_CompressOptions options = {};
+        options.dwSize              = sizeof(CMP_CompressOptions);
+
+        return CMP_ConvertTexture(&source_texture, &destination_texture, &options, nullptr) == CMP_OK;
+    }
+
+    bool RHI_Texture::Import(const string& file_path)
+    {
+        vector<string> file_paths = { file_path };
+
+        // if this is an array, try to find all the textures
+        if (m_type == RHI_Texture_Type::Type2DArray)
+        {
+            string file_path_extension    = FileSystem::GetExtensionFromFilePath(file_path);
+            string file_path_no_extension = FileSystem::GetFilePathWithoutExtension(file_path);
+            string file_path_no_digit     = file_path_no_extension.substr(0, file_path_no_extension.size() - 1);
+
+            uint32_t index = 1;
+            string file_path_guess = file_path_no_digit + to_string(index) + file_path_extension;
+            while (FileSystem::Exists(file_path_guess))
+            {
+                file_paths.emplace_back(file_path_guess);
+                file_path_guess = file_path_no_digit + to_string(++index) + file_path_extension;
+            }
+        }
+
+        // decoding, mip generation and compression are the slow part, so single images go through the derived data cache
+        // the key covers the source bytes and everything that shapes the output: compression, mip filtering and requested dimensions
+        const RHI_Texture_Compression quality = compressonator::quality;
+        uint64_t key = 0;
+        string file_path_derived;
+        if (file_paths.size() == 1)
+        {
+            uint64_t settings = m_flags & (RHI_Texture_Compress | RHI_Texture_Srgb | RHI_Texture_Normal | RHI_Texture_MaybeNormal);
+            settings          = DerivedDataCache::HashCombine(settings, (static_cast<uint64_t>(m_width) << 32) | m_height);
+            settings          = DerivedDataCache::HashCombine(settings, static_cast<uint64_t>(quality));
+            key               = DerivedDataCache::ComputeKey(file_path, settings, derived_data_version);
+        }
+
+        if (key != 0)
+        {
+            file_path_derived = DerivedDataCache::GetFilePath(key, EXTENSION_TEXTURE);
+            if (FileSystem::Exists(file_path_derived) && LoadContainer(file_path_derived, true))
+            {
+                SetResourceFilePath(file_path);
+                return true;
+            }
+        }
+
+        // import
+        for (uint32_t slice_index = 0; slice_index < static_cast<uint32_t>(file_paths.size()); slice_index++)
+        {
+            if (!ImageImporterExporter::Load(file_paths[slice_index], slice_index, this))
+                return false;
+        }
+
+        // set resource file path so it can be used by the resource cache.
+        SetResourceFilePath(file_path);
+
+        // compress texture (if not alraedy compressed)
+        if ((m_flags & RHI_Texture_Compress) && !IsCompressedFormat(m_format))
+        {
+            compressonator::compress(this, quality);
+        }
+
+        // store the result for next time, failing to do so only costs a re-import
+        if (key != 0)
+        {
+            const string file_path_temp = DerivedDataCache::GetTemporaryFilePath(file_path_derived);
+            if (WriteContainer(file_path_temp, nullptr))
+            {
+                DerivedDataCache::Commit(file_path_temp, file_path_derived);
+            }
+            else
+            {
+                FileSystem::Delete(file_path_temp);
+            }
+        }
+
+        return true;
+    }
+
+    bool RHI_Texture::LoadContainer(const string& file_path, const bool is_derived, shared_ptr<AssetContainer> container)
+    {
+        if (!container)
+        {
+            container = make_shared<AssetContainer>();
+            if (!container->Open(file_path))
+                return false;
+        }
+
+        TextureProperties properties;
+        if (!container->ReadChunk(chunk_properties, 0, &properties))
+            return false;
+
+        // read properties
+        m_width            = properties.width;
+        m_height           = properties.height;
+        m_depth            = properties.depth;
+        m_mip_count        = properties.mip_count;
+        m_channel_count    = properties.channel_count;
+        m_bits_per_channel = properties.bits_per_channel;
+        m_type             = static_cast<RHI_Texture_Type>(properties.type);
+        m_format           = static_cast<RHI_Format>(properties.format);
+
+        // derived data is shared by every texture made from the same source, so it only
+        // contributes what the import deduced from the image, the identity stays with the texture
+        if (is_derived)
+        {
+            m_flags |= properties.flags & (RHI_Texture_Greyscale | RHI_Texture_Transparent | RHI_Texture_Srgb | RHI_Texture_Normal);
+        }
+        else
+        {
+            m_flags = properties.flags;
+            SetObjectId(properties.object_id);
+
+            string resource_file_path;
+            container->ReadChunk(chunk_path, 0, &resource_file_path);
+            SetResourceFilePath(resource_file_path);
+        }
+
+        // the mips are uploaded straight from the mapped file, unless the cpu needs to keep them around
+        if (m_flags & RHI_Texture_KeepData)
+        {
+            m_slices.resize(m_depth);
+            for (uint32_t array_index = 0; array_index < m_depth; array_index++)
+            {
+                m_slices[array_index].mips.resize(m_mip_count);
+                for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
+                {
+                    uint64_t size         = 0;
+                    const std::byte* data = container->GetChunkData(chunk_mip, array_index * m_mip_count + mip_index, &size);
+                    if (data)
+                    {
+                        m_slices[array_index].mips[mip_index].bytes.assign(data, data + size);
+                    }
+                }
+            }
+        }
+        else
+        {
+            m_container = container;
+        }
+
+        return true;
+    }
+
+    bool RHI_Texture::WriteContainer(const string& file_path, AssetContainer* existing)
+    {
+        const bool has_data = HasData();
+
+        TextureProperties properties;
+        properties.width            = m_width;
+        properties.height           = m_height;
+        properties.depth            = m_depth;
+        properties.mip_count        = m_mip_count;
+        properties.channel_count    = m_channel_count;
+        properties.bits_per_channel = m_bits_per_channel;
+        properties.type             = static_cast<uint32_t>(m_type);
+        properties.format           = static_cast<uint32_t>(m_format);
+        properties.flags            = m_flags;
+        properties.object_id        = GetObjectId();
+
+        AssetContainerWriter writer;
+        writer.AddChunk(chunk_properties, 0, &properties, sizeof(properties));
+        writer.AddChunk(chunk_path, 0, GetResourceFilePath());
+
+        for (uint32_t array_index = 0; array_index < m_depth; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
+            {
+                const uint32_t chunk_index = array_index * m_mip_count + mip_index;
+
+                if (has_data)
+                {
+                    span<const std::byte> data = GetMipData(array_index, mip_index);
+                    writer.AddChunk(chunk_mip, chunk_index, data.data(), data.size());
+                }
+                else if (existing)
+                {
+                    uint64_t size         = 0;
+                    const std::byte* data = existing->GetChunkData(chunk_mip, chunk_index, &size);
+                    if (data)
+                    {
+                        writer.AddChunk(chunk_mip, chunk_index, data, size);
+                    }
+                }
+            }
+        }
+
+        return writer.Write(file_path);
+    }
+
     RHI_Texture_Mip& RHI_Texture::CreateMip(const uint32_t array_index)
     {
         // ensure there's room for the new array index
@@ -395,6 +740,22 @@ namespace Spartan
         return m_slices[array_index].mips[mip_index];
     }
 
+    span<const std::byte> RHI_Texture::GetMipData(const uint32_t array_index, const uint32_t mip_index)
+    {
+        if (array_index < m_slices.size() && mip_index < m_slices[array_index].mips.size() && !m_slices[array_index].mips[mip_index].bytes.empty())
+            return m_slices[array_index].mips[mip_index].bytes;
+
+        if (m_container)
+        {
+            uint64_t size         = 0;
+            const std::byte* data = m_container->GetChunkData(chunk_mip, array_index * m_mip_count + mip_index, &size);
+            if (data)
+                return span<const std::byte>(data, static_cast<size_t>(size));
+        }
+
+        return {};
+    }
+
     RHI_Texture_Slice& RHI_Texture::GetSlice(const uint32_t array_index)
     {
         static RHI_Texture_Slice empty;
@@ -407,7 +768,7 @@ namespace Spartan
 
     void RHI_Texture::ComputeMemoryUsage()
     {
-        m_object_size = 0;
+        uint64_t size = 0;
 
         for (uint32_t array_index = 0; array_index < m_depth; array_index++)
         {
@@ -417,9 +778,11 @@ namespace Spartan
                 const uint32_t mip_height = max(1u, m_height >> mip_index);
                 const uint32_t mip_depth  = (GetType() == RHI_Texture_Type::Type3D) ? (m_depth  >> mip_index) : 1;
 
-                m_object_size += CalculateMipSize(mip_width, mip_height, m_depth, m_format, m_bits_per_channel, m_channel_count);
+                size += CalculateMipSize(mip_width, mip_height, m_depth, m_format, m_bits_per_channel, m_channel_count);
             }
         }
+
+        SetResourceSize(size);
     }
 
     void RHI_Texture::SetLayout(const RHI_Image_Layout new_layout, RHI_CommandList* cmd_list, uint32_t mip_index /*= all_mips*/, uint32_t mip_range /*= 0*/)
@@ -486,6 +849,7 @@ namespace Spartan
         return
             format == RHI_Format::BC1_Unorm ||
             format == RHI_Format::BC3_Unorm ||
+            format == RHI_Format::BC4_Unorm ||
             format == RHI_Format::BC5_Unorm ||
             format == RHI_Format::BC7_Unorm ||
             format == RHI_Format::ASTC;
@@ -505,6 +869,7 @@ namespace Spartan
             switch (format)
             {
             case RHI_Format::BC1_Unorm:
+            case RHI_Format::BC4_Unorm:
                 block_size = 8;
                 break;
             case RHI_Format::BC3_Unorm:
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <array>
+#include <span>
 #include "RHI_Viewport.h"
 #include "RHI_Definitions.h"
 #include "../Resource/IResource.h"
@@ -30,6 +31,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class AssetContainer;
+
     enum class RHI_Texture_Type
     {
         Type2D,
@@ -53,7 +56,15 @@ namespace Spartan
         RHI_Texture_Mappable       = 1U << 9,
         RHI_Texture_KeepData       = 1U << 10,
         RHI_Texture_Compress       = 1U << 11,
-        RHI_Texture_ExternalMemory = 1U << 12
+        RHI_Texture_ExternalMemory = 1U << 12,
+        RHI_Texture_Normal         = 1U << 13,
+        RHI_Texture_MaybeNormal    = 1U << 14  // a height map, unless the image has color, some models pass their normal maps as height maps
+    };
+
+    enum class RHI_Texture_Compression
+    {
+        Preview,   // fast and lower quality, for iterating on assets
+        Production // slow and high quality, for shipping
     };
 
     struct RHI_Texture_Mip
@@ -87,10 +98,11 @@ namespace Spartan
         RHI_Texture();
         ~RHI_Texture();
 
-        //= IResource ===========================================
+        //= IResource ==========================================================================================================
         bool SaveToFile(const std::string& file_path) override;
         bool LoadFromFile(const std::string& file_path) override;
-        //=======================================================
+        bool LoadFromContainer(const std::string& file_path, const std::shared_ptr<AssetContainer>& container) override;
+        //======================================================================================================================
 
         uint32_t GetWidth()                                const { return m_width; }
         void SetWidth(const uint32_t width)                      { m_width = width; }
@@ -118,14 +130,27 @@ namespace Spartan
         static bool IsCompressedFormat(const RHI_Format format);
         static size_t CalculateMipSize(uint32_t width, uint32_t height, uint32_t depth, RHI_Format format, uint32_t bits_per_channel, uint32_t channel_count);
 
+        // imports an image into the derived data cache without creating a gpu resource, used by the cooker
+        static bool Cook(const std::string& file_path, const uint32_t flags);
+
+        // compression quality for textures which are imported from now on
+        static void SetCompressionQuality(const RHI_Texture_Compression quality);
+        static RHI_Texture_Compression GetCompressionQuality();
+
+        // compresses an 8-bit rgba image with the preset an import with these flags would use, and decompresses it back to 8-bit rgba
+        // imports don't need either, they are here so that the presets can be measured without a device
+        static RHI_Format Compress(const std::byte* data, const uint32_t width, const uint32_t height, const uint32_t flags, const RHI_Texture_Compression quality, std::vector<std::byte>* compressed);
+        static bool Decompress(const std::byte* data, const uint32_t width, const uint32_t height, const RHI_Format format, std::vector<std::byte>* decompressed);
+
         // data
         uint32_t GetMipCount()                    const { return m_mip_count; }
         uint32_t GetDepth()                       const { return m_depth; }
-        bool HasData()                            const { return !m_slices.empty() && !m_slices[0].mips.empty() && !m_slices[0].mips[0].bytes.empty(); };
+        bool HasData()                            const { return (!m_slices.empty() && !m_slices[0].mips.empty() && !m_slices[0].mips[0].bytes.empty()) || m_container; };
         std::vector<RHI_Texture_Slice>& GetData()       { return m_slices; }
         RHI_Texture_Mip& CreateMip(const uint32_t array_index);
         RHI_Texture_Mip& GetMip(const uint32_t array_index, const uint32_t mip_index);
         RHI_Texture_Slice& GetSlice(const uint32_t array_index);
+        std::span<const std::byte> GetMipData(const uint32_t array_index, const uint32_t mip_index); // owned bytes, or a view into the file the texture was loaded from
 
         // flags
         bool IsSrv()             const { return m_flags & RHI_Texture_Srv; }
@@ -138,6 +163,7 @@ namespace Spartan
         bool IsGrayscale()       const { return m_flags & RHI_Texture_Greyscale; }
         bool IsSemiTransparent() const { return m_flags & RHI_Texture_Transparent; }
         bool HasExternalMemory() const { return m_flags & RHI_Texture_ExternalMemory; }
+        bool IsNormalMap()       const { return m_flags & RHI_Texture_Normal; }
 
         // format type
         bool IsDepthFormat()        const { return m_format == RHI_Format::D16_Unorm || m_format == RHI_Format::D32_Float || m_format == RHI_Format::D32_Float_S8X24_Uint; }
@@ -176,6 +202,7 @@ namespace Spartan
         RHI_Texture_Type m_type     = RHI_Texture_Type::Max;
         RHI_Viewport m_viewport;
         std::vector<RHI_Texture_Slice> m_slices;
+        std::shared_ptr<AssetContainer> m_container; // mapped file whose mips are uploaded in place, released after the upload
         std::array<RHI_Image_Layout, rhi_max_mip_count> m_layout = { RHI_Image_Layout::Max };
 
         // api resources
@@ -189,5 +216,9 @@ namespace Spartan
 
     private:
         void ComputeMemoryUsage();
+        bool Load(const std::string& file_path, std::shared_ptr<AssetContainer> container); // without a container, an engine texture file is opened here
+        bool Import(const std::string& file_path);
+        bool LoadContainer(const std::string& file_path, const bool is_derived, std::shared_ptr<AssetContainer> container = nullptr);
+        bool WriteContainer(const std::string& file_path, AssetContainer* existing);
     };
 }
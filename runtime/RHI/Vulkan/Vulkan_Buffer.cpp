@@ -138,5 +138,35 @@ namespace Spartan
             reinterpret_cast<std::byte*>(data_cpu),              // source
             size != 0 ? size : m_stride                          // size
         );
-    } 
+    }
+
+    void RHI_Buffer::UpdateRange(const void* data_cpu, const uint64_t offset, const uint64_t size)
+    {
+        SP_ASSERT_MSG(data_cpu != nullptr,              "Invalid cpu data");
+        SP_ASSERT_MSG(offset + size <= m_object_size,   "Out of memory");
+
+        if (size == 0)
+            return;
+
+        if (m_mappable)
+        {
+            memcpy(reinterpret_cast<std::byte*>(m_data_gpu) + offset, data_cpu, size);
+            return;
+        }
+
+        // device local, so go through a staging buffer which is only as big as the range
+        void* staging_buffer = nullptr;
+        RHI_Device::MemoryBufferCreate(staging_buffer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, data_cpu, m_object_name.c_str());
+
+        VkBuffer* buffer_vk         = reinterpret_cast<VkBuffer*>(&m_rhi_resource);
+        VkBuffer* buffer_staging_vk = reinterpret_cast<VkBuffer*>(&staging_buffer);
+        VkBufferCopy copy_region    = {};
+        copy_region.srcOffset       = 0;
+        copy_region.dstOffset       = offset;
+        copy_region.size            = size;
+        RHI_CommandList* cmd_list   = RHI_Device::CmdImmediateBegin(RHI_Queue_Type::Copy);
+        vkCmdCopyBuffer(static_cast<VkCommandBuffer>(cmd_list->GetRhiResource()), *buffer_staging_vk, *buffer_vk, 1, &copy_region);
+        RHI_Device::CmdImmediateSubmit(cmd_list);
+        RHI_Device::MemoryBufferDestroy(staging_buffer);
+    }
 }
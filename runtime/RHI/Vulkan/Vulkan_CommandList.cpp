@@ -960,7 +960,7 @@ namespace Spartan
         }
     }
 
-    void RHI_CommandList::Draw(const uint32_t vertex_count, const uint32_t vertex_start_index /*= 0*/)
+    void RHI_CommandList::Draw(const uint32_t vertex_count, const uint32_t vertex_start_index /*= 0*/, const uint32_t instance_start_index /*= 0*/, const uint32_t instance_count /*= 1*/)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
 
@@ -969,9 +969,9 @@ namespace Spartan
         vkCmdDraw(
             static_cast<VkCommandBuffer>(m_rhi_resource), // commandBuffer
             vertex_count,                                 // vertexCount
-            1,                                            // instanceCount
+            instance_count,                               // instanceCount
             vertex_start_index,                           // firstVertex
-            0                                             // firstInstance
+            instance_start_index                          // firstInstance
         );
         Profiler::m_rhi_draw++;
     }
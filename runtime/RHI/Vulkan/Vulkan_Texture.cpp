@@ -105,6 +105,14 @@ namespace Spartan
             create_info.components.b                    = VK_COMPONENT_SWIZZLE_IDENTITY;
             create_info.components.a                    = VK_COMPONENT_SWIZZLE_IDENTITY;
 
+            // single channel compressed textures come from greyscale images, so broadcast red to keep them reading like the rgba source did
+            if (texture->GetFormat() == RHI_Format::BC4_Unorm)
+            {
+                create_info.components.g = VK_COMPONENT_SWIZZLE_R;
+                create_info.components.b = VK_COMPONENT_SWIZZLE_R;
+                create_info.components.a = VK_COMPONENT_SWIZZLE_ONE;
+            }
+
             SP_ASSERT_MSG(vkCreateImageView(RHI_Context::device, &create_info, nullptr, reinterpret_cast<VkImageView*>(&image_view)) == VK_SUCCESS, "Failed to create image view");
         }
 
@@ -208,9 +216,10 @@ namespace Spartan
                         uint32_t mip_depth  = (texture->GetType() == RHI_Texture_Type::Type3D) ? (depth >> mip_index) : 1;
                         size_t size = RHI_Texture::CalculateMipSize(mip_width, mip_height, mip_depth, texture->GetFormat(), texture->GetBitsPerChannel(), texture->GetChannelCount());
 
-                        if (texture->GetMip(array_index, mip_index).bytes.size() != 0)
+                        span<const std::byte> data = texture->GetMipData(array_index, mip_index);
+                        if (data.size() != 0)
                         {
-                            memcpy(static_cast<std::byte*>(mapped_data) + buffer_offset, texture->GetMip(array_index, mip_index).bytes.data(), size);
+                            memcpy(static_cast<std::byte*>(mapped_data) + buffer_offset, data.data(), min(size, data.size()));
                         }
 
                         buffer_offset += size;
@@ -293,6 +302,7 @@ namespace Spartan
         if (HasData())
         {
             stage(this);
+            m_container = nullptr;
             if ((m_flags & RHI_Texture_KeepData) == 0)
             { 
                 m_slices.clear();
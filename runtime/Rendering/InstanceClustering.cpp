@@ -0,0 +1,245 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ================
+#include "pch.h"
+#include "InstanceClustering.h"
+//===========================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan::instance_clustering
+{
+    namespace
+    {
+        // 16 bits per axis gives 65536 cells per axis at the finest level, enough for any world
+        const uint32_t bits_per_axis = 16;
+
+        uint64_t spread_bits(uint64_t value)
+        {
+            // inserts two zero bits between each of the lower 21 bits
+            value &= 0x1fffff;
+            value  = (value | value << 32) & 0x1f00000000ffff;
+            value  = (value | value << 16) & 0x1f0000ff0000ff;
+            value  = (value | value << 8)  & 0x100f00f00f00f00f;
+            value  = (value | value << 4)  & 0x10c30c30c30c30c3;
+            value  = (value | value << 2)  & 0x1249249249249249;
+            return value;
+        }
+
+        uint64_t morton_code(const uint32_t x, const uint32_t y, const uint32_t z)
+        {
+            return spread_bits(x) | (spread_bits(y) << 1) | (spread_bits(z) << 2);
+        }
+
+        // lsd radix sort on 8 bit digits, passes where every key has the same digit are skipped
+        void radix_sort(vector<uint64_t>& keys, vector<uint32_t>& values)
+        {
+            const size_t count = keys.size();
+            vector<uint64_t> keys_temp(count);
+            vector<uint32_t> values_temp(count);
+
+            const uint32_t key_bits = bits_per_axis * 3;
+            for (uint32_t shift = 0; shift < key_bits; shift += 8)
+            {
+                size_t histogram[256] = {};
+                for (size_t i = 0; i < count; i++)
+                {
+                    histogram[(keys[i] >> shift) & 0xff]++;
+                }
+
+                if (histogram[(keys[0] >> shift) & 0xff] == count)
+                    continue;
+
+                size_t offset = 0;
+                for (size_t& bucket : histogram)
+                {
+                    const size_t bucket_count = bucket;
+                    bucket  = offset;
+                    offset += bucket_count;
+                }
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    const size_t destination   = histogram[(keys[i] >> shift) & 0xff]++;
+                    keys_temp[destination]     = keys[i];
+                    values_temp[destination]   = values[i];
+                }
+
+                keys.swap(keys_temp);
+                values.swap(values_temp);
+            }
+        }
+
+        // splits [begin, end) along the implicit octree of the sorted codes, level is the number of unresolved bits per axis
+        void split(const vector<uint64_t>& codes, const uint32_t begin, const uint32_t end, const uint32_t level, vector<uint32_t>& group_end_indices)
+        {
+            if (end - begin <= group_size_target)
+            {
+                group_end_indices.push_back(end);
+                return;
+            }
+
+            // instances that share the finest cell can't be told apart spatially, chunk them
+            if (level == 0)
+            {
+                for (uint32_t i = begin + group_size_target; i < end; i += group_size_target)
+                {
+                    group_end_indices.push_back(i);
+                }
+                group_end_indices.push_back(end);
+                return;
+            }
+
+            // the children of this cell are contiguous since the codes are sorted
+            // small sibling cells are merged so that sparse areas don't produce a lot of tiny groups
+            const uint32_t shift = 3 * (level - 1);
+            uint32_t pending_begin = begin;
+            uint32_t i             = begin;
+            while (i < end)
+            {
+                const uint64_t child = (codes[i] >> shift) & 7;
+                uint32_t child_end   = i;
+                while (child_end < end && ((codes[child_end] >> shift) & 7) == child)
+                {
+                    child_end++;
+                }
+
+                if (child_end - i > group_size_target)
+                {
+                    if (pending_begin != i)
+                    {
+                        group_end_indices.push_back(i);
+                    }
+
+                    split(codes, i, child_end, level - 1, group_end_indices);
+                    pending_begin = child_end;
+                }
+                else if (child_end - pending_begin > group_size_target)
+                {
+                    group_end_indices.push_back(i);
+                    pending_begin = i;
+                }
+
+                i = child_end;
+            }
+
+            if (pending_begin != end)
+            {
+                group_end_indices.push_back(end);
+            }
+        }
+    }
+
+    void cluster(vector<Matrix>& instances, vector<uint32_t>& group_end_indices)
+    {
+        group_end_indices.clear();
+
+        const uint32_t count = static_cast<uint32_t>(instances.size());
+        if (count == 0)
+            return;
+
+        if (count <= group_size_target)
+        {
+            group_end_indices.push_back(count);
+            return;
+        }
+
+        // bounds of the instance positions
+        BoundingBox bounds;
+        for (const Matrix& instance : instances)
+        {
+            const Vector3 position = instance.GetTranslation();
+            bounds.Merge(BoundingBox(position, position));
+        }
+
+        // quantize relative to the minimum, so negative coordinates don't wrap, cells are cubic
+        const Vector3 size       = bounds.GetSize();
+        const float extent       = Helper::Max(size.x, Helper::Max(size.y, size.z));
+        const float cell_max     = static_cast<float>((1u << bits_per_axis) - 1);
+        const float scale        = extent > 0.0f ? cell_max / extent : 0.0f;
+        const Vector3& bound_min = bounds.GetMin();
+
+        vector<uint64_t> codes(count);
+        vector<uint32_t> order(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Vector3 cell = (instances[i].GetTranslation() - bound_min) * scale;
+            codes[i] = morton_code(
+                static_cast<uint32_t>(Helper::Clamp(cell.x, 0.0f, cell_max)),
+                static_cast<uint32_t>(Helper::Clamp(cell.y, 0.0f, cell_max)),
+                static_cast<uint32_t>(Helper::Clamp(cell.z, 0.0f, cell_max))
+            );
+            order[i] = i;
+        }
+
+        radix_sort(codes, order);
+        split(codes, 0, count, bits_per_axis, group_end_indices);
+
+        // reorder the instances
+        vector<Matrix> instances_sorted(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            instances_sorted[i] = instances[order[i]];
+        }
+        instances.swap(instances_sorted);
+    }
+
+    BoundingBox compute_group_bounds(
+        const vector<BoundingBox>& instance_bounds,
+        const vector<uint32_t>& group_end_indices,
+        vector<BoundingBox>& group_bounds,
+        const uint32_t dirty_start,
+        const uint32_t dirty_end
+    )
+    {
+        BoundingBox bounds = BoundingBox::Undefined;
+
+        // groups that didn't exist before have to be merged regardless of the dirty range
+        const size_t group_count_previous = group_bounds.size();
+        group_bounds.resize(group_end_indices.size());
+
+        uint32_t start_index = 0;
+        for (size_t group_index = 0; group_index < group_end_indices.size(); group_index++)
+        {
+            const uint32_t end_index  = group_end_indices[group_index];
+            BoundingBox& bounds_group = group_bounds[group_index];
+
+            const bool dirty = group_index >= group_count_previous || (start_index < dirty_end && end_index > dirty_start);
+            if (dirty)
+            {
+                bounds_group = BoundingBox::Undefined;
+                for (uint32_t i = start_index; i < end_index; i++)
+                {
+                    bounds_group.Merge(instance_bounds[i]);
+                }
+            }
+
+            bounds.Merge(bounds_group);
+            start_index = end_index;
+        }
+
+        return bounds;
+    }
+}
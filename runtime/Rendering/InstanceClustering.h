@@ -0,0 +1,50 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include "../Math/BoundingBox.h"
+#include "../Math/Matrix.h"
+//===============================
+
+namespace Spartan::instance_clustering
+{
+    // groups instances into spatially compact clusters so that they can be culled (and drawn) per group
+    // positions are quantized into morton codes, radix sorted, and the resulting implicit octree is split
+    // until every group holds at most group_size_target instances, so dense areas get small cells and sparse areas big ones
+
+    const uint32_t group_size_target = 512;
+
+    // reorders the instances so that each group is contiguous, group_end_indices receives the (exclusive) end index of every group
+    void cluster(std::vector<Math::Matrix>& instances, std::vector<uint32_t>& group_end_indices);
+
+    // merges the bounds of the instances of each group, returns the bounds of all the groups together
+    // only groups which overlap [dirty_start, dirty_end) are re-merged, the rest of group_bounds is assumed to be up to date
+    Math::BoundingBox compute_group_bounds(
+        const std::vector<Math::BoundingBox>& instance_bounds,
+        const std::vector<uint32_t>& group_end_indices,
+        std::vector<Math::BoundingBox>& group_bounds,
+        const uint32_t dirty_start = 0,
+        const uint32_t dirty_end   = std::numeric_limits<uint32_t>::max()
+    );
+}
@@ -135,13 +135,13 @@ namespace Spartan
             // If there is not texture (it's not loaded yet), load it
             if (!texture)
             {
-                texture = ResourceCache::Load<RHI_Texture>(tex_path);
+                texture = ResourceCache::Load<RHI_Texture>(tex_path, GetTextureImportFlags(tex_type));
             }
 
             SetTexture(tex_type, texture);
         }
 
-        m_object_size = sizeof(*this);
+        SetResourceSize(sizeof(*this));
 
         return true;
     }
@@ -219,7 +219,7 @@ namespace Spartan
 
     void Material::SetTexture(const MaterialTexture texture_type, const string& file_path)
     {
-        SetTexture(texture_type, ResourceCache::Load<RHI_Texture>(file_path, RHI_Texture_Srv));
+        SetTexture(texture_type, ResourceCache::Load<RHI_Texture>(file_path, RHI_Texture_Srv | GetTextureImportFlags(texture_type)));
     }
  
     bool Material::HasTexture(const string& path) const
@@ -288,6 +288,27 @@ namespace Spartan
         return max<uint32_t>(*max_element(begin(max_index), end(max_index)), 1);
     }
 
+    uint32_t Material::GetTextureImportFlags(const MaterialTexture texture_type)
+    {
+        uint32_t flags = 0;
+
+        const uint32_t type_index = static_cast<uint32_t>(texture_type) / material_texture_slots_per_type * material_texture_slots_per_type;
+        if (type_index == static_cast<uint32_t>(MaterialTexture::Color) || type_index == static_cast<uint32_t>(MaterialTexture::Emission))
+        {
+            flags |= RHI_Texture_Srgb;
+        }
+        else if (type_index == static_cast<uint32_t>(MaterialTexture::Normal))
+        {
+            flags |= RHI_Texture_Normal;
+        }
+        else if (type_index == static_cast<uint32_t>(MaterialTexture::Height))
+        {
+            flags |= RHI_Texture_MaybeNormal;
+        }
+
+        return flags;
+    }
+
     void Material::SetProperty(const MaterialProperty property_type, float value)
     {
         if (m_properties[static_cast<uint32_t>(property_type)] == value)
@@ -112,6 +112,9 @@ namespace Spartan
         RHI_Texture* GetTexture(const MaterialTexture texture_type);
         uint32_t GetArraySize();
 
+        // how a texture of this type should be mipped when imported, colors are filtered in linear space and normals are renormalized
+        static uint32_t GetTextureImportFlags(const MaterialTexture texture_type);
+
         // index of refraction
         static float EnumToIor(const MaterialIor ior);
         static MaterialIor IorToEnum(const float ior);
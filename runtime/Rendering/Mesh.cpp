@@ -28,7 +28,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Entity.h"
 #include "../Resource/ResourceCache.h"
 #include "../IO/FileStream.h"
+#include "../IO/AssetContainer.h"
 #include "../Resource/Import/ModelImporter.h"
+#include "../Physics/MeshShapeCache.h"
 SP_WARNINGS_OFF
 #include "meshoptimizer/meshoptimizer.h"
 SP_WARNINGS_ON
@@ -41,6 +43,13 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    namespace
+    {
+        const uint32_t chunk_path     = asset_chunk_id("PATH");
+        const uint32_t chunk_indices  = asset_chunk_id("MIDX");
+        const uint32_t chunk_vertices = asset_chunk_id("MVTX");
+    }
+
     Mesh::Mesh() : IResource(ResourceType::Mesh)
     {
         m_flags = GetDefaultFlags();
@@ -48,20 +57,57 @@ namespace Spartan
 
     Mesh::~Mesh()
     {
+        MeshShapeCache::Invalidate(this);
+
         m_index_buffer  = nullptr;
         m_vertex_buffer = nullptr;
     }
 
     void Mesh::Clear()
     {
+        // collision shapes reference the geometry, so they have to let go of it before it changes
+        MeshShapeCache::Invalidate(this);
+
         m_indices.clear();
         m_indices.shrink_to_fit();
 
         m_vertices.clear();
         m_vertices.shrink_to_fit();
+
+        ClearTriangleBvhs();
+    }
+
+    bool Mesh::LoadGeometry(const string& file_path)
+    {
+        AssetContainer container;
+        vector<uint32_t> indices;
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        if (!container.Open(file_path) ||
+            !container.ReadChunk(chunk_indices, 0, &indices) ||
+            !container.ReadChunk(chunk_vertices, 0, &vertices))
+            return false;
+
+        lock_guard lock_indices(m_mutex_indices);
+        lock_guard lock_vertices(m_mutex_vertices);
+        MeshShapeCache::Invalidate(this);
+        m_indices  = move(indices);
+        m_vertices = move(vertices);
+        ClearTriangleBvhs();
+
+        return true;
     }
 
     bool Mesh::LoadFromFile(const string& file_path)
+    {
+        return Load(file_path, nullptr);
+    }
+
+    bool Mesh::LoadFromContainer(const string& file_path, const shared_ptr<AssetContainer>& container)
+    {
+        return Load(file_path, container.get());
+    }
+
+    bool Mesh::Load(const string& file_path, AssetContainer* container)
     {
         const Stopwatch timer;
 
@@ -75,13 +121,35 @@ namespace Spartan
         if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_MODEL)
         {
             // deserialize
-            auto file = make_unique<FileStream>(file_path, FileStream_Read);
-            if (!file->IsOpen())
-                return false;
+            if (container || AssetContainer::IsContainer(file_path))
+            {
+                AssetContainer container_opened;
+                if (!container)
+                {
+                    if (!container_opened.Open(file_path))
+                        return false;
+
+                    container = &container_opened;
+                }
+
+                string resource_file_path;
+                if (!container->ReadChunk(chunk_path, 0, &resource_file_path) ||
+                    !container->ReadChunk(chunk_indices, 0, &m_indices) ||
+                    !container->ReadChunk(chunk_vertices, 0, &m_vertices))
+                    return false;
+
+                SetResourceFilePath(resource_file_path);
+            }
+            else // the format from before the asset container
+            {
+                auto file = make_unique<FileStream>(file_path, FileStream_Read);
+                if (!file->IsOpen())
+                    return false;
 
-            SetResourceFilePath(file->ReadAs<string>());
-            file->Read(&m_indices);
-            file->Read(&m_vertices);
+                SetResourceFilePath(file->ReadAs<string>());
+                file->Read(&m_indices);
+                file->Read(&m_vertices);
+            }
 
             //Optimize();
             ComputeAabb();
@@ -101,8 +169,7 @@ namespace Spartan
         {
             if (m_vertex_buffer && m_index_buffer)
             {
-                m_object_size = m_vertex_buffer->GetObjectSize();
-                m_object_size += m_index_buffer->GetObjectSize();
+                SetResourceSize(m_vertex_buffer->GetObjectSize() + m_index_buffer->GetObjectSize());
             }
         }
 
@@ -113,17 +180,12 @@ namespace Spartan
 
     bool Mesh::SaveToFile(const string& file_path)
     {
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
-        if (!file->IsOpen())
-            return false;
-
-        file->Write(GetResourceFilePath());
-        file->Write(m_indices);
-        file->Write(m_vertices);
+        AssetContainerWriter writer;
+        writer.AddChunk(chunk_path,     0, GetResourceFilePath());
+        writer.AddChunk(chunk_indices,  0, m_indices);
+        writer.AddChunk(chunk_vertices, 0, m_vertices);
 
-        file->Close();
-
-        return true;
+        return writer.Write(file_path);
     }
 
     uint32_t Mesh::GetMemoryUsage() const
@@ -167,7 +229,10 @@ namespace Spartan
             *vertex_offset_out = static_cast<uint32_t>(m_vertices.size());
         }
 
+        // appending can move the existing vertices
+        MeshShapeCache::Invalidate(this);
         m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+        ClearTriangleBvhs();
     }
 
     void Mesh::AddIndices(const vector<uint32_t>& indices, uint32_t* index_offset_out /*= nullptr*/)
@@ -179,7 +244,9 @@ namespace Spartan
             *index_offset_out = static_cast<uint32_t>(m_indices.size());
         }
 
+        MeshShapeCache::Invalidate(this);
         m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+        ClearTriangleBvhs();
     }
 
     uint32_t Mesh::GetVertexCount() const
@@ -247,9 +314,41 @@ namespace Spartan
         }
 
         // store the updated data back to member variables
+        MeshShapeCache::Invalidate(this);
         m_indices  = move(indices);
         m_vertices = move(vertices);
+        ClearTriangleBvhs();
     }
+
+    float Mesh::HitDistance(const Ray& ray, const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset)
+    {
+        // the cpu data can be released after the gpu buffers are created (e.g. terrain)
+        if (index_count == 0 || m_indices.size() < index_offset + index_count || vertex_offset >= m_vertices.size())
+            return Helper::INFINITY_;
+
+        const RHI_Vertex_PosTexNorTan* vertices = &m_vertices[vertex_offset];
+        const uint32_t* indices                 = &m_indices[index_offset];
+
+        lock_guard lock(m_mutex_triangle_bvhs);
+
+        // sub-meshes share the same buffers, so each range gets its own bvh, built on first use
+        const uint64_t key = (static_cast<uint64_t>(index_offset) << 32) | vertex_offset;
+        unique_ptr<TriangleBvh>& bvh = m_triangle_bvhs[key];
+        if (!bvh)
+        {
+            bvh = make_unique<TriangleBvh>();
+            bvh->Build(vertices, indices, index_count - index_count % 3);
+        }
+
+        return bvh->HitDistance(ray, vertices, indices);
+    }
+
+    void Mesh::ClearTriangleBvhs()
+    {
+        lock_guard lock(m_mutex_triangle_bvhs);
+        m_triangle_bvhs.clear();
+    }
+
     void Mesh::CreateGpuBuffers()
     {
         m_vertex_buffer = make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex,
@@ -298,7 +397,7 @@ namespace Spartan
         else // if we didn't get a texture, it's not cached, hence we have to load it and cache it now
         {
             // load texture
-            texture = ResourceCache::Load<RHI_Texture>(file_path, RHI_Texture_Srv | RHI_Texture_Compress);
+            texture = ResourceCache::Load<RHI_Texture>(file_path, RHI_Texture_Srv | RHI_Texture_Compress | Material::GetTextureImportFlags(texture_type));
 
             // set the texture to the provided material
             material->SetTexture(texture_type, texture);
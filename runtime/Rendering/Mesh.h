@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Material.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/TriangleBvh.h"
 #include "../RHI/RHI_Vertex.h"
 //================================
 
@@ -62,10 +63,12 @@ namespace Spartan
 
         // iresource
         bool LoadFromFile(const std::string& file_path) override;
+        bool LoadFromContainer(const std::string& file_path, const std::shared_ptr<AssetContainer>& container) override;
         bool SaveToFile(const std::string& file_path) override;
 
         // geometry
         void Clear();
+        bool LoadGeometry(const std::string& file_path); // replaces the indices and vertices with the ones in an engine mesh file
         void GetGeometry(
             uint32_t indexOffset,
             uint32_t indexCount,
@@ -92,6 +95,9 @@ namespace Spartan
         const Math::BoundingBox& GetAabb() const { return m_aabb; }
         void ComputeAabb();
 
+        // ray intersection against a sub-range of the geometry, the ray is in the mesh's local space
+        float HitDistance(const Math::Ray& ray, const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset);
+
         // gpu buffers
         void CreateGpuBuffers();
         RHI_Buffer* GetIndexBuffer()  { return m_index_buffer.get();  }
@@ -114,6 +120,8 @@ namespace Spartan
         void AddTexture(std::shared_ptr<Material>& material, MaterialTexture texture_type, const std::string& file_path, bool is_gltf);
 
     private:
+        bool Load(const std::string& file_path, AssetContainer* container); // without a container, an engine mesh file is opened here
+
         // geometry
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices;
         std::vector<uint32_t> m_indices;
@@ -125,9 +133,14 @@ namespace Spartan
         // aabb
         Math::BoundingBox m_aabb;
 
+        // triangle bvhs, keyed by index and vertex offset
+        void ClearTriangleBvhs();
+        std::unordered_map<uint64_t, std::unique_ptr<Math::TriangleBvh>> m_triangle_bvhs;
+
         // sync primitives
         std::mutex m_mutex_indices;
         std::mutex m_mutex_vertices;
+        std::mutex m_mutex_triangle_bvhs;
 
         // misc
         std::weak_ptr<Entity> m_root_entity;
@@ -58,6 +58,12 @@ namespace Spartan
     vector<float> Renderer::m_lines_duration;
     uint32_t Renderer::m_lines_index_depth_off;
     uint32_t Renderer::m_lines_index_depth_on;
+    shared_ptr<RHI_Buffer> Renderer::m_vertex_buffer_lines_instanced;
+    shared_ptr<RHI_Buffer> Renderer::m_instance_buffer_lines;
+    vector<RHI_Vertex_PosCol> Renderer::m_lines_instanced_vertices;
+    uint64_t Renderer::m_lines_instanced_version = 0;
+    vector<Renderer_LineInstances> Renderer::m_lines_instanced;
+    vector<Matrix> Renderer::m_lines_instanced_transforms;
 
     // misc
     uint32_t Renderer::m_resource_index                           = 0;
@@ -257,8 +263,10 @@ namespace Spartan
             DestroyResources();
 
             m_renderables.clear();
-            swap_chain            = nullptr;
-            m_vertex_buffer_lines = nullptr;
+            swap_chain                      = nullptr;
+            m_vertex_buffer_lines           = nullptr;
+            m_vertex_buffer_lines_instanced = nullptr;
+            m_instance_buffer_lines         = nullptr;
         }
 
         RHI_OpenImageDenoise::Shutdown();
@@ -473,19 +481,12 @@ namespace Spartan
         GetBuffer(Renderer_Buffer::ConstantFrame)->Update(&m_cb_frame_cpu);
     }
 
-    void Renderer::SetEntities(unordered_map<uint64_t, shared_ptr<Entity>>& entities)
+    namespace
     {
-        m_mutex_renderables.lock();
-
-        // clear previous state
-        m_renderables.clear();
-
-        for (auto it : entities)
+        void add_entity(unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>>& renderables, const shared_ptr<Entity>& entity)
         {
-            shared_ptr<Entity>& entity = it.second;
-
             if (!entity->IsActive())
-                continue;
+                return;
 
             if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
             {
@@ -496,7 +497,7 @@ namespace Spartan
                         // a mesh can be uninitialized if it's currently loading in a different thread
                         if (renderable->GetVertexBuffer() && renderable->GetIndexBuffer())
                         { 
-                            m_renderables[Renderer_Entity::Mesh].emplace_back(entity);
+                            renderables[Renderer_Entity::Mesh].emplace_back(entity);
                         }
                     }
                 }
@@ -504,19 +505,32 @@ namespace Spartan
 
             if (shared_ptr<Light> light = entity->GetComponent<Light>())
             {
-                m_renderables[Renderer_Entity::Light].emplace_back(entity);
+                renderables[Renderer_Entity::Light].emplace_back(entity);
             }
 
             if (shared_ptr<Camera> camera = entity->GetComponent<Camera>())
             {
-                m_renderables[Renderer_Entity::Camera].emplace_back(entity);
+                renderables[Renderer_Entity::Camera].emplace_back(entity);
             }
 
             if (shared_ptr<AudioSource> audio_source = entity->GetComponent<AudioSource>())
             {
-                m_renderables[Renderer_Entity::AudioSource].emplace_back(entity);
+                renderables[Renderer_Entity::AudioSource].emplace_back(entity);
             }
         }
+    }
+
+    void Renderer::SetEntities(unordered_map<uint64_t, shared_ptr<Entity>>& entities)
+    {
+        m_mutex_renderables.lock();
+
+        // clear previous state
+        m_renderables.clear();
+
+        for (auto it : entities)
+        {
+            add_entity(m_renderables, it.second);
+        }
 
         m_mutex_renderables.unlock();
 
@@ -527,6 +541,42 @@ namespace Spartan
         }
     }
 
+    void Renderer::AddEntities(const vector<shared_ptr<Entity>>& entities)
+    {
+        m_mutex_renderables.lock();
+
+        for (const shared_ptr<Entity>& entity : entities)
+        {
+            add_entity(m_renderables, entity);
+        }
+
+        m_mutex_renderables.unlock();
+
+        BindlessUpdateMaterials();
+        BindlessUpdateLights();
+    }
+
+    void Renderer::RemoveEntities(const vector<shared_ptr<Entity>>& entities)
+    {
+        unordered_set<Entity*> entities_to_remove;
+        for (const shared_ptr<Entity>& entity : entities)
+        {
+            entities_to_remove.insert(entity.get());
+        }
+
+        m_mutex_renderables.lock();
+
+        for (auto& it : m_renderables)
+        {
+            erase_if(it.second, [&entities_to_remove](const shared_ptr<Entity>& entity) { return entities_to_remove.count(entity.get()) != 0; });
+        }
+
+        m_mutex_renderables.unlock();
+
+        BindlessUpdateMaterials();
+        BindlessUpdateLights();
+    }
+
     bool Renderer::CanUseCmdList()
     {
         RHI_CommandList* cmd_list = RHI_Device::GetQueue(RHI_Queue_Type::Graphics)->GetCommandList();
@@ -63,6 +63,7 @@ namespace Spartan
         static void DrawDirectionalArrow(const Math::Vector3& start, const Math::Vector3& end, float arrow_size, const Color& color = Color::standard_renderer_lines, const float duration = 0.0f, const bool depth = true);
         static void DrawPlane(const Math::Plane& plane, const Color& color = Color::standard_renderer_lines, const float duration = 0.0f, const bool depth = true);
         static void DrawString(const std::string& text, const Math::Vector2& position_screen_percentage);
+        static void DrawLinesInstanced(const std::vector<RHI_Vertex_PosCol>& vertices, const uint64_t vertices_version, const std::vector<Renderer_LineInstances>& batches, const std::vector<Math::Matrix>& transforms);
 
         // options
         template<typename T>
@@ -82,6 +83,8 @@ namespace Spartan
         static RHI_Api_Type GetRhiApiType();
         static void Screenshot(const std::string& file_path);
         static void SetEntities(std::unordered_map<uint64_t, std::shared_ptr<Entity>>& entities);
+        static void AddEntities(const std::vector<std::shared_ptr<Entity>>& entities);    // incremental, for streaming
+        static void RemoveEntities(const std::vector<std::shared_ptr<Entity>>& entities); // incremental, for streaming
         static bool CanUseCmdList();
 
         //= RESOLUTION/SIZE =============================================================================
@@ -201,6 +204,12 @@ namespace Spartan
         static std::vector<float> m_lines_duration;
         static uint32_t m_lines_index_depth_off;
         static uint32_t m_lines_index_depth_on;
+        static std::shared_ptr<RHI_Buffer> m_vertex_buffer_lines_instanced;
+        static std::shared_ptr<RHI_Buffer> m_instance_buffer_lines;
+        static std::vector<RHI_Vertex_PosCol> m_lines_instanced_vertices;
+        static uint64_t m_lines_instanced_version;
+        static std::vector<Renderer_LineInstances> m_lines_instanced;
+        static std::vector<Math::Matrix> m_lines_instanced_transforms;
         static uint32_t m_resource_index;
         static std::atomic<bool> m_initialized_resources;
         static std::atomic<bool> m_initialized_third_party;
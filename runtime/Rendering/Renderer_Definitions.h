@@ -185,6 +185,7 @@ namespace Spartan
         light_image_based_c,
         line_v,
         line_p,
+        line_instanced_v,
         grid_v,
         grid_p,
         outline_v,
@@ -319,4 +320,13 @@ namespace Spartan
         Max,
         Average
     };
+
+    // a range of line list vertices, drawn once for every transform in a range of transforms
+    struct Renderer_LineInstances
+    {
+        uint32_t vertex_offset   = 0;
+        uint32_t vertex_count    = 0;
+        uint32_t instance_offset = 0;
+        uint32_t instance_count  = 0;
+    };
 }
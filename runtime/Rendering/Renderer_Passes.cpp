@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Entity.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
+#include "../Math/Bvh.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../RHI/RHI_Buffer.h"
 #include "../RHI/RHI_Shader.h"
@@ -60,11 +61,74 @@ namespace Spartan
             unordered_map<uint64_t, Rectangle> rectangles;
             unordered_map<uint64_t, BoundingBox> boxes;
 
+            // visible (start, count) instance ranges of a renderable, per view (camera or light slice), shared by all the passes of a frame
+            map<tuple<const Renderable*, const Light*, uint32_t>, vector<pair<uint32_t, uint32_t>>> instance_ranges;
+
+            // hidden runs shorter than this are drawn anyway, that's cheaper than splitting the draw call
+            const uint32_t instance_gap_max = 8;
+
             void clear()
             {
                 distances_squared.clear();
                 rectangles.clear();
                 boxes.clear();
+                instance_ranges.clear();
+            }
+
+            const vector<pair<uint32_t, uint32_t>>& get_visible_instance_ranges(Camera* camera, Renderable* renderable, Light* light, const uint32_t array_index)
+            {
+                const auto key = make_tuple(static_cast<const Renderable*>(renderable), static_cast<const Light*>(light), array_index);
+                auto it = instance_ranges.find(key);
+                if (it != instance_ranges.end())
+                    return it->second;
+
+                vector<pair<uint32_t, uint32_t>>& ranges = instance_ranges[key];
+                auto add_range = [&ranges](const uint32_t start, const uint32_t end)
+                {
+                    if (!ranges.empty() && start - (ranges.back().first + ranges.back().second) <= instance_gap_max)
+                    {
+                        ranges.back().second = end - ranges.back().first;
+                    }
+                    else
+                    {
+                        ranges.emplace_back(start, end - start);
+                    }
+                };
+
+                auto get_intersection = [camera, light, array_index](const BoundingBox& box)
+                {
+                    if (box == BoundingBox::Undefined)
+                        return Intersection::Outside;
+
+                    return light ? light->GetFrustumIntersection(box, array_index) : camera->GetFrustum().GetIntersection(box.GetCenter(), box.GetExtents());
+                };
+
+                uint32_t group_start_index = 0;
+                for (uint32_t group_index = 0; group_index < renderable->GetInstancePartitionCount(); group_index++)
+                {
+                    const uint32_t group_end_index = renderable->GetBoundingBoxGroupEndIndices()[group_index];
+
+                    // whole groups are accepted or rejected with a single test, only the ones on the frustum's edge are tested per instance
+                    const Intersection intersection = get_intersection(renderable->GetBoundingBox(BoundingBoxType::TransformedInstanceGroup, group_index));
+                    if (intersection == Intersection::Inside)
+                    {
+                        add_range(group_start_index, group_end_index);
+                    }
+                    else if (intersection == Intersection::Intersects)
+                    {
+                        for (uint32_t i = group_start_index; i < group_end_index; i++)
+                        {
+                            if (get_intersection(renderable->GetBoundingBox(BoundingBoxType::TransformedInstance, i)) != Intersection::Outside)
+                            {
+                                add_range(i, i + 1);
+                            }
+                        }
+                    }
+
+                    group_start_index = group_end_index;
+                }
+
+                return ranges;
             }
 
             float get_squared_distance(const shared_ptr<Entity>& entity)
@@ -88,14 +152,32 @@ namespace Spartan
                 }
             }
 
+            // fills boxes_soa with the transformed bounding boxes of the renderables in [index_start, index_end)
+            void gather_boxes(vector<shared_ptr<Entity>>& renderables, AabbSoA& boxes_soa, const size_t index_start, const size_t index_end)
+            {
+                boxes_soa.Clear();
+                boxes_soa.Reserve(static_cast<uint32_t>(index_end - index_start));
+                for (size_t i = index_start; i < index_end; i++)
+                {
+                    boxes_soa.Add(renderables[i]->GetComponent<Renderable>()->GetBoundingBox(BoundingBoxType::Transformed));
+                }
+            }
+
             void frustum_culling(vector<shared_ptr<Entity>>& renderables)
             {
+                // assume everything is culled
                 for (shared_ptr<Entity>& entity : renderables)
                 {
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                    renderable->SetFlag(RenderableFlags::OccludedCpu, !Renderer::GetCamera()->IsInViewFrustum(renderable));
+                    renderable->SetFlag(RenderableFlags::OccludedCpu, true);
                     renderable->SetFlag(RenderableFlags::Occluder, false);
                 }
+
+                // walk the world's bvh, whole subtrees that are outside (or inside) the frustum are resolved with a single test
+                World::GetBvh().QueryFrustum(Renderer::GetCamera()->GetFrustum(), [](void* user_data)
+                {
+                    static_cast<Entity*>(user_data)->GetComponent<Renderable>()->SetFlag(RenderableFlags::OccludedCpu, false);
+                });
             }
 
             void sort(vector<shared_ptr<Entity>>& renderables)
@@ -279,51 +361,20 @@ namespace Spartan
 
         void draw_renderable(RHI_CommandList* cmd_list, RHI_PipelineState& pso, Camera* camera, Renderable* renderable, Light* light = nullptr, uint32_t array_index = 0)
         {
-            uint32_t instance_start_index = 0;
-            bool draw_instanced           = pso.instancing && renderable->HasInstancing();
+            bool draw_instanced = pso.instancing && renderable->HasInstancing();
 
             if (draw_instanced)
             {
-                for (uint32_t group_index = 0; group_index < renderable->GetInstancePartitionCount(); group_index++)
+                // only the instances that are visible from this view
+                for (const auto& [instance_start_index, instance_count] : visibility::get_visible_instance_ranges(camera, renderable, light, array_index))
                 {
-                    uint32_t group_end_index = renderable->GetBoundingBoxGroupEndIndices()[group_index];
-                    uint32_t instance_count  = group_end_index - instance_start_index;
-
-                    // skip instance groups outside of the view frustum
-                    {
-                        const BoundingBox& bounding_box_group = renderable->GetBoundingBox(BoundingBoxType::TransformedInstanceGroup, group_index);
-
-                        if (light)
-                        {
-                            if (!light->IsInViewFrustum(renderable, array_index))
-                            {
-                                instance_start_index = group_end_index;
-                                continue;
-                            }
-                        }
-                        else if (!camera->IsInViewFrustum(bounding_box_group))
-                        {
-                            instance_start_index = group_end_index;
-                            continue;
-                        }
-                    }
-
-                    // skip this iteration if we've reached the total number of instances
-                    if (instance_start_index + instance_count >= renderable->GetInstanceCount())
-                        continue;
-
-                    if (instance_count > 0)
-                    {
-                        cmd_list->DrawIndexed(
-                            renderable->GetIndexCount(),
-                            renderable->GetIndexOffset(),
-                            renderable->GetVertexOffset(),
-                            instance_start_index,
-                            instance_count
-                        );
-                    }
-
-                    instance_start_index = group_end_index;
+                    cmd_list->DrawIndexed(
+                        renderable->GetIndexCount(),
+                        renderable->GetIndexOffset(),
+                        renderable->GetVertexOffset(),
+                        instance_start_index,
+                        instance_count
+                    );
                 }
             }
             else 
@@ -539,6 +590,15 @@ namespace Spartan
                 }
             }
 
+            // cull the entities against all the cascades/faces of the light in one pass
+            int64_t index_start = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, true);
+            int64_t index_end   = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, false);
+            static AabbSoA boxes_soa;
+            static vector<uint8_t> slice_masks;
+            visibility::gather_boxes(m_renderables[Renderer_Entity::Mesh], boxes_soa, static_cast<size_t>(index_start), static_cast<size_t>(index_end));
+            slice_masks.resize(boxes_soa.GetCount());
+            light->CullBoxes(boxes_soa, slice_masks.data());
+
             // iterate over light cascade/faces
             for (uint32_t array_index = 0; array_index < pso.render_target_depth_texture->GetDepth(); array_index++)
             {
@@ -546,22 +606,20 @@ namespace Spartan
                 cmd_list->SetIgnoreClearValues(is_transparent_pass);
 
                 // iterate over entities
-                int64_t index_start = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, true);
-                int64_t index_end   = get_mesh_indices(m_renderables[Renderer_Entity::Mesh], is_transparent_pass, false);
                 for (int64_t i = index_start; i < index_end; i++)
                 {
                     // this can happen during async loading
                     if (i >= static_cast<int64_t>(m_renderables[Renderer_Entity::Mesh].size()))
                         continue;
 
+                    if ((slice_masks[i - index_start] & (1u << array_index)) == 0)
+                        continue;
+
                     shared_ptr<Entity>& entity        = m_renderables[Renderer_Entity::Mesh][i];
                     shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
                     if (!renderable || !renderable->HasFlag(RenderableFlags::CastsShadows))
                         continue;
 
-                    if (!light->IsInViewFrustum(renderable.get(), array_index))
-                        continue;
-
                     cmd_list->SetCullMode(static_cast<RHI_CullMode>(renderable->GetMaterial()->GetProperty(MaterialProperty::CullMode)));
 
                     // set pipeline
@@ -2173,6 +2231,61 @@ namespace Spartan
             }
         }
 
+        // draw instanced lines
+        RHI_Shader* shader_instanced_v = GetShader(Renderer_Shader::line_instanced_v);
+        if (!m_lines_instanced.empty() && shader_instanced_v->IsCompiled())
+        {
+            cmd_list->BeginMarker("instanced");
+            cmd_list->SetCullMode(RHI_CullMode::None);
+
+            // the geometry only changes when new shapes show up
+            if (!m_vertex_buffer_lines_instanced && !m_lines_instanced_vertices.empty())
+            {
+                m_vertex_buffer_lines_instanced = make_shared<RHI_Buffer>(RHI_Buffer_Type::Vertex, sizeof(m_lines_instanced_vertices[0]), static_cast<uint32_t>(m_lines_instanced_vertices.size()), static_cast<void*>(&m_lines_instanced_vertices[0]), false, "lines_instanced");
+                m_lines_instanced_vertices.clear();
+                m_lines_instanced_vertices.shrink_to_fit();
+            }
+
+            // grow instance buffer (if needed)
+            uint32_t instance_count = static_cast<uint32_t>(m_lines_instanced_transforms.size());
+            if (!m_instance_buffer_lines || instance_count > m_instance_buffer_lines->GetElementCount())
+            {
+                uint32_t capacity       = m_instance_buffer_lines ? max(instance_count, m_instance_buffer_lines->GetElementCount() * 2) : max(instance_count, 1024u);
+                m_instance_buffer_lines = make_shared<RHI_Buffer>(RHI_Buffer_Type::Instance, sizeof(Matrix), capacity, nullptr, true, "lines_instances");
+            }
+
+            if (m_vertex_buffer_lines_instanced && instance_count != 0)
+            {
+                // update instance buffer
+                Matrix* buffer = static_cast<Matrix*>(m_instance_buffer_lines->GetMappedData());
+                for (uint32_t i = 0; i < instance_count; i++)
+                {
+                    buffer[i] = m_lines_instanced_transforms[i].Transposed();
+                }
+
+                // set pipeline state
+                pso.shaders[RHI_Shader_Type::Vertex] = shader_instanced_v;
+                pso.instancing                       = true;
+                pso.blend_state                      = GetBlendState(Renderer_BlendState::Alpha);
+                pso.depth_stencil_state              = GetDepthStencilState(Renderer_DepthStencilState::Read);
+                cmd_list->SetPipelineState(pso);
+
+                cmd_list->SetBufferVertex(m_vertex_buffer_lines_instanced.get());
+                cmd_list->SetBufferVertex(m_instance_buffer_lines.get(), 1);
+                for (const Renderer_LineInstances& batch : m_lines_instanced)
+                {
+                    cmd_list->Draw(batch.vertex_count, batch.vertex_offset, batch.instance_offset, batch.instance_count);
+                }
+
+                pso.shaders[RHI_Shader_Type::Vertex] = shader_v;
+                pso.instancing                       = false;
+            }
+
+            cmd_list->EndMarker();
+        }
+        m_lines_instanced.clear();
+        m_lines_instanced_transforms.clear();
+
         m_lines_index_depth_off = numeric_limits<uint32_t>::max();                         // max +1 will wrap it to 0
         m_lines_index_depth_on  = (static_cast<uint32_t>(m_line_vertices.size()) / 2) - 1; // -1 because +1 will make it go to size / 2
 
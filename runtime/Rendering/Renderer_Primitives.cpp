@@ -244,6 +244,21 @@ namespace Spartan
         DrawLine(plane_origin - V * scale, plane_origin + V * scale, color, color, duration, depth);
     }
 
+    void Renderer::DrawLinesInstanced(const vector<RHI_Vertex_PosCol>& vertices, const uint64_t vertices_version, const vector<Renderer_LineInstances>& batches, const vector<Matrix>& transforms)
+    {
+        // the geometry is only taken when it changed, the lines pass uploads it once and drops the copy
+        if (vertices_version != m_lines_instanced_version)
+        {
+            m_lines_instanced_vertices      = vertices;
+            m_lines_instanced_version       = vertices_version;
+            m_vertex_buffer_lines_instanced = nullptr;
+        }
+
+        // the transforms change every frame
+        m_lines_instanced            = batches;
+        m_lines_instanced_transforms = transforms;
+    }
+
     void Renderer::AddLinesToBeRendered()
     {
         // only render debug lines when not in game mode
@@ -288,6 +288,9 @@ namespace Spartan
             shader(Renderer_Shader::line_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "line.hlsl", async, RHI_Vertex_Type::PosCol);
             shader(Renderer_Shader::line_p) = make_shared<RHI_Shader>();
             shader(Renderer_Shader::line_p)->Compile(RHI_Shader_Type::Pixel, shader_dir + "line.hlsl", async);
+            shader(Renderer_Shader::line_instanced_v) = make_shared<RHI_Shader>();
+            shader(Renderer_Shader::line_instanced_v)->AddDefine("INSTANCED");
+            shader(Renderer_Shader::line_instanced_v)->Compile(RHI_Shader_Type::Vertex, shader_dir + "line.hlsl", async, RHI_Vertex_Type::PosCol);
 
             // grid
             {
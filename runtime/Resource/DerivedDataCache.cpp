@@ -0,0 +1,270 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===============
+#include "pch.h"
+#include "DerivedDataCache.h"
+#include "ResourceCache.h"
+//==========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        string directory;
+        mutex mutex_directory;
+        atomic<uint64_t> temporary_file_count = 0;
+
+        // hashing the source is much cheaper than importing it, but it still reads the whole file,
+        // so the hash is kept for as long as the file's size and write time don't change
+        struct SourceStamp
+        {
+            uint64_t size = 0;
+            int64_t time  = 0;
+            uint64_t hash = 0;
+        };
+        unordered_map<string, SourceStamp> source_stamps;
+        mutex mutex_source_stamps;
+
+        const uint64_t prime_0 = 0x9E3779B185EBCA87ull;
+        const uint64_t prime_1 = 0xC2B2AE3D27D4EB4Full;
+        const uint64_t prime_2 = 0x165667B19E3779F9ull;
+
+        uint64_t rotate_left(const uint64_t value, const uint32_t bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        uint64_t mix(uint64_t value)
+        {
+            value ^= value >> 33;
+            value *= prime_1;
+            value ^= value >> 29;
+            value *= prime_2;
+            value ^= value >> 32;
+            return value;
+        }
+
+        bool hash_file(const string& file_path, uint64_t* hash)
+        {
+            ifstream file(file_path, ios::binary);
+            if (!file.is_open())
+                return false;
+
+            // hash in blocks, carrying the hash over as the seed of the next block
+            vector<char> buffer(4 * 1024 * 1024);
+            uint64_t result = 0;
+            while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+            {
+                result = DerivedDataCache::Hash(buffer.data(), static_cast<uint64_t>(file.gcount()), result);
+            }
+
+            *hash = result;
+            return true;
+        }
+
+        bool get_source_hash(const string& file_path, uint64_t* hash)
+        {
+            error_code error;
+            const uint64_t size = static_cast<uint64_t>(filesystem::file_size(file_path, error));
+            if (error)
+                return false;
+
+            const int64_t time = static_cast<int64_t>(filesystem::last_write_time(file_path, error).time_since_epoch().count());
+
+            {
+                lock_guard<mutex> lock(mutex_source_stamps);
+                auto it = source_stamps.find(file_path);
+                if (it != source_stamps.end() && it->second.size == size && it->second.time == time)
+                {
+                    *hash = it->second.hash;
+                    return true;
+                }
+            }
+
+            if (!hash_file(file_path, hash))
+                return false;
+
+            lock_guard<mutex> lock(mutex_source_stamps);
+            source_stamps[file_path] = { size, time, *hash };
+
+            return true;
+        }
+    }
+
+    void DerivedDataCache::SetDirectory(const string& directory_)
+    {
+        lock_guard<mutex> lock(mutex_directory);
+        directory = directory_;
+    }
+
+    string DerivedDataCache::GetDirectory()
+    {
+        lock_guard<mutex> lock(mutex_directory);
+
+        if (directory.empty())
+        {
+            directory = ResourceCache::GetProjectDirectory() + "derived_data/";
+        }
+
+        if (!FileSystem::Exists(directory))
+        {
+            FileSystem::CreateDirectory(directory);
+        }
+
+        return directory;
+    }
+
+    uint64_t DerivedDataCache::ComputeKey(const string& source_file_path, const uint64_t settings, const uint32_t version)
+    {
+        uint64_t hash = 0;
+        if (!get_source_hash(source_file_path, &hash))
+            return 0;
+
+        uint64_t key = HashCombine(hash, settings);
+        key          = HashCombine(key, version);
+
+        // 0 means no key
+        return key != 0 ? key : 1;
+    }
+
+    bool DerivedDataCache::ReadDependencies(const uint64_t key, vector<string>* file_paths)
+    {
+        ifstream file(GetFilePath(key, ".dependencies"));
+        if (!file.is_open())
+            return false;
+
+        // one path per line
+        file_paths->clear();
+        string file_path;
+        while (getline(file, file_path))
+        {
+            if (!file_path.empty())
+            {
+                file_paths->emplace_back(file_path);
+            }
+        }
+
+        return true;
+    }
+
+    void DerivedDataCache::WriteDependencies(const uint64_t key, const vector<string>& file_paths)
+    {
+        const string file_path      = GetFilePath(key, ".dependencies");
+        const string file_path_temp = GetTemporaryFilePath(file_path);
+        {
+            ofstream file(file_path_temp);
+            for (const string& dependency : file_paths)
+            {
+                file << dependency << "\n";
+            }
+
+            if (!file.good())
+            {
+                file.close();
+                FileSystem::Delete(file_path_temp);
+                return;
+            }
+        }
+
+        Commit(file_path_temp, file_path);
+    }
+
+    uint64_t DerivedDataCache::ComputeKey(const uint64_t key, const vector<string>& dependency_file_paths)
+    {
+        if (key == 0)
+            return 0;
+
+        uint64_t result = key;
+        for (const string& file_path : dependency_file_paths)
+        {
+            // a dependency which went missing still changes the key, the import will then fail (or succeed without it) as it would without a cache
+            uint64_t hash = 0;
+            get_source_hash(file_path, &hash);
+            result = HashCombine(result, Hash(file_path.data(), file_path.size()));
+            result = HashCombine(result, hash);
+        }
+
+        return result != 0 ? result : 1;
+    }
+
+    string DerivedDataCache::GetFilePath(const uint64_t key, const string& extension)
+    {
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return GetDirectory() + name + extension;
+    }
+
+    string DerivedDataCache::GetTemporaryFilePath(const string& file_path)
+    {
+        return file_path + "." + to_string(temporary_file_count++) + ".tmp";
+    }
+
+    bool DerivedDataCache::Commit(const string& file_path_temporary, const string& file_path)
+    {
+        error_code error;
+        filesystem::rename(file_path_temporary, file_path, error);
+        if (error)
+        {
+            // most likely another import of the same source got there first, which is just as good
+            FileSystem::Delete(file_path_temporary);
+            return FileSystem::Exists(file_path);
+        }
+
+        return true;
+    }
+
+    uint64_t DerivedDataCache::Hash(const void* data, const uint64_t size, uint64_t seed)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash        = seed ^ (size * prime_0);
+
+        // eight bytes at a time
+        uint64_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash ^= mix(word);
+            hash  = rotate_left(hash, 27) * prime_0 + prime_2;
+        }
+
+        // the tail
+        uint64_t tail = 0;
+        for (uint32_t shift = 0; i < size; i++, shift += 8)
+        {
+            tail |= static_cast<uint64_t>(bytes[i]) << shift;
+        }
+        hash ^= mix(tail);
+
+        return mix(hash);
+    }
+
+    uint64_t DerivedDataCache::HashCombine(const uint64_t seed, const uint64_t value)
+    {
+        return mix(seed ^ (mix(value) + prime_0 + (seed << 6) + (seed >> 2)));
+    }
+}
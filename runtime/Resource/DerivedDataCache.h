@@ -0,0 +1,62 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===================
+#include <string>
+#include <vector>
+#include "../Core/Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // an on-drive store for the outputs of expensive imports (decoded and compressed textures, post-processed models, optimized geometry)
+    // entries are keyed by a hash of the source file's bytes and the settings which shaped the output, so they never go stale,
+    // a changed source or different settings simply produce a different key
+    class SP_CLASS DerivedDataCache
+    {
+    public:
+        // defaults to a directory inside the project directory
+        static void SetDirectory(const std::string& directory);
+        static std::string GetDirectory();
+
+        // bump the version passed in when the importer's output changes, so that older entries are no longer picked up
+        static uint64_t ComputeKey(const std::string& source_file_path, const uint64_t settings, const uint32_t version);
+
+        // the other files an import reads (a gltf's buffers, an obj's materials) are only known once it ran, so they are recorded
+        // under the key of the main source and folded into it, a change to any of them then produces a different key as well
+        static bool ReadDependencies(const uint64_t key, std::vector<std::string>* file_paths);
+        static void WriteDependencies(const uint64_t key, const std::vector<std::string>& file_paths);
+        static uint64_t ComputeKey(const uint64_t key, const std::vector<std::string>& dependency_file_paths);
+        static std::string GetFilePath(const uint64_t key, const std::string& extension);
+
+        // a unique path to write to before moving the finished file into place with Commit(),
+        // this way concurrent imports of the same source never see a partially written entry
+        static std::string GetTemporaryFilePath(const std::string& file_path);
+        static bool Commit(const std::string& file_path_temporary, const std::string& file_path);
+
+        // hashing
+        static uint64_t Hash(const void* data, const uint64_t size, uint64_t seed = 0);
+        static uint64_t HashCombine(const uint64_t seed, const uint64_t value);
+    };
+}
@@ -22,11 +22,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ======================
 #include "pch.h"
 #include "IResource.h"
+#include "ResourceCache.h"
 #include "../Audio/AudioClip.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Rendering/Font/Font.h"
 #include "../Rendering/Animation.h"
 #include "../Rendering/Mesh.h"
+#include "../World/Prefab.h"
 //=================================
 
 //= NAMESPACES ==========
@@ -39,6 +41,12 @@ IResource::IResource(const ResourceType type)
     m_resource_type = type;
 }
 
+void IResource::SetResourceSize(const uint64_t size)
+{
+    m_object_size = size;
+    ResourceCache::OnResourceSizeChanged(this);
+}
+
 template <typename T>
 inline constexpr ResourceType IResource::TypeToEnum() { return ResourceType::Unknown; }
 
@@ -55,3 +63,4 @@ INSTANTIATE_TO_RESOURCE_TYPE(Material,    ResourceType::Material)
 INSTANTIATE_TO_RESOURCE_TYPE(Animation,   ResourceType::Animation)
 INSTANTIATE_TO_RESOURCE_TYPE(Font,        ResourceType::Font)
 INSTANTIATE_TO_RESOURCE_TYPE(Mesh,        ResourceType::Mesh)
+INSTANTIATE_TO_RESOURCE_TYPE(Prefab,      ResourceType::Prefab)
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <atomic>
+#include <memory>
 #include "../Core/FileSystem.h"
 #include "../Core/SpartanObject.h"
 #include "../Logging/Log.h"
@@ -30,6 +31,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class AssetContainer;
+
     enum class ResourceType
     {
         Unknown,
@@ -41,6 +44,7 @@ namespace Spartan
         Animation,
         Font,
         Shader,
+        Prefab,
         Max,
     };
 
@@ -111,12 +115,16 @@ namespace Spartan
         // io
         virtual bool SaveToFile(const std::string& file_path) { return true; }
         virtual bool LoadFromFile(const std::string& file_path) { return true; }
+        virtual bool LoadFromContainer(const std::string& file_path, const std::shared_ptr<AssetContainer>& container) { return LoadFromFile(file_path); } // the file, already mapped by the caller
 
         // type
         template <typename T>
         static constexpr ResourceType TypeToEnum();
 
     protected:
+        // use this instead of writing m_object_size directly, so the resource cache can keep its memory usage up to date
+        void SetResourceSize(const uint64_t size);
+
         ResourceType m_resource_type         = ResourceType::Max;
         std::atomic<bool> m_is_ready_for_use = false;
         uint32_t m_flags                     = 0;
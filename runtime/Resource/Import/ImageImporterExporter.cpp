@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =======================
 #include "pch.h"
 #include "ImageImporterExporter.h"
+#include "MipGenerator.h"
 #include "../../RHI/RHI_Texture.h"
 SP_WARNINGS_OFF
 #define FREEIMAGE_LIB
@@ -40,6 +41,9 @@ namespace Spartan
 {
     namespace
     {
+        // matches ALPHA_THRESHOLD_DEFAULT in the shaders
+        const float alpha_cutoff = 0.6f;
+
         bool get_is_srgb(FIBITMAP* bitmap)
         {
             if (FIICCPROFILE* icc_profile = FreeImage_GetICCProfile(bitmap))
@@ -398,6 +402,10 @@ namespace Spartan
             {
                 format = RHI_Format::BC3_Unorm;
             }
+            else if (format_dxgi == tinyddsloader::DDSFile::DXGIFormat::BC4_UNorm)
+            {
+                format = RHI_Format::BC4_Unorm;
+            }
             else if (format_dxgi == tinyddsloader::DDSFile::DXGIFormat::BC5_UNorm)
             {
                 format = RHI_Format::BC5_Unorm;
@@ -436,6 +444,16 @@ namespace Spartan
         // done before ApplyBitmapCorrections(), as after that, results for grayscale seem to be always false
         texture_flags |= (FreeImage_GetColorType(bitmap) == FREE_IMAGE_COLOR_TYPE::FIC_MINISBLACK) ? RHI_Texture_Greyscale : 0;
         texture_flags |= get_is_srgb(bitmap) ? RHI_Texture_Srgb : 0;
+
+        // the slot a texture was found in isn't always what it is, a grey image can't be a normal map and a colored height map is one
+        if (texture_flags & RHI_Texture_Greyscale)
+        {
+            texture_flags &= ~RHI_Texture_Normal;
+        }
+        else if (texture_flags & RHI_Texture_MaybeNormal)
+        {
+            texture_flags |= RHI_Texture_Normal;
+        }
         texture->SetFlags(texture_flags);
 
         // perform some corrections
@@ -459,45 +477,37 @@ namespace Spartan
         texture->SetChannelCount(get_channel_count(bitmap));
         texture->SetFormat(get_rhi_format(texture->GetBitsPerChannel(), texture->GetChannelCount()));
 
+        // alpha tested textures should keep their coverage as they get smaller
+        const bool is_transparent = FreeImage_GetBPP(bitmap) == 32 && has_transparent_pixels(bitmap);
+        texture->SetFlag(RHI_Texture_Transparent, is_transparent);
+
         // fill in all the mips
-        uint32_t mip_count       = calculate_mip_count(texture->GetWidth(), texture->GetHeight());
-        FIBITMAP* current_bitmap = bitmap;
-        for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
         {
-            if (mip_index != 0) // rescale bitmap for next mip levels
+            MipSettings settings;
+            settings.srgb         = (texture->GetFlags() & RHI_Texture_Srgb) != 0;
+            settings.normal       = (texture->GetFlags() & RHI_Texture_Normal) != 0;
+            settings.alpha_cutoff = (is_transparent && !settings.normal) ? alpha_cutoff : 0.0f;
+
+            vector<vector<std::byte>> mips;
+            MipGenerator::Generate(
+                reinterpret_cast<const std::byte*>(FreeImage_GetBits(bitmap)),
+                texture->GetWidth(),
+                texture->GetHeight(),
+                FreeImage_GetPitch(bitmap),
+                texture->GetChannelCount(),
+                texture->GetBitsPerChannel(),
+                max(1u, calculate_mip_count(texture->GetWidth(), texture->GetHeight())),
+                settings,
+                &mips
+            );
+
+            for (vector<std::byte>& bytes : mips)
             {
-                uint32_t width           = texture->GetWidth() >> mip_index;
-                uint32_t height          = texture->GetHeight() >> mip_index;
-                FIBITMAP* resized_bitmap = FreeImage_Rescale(current_bitmap, width, height, FILTER_BICUBIC);
-                if (!resized_bitmap)
-                {
-                    SP_LOG_ERROR("Failed to resize image for mip level %d", mip_index);
-                    FreeImage_Unload(bitmap);
-                    return false;
-                }
-
-                if (mip_index > 1)
-                {
-                    FreeImage_Unload(current_bitmap);
-                }
-
-                current_bitmap = resized_bitmap;
+                texture->CreateMip(slice_index).bytes = move(bytes);
             }
-
-            if (mip_index == 2)
-            {
-                texture->SetFlag(RHI_Texture_Transparent, has_transparent_pixels(current_bitmap));
-            }
-
-            // copy data over to the texture
-            RHI_Texture_Mip& mip = texture->CreateMip(slice_index);
-            BYTE* bytes          = FreeImage_GetBits(current_bitmap);
-            size_t bytes_size    = FreeImage_GetPitch(current_bitmap) * FreeImage_GetHeight(current_bitmap);
-            mip.bytes.resize(bytes_size);
-            memcpy(&mip.bytes[0], bytes, bytes_size);
         }
 
-        FreeImage_Unload(current_bitmap);
+        FreeImage_Unload(bitmap);
 
         return true;
     }
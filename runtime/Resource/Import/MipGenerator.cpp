@@ -0,0 +1,553 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =========================
+#include "pch.h"
+#include "MipGenerator.h"
+#include "../../Core/ThreadPool.h"
+#include "../../Math/Simd.h"
+//====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    namespace
+    {
+        // below this many rows per task, handing work to other threads costs more than it saves
+        const uint32_t rows_per_task_min = 16;
+
+        // the shape of the kaiser window
+        const float kaiser_alpha = 4.0f;
+
+        float srgb_to_linear(const float value)
+        {
+            return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linear_to_srgb(const float value)
+        {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        float saturate(const float value)
+        {
+            return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        }
+
+        // decoding 8 bit srgb is a lookup
+        const array<float, 256>& get_srgb_table()
+        {
+            static const array<float, 256> table = []()
+            {
+                array<float, 256> values;
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    values[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+                }
+                return values;
+            }();
+
+            return table;
+        }
+
+        float sinc(const float x)
+        {
+            if (fabsf(x) < 1e-5f)
+                return 1.0f;
+
+            const float pi_x = Helper::PI * x;
+            return sinf(pi_x) / pi_x;
+        }
+
+        // modified bessel function of the first kind, order 0
+        float bessel_i0(const float x)
+        {
+            const float x_half_squared = x * x * 0.25f;
+            float sum                  = 1.0f;
+            float term                 = 1.0f;
+            for (uint32_t k = 1; k < 32 && term > sum * 1e-7f; k++)
+            {
+                term *= x_half_squared / static_cast<float>(k * k);
+                sum  += term;
+            }
+
+            return sum;
+        }
+
+        // support of the filter in destination texels
+        float get_filter_radius(const MipFilter filter)
+        {
+            switch (filter)
+            {
+                case MipFilter::Box:     return 0.5f;
+                case MipFilter::Kaiser:  return 2.0f;
+                case MipFilter::Lanczos: return 3.0f;
+            }
+
+            return 0.5f;
+        }
+
+        // t is the distance from the center of the destination texel, in destination texels
+        float evaluate_filter(const MipFilter filter, const float t)
+        {
+            const float radius = get_filter_radius(filter);
+
+            switch (filter)
+            {
+                case MipFilter::Box:
+                    return (t >= -radius && t < radius) ? 1.0f : 0.0f;
+
+                case MipFilter::Kaiser:
+                {
+                    const float x = t / radius;
+                    if (fabsf(x) >= 1.0f)
+                        return 0.0f;
+
+                    return sinc(t) * bessel_i0(kaiser_alpha * sqrtf(1.0f - x * x)) / bessel_i0(kaiser_alpha);
+                }
+
+                case MipFilter::Lanczos:
+                    return fabsf(t) < radius ? sinc(t) * sinc(t / radius) : 0.0f;
+            }
+
+            return 0.0f;
+        }
+
+        // the source texels (and their weights) that each destination texel is made of, along one axis
+        struct Taps
+        {
+            vector<uint32_t> first; // per destination texel
+            vector<uint32_t> count; // per destination texel
+            vector<uint32_t> index;
+            vector<float> weight;
+        };
+
+        Taps compute_taps(const uint32_t size_source, const uint32_t size_destination, const MipFilter filter)
+        {
+            const float scale  = static_cast<float>(size_source) / static_cast<float>(size_destination);
+            const float radius = get_filter_radius(filter) * scale;
+
+            Taps taps;
+            taps.first.resize(size_destination);
+            taps.count.resize(size_destination);
+            for (uint32_t i = 0; i < size_destination; i++)
+            {
+                const float center  = (static_cast<float>(i) + 0.5f) * scale;
+                const int32_t begin = static_cast<int32_t>(floorf(center - radius));
+                const int32_t end   = static_cast<int32_t>(ceilf(center + radius));
+
+                taps.first[i]    = static_cast<uint32_t>(taps.index.size());
+                float weight_sum = 0.0f;
+                for (int32_t s = begin; s <= end; s++)
+                {
+                    const float weight = evaluate_filter(filter, (static_cast<float>(s) + 0.5f - center) / scale);
+                    if (weight == 0.0f)
+                        continue;
+
+                    // clamp to the edge
+                    taps.index.emplace_back(static_cast<uint32_t>(clamp(s, 0, static_cast<int32_t>(size_source) - 1)));
+                    taps.weight.emplace_back(weight);
+                    weight_sum += weight;
+                }
+                taps.count[i] = static_cast<uint32_t>(taps.index.size()) - taps.first[i];
+
+                for (uint32_t k = taps.first[i]; k < taps.first[i] + taps.count[i]; k++)
+                {
+                    taps.weight[k] /= weight_sum;
+                }
+            }
+
+            return taps;
+        }
+
+        // unpacks a row into four floats per texel, missing channels are 0 and missing alpha is 1
+        void decode_row(const std::byte* row, const uint32_t width, const uint32_t channel_count, const uint32_t bits_per_channel, const bool srgb, float* texels)
+        {
+            const array<float, 256>& srgb_table = get_srgb_table();
+
+            for (uint32_t x = 0; x < width; x++)
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float value = (c == 3) ? 1.0f : 0.0f;
+                    if (c < channel_count)
+                    {
+                        const size_t offset = (static_cast<size_t>(x) * channel_count + c) * (bits_per_channel / 8);
+                        if (bits_per_channel == 8)
+                        {
+                            const uint8_t encoded = static_cast<uint8_t>(row[offset]);
+                            value = (srgb && c < 3) ? srgb_table[encoded] : static_cast<float>(encoded) / 255.0f;
+                        }
+                        else if (bits_per_channel == 16)
+                        {
+                            uint16_t encoded;
+                            memcpy(&encoded, row + offset, sizeof(encoded));
+                            value = static_cast<float>(encoded) / 65535.0f;
+                            value = (srgb && c < 3) ? srgb_to_linear(value) : value;
+                        }
+                        else
+                        {
+                            memcpy(&value, row + offset, sizeof(value));
+                        }
+                    }
+
+                    texels[x * 4 + c] = value;
+                }
+            }
+        }
+
+        void encode_row(const float* texels, const uint32_t width, const uint32_t channel_count, const uint32_t bits_per_channel, const bool srgb, const float alpha_scale, std::byte* row)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                for (uint32_t c = 0; c < channel_count; c++)
+                {
+                    float value = texels[x * 4 + c];
+                    value       = (c == 3) ? value * alpha_scale : value;
+
+                    const size_t offset = (static_cast<size_t>(x) * channel_count + c) * (bits_per_channel / 8);
+                    if (bits_per_channel == 32)
+                    {
+                        memcpy(row + offset, &value, sizeof(value));
+                        continue;
+                    }
+
+                    value = saturate(value);
+                    value = (srgb && c < 3) ? linear_to_srgb(value) : value;
+
+                    if (bits_per_channel == 8)
+                    {
+                        row[offset] = static_cast<std::byte>(static_cast<uint8_t>(value * 255.0f + 0.5f));
+                    }
+                    else
+                    {
+                        const uint16_t encoded = static_cast<uint16_t>(value * 65535.0f + 0.5f);
+                        memcpy(row + offset, &encoded, sizeof(encoded));
+                    }
+                }
+            }
+        }
+
+        // the rows of the mip being downsampled, either the imported bytes or a previously generated mip
+        struct RowReader
+        {
+            const std::byte* bytes    = nullptr;
+            const float* texels       = nullptr;
+            uint32_t width            = 0;
+            uint32_t pitch            = 0;
+            uint32_t channel_count    = 0;
+            uint32_t bits_per_channel = 0;
+            bool srgb                 = false;
+
+            const float* Read(const uint32_t y, float* scratch) const
+            {
+                if (texels)
+                    return texels + static_cast<size_t>(y) * width * 4;
+
+                decode_row(bytes + static_cast<size_t>(y) * pitch, width, channel_count, bits_per_channel, srgb, scratch);
+                return scratch;
+            }
+        };
+
+        // splits [0, count) into chunks which the calling thread and any idle pool threads take turns on
+        // the caller works too, so it never waits on a task which hasn't started, which makes this safe
+        // to call from a pool task (that's where textures are usually imported)
+        // separable, a horizontal pass into an intermediate image followed by a vertical pass which accumulates whole rows
+        void downsample(const RowReader& source, const uint32_t width_source, const uint32_t height_source, const uint32_t width, const uint32_t height, const MipFilter filter, vector<float>* texels)
+        {
+            const Taps taps_x = compute_taps(width_source, width, filter);
+            const Taps taps_y = compute_taps(height_source, height, filter);
+
+            vector<float> intermediate(static_cast<size_t>(width) * height_source * 4);
+            ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+            {
+                vector<float> scratch(source.texels ? 0 : static_cast<size_t>(width_source) * 4);
+                for (uint32_t y = start; y < end; y++)
+                {
+                    const float* row_in = source.Read(y, scratch.data());
+                    float* row_out      = &intermediate[static_cast<size_t>(y) * width * 4];
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        Simd::vec4 sum = Simd::splat(0.0f);
+                        for (uint32_t k = taps_x.first[x]; k < taps_x.first[x] + taps_x.count[x]; k++)
+                        {
+                            sum = Simd::madd(Simd::load(row_in + taps_x.index[k] * 4), Simd::splat(taps_x.weight[k]), sum);
+                        }
+                        Simd::store(row_out + x * 4, sum);
+                    }
+                }
+            }, height_source, rows_per_task_min);
+
+            texels->assign(static_cast<size_t>(width) * height * 4, 0.0f);
+            ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+            {
+                const Simd::vec4 zero = Simd::splat(0.0f);
+                for (uint32_t y = start; y < end; y++)
+                {
+                    float* row_out = texels->data() + static_cast<size_t>(y) * width * 4;
+                    for (uint32_t k = taps_y.first[y]; k < taps_y.first[y] + taps_y.count[y]; k++)
+                    {
+                        const float* row_in     = &intermediate[static_cast<size_t>(taps_y.index[k]) * width * 4];
+                        const Simd::vec4 weight = Simd::splat(taps_y.weight[k]);
+                        for (uint32_t x = 0; x < width; x++)
+                        {
+                            Simd::store(row_out + x * 4, Simd::madd(Simd::load(row_in + x * 4), weight, Simd::load(row_out + x * 4)));
+                        }
+                    }
+
+                    // ringing can push values below zero
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        Simd::store(row_out + x * 4, Simd::max(Simd::load(row_out + x * 4), zero));
+                    }
+                }
+            }, height, rows_per_task_min);
+        }
+
+        void renormalize(vector<float>& texels)
+        {
+            for (size_t i = 0; i < texels.size(); i += 4)
+            {
+                const float x      = texels[i + 0] * 2.0f - 1.0f;
+                const float y      = texels[i + 1] * 2.0f - 1.0f;
+                const float z      = texels[i + 2] * 2.0f - 1.0f;
+                const float length = sqrtf(x * x + y * y + z * z);
+
+                // opposing normals can cancel out, fall back to pointing straight out of the surface
+                if (length < 1e-6f)
+                {
+                    texels[i + 0] = 0.5f;
+                    texels[i + 1] = 0.5f;
+                    texels[i + 2] = 1.0f;
+                    continue;
+                }
+
+                texels[i + 0] = (x / length) * 0.5f + 0.5f;
+                texels[i + 1] = (y / length) * 0.5f + 0.5f;
+                texels[i + 2] = (z / length) * 0.5f + 0.5f;
+            }
+        }
+
+        // the fraction of texels whose alpha passes the cutoff, the shaders discard alpha <= cutoff
+        float compute_coverage(const RowReader& source, const uint32_t height, const float cutoff)
+        {
+            vector<float> scratch(source.texels ? 0 : static_cast<size_t>(source.width) * 4);
+            uint64_t pass_count = 0;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const float* row = source.Read(y, scratch.data());
+                for (uint32_t x = 0; x < source.width; x++)
+                {
+                    pass_count += row[x * 4 + 3] > cutoff ? 1 : 0;
+                }
+            }
+
+            return static_cast<float>(static_cast<double>(pass_count) / (static_cast<double>(source.width) * height));
+        }
+
+        // filtering averages alpha towards the middle, so alpha tested geometry thins out (or grows) with distance,
+        // this finds the alpha scale at which this mip passes as many texels as the top one
+        float compute_alpha_scale(const vector<float>& texels, const float cutoff, const float coverage)
+        {
+            const size_t texel_count = texels.size() / 4;
+            const size_t pass_count  = static_cast<size_t>(coverage * static_cast<float>(texel_count) + 0.5f);
+            if (pass_count == 0)
+                return 1.0f;
+
+            vector<float> alphas(texel_count);
+            for (size_t i = 0; i < texel_count; i++)
+            {
+                alphas[i] = texels[i * 4 + 3];
+            }
+
+            // the alpha of the last texel that has to pass
+            nth_element(alphas.begin(), alphas.begin() + (pass_count - 1), alphas.end(), greater<float>());
+            float alpha = alphas[pass_count - 1];
+
+            // filtering produces many texels with the same alpha, which all pass or fail together,
+            // so pick whichever side of that group gets closer to the wanted count
+            size_t count_greater = 0;
+            size_t count_equal   = 0;
+            float alpha_above    = Helper::INFINITY_;
+            for (const float value : alphas)
+            {
+                if (value > alpha)
+                {
+                    count_greater++;
+                    alpha_above = min(alpha_above, value);
+                }
+                else if (value == alpha)
+                {
+                    count_equal++;
+                }
+            }
+
+            const size_t error_with    = count_greater + count_equal - pass_count;
+            const size_t error_without = pass_count - count_greater;
+            if (error_without < error_with && count_greater > 0)
+            {
+                alpha = alpha_above;
+            }
+
+            if (alpha <= 0.0f)
+                return 1.0f;
+
+            // land just above the cutoff, so the texel survives quantization
+            return (cutoff + 0.5f / 255.0f) / alpha;
+        }
+
+        float read_normalized(const std::byte* data, const size_t index, const uint32_t bits_per_channel)
+        {
+            if (bits_per_channel == 8)
+                return static_cast<float>(static_cast<uint8_t>(data[index])) / 255.0f;
+
+            if (bits_per_channel == 16)
+            {
+                uint16_t value;
+                memcpy(&value, data + index * 2, sizeof(value));
+                return static_cast<float>(value) / 65535.0f;
+            }
+
+            float value;
+            memcpy(&value, data + index * 4, sizeof(value));
+            return value;
+        }
+    }
+
+    void MipGenerator::Generate(
+        const std::byte* data,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t pitch,
+        const uint32_t channel_count,
+        const uint32_t bits_per_channel,
+        const uint32_t mip_count,
+        const MipSettings& settings,
+        vector<vector<std::byte>>* mips
+    )
+    {
+        SP_ASSERT(data != nullptr && mips != nullptr);
+        SP_ASSERT(width != 0 && height != 0 && mip_count != 0);
+        SP_ASSERT(channel_count >= 1 && channel_count <= 4);
+        SP_ASSERT(bits_per_channel == 8 || bits_per_channel == 16 || bits_per_channel == 32);
+
+        const uint32_t bytes_per_texel = channel_count * (bits_per_channel / 8);
+        mips->clear();
+        mips->resize(mip_count);
+
+        // the top mip is copied as is, minus any row padding
+        {
+            const size_t row_size  = static_cast<size_t>(width) * bytes_per_texel;
+            vector<std::byte>& mip = (*mips)[0];
+            mip.resize(row_size * height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                memcpy(&mip[y * row_size], data + static_cast<size_t>(y) * pitch, row_size);
+            }
+        }
+
+        const bool normal         = settings.normal && channel_count >= 3;
+        const bool srgb           = settings.srgb && channel_count >= 3 && !normal && bits_per_channel != 32;
+        const bool alpha_coverage = settings.alpha_cutoff > 0.0f && channel_count == 4;
+
+        RowReader reader;
+        reader.bytes            = data;
+        reader.width            = width;
+        reader.pitch            = pitch;
+        reader.channel_count    = channel_count;
+        reader.bits_per_channel = bits_per_channel;
+        reader.srgb             = srgb;
+
+        const float coverage = alpha_coverage ? compute_coverage(reader, height, settings.alpha_cutoff) : 0.0f;
+
+        // each mip is filtered from the previous one, which is kept as floats so no precision is lost along the chain
+        vector<float> texels;
+        vector<float> texels_previous;
+        uint32_t width_previous  = width;
+        uint32_t height_previous = height;
+        for (uint32_t mip_index = 1; mip_index < mip_count; mip_index++)
+        {
+            const uint32_t mip_width  = max(1u, width >> mip_index);
+            const uint32_t mip_height = max(1u, height >> mip_index);
+
+            downsample(reader, width_previous, height_previous, mip_width, mip_height, settings.filter, &texels);
+
+            if (normal)
+            {
+                renormalize(texels);
+            }
+
+            // the scale only applies to the output, the next mip is filtered from the unscaled alpha
+            const float alpha_scale = alpha_coverage ? compute_alpha_scale(texels, settings.alpha_cutoff, coverage) : 1.0f;
+
+            const size_t row_size  = static_cast<size_t>(mip_width) * bytes_per_texel;
+            vector<std::byte>& mip = (*mips)[mip_index];
+            mip.resize(row_size * mip_height);
+            ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+            {
+                for (uint32_t y = start; y < end; y++)
+                {
+                    encode_row(&texels[static_cast<size_t>(y) * mip_width * 4], mip_width, channel_count, bits_per_channel, srgb, alpha_scale, &mip[y * row_size]);
+                }
+            }, mip_height, rows_per_task_min);
+
+            texels_previous.swap(texels);
+            width_previous  = mip_width;
+            height_previous = mip_height;
+
+            reader.bytes  = nullptr;
+            reader.texels = texels_previous.data();
+            reader.width  = mip_width;
+        }
+    }
+
+    float MipGenerator::ComputePsnr(
+        const std::byte* a,
+        const std::byte* b,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t channel_count,
+        const uint32_t bits_per_channel
+    )
+    {
+        SP_ASSERT(a != nullptr && b != nullptr);
+
+        const size_t value_count = static_cast<size_t>(width) * height * channel_count;
+        if (value_count == 0)
+            return Helper::INFINITY_;
+
+        double error_sum = 0.0;
+        for (size_t i = 0; i < value_count; i++)
+        {
+            const double error = static_cast<double>(read_normalized(a, i, bits_per_channel)) - static_cast<double>(read_normalized(b, i, bits_per_channel));
+            error_sum += error * error;
+        }
+
+        // values are normalized, so the peak is 1
+        const double mse = error_sum / static_cast<double>(value_count);
+        return mse == 0.0 ? Helper::INFINITY_ : static_cast<float>(10.0 * log10(1.0 / mse));
+    }
+}
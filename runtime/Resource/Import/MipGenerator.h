@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include "../../Core/Definitions.h"
+//=================================
+
+namespace Spartan
+{
+    enum class MipFilter : uint8_t
+    {
+        Box,     // cheapest, softest
+        Kaiser,  // windowed sinc, sharp with little ringing
+        Lanczos, // sharpest, rings the most
+    };
+
+    struct MipSettings
+    {
+        MipFilter filter   = MipFilter::Kaiser;
+        bool srgb          = false; // rgb is srgb encoded and gets filtered in linear space
+        bool normal        = false; // rgb is a unit vector packed into [0, 1] and gets renormalized
+        float alpha_cutoff = 0.0f;  // if above 0, every mip keeps the fraction of texels whose alpha passes this cutoff
+    };
+
+    // generates a mip chain through successive 2x reductions, each mip is filtered from the previous one
+    // texels are filtered as four floats at a time and rows are spread across the thread pool
+    class SP_CLASS MipGenerator
+    {
+    public:
+        // data holds the top mip with rows pitch bytes apart, 1 to 4 channels of unorm8, unorm16 or float32
+        // the output holds mip_count tightly packed mips in the same format, starting with a copy of the top one
+        static void Generate(
+            const std::byte* data,
+            const uint32_t width,
+            const uint32_t height,
+            const uint32_t pitch,
+            const uint32_t channel_count,
+            const uint32_t bits_per_channel,
+            const uint32_t mip_count,
+            const MipSettings& settings,
+            std::vector<std::vector<std::byte>>* mips
+        );
+
+        // peak signal to noise ratio in db between two tightly packed images of the same format, infinity if they are identical
+        static float ComputePsnr(
+            const std::byte* a,
+            const std::byte* b,
+            const uint32_t width,
+            const uint32_t height,
+            const uint32_t channel_count,
+            const uint32_t bits_per_channel
+        );
+    };
+}
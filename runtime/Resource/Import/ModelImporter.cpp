@@ -23,6 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "ModelImporter.h"
 #include "../../Core/ProgressTracker.h"
+#include "../../Core/ThreadPool.h"
+#include "../../Resource/DerivedDataCache.h"
+#include "../../Resource/ResourceCache.h"
 #include "../../RHI/RHI_Texture.h"
 #include "../../Rendering/Animation.h"
 #include "../../Rendering/Mesh.h"
@@ -34,6 +37,8 @@ SP_WARNINGS_OFF
 #include "assimp/ProgressHandler.hpp"
 #include "assimp/version.h"
 #include "assimp/Importer.hpp"
+#include "assimp/Exporter.hpp"
+#include "assimp/DefaultIOSystem.h"
 #include "assimp/postprocess.h"
 SP_WARNINGS_ON
 //=====================================
@@ -55,6 +60,52 @@ namespace Spartan
         bool model_is_gltf       = false;
         const aiScene* scene     = nullptr;
 
+        // bump when the import produces different output, older derived data will then be ignored
+        const uint32_t derived_data_version = 2;
+
+        // the assimp texture types each engine texture type is read from, the legacy one is a fallback for non-pbr materials
+        struct TextureSlot
+        {
+            MaterialTexture texture_type      = MaterialTexture::Max;
+            aiTextureType type_assimp_pbr    = aiTextureType_NONE;
+            aiTextureType type_assimp_legacy = aiTextureType_NONE;
+        };
+
+        const array<TextureSlot, 8> texture_slots =
+        {{
+            { MaterialTexture::Color,     aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE           },
+            { MaterialTexture::Roughness, aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS         }, // use specular as fallback
+            { MaterialTexture::Metalness, aiTextureType_METALNESS,         aiTextureType_NONE              },
+            { MaterialTexture::Normal,    aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS           },
+            { MaterialTexture::Occlusion, aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP          },
+            { MaterialTexture::Emission,  aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE          },
+            { MaterialTexture::Height,    aiTextureType_HEIGHT,            aiTextureType_NONE              },
+            { MaterialTexture::AlphaMask, aiTextureType_OPACITY,           aiTextureType_NONE              }
+        }};
+
+        // a texture a material asked for, it's bound once all the textures of the model are loaded
+        struct TextureBinding
+        {
+            MaterialTexture texture_type  = MaterialTexture::Max;
+            aiTextureType type_assimp     = aiTextureType_NONE;
+            string file_path;
+        };
+
+        // materials are created once per assimp material, and finalized after their textures are bound
+        struct ImportedMaterial
+        {
+            shared_ptr<Material> material;
+            vector<TextureBinding> textures;
+        };
+        vector<ImportedMaterial> materials;
+
+        // textures are loaded on the thread pool while the nodes are parsed, once per file path
+        // a job writes its texture into its own map node, which is only read after all jobs are done
+        unordered_map<string, shared_ptr<RHI_Texture>> textures;
+        mutex mutex_textures;
+        condition_variable condition_textures;
+        uint32_t texture_jobs_pending = 0;
+
         Matrix convert_matrix(const aiMatrix4x4& transform)
         {
             return Matrix
@@ -91,6 +142,141 @@ namespace Spartan
             return Quaternion(ai_quaternion.x, ai_quaternion.y, ai_quaternion.z, ai_quaternion.w);
         }
 
+        void configure_importer(Importer& importer)
+        {
+            // remove points and lines
+            importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
+
+            // remove cameras
+            importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_CAMERAS);
+        }
+
+        uint32_t get_import_flags(const uint32_t mesh_flags)
+        {
+            uint32_t import_flags = 0;
+
+            import_flags |= aiProcess_ValidateDataStructure; // validates the imported scene data structure.
+            import_flags |= aiProcess_Triangulate;           // triangulates all faces of all meshes.
+            import_flags |= aiProcess_SortByPType;           // splits meshes with more than one primitive type in homogeneous sub-meshes
+
+            // switch to engine conventions
+            import_flags |= aiProcess_MakeLeftHanded;   // directx style
+            import_flags |= aiProcess_FlipUVs;          // directx style
+            import_flags |= aiProcess_FlipWindingOrder; // directx style
+
+            // generate missing normals or UVs
+            import_flags |= aiProcess_CalcTangentSpace; // calculates  tangents and bitangents
+            import_flags |= aiProcess_GenSmoothNormals; // ignored if the mesh already has normals
+            import_flags |= aiProcess_GenUVCoords;      // converts non-UV mappings (such as spherical or cylindrical mapping) to proper texture coordinate channels
+
+            // combine meshes
+            if (mesh_flags & static_cast<uint32_t>(MeshFlags::ImportCombineMeshes))
+            {
+                import_flags |= aiProcess_OptimizeMeshes;
+                import_flags |= aiProcess_OptimizeGraph;
+                import_flags |= aiProcess_PreTransformVertices;
+            }
+
+            // validate
+            if (mesh_flags & static_cast<uint32_t>(MeshFlags::ImportRemoveRedundantData))
+            {
+                import_flags |= aiProcess_RemoveRedundantMaterials; // searches for redundant/unreferenced materials and removes them
+                import_flags |= aiProcess_JoinIdenticalVertices;    // identifies and joins identical vertex data sets within all imported meshes
+                import_flags |= aiProcess_FindDegenerates;          // convert degenerate primitives to proper lines or points.
+                import_flags |= aiProcess_FindInvalidData;          // this step searches all meshes for invalid data, such as zeroed normal vectors or invalid UV coords and removes / fixes them
+                import_flags |= aiProcess_FindInstances;            // this step searches for duplicate meshes and replaces them with references to the first mesh
+            }
+
+            return import_flags;
+        }
+
+        string get_absolute_path(const string& file_path)
+        {
+            error_code error;
+            const filesystem::path path = filesystem::absolute(filesystem::path(file_path), error);
+            return (error ? filesystem::path(file_path) : path).lexically_normal().generic_string();
+        }
+
+        // records every file an import opens besides the model itself (a gltf's buffers, an obj's materials and so on)
+        class RecordingIOSystem : public DefaultIOSystem
+        {
+        public:
+            RecordingIOSystem(const string& file_path) : m_file_path(get_absolute_path(file_path)) { }
+
+            IOStream* Open(const char* file_path, const char* mode = "rb") override
+            {
+                IOStream* stream = DefaultIOSystem::Open(file_path, mode);
+                if (stream)
+                {
+                    const string path = get_absolute_path(file_path);
+                    if (path != m_file_path && find(m_file_paths.begin(), m_file_paths.end(), path) == m_file_paths.end())
+                    {
+                        m_file_paths.emplace_back(path);
+                    }
+                }
+
+                return stream;
+            }
+
+            const vector<string>& GetFilePaths() const { return m_file_paths; }
+
+        private:
+            string m_file_path;
+            vector<string> m_file_paths;
+        };
+
+        // reads the post-processed scene from the derived data cache, or imports it and stores it there,
+        // the key covers the model and the files the last import of it read, so it's also what the other derived data of the model is stored under
+        const aiScene* read_scene(Importer& importer, const string& file_path, const uint32_t mesh_flags, uint64_t* key)
+        {
+            const uint64_t key_source = DerivedDataCache::ComputeKey(file_path, mesh_flags, derived_data_version);
+            *key                      = 0;
+
+            vector<string> dependencies;
+            if (key_source != 0 && DerivedDataCache::ReadDependencies(key_source, &dependencies))
+            {
+                *key = DerivedDataCache::ComputeKey(key_source, dependencies);
+
+                const string file_path_derived = DerivedDataCache::GetFilePath(*key, ".assbin");
+                if (FileSystem::Exists(file_path_derived))
+                {
+                    if (const aiScene* scene_derived = importer.ReadFile(file_path_derived, 0))
+                        return scene_derived;
+                }
+            }
+
+            // the importer owns the io system
+            RecordingIOSystem* io_system = new RecordingIOSystem(file_path);
+            importer.SetIOHandler(io_system);
+            configure_importer(importer);
+            const aiScene* scene_imported = importer.ReadFile(file_path, get_import_flags(mesh_flags));
+            if (!scene_imported || key_source == 0)
+                return scene_imported;
+
+            dependencies = io_system->GetFilePaths();
+            sort(dependencies.begin(), dependencies.end());
+            DerivedDataCache::WriteDependencies(key_source, dependencies);
+            *key = DerivedDataCache::ComputeKey(key_source, dependencies);
+
+        #ifndef ASSIMP_BUILD_NO_EXPORT
+            {
+                const string file_path_derived = DerivedDataCache::GetFilePath(*key, ".assbin");
+                const string file_path_temp    = DerivedDataCache::GetTemporaryFilePath(file_path_derived);
+                Exporter exporter;
+                if (exporter.Export(scene_imported, "assbin", file_path_temp) == aiReturn_SUCCESS)
+                {
+                    DerivedDataCache::Commit(file_path_temp, file_path_derived);
+                }
+                else
+                {
+                    FileSystem::Delete(file_path_temp);
+                }
+            }
+        #endif
+
+            return scene_imported;
+        }
+
         void set_entity_transform(const aiNode* node, shared_ptr<Entity> entity)
         {
             // convert to engine matrix
@@ -213,41 +399,117 @@ namespace Spartan
             return "";
         }
 
-        bool load_material_texture(
-            Mesh* mesh,
-            const string& file_path,
-            const bool is_gltf,
-            shared_ptr<Material> material,
-            const aiMaterial* material_assimp,
-            const MaterialTexture texture_type,
-            const aiTextureType texture_type_assimp_pbr,
-            const aiTextureType texture_type_assimp_legacy
-        )
+        void request_texture(const string& file_path, const uint32_t flags)
+        {
+            auto it = textures.find(file_path);
+            if (it != textures.end())
+                return;
+
+            // if a previous import already loaded it, there is nothing to do
+            const string name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
+            shared_ptr<RHI_Texture>& texture = textures[file_path];
+            texture = ResourceCache::GetByName<RHI_Texture>(name);
+            if (texture)
+                return;
+
+            // with a single worker (and the import is likely running on it), nobody would pick the job up
+            if (ThreadPool::GetThreadCount() < 2)
+            {
+                texture = ResourceCache::Load<RHI_Texture>(file_path, flags);
+                return;
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_textures);
+                texture_jobs_pending++;
+            }
+
+            shared_ptr<RHI_Texture>* slot = &texture;
+            ThreadPool::AddTask([slot, file_path, flags]()
+            {
+                shared_ptr<RHI_Texture> texture = ResourceCache::Load<RHI_Texture>(file_path, flags);
+
+                lock_guard<mutex> lock(mutex_textures);
+                *slot = texture;
+                texture_jobs_pending--;
+                condition_textures.notify_all();
+            });
+        }
+
+        void wait_for_textures()
+        {
+            unique_lock<mutex> lock(mutex_textures);
+            condition_textures.wait(lock, []() { return texture_jobs_pending == 0; });
+        }
+
+        // the flags of the engine texture type an assimp texture type ends up as
+        uint32_t get_texture_import_flags(const aiTextureType type)
+        {
+            switch (type)
+            {
+                case aiTextureType_BASE_COLOR:
+                case aiTextureType_DIFFUSE:        return Material::GetTextureImportFlags(MaterialTexture::Color);
+                case aiTextureType_NORMAL_CAMERA:
+                case aiTextureType_NORMALS:        return Material::GetTextureImportFlags(MaterialTexture::Normal);
+                case aiTextureType_EMISSION_COLOR:
+                case aiTextureType_EMISSIVE:       return Material::GetTextureImportFlags(MaterialTexture::Emission);
+                case aiTextureType_HEIGHT:         return Material::GetTextureImportFlags(MaterialTexture::Height);
+                default:                           return 0;
+            }
+        }
+
+        // returns the path of the image the material has in this slot, or an empty string if there is none (or it's not supported)
+        string get_material_texture(const string& file_path, const aiMaterial* material_assimp, const TextureSlot& slot, aiTextureType* type_assimp_out)
         {
             // determine if this is a pbr material or not
             aiTextureType type_assimp = aiTextureType_NONE;
-            type_assimp = material_assimp->GetTextureCount(texture_type_assimp_pbr) > 0 ? texture_type_assimp_pbr : type_assimp;
-            type_assimp = (type_assimp == aiTextureType_NONE) ? (material_assimp->GetTextureCount(texture_type_assimp_legacy) > 0 ? texture_type_assimp_legacy : type_assimp) : type_assimp;
+            type_assimp = material_assimp->GetTextureCount(slot.type_assimp_pbr) > 0 ? slot.type_assimp_pbr : type_assimp;
+            type_assimp = (type_assimp == aiTextureType_NONE) ? (material_assimp->GetTextureCount(slot.type_assimp_legacy) > 0 ? slot.type_assimp_legacy : type_assimp) : type_assimp;
 
             // check if the material has any textures
             if (material_assimp->GetTextureCount(type_assimp) == 0)
-                return true;
+                return "";
 
             // try to get the texture path
             aiString texture_path;
             if (material_assimp->GetTexture(type_assimp, 0, &texture_path) != AI_SUCCESS)
-                return false;
+                return "";
 
             // see if the texture type is supported by the engine
             const string deduced_path = texture_validate_path(texture_path.data, file_path);
             if (!FileSystem::IsSupportedImageFile(deduced_path))
+                return "";
+
+            *type_assimp_out = type_assimp;
+            return deduced_path;
+        }
+
+        uint32_t get_material_texture_flags(const TextureSlot& slot)
+        {
+            return RHI_Texture_Srv | RHI_Texture_Compress | Material::GetTextureImportFlags(slot.texture_type);
+        }
+
+        // returns true if the material has a texture of this type
+        bool request_material_texture(ImportedMaterial& imported, const string& file_path, const aiMaterial* material_assimp, const TextureSlot& slot)
+        {
+            aiTextureType type_assimp = aiTextureType_NONE;
+            const string texture_path = get_material_texture(file_path, material_assimp, slot, &type_assimp);
+            if (texture_path.empty())
                 return false;
 
-            // add the texture to the model
-            mesh->AddTexture(material, texture_type, texture_validate_path(texture_path.data, file_path), is_gltf);
+            // start loading it, the material gets it once the parsing is done
+            request_texture(texture_path, get_material_texture_flags(slot));
+            imported.textures.push_back({ slot.texture_type, type_assimp, texture_path });
+
+            return true;
+        }
+
+        void bind_material_texture(Material* material, const TextureBinding& binding)
+        {
+            material->SetTexture(binding.texture_type, textures[binding.file_path]);
 
             // FIX: materials that have a diffuse texture should not be tinted black/gray
-            if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
+            if (binding.type_assimp == aiTextureType_BASE_COLOR || binding.type_assimp == aiTextureType_DIFFUSE)
             {
                 material->SetProperty(MaterialProperty::ColorR, 1.0f);
                 material->SetProperty(MaterialProperty::ColorG, 1.0f);
@@ -256,6 +518,7 @@ namespace Spartan
             }
 
             // FIX: Some models pass a normal map as a height map and vice versa, we correct that
+            const MaterialTexture texture_type = binding.texture_type;
             if (texture_type == MaterialTexture::Normal || texture_type == MaterialTexture::Height)
             {
                 if (RHI_Texture* texture = material->GetTexture(texture_type))
@@ -271,31 +534,46 @@ namespace Spartan
                     }
                 }
             }
-
-            return true;
         }
 
-        shared_ptr<Material> load_material(Mesh* mesh, const string& file_path, const bool is_gltf, const aiMaterial* material_assimp)
+        shared_ptr<Material> load_material(const string& file_path, const uint32_t material_index)
         {
+            ImportedMaterial& imported = materials[material_index];
+            if (imported.material)
+                return imported.material;
+
+            const aiMaterial* material_assimp = scene->mMaterials[material_index];
             SP_ASSERT(material_assimp != nullptr);
-            shared_ptr<Material> material = make_shared<Material>();
-
-            //                                                                         texture type,                texture type assimp (pbr),       texture type assimp (legacy/fallback)
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Color,      aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Roughness,  aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS); // use specular as fallback
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Metalness,  aiTextureType_METALNESS,         aiTextureType_NONE);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Normal,     aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Occlusion,  aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Emission,   aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::Height,     aiTextureType_HEIGHT,            aiTextureType_NONE);
-            load_material_texture(mesh, file_path, is_gltf, material, material_assimp, MaterialTexture::AlphaMask,  aiTextureType_OPACITY,           aiTextureType_NONE);
+            imported.material = make_shared<Material>();
+
+            for (const TextureSlot& slot : texture_slots)
+            {
+                request_material_texture(imported, file_path, material_assimp, slot);
+            }
 
             // name
             aiString name_assimp;
             aiGetMaterialString(material_assimp, AI_MATKEY_NAME, &name_assimp);
-            string name = name_assimp.C_Str();
             // set a material file path, this allows for the material to be cached (also means that if already cached, the engine will not save it as a duplicate)
-            material->SetResourceFilePath(FileSystem::RemoveIllegalCharacters(FileSystem::GetDirectoryFromFilePath(file_path) + name + EXTENSION_MATERIAL));
+            imported.material->SetResourceFilePath(FileSystem::RemoveIllegalCharacters(FileSystem::GetDirectoryFromFilePath(file_path) + name_assimp.C_Str() + EXTENSION_MATERIAL));
+
+            return imported.material;
+        }
+
+        // runs once the textures are loaded, the properties below depend on which textures the material ended up with
+        void finalize_material(ImportedMaterial& imported, const bool is_gltf, const aiMaterial* material_assimp)
+        {
+            Material* material = imported.material.get();
+
+            for (const TextureBinding& binding : imported.textures)
+            {
+                bind_material_texture(material, binding);
+            }
+
+            // name
+            aiString name_assimp;
+            aiGetMaterialString(material_assimp, AI_MATKEY_NAME, &name_assimp);
+            string name = name_assimp.C_Str();
 
             // color
             aiColor4D color_diffuse(1.0f, 1.0f, 1.0f, 1.0f);
@@ -384,8 +662,6 @@ namespace Spartan
                     }
                 }
             }
-
-            return material;
         }
     }
 
@@ -416,58 +692,15 @@ namespace Spartan
 
         // set up the importer
         Importer importer;
-        {
-            // remove points and lines
-            importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
-
-            // remove cameras
-            importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_CAMERAS);
-
-            // enable progress tracking
-            importer.SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
-            importer.SetProgressHandler(new AssimpProgress(file_path));
-        }
-
-        // import flags
-        uint32_t import_flags = 0;
-        {
-            import_flags |= aiProcess_ValidateDataStructure; // validates the imported scene data structure.
-            import_flags |= aiProcess_Triangulate;           // triangulates all faces of all meshes.
-            import_flags |= aiProcess_SortByPType;           // splits meshes with more than one primitive type in homogeneous sub-meshes
-
-            // switch to engine conventions
-            import_flags |= aiProcess_MakeLeftHanded;   // directx style
-            import_flags |= aiProcess_FlipUVs;          // directx style
-            import_flags |= aiProcess_FlipWindingOrder; // directx style
-
-            // generate missing normals or UVs
-            import_flags |= aiProcess_CalcTangentSpace; // calculates  tangents and bitangents
-            import_flags |= aiProcess_GenSmoothNormals; // ignored if the mesh already has normals
-            import_flags |= aiProcess_GenUVCoords;      // converts non-UV mappings (such as spherical or cylindrical mapping) to proper texture coordinate channels
-
-            // combine meshes
-            if (mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::ImportCombineMeshes))
-            {
-                import_flags |= aiProcess_OptimizeMeshes;
-                import_flags |= aiProcess_OptimizeGraph;
-                import_flags |= aiProcess_PreTransformVertices;
-            }
-
-            // validate
-            if (mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::ImportRemoveRedundantData))
-            {
-                import_flags |= aiProcess_RemoveRedundantMaterials; // searches for redundant/unreferenced materials and removes them
-                import_flags |= aiProcess_JoinIdenticalVertices;    // identifies and joins identical vertex data sets within all imported meshes
-                import_flags |= aiProcess_FindDegenerates;          // convert degenerate primitives to proper lines or points.
-                import_flags |= aiProcess_FindInvalidData;          // this step searches all meshes for invalid data, such as zeroed normal vectors or invalid UV coords and removes / fixes them
-                import_flags |= aiProcess_FindInstances;            // this step searches for duplicate meshes and replaces them with references to the first mesh
-            }
-        }
+        importer.SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+        importer.SetProgressHandler(new AssimpProgress(file_path));
 
         ProgressTracker::GetProgress(ProgressType::ModelImporter).Start(1, "Loading model from drive...");
 
-        // read the 3D model file from drive
-        if (scene = importer.ReadFile(file_path, import_flags))
+        // read the 3D model file from drive, post-processing is the slow part so the processed scene is kept in the derived data cache
+        uint64_t key = 0;
+        scene        = read_scene(importer, file_path, mesh->GetFlags(), &key);
+        if (scene)
         {
             // update progress tracking
             uint32_t job_count = 0;
@@ -476,23 +709,46 @@ namespace Spartan
 
             model_has_animation = scene->mNumAnimations != 0;
 
-            // recursively parse nodes
+            // recursively parse nodes, material textures load in the background meanwhile
+            materials.resize(scene->mNumMaterials);
             ParseNode(scene->mRootNode);
 
-            // update model geometry
+            // bind the textures and finish the materials
+            wait_for_textures();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(materials.size()); i++)
             {
-                while (ProgressTracker::GetProgress(ProgressType::ModelImporter).GetFraction() != 1.0f)
+                if (materials[i].material)
                 {
-                    SP_LOG_INFO("Waiting for node processing threads to finish before creating GPU buffers...");
-                    this_thread::sleep_for(std::chrono::milliseconds(16));
+                    finalize_material(materials[i], model_is_gltf, scene->mMaterials[i]);
                 }
+            }
+
+            // update model geometry
+            {
 
-                // optimize
+                // optimize, the result only depends on the source and the flags, so it's cached too
                 if ((mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::OptimizeVertexCache)) ||
                     (mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::OptimizeVertexFetch)) ||
                     (mesh->GetFlags() & static_cast<uint32_t>(MeshFlags::OptimizeOverdraw)))
                 {
-                    mesh->Optimize();
+                    const string file_path_derived = key != 0 ? DerivedDataCache::GetFilePath(key, EXTENSION_MODEL) : "";
+                    if (file_path_derived.empty() || !FileSystem::Exists(file_path_derived) || !mesh->LoadGeometry(file_path_derived))
+                    {
+                        mesh->Optimize();
+
+                        if (!file_path_derived.empty())
+                        {
+                            const string file_path_temp = DerivedDataCache::GetTemporaryFilePath(file_path_derived);
+                            if (mesh->SaveToFile(file_path_temp))
+                            {
+                                DerivedDataCache::Commit(file_path_temp, file_path_derived);
+                            }
+                            else
+                            {
+                                FileSystem::Delete(file_path_temp);
+                            }
+                        }
+                    }
                 }
 
                 // aabb
@@ -520,10 +776,101 @@ namespace Spartan
 
         importer.FreeScene();
         mesh = nullptr;
+        materials.clear();
+        textures.clear();
 
         return scene != nullptr;
     }
 
+    bool ModelImporter::Cook(const string& file_path, const uint32_t mesh_flags, vector<string>* texture_file_paths)
+    {
+        if (!FileSystem::IsFile(file_path))
+            return false;
+
+        // the post-processed scene
+        Importer importer;
+        uint64_t key                = 0;
+        const aiScene* cooked_scene = read_scene(importer, file_path, mesh_flags, &key);
+        if (!cooked_scene)
+        {
+            SP_LOG_ERROR("%s", importer.GetErrorString());
+            return false;
+        }
+
+        // the textures the materials reference, from the same slots and with the same flags that Load() reads them with,
+        // a texture in more than one slot is loaded once, with the flags of the first one
+        vector<pair<string, uint32_t>> textures_to_cook;
+        for (uint32_t material_index = 0; material_index < cooked_scene->mNumMaterials; material_index++)
+        {
+            const aiMaterial* material_assimp = cooked_scene->mMaterials[material_index];
+            for (const TextureSlot& slot : texture_slots)
+            {
+                aiTextureType type_assimp = aiTextureType_NONE;
+                const string texture_path = get_material_texture(file_path, material_assimp, slot, &type_assimp);
+                const auto it             = find_if(textures_to_cook.begin(), textures_to_cook.end(), [&texture_path](const auto& texture) { return texture.first == texture_path; });
+                if (!texture_path.empty() && it == textures_to_cook.end())
+                {
+                    textures_to_cook.emplace_back(texture_path, get_material_texture_flags(slot));
+                }
+            }
+        }
+        importer.FreeScene();
+
+        if (texture_file_paths)
+        {
+            for (const auto& texture : textures_to_cook)
+            {
+                texture_file_paths->emplace_back(texture.first);
+            }
+        }
+
+        atomic<bool> success = true;
+        auto cook_textures = [&textures_to_cook, &success](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                if (!RHI_Texture::Cook(textures_to_cook[i].first, textures_to_cook[i].second))
+                {
+                    success = false;
+                }
+            }
+        };
+
+        ThreadPool::ParallelLoop(cook_textures, static_cast<uint32_t>(textures_to_cook.size()));
+
+        // optimized geometry depends on how the nodes are parsed, so it's cached the first time the model is loaded
+        return success;
+    }
+
+    uint32_t ModelImporter::GetTextureImportFlags(const string& file_path)
+    {
+        // the usual suffixes of texture sets, the first match wins
+        static const array<pair<const char*, aiTextureType>, 11> suffixes =
+        {{
+            { "normal",    aiTextureType_NORMALS    },
+            { "nrm",       aiTextureType_NORMALS    },
+            { "height",    aiTextureType_HEIGHT     },
+            { "bump",      aiTextureType_HEIGHT     },
+            { "disp",      aiTextureType_HEIGHT     },
+            { "emissive",  aiTextureType_EMISSIVE   },
+            { "emission",  aiTextureType_EMISSIVE   },
+            { "basecolor", aiTextureType_BASE_COLOR },
+            { "albedo",    aiTextureType_BASE_COLOR },
+            { "diffuse",   aiTextureType_DIFFUSE    },
+            { "color",     aiTextureType_DIFFUSE    }
+        }};
+
+        string name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        for (const auto& [suffix, type] : suffixes)
+        {
+            if (name.find(suffix) != string::npos)
+                return RHI_Texture_Srv | RHI_Texture_Compress | get_texture_import_flags(type);
+        }
+
+        return RHI_Texture_Srv | RHI_Texture_Compress;
+    }
+
     void ModelImporter::ParseNode(const aiNode* node, shared_ptr<Entity> parent_entity)
     {
         // create an entity that will match this node.
@@ -742,11 +1089,8 @@ namespace Spartan
         // material
         if (scene->HasMaterials())
         {
-            // get aiMaterial
-            const aiMaterial* assimp_material = scene->mMaterials[assimp_mesh->mMaterialIndex];
-
-            // convert it and add it to the model
-            shared_ptr<Material> material = load_material(mesh, model_file_path, model_is_gltf, assimp_material);
+            // convert it and add it to the model, meshes that share an assimp material share the engine material too
+            shared_ptr<Material> material = load_material(model_file_path, assimp_mesh->mMaterialIndex);
 
             mesh->SetMaterial(material, entity_parent.get());
         }
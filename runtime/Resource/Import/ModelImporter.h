@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ======================
 #include <string>
+#include <vector>
 #include "../../Core/Definitions.h"
 //=================================
 
@@ -40,6 +41,13 @@ namespace Spartan
         static void Initialize();
         static bool Load(Mesh* mesh, const std::string& file_path);
 
+        // imports the model and its textures into the derived data cache without creating any entities or gpu resources,
+        // the textures it cooked are appended to texture_file_paths (if provided)
+        static bool Cook(const std::string& file_path, const uint32_t mesh_flags, std::vector<std::string>* texture_file_paths = nullptr);
+
+        // the flags an image which no model references is imported with, deduced from the slot its name suggests (e.g. "brick_normal")
+        static uint32_t GetTextureImportFlags(const std::string& file_path);
+
     private:
         static void ParseNode(const aiNode* node, std::shared_ptr<Entity> parent_entity = nullptr);
         static void ParseNodeMeshes(const aiNode* node, std::shared_ptr<Entity> new_entity);
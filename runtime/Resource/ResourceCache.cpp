@@ -24,9 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ResourceCache.h"
 #include "../World/World.h"
 #include "../IO/FileStream.h"
+#include "../IO/AssetContainer.h"
 #include "../RHI/RHI_Texture.h"
 #include "../Audio/AudioClip.h"
 #include "../Rendering/Mesh.h"
+#include "../World/Prefab.h"
+#include "../Core/ThreadPool.h"
+#include "../IO/pugixml.hpp"
 //===============================
 
 //= NAMESPACES ================
@@ -40,9 +44,139 @@ namespace Spartan
     {
         array<string, 6> m_standard_resource_directories;
         string m_project_directory;
-        vector<shared_ptr<IResource>> m_resources;
-        mutex m_mutex;
         bool use_root_shader_directory = false;
+
+        // lookups go through hash indices which are split into shards, each with its own reader/writer lock,
+        // so concurrent loaders only contend when they hit the same shard, and readers never block each other
+        const uint32_t shard_count = 16;
+        const uint32_t type_count  = static_cast<uint32_t>(ResourceType::Max);
+
+        template<typename Key>
+        struct Shard
+        {
+            shared_mutex mutex;
+            unordered_map<Key, shared_ptr<IResource>> map;
+        };
+
+        // what a resource was indexed with, so it can be removed even if its name or path changed since
+        struct Record
+        {
+            shared_ptr<IResource> resource;
+            string path;
+            string name;
+            uint64_t id   = 0;
+            uint64_t size = 0;
+        };
+
+        // per type storage, records are dense and swap-removed, memory and count are kept up to date on every change
+        struct Bucket
+        {
+            shared_mutex mutex;
+            vector<Record> records;
+            unordered_map<const IResource*, uint32_t> slots;
+            atomic<uint64_t> memory_usage = 0;
+            atomic<uint32_t> count        = 0;
+        };
+
+        // lock order is path shard, name shard, id shard, bucket
+        array<array<Shard<string>, shard_count>, type_count> shards_path;
+        array<array<Shard<string>, shard_count>, type_count> shards_name;
+        array<Shard<uint64_t>, shard_count> shards_id;
+        array<Bucket, type_count> buckets;
+
+        uint32_t get_shard_index(const uint64_t hash)
+        {
+            // fold the high bits in, so the shard doesn't correlate with the bucket the map picks
+            return static_cast<uint32_t>((hash ^ (hash >> 32)) & (shard_count - 1));
+        }
+
+        Shard<string>& get_shard_path(const string& path, const ResourceType type)
+        {
+            return shards_path[static_cast<uint32_t>(type)][get_shard_index(hash<string>{}(path))];
+        }
+
+        Shard<string>& get_shard_name(const string& name, const ResourceType type)
+        {
+            return shards_name[static_cast<uint32_t>(type)][get_shard_index(hash<string>{}(name))];
+        }
+
+        Shard<uint64_t>& get_shard_id(const uint64_t id)
+        {
+            return shards_id[get_shard_index(id * 0x9E3779B97F4A7C15ull)];
+        }
+
+        bool is_valid_type(const ResourceType type)
+        {
+            return static_cast<uint32_t>(type) < type_count;
+        }
+
+        template<typename Key>
+        shared_ptr<IResource> find(Shard<Key>& shard, const Key& key)
+        {
+            shared_lock<shared_mutex> lock(shard.mutex);
+            auto it = shard.map.find(key);
+            return it != shard.map.end() ? it->second : nullptr;
+        }
+
+        template<typename Key>
+        void erase_if_same(Shard<Key>& shard, const Key& key, const IResource* resource)
+        {
+            lock_guard<shared_mutex> lock(shard.mutex);
+            auto it = shard.map.find(key);
+            if (it != shard.map.end() && it->second.get() == resource)
+            {
+                shard.map.erase(it);
+            }
+        }
+
+        // a node of the deserialization graph, a resource is decoded once its file has been read and all its dependencies are loaded
+        struct LoadJob
+        {
+            string file_path;
+            ResourceType type = ResourceType::Max;
+            vector<uint32_t> dependents;
+            atomic<uint32_t> dependencies_left = 0;
+            shared_ptr<AssetContainer> container; // the file, mapped and paged in by an io lane, the decoder reads it from there
+        };
+
+        // reading is bound by the drive, so only a few lanes do it, and they hand decoding over to the rest of the pool
+        const uint32_t io_lane_count = 2;
+
+        void read_file(LoadJob* job)
+        {
+            // containers (meshes and textures, the bulk of the data) are handed to the decoder as they are mapped here,
+            // anything else is small or in an older format and is read by its decoder, so no file is read twice
+            if (!AssetContainer::IsContainer(job->file_path))
+                return;
+
+            shared_ptr<AssetContainer> container = make_shared<AssetContainer>();
+            if (container->Open(job->file_path))
+            {
+                container->Prefetch();
+                job->container = move(container);
+            }
+        }
+
+        vector<string> get_material_texture_paths(const string& file_path)
+        {
+            vector<string> paths;
+
+            pugi::xml_document doc;
+            if (!doc.load_file(file_path.c_str()))
+                return paths;
+
+            pugi::xml_node node_textures = doc.child("Material").child("textures");
+            for (pugi::xml_node node_texture : node_textures.children())
+            {
+                string path = node_texture.attribute("texture_path").as_string();
+                if (!path.empty())
+                {
+                    paths.emplace_back(move(path));
+                }
+            }
+
+            return paths;
+        }
     }
 
     void ResourceCache::Initialize()
@@ -69,82 +203,211 @@ namespace Spartan
     {
         SP_ASSERT(!resource_file_path_native.empty());
 
-        lock_guard<mutex> guard(m_mutex);
+        if (!is_valid_type(resource_type))
+            return false;
+
+        return find(get_shard_path(resource_file_path_native, resource_type), resource_file_path_native) != nullptr;
+    }
 
-        for (shared_ptr<IResource>& resource : m_resources)
+    bool ResourceCache::IsCached(const uint64_t resource_id)
+    {
+        return find(get_shard_id(resource_id), resource_id) != nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::Insert(const shared_ptr<IResource>& resource)
+    {
+        const ResourceType type = resource->GetResourceType();
+        SP_ASSERT_MSG(is_valid_type(type), "Resources must have a type");
+
+        Record record;
+        record.resource = resource;
+        record.path     = resource->GetResourceFilePathNative();
+        record.name     = resource->GetObjectName();
+        record.id       = resource->GetObjectId();
+
+        // the path shard stays locked until the resource is fully indexed, so two threads
+        // caching the same path can't both succeed, and the loser gets the winner's resource
+        Shard<string>& shard_path = get_shard_path(record.path, type);
+        lock_guard<shared_mutex> lock_path(shard_path.mutex);
         {
-            if (resource->GetResourceType() != resource_type)
-                continue;
+            auto it = shard_path.map.find(record.path);
+            if (it != shard_path.map.end())
+                return it->second;
+
+            shard_path.map.emplace(record.path, resource);
+        }
+
+        // names and ids are not guaranteed to be unique, the first resource to claim them wins
+        {
+            Shard<string>& shard = get_shard_name(record.name, type);
+            lock_guard<shared_mutex> lock(shard.mutex);
+            shard.map.emplace(record.name, resource);
+        }
 
-            if (resource_file_path_native == resource->GetResourceFilePathNative())
-                return true;
+        {
+            Shard<uint64_t>& shard = get_shard_id(record.id);
+            lock_guard<shared_mutex> lock(shard.mutex);
+            shard.map.emplace(record.id, resource);
         }
 
-        return false;
+        {
+            Bucket& bucket = buckets[static_cast<uint32_t>(type)];
+            lock_guard<shared_mutex> lock(bucket.mutex);
+
+            record.size = resource->GetObjectSize();
+            bucket.memory_usage += record.size;
+            bucket.count++;
+            bucket.slots[resource.get()] = static_cast<uint32_t>(bucket.records.size());
+            bucket.records.emplace_back(move(record));
+        }
+
+        return resource;
     }
 
-    bool ResourceCache::IsCached(const uint64_t resource_id)
+    void ResourceCache::Erase(const shared_ptr<IResource>& resource)
     {
-        lock_guard<mutex> guard(m_mutex);
+        const ResourceType type = resource->GetResourceType();
+        if (!is_valid_type(type))
+            return;
 
-        for (shared_ptr<IResource>& resource : m_resources)
+        // take the record out of its bucket
+        Bucket& bucket = buckets[static_cast<uint32_t>(type)];
+        Record record;
         {
-            if (resource_id == resource->GetObjectId())
-                return true;
+            lock_guard<shared_mutex> lock(bucket.mutex);
+
+            auto it = bucket.slots.find(resource.get());
+            if (it == bucket.slots.end())
+                return;
+
+            const uint32_t slot = it->second;
+            bucket.slots.erase(it);
+
+            record = move(bucket.records[slot]);
+            if (slot != bucket.records.size() - 1)
+            {
+                bucket.records[slot] = move(bucket.records.back());
+                bucket.slots[bucket.records[slot].resource.get()] = slot;
+            }
+            bucket.records.pop_back();
+
+            bucket.memory_usage -= record.size;
+            bucket.count--;
         }
 
-        return false;
+        erase_if_same(get_shard_path(record.path, type), record.path, resource.get());
+        erase_if_same(get_shard_id(record.id), record.id, resource.get());
+
+        // if the name pointed to this resource, hand it over to another resource with the same name
+        Shard<string>& shard_name = get_shard_name(record.name, type);
+        lock_guard<shared_mutex> lock_name(shard_name.mutex);
+        auto it = shard_name.map.find(record.name);
+        if (it != shard_name.map.end() && it->second == resource)
+        {
+            shard_name.map.erase(it);
+
+            shared_lock<shared_mutex> lock(bucket.mutex);
+            for (const Record& other : bucket.records)
+            {
+                if (other.name == record.name)
+                {
+                    shard_name.map.emplace(record.name, other.resource);
+                    break;
+                }
+            }
+        }
     }
-    
-	shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const ResourceType type)
+
+    shared_ptr<IResource> ResourceCache::GetByName(const string& name, const ResourceType type)
     {
-        lock_guard<mutex> guard(m_mutex);
+        if (is_valid_type(type))
+            return find(get_shard_name(name, type), name);
 
-        for (shared_ptr<IResource>& resource : m_resources)
+        // no type, check them all
+        for (uint32_t i = 0; i < type_count; i++)
         {
-            if (name == resource->GetObjectName())
+            if (shared_ptr<IResource> resource = find(get_shard_name(name, static_cast<ResourceType>(i)), name))
                 return resource;
         }
 
-        static shared_ptr<IResource> empty;
-        return empty;
+        return nullptr;
     }
 
-    vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Unknown*/)
+    shared_ptr<IResource> ResourceCache::GetByPath(const string& path, const ResourceType type)
     {
-        lock_guard<mutex> guard(m_mutex);
+        if (!is_valid_type(type))
+            return nullptr;
 
+        return find(get_shard_path(path, type), path);
+    }
+
+    vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Max*/)
+    {
         vector<shared_ptr<IResource>> resources;
-        for (shared_ptr<IResource>& resource : m_resources)
+        resources.reserve(GetResourceCount(type));
+
+        for (uint32_t i = 0; i < type_count; i++)
         {
-            if (resource->GetResourceType() == type || type == ResourceType::Max)
+            if (static_cast<ResourceType>(i) != type && type != ResourceType::Max)
+                continue;
+
+            shared_lock<shared_mutex> lock(buckets[i].mutex);
+            for (const Record& record : buckets[i].records)
             {
-                resources.emplace_back(resource);
+                resources.emplace_back(record.resource);
             }
         }
 
         return resources;
     }
 
-    uint64_t ResourceCache::GetMemoryUsage(ResourceType type /*= Resource_Unknown*/)
+    uint64_t ResourceCache::GetMemoryUsage(ResourceType type /*= ResourceType::Max*/)
     {
-        lock_guard<mutex> guard(m_mutex);
+        if (is_valid_type(type))
+            return buckets[static_cast<uint32_t>(type)].memory_usage;
 
         uint64_t size = 0;
-        for (shared_ptr<IResource>& resource : m_resources)
+        for (Bucket& bucket : buckets)
         {
-            if (resource->GetResourceType() == type || type == ResourceType::Max)
-            {
-                if (SpartanObject* object = dynamic_cast<SpartanObject*>(resource.get()))
-                {
-                    size += object->GetObjectSize();
-                }
-            }
+            size += bucket.memory_usage;
         }
 
         return size;
     }
 
+    uint32_t ResourceCache::GetResourceCount(const ResourceType type /*= ResourceType::Max*/)
+    {
+        if (is_valid_type(type))
+            return buckets[static_cast<uint32_t>(type)].count;
+
+        uint32_t count = 0;
+        for (Bucket& bucket : buckets)
+        {
+            count += bucket.count;
+        }
+
+        return count;
+    }
+
+    void ResourceCache::OnResourceSizeChanged(const IResource* resource)
+    {
+        const ResourceType type = resource->GetResourceType();
+        if (!is_valid_type(type))
+            return;
+
+        Bucket& bucket = buckets[static_cast<uint32_t>(type)];
+        lock_guard<shared_mutex> lock(bucket.mutex);
+
+        auto it = bucket.slots.find(resource);
+        if (it == bucket.slots.end())
+            return;
+
+        Record& record       = bucket.records[it->second];
+        bucket.memory_usage -= record.size;
+        record.size          = resource->GetObjectSize();
+        bucket.memory_usage += record.size;
+    }
+
     void ResourceCache::Serialize()
     {
         // create resource list file
@@ -156,26 +419,25 @@ namespace Spartan
             return;
         }
 
-        const uint32_t resource_count = GetResourceCount();
+        // only resources with a native file can be loaded back
+        vector<shared_ptr<IResource>> resources = GetByType();
+        resources.erase(remove_if(resources.begin(), resources.end(), [](const shared_ptr<IResource>& resource) { return !resource->HasFilePathNative(); }), resources.end());
+        const uint32_t resource_count = static_cast<uint32_t>(resources.size());
 
         // start progress report
-        ProgressTracker::GetProgress(ProgressType::Resource).Start(resource_count, "Loading resources...");
+        ProgressTracker::GetProgress(ProgressType::Resource).Start(resource_count, "Saving resources...");
 
         // save resource count
         file->Write(resource_count);
 
         // save all the currently used resources to disk
-        for (shared_ptr<IResource>& resource : m_resources)
+        for (shared_ptr<IResource>& resource : resources)
         {
-            if (resource->HasFilePathNative())
-            {
-                SP_ASSERT_MSG(!resource->GetResourceFilePathNative().empty(), "Resources must have a native file path");
-                SP_ASSERT_MSG(resource->GetResourceType() != ResourceType::Max, "Resources must have a type");
+            SP_ASSERT_MSG(resource->GetResourceType() != ResourceType::Max, "Resources must have a type");
 
-                file->Write(resource->GetResourceFilePathNative());              // file path
-                file->Write(static_cast<uint32_t>(resource->GetResourceType())); // type
-                resource->SaveToFile(resource->GetResourceFilePathNative());     // save
-            }
+            file->Write(resource->GetResourceFilePathNative());              // file path
+            file->Write(static_cast<uint32_t>(resource->GetResourceType())); // type
+            resource->SaveToFile(resource->GetResourceFilePathNative());     // save
 
             // update progress
             ProgressTracker::GetProgress(ProgressType::Resource).JobDone();
@@ -190,41 +452,197 @@ namespace Spartan
         if (!file->IsOpen())
             return;
 
-        // go through each resource and load it
+        const Stopwatch timer;
+
+        // read the manifest
         const uint32_t resource_count = file->ReadAs<uint32_t>();
+        vector<LoadJob> jobs(resource_count);
+        unordered_map<string, uint32_t> texture_jobs;
+        for (uint32_t i = 0; i < resource_count; i++)
+        {
+            jobs[i].file_path = file->ReadAs<string>();
+            jobs[i].type      = static_cast<ResourceType>(file->ReadAs<uint32_t>());
+
+            if (jobs[i].type == ResourceType::Texture)
+            {
+                texture_jobs.emplace(jobs[i].file_path, i);
+            }
+        }
+        file->Close();
+
+        if (resource_count == 0)
+            return;
+
+        ProgressTracker::GetProgress(ProgressType::Resource).Start(resource_count, "Loading resources...");
+
+        // build the dependency graph, materials wait for their textures, meshes, textures and audio clips are independent
+        // every job also waits for its own file to be read, materials are small so they are read here, while building the graph
+        vector<uint32_t> jobs_io;
+        vector<uint32_t> jobs_ready;
         for (uint32_t i = 0; i < resource_count; i++)
         {
-            string file_path = file->ReadAs<string>();
-            const ResourceType type = static_cast<ResourceType>(file->ReadAs<uint32_t>());
+            LoadJob& job = jobs[i];
+
+            if (job.type != ResourceType::Material)
+            {
+                job.dependencies_left = 1;
+                jobs_io.emplace_back(i);
+                continue;
+            }
+
+            for (const string& texture_path : get_material_texture_paths(job.file_path))
+            {
+                auto it = texture_jobs.find(texture_path);
+                if (it != texture_jobs.end())
+                {
+                    jobs[it->second].dependents.emplace_back(i);
+                    job.dependencies_left++;
+                }
+            }
+
+            if (job.dependencies_left == 0)
+            {
+                jobs_ready.emplace_back(i);
+            }
+        }
+
+        // with fewer than two workers (the caller might be one of them) there is nobody to wait on, so load in place
+        if (ThreadPool::GetThreadCount() < 2)
+        {
+            vector<uint32_t> order = jobs_io;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(order.size()); i++)
+            {
+                for (uint32_t dependent : jobs[order[i]].dependents)
+                {
+                    if (--jobs[dependent].dependencies_left == 0)
+                    {
+                        order.emplace_back(dependent);
+                    }
+                }
+            }
+            order.insert(order.end(), jobs_ready.begin(), jobs_ready.end());
+
+            for (uint32_t index : order)
+            {
+                LoadJob& job = jobs[index];
+                LoadByType(job.file_path, job.type, job.container);
+                ProgressTracker::GetProgress(ProgressType::Resource).JobDone();
+            }
+        }
+        else
+        {
+            // the counters are guarded by the mutex, so the tasks are done touching this stack frame by the time the wait returns
+            uint32_t jobs_done         = 0;
+            uint32_t lanes_done        = 0;
+            atomic<uint32_t> io_cursor = 0;
+            mutex mutex_done;
+            condition_variable condition_done;
+            const uint32_t lane_count = min(io_lane_count, static_cast<uint32_t>(jobs_io.size()));
+
+            function<void(uint32_t)> decode = [&](const uint32_t index)
+            {
+                LoadJob& job = jobs[index];
+                LoadByType(job.file_path, job.type, job.container);
+                job.container = nullptr; // the resource holds on to it if it still needs it
+                ProgressTracker::GetProgress(ProgressType::Resource).JobDone();
+
+                for (uint32_t dependent : job.dependents)
+                {
+                    if (--jobs[dependent].dependencies_left == 0)
+                    {
+                        ThreadPool::AddTask([&decode, dependent]() { decode(dependent); });
+                    }
+                }
+
+                lock_guard<mutex> lock(mutex_done);
+                jobs_done++;
+                condition_done.notify_one();
+            };
 
-            switch (type)
+            for (uint32_t index : jobs_ready)
             {
-            case ResourceType::Mesh:
-                Load<Mesh>(file_path);
-                break;
-            case ResourceType::Material:
-                Load<Material>(file_path);
-                break;
-            case ResourceType::Texture:
-                Load<RHI_Texture>(file_path);
-                break;
-            case ResourceType::Audio:
-                Load<AudioClip>(file_path);
-                break;
+                ThreadPool::AddTask([&decode, index]() { decode(index); });
             }
+
+            for (uint32_t lane = 0; lane < lane_count; lane++)
+            {
+                ThreadPool::AddTask([&]()
+                {
+                    for (uint32_t i = io_cursor++; i < jobs_io.size(); i = io_cursor++)
+                    {
+                        const uint32_t index = jobs_io[i];
+                        read_file(&jobs[index]);
+
+                        if (--jobs[index].dependencies_left == 0)
+                        {
+                            ThreadPool::AddTask([&decode, index]() { decode(index); });
+                        }
+                    }
+
+                    lock_guard<mutex> lock(mutex_done);
+                    lanes_done++;
+                    condition_done.notify_one();
+                });
+            }
+
+            unique_lock<mutex> lock(mutex_done);
+            condition_done.wait(lock, [&]() { return jobs_done == resource_count && lanes_done == lane_count; });
         }
+
+        SP_LOG_INFO("%d resources have been loaded. Duration %.2f ms", resource_count, timer.GetElapsedTimeMs());
     }
 
-    void ResourceCache::Shutdown()
+    void ResourceCache::LoadByType(const string& file_path, const ResourceType type, const shared_ptr<AssetContainer>& container)
     {
-        uint32_t resource_count = static_cast<uint32_t>(m_resources.size());
-        m_resources.clear();
-        SP_LOG_INFO("%d resources have been cleared", resource_count);
+        switch (type)
+        {
+        case ResourceType::Mesh:
+            Load<Mesh>(file_path, 0, container);
+            break;
+        case ResourceType::Material:
+            Load<Material>(file_path);
+            break;
+        case ResourceType::Texture:
+            Load<RHI_Texture>(file_path, 0, container);
+            break;
+        case ResourceType::Audio:
+            Load<AudioClip>(file_path);
+            break;
+        case ResourceType::Prefab:
+            Load<Prefab>(file_path);
+            break;
+        default:
+            break;
+        }
     }
 
-    uint32_t ResourceCache::GetResourceCount(const ResourceType type)
+    void ResourceCache::Shutdown()
     {
-        return static_cast<uint32_t>(GetByType(type).size());
+        uint32_t resource_count = GetResourceCount();
+
+        for (Bucket& bucket : buckets)
+        {
+            lock_guard<shared_mutex> lock(bucket.mutex);
+            bucket.records.clear();
+            bucket.slots.clear();
+            bucket.memory_usage = 0;
+            bucket.count        = 0;
+        }
+
+        auto clear = [](auto& shard)
+        {
+            lock_guard<shared_mutex> lock(shard.mutex);
+            shard.map.clear();
+        };
+
+        for (uint32_t i = 0; i < type_count; i++)
+        {
+            for_each(shards_path[i].begin(), shards_path[i].end(), clear);
+            for_each(shards_name[i].begin(), shards_name[i].end(), clear);
+        }
+        for_each(shards_id.begin(), shards_id.end(), clear);
+
+        SP_LOG_INFO("%d resources have been cleared", resource_count);
     }
 
     void ResourceCache::AddResourceDirectory(const ResourceDirectory type, const string& directory)
@@ -272,16 +690,6 @@ namespace Spartan
         return "Data";
     }
 
-    vector<shared_ptr<IResource>>& ResourceCache::GetResources()
-    {
-        return m_resources;
-    }
-
-    mutex& ResourceCache::GetMutex()
-    {
-        return m_mutex;
-    }
-
     bool ResourceCache::GetUseRootShaderDirectory()
     {
         return use_root_shader_directory;
@@ -46,7 +46,7 @@ namespace Spartan
         static void Shutdown();
 
         // get by name
-        static std::shared_ptr<IResource>& GetByName(const std::string& name, ResourceType type);
+        static std::shared_ptr<IResource> GetByName(const std::string& name, ResourceType type);
         template <class T> 
         static std::shared_ptr<T> GetByName(const std::string& name) 
         { 
@@ -57,16 +57,11 @@ namespace Spartan
         static std::vector<std::shared_ptr<IResource>> GetByType(ResourceType type = ResourceType::Max);
 
         // get by path
+        static std::shared_ptr<IResource> GetByPath(const std::string& path, ResourceType type);
         template <class T>
         static std::shared_ptr<T> GetByPath(const std::string& path)
         {
-            for (std::shared_ptr<IResource>& resource : GetResources())
-            {
-                if (path == resource->GetResourceFilePathNative())
-                    return std::static_pointer_cast<T>(resource);
-            }
-
-            return nullptr;
+            return std::static_pointer_cast<T>(GetByPath(path, IResource::TypeToEnum<T>()));
         }
 
         // caches resource, or replaces with existing cached resource
@@ -91,18 +86,13 @@ namespace Spartan
                 return nullptr;
             }
 
-            // ensure that this resource is not already cached
-            if (IsCached(resource->GetResourceFilePathNative(), resource->GetResourceType()))
-                return GetByPath<T>(resource->GetResourceFilePathNative());
-
-            // cache it
-            std::lock_guard<std::mutex> guard(GetMutex());
-            return std::static_pointer_cast<T>(GetResources().emplace_back(resource));
+            // cache it, or get the resource that was cached first under the same path
+            return std::static_pointer_cast<T>(Insert(resource));
         }
 
         // loads a resource and adds it to the resource cache
         template <class T>
-        static std::shared_ptr<T> Load(const std::string& file_path, uint32_t flags = 0)
+        static std::shared_ptr<T> Load(const std::string& file_path, uint32_t flags = 0, const std::shared_ptr<AssetContainer>& container = nullptr)
         {
             if (!FileSystem::Exists(file_path))
             {
@@ -110,10 +100,11 @@ namespace Spartan
                 return nullptr;
             }
 
-            // check if the resource is already loaded
-            const std::string name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
-            if (IsCached(name, IResource::TypeToEnum<T>()))
-                return GetByName<T>(name);
+            // check if the resource is already loaded, the cache is keyed by the native path
+            const std::string file_path_relative = FileSystem::GetRelativePath(file_path);
+            const std::string file_path_native   = FileSystem::IsEngineFile(file_path) ? file_path_relative : FileSystem::NativizeFilePath(file_path_relative);
+            if (std::shared_ptr<T> resource = GetByPath<T>(file_path_native))
+                return resource;
 
             // create new resource
             std::shared_ptr<T> resource = std::make_shared<T>();
@@ -126,8 +117,9 @@ namespace Spartan
             // set a default file path in case it's not overridden by LoadFromFile()
             resource->SetResourceFilePath(file_path);
 
-            // load
-            if (!resource || !resource->LoadFromFile(file_path))
+            // load, from the container when the caller already mapped the file
+            const bool loaded = container ? resource->LoadFromContainer(file_path, container) : resource->LoadFromFile(file_path);
+            if (!resource || !loaded)
             {
                 SP_LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
                 return nullptr;
@@ -143,24 +135,13 @@ namespace Spartan
             if (!resource)
                 return;
 
-            if (!IsCached(resource->GetObjectName(), resource->GetResourceType()))
-                return;
-
-            GetResources().erase
-            (
-                std::remove_if
-                (
-                    GetResources().begin(),
-                    GetResources().end(),
-                    [](std::shared_ptr<IResource> resource) { return dynamic_cast<SpartanObject*>(resource.get())->GetObjectId() == resource->GetObjectId(); }
-                ),
-                GetResources().end()
-            );
+            Erase(resource);
         }
 
         // memory
         static uint64_t GetMemoryUsage(ResourceType type = ResourceType::Max);
         static uint32_t GetResourceCount(ResourceType type = ResourceType::Max);
+        static void OnResourceSizeChanged(const IResource* resource); // called by resources when their size changes after they were cached
 
         // directories
         static void AddResourceDirectory(ResourceDirectory type, const std::string& directory);
@@ -171,14 +152,15 @@ namespace Spartan
         static std::string GetDataDirectory();
 
         // misc
-        static std::vector<std::shared_ptr<IResource>>& GetResources();
-        static std::mutex& GetMutex();
         static bool GetUseRootShaderDirectory();
         static void SetUseRootShaderDirectory(const bool use_root_shader_directory);
 
     private:
         static bool IsCached(const uint64_t resource_id);
-        static bool IsCached(const std::string& resource_name, const ResourceType resource_type);
+        static bool IsCached(const std::string& resource_file_path_native, const ResourceType resource_type);
+        static std::shared_ptr<IResource> Insert(const std::shared_ptr<IResource>& resource);
+        static void Erase(const std::shared_ptr<IResource>& resource);
+        static void LoadByType(const std::string& file_path, const ResourceType type, const std::shared_ptr<AssetContainer>& container);
 
         // event handlers
         static void Serialize();
@@ -30,6 +30,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Input/Input.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
+#include "../../Rendering/Mesh.h"
+#include "../../Math/Bvh.h"
 #include "../../Display/Display.h"
 //===================================
 
@@ -171,40 +173,14 @@ namespace Spartan
             return;
         }
 
-        // traces ray against all AABBs in the world
+        // traces ray against the bvh of the world, collecting every renderable whose bounding box is hit
         Ray ray = ComputePickingRay();
-        vector<RayHit> hits;
+        vector<pair<float, Entity*>> hits;
+        World::GetBvh().QueryRay(ray, Helper::INFINITY_, [&hits](void* user_data, float distance)
         {
-            const unordered_map<uint64_t, shared_ptr<Entity>>& entities = World::GetAllEntities();
-            for (auto it : entities)
-            {
-                shared_ptr<Entity> entity = it.second;
-
-                // Make sure there entity has a renderable
-                if (!entity->GetComponent<Renderable>())
-                    continue;
-
-                // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetBoundingBox(BoundingBoxType::Transformed);
-
-                // Compute hit distance
-                float distance = ray.HitDistance(aabb);
-
-                // Don't store hit data if there was no hit
-                if (distance == Helper::INFINITY_)
-                    continue;
-
-                hits.emplace_back(
-                    entity,                                         // entity
-                    ray.GetStart() + ray.GetDirection() * distance, // position
-                    distance,                                       // distance
-                    distance == 0.0f                                // inside
-                );
-            }
-
-            // sort by distance (ascending)
-            sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
-        }
+            hits.emplace_back(distance, static_cast<Entity*>(user_data));
+            return Helper::INFINITY_;
+        });
 
         // check if there are any hits
         if (hits.empty())
@@ -213,46 +189,68 @@ namespace Spartan
             return;
         }
 
+        // sort by distance (ascending)
+        sort(hits.begin(), hits.end(), [](const pair<float, Entity*>& a, const pair<float, Entity*>& b) { return a.first < b.first; });
+
         // if there is a single hit, return that
         if (hits.size() == 1)
         {
-            m_selected_entity = hits.front().m_entity;
+            m_selected_entity = World::GetEntityById(hits.front().second->GetObjectId());
             return;
         }
 
         // if there are more hits, perform triangle intersection
         float distance_min = numeric_limits<float>::max();
-        for (RayHit& hit : hits)
+        Entity* selected   = nullptr;
+        for (const auto& [distance_box, entity] : hits)
         {
-            // Get entity geometry
-            shared_ptr<Renderable> renderable = hit.m_entity->GetComponent<Renderable>();
-            vector<uint32_t> indicies;
-            vector<RHI_Vertex_PosTexNorTan> vertices;
-            renderable->GetGeometry(&indicies, &vertices);
-            if (indicies.empty()|| vertices.empty())
-            {
-                SP_LOG_ERROR("Failed to get geometry of entity %s, skipping intersection test.");
-                continue;
-            }
+            // the boxes are sorted, so once they are further away than the closest triangle there is nothing closer
+            if (distance_box > distance_min)
+                break;
 
-            // Compute matrix which can transform vertices to view space
-            Matrix vertex_transform = hit.m_entity->GetMatrix();
+            Renderable* renderable = entity->GetComponent<Renderable>().get();
+            Mesh* mesh             = renderable->GetMesh();
 
-            // Go through each face
-            for (uint32_t i = 0; i < indicies.size(); i += 3)
+            auto hit_test = [&](const Matrix& transform)
             {
-                Vector3 p1_world = Vector3(vertices[indicies[i]].pos) * vertex_transform;
-                Vector3 p2_world = Vector3(vertices[indicies[i + 1]].pos) * vertex_transform;
-                Vector3 p3_world = Vector3(vertices[indicies[i + 2]].pos) * vertex_transform;
+                // bring the ray into the mesh's local space instead of transforming every triangle into world space
+                const Matrix transform_inverse = transform.Inverted();
+                const Ray ray_local(transform_inverse.TransformPoint(ray.GetStart()), transform_inverse.TransformDirection(ray.GetDirection()));
+
+                const float distance_local = mesh->HitDistance(ray_local, renderable->GetIndexOffset(), renderable->GetIndexCount(), renderable->GetVertexOffset());
+                if (distance_local == Helper::INFINITY_)
+                    return;
 
-                float distance = ray.HitDistance(p1_world, p2_world, p3_world);
+                // compare in world space, the local distance is affected by scale
+                const Vector3 position = transform.TransformPoint(ray_local.GetStart() + ray_local.GetDirection() * distance_local);
+                const float distance   = (position - ray.GetStart()).Length();
                 if (distance < distance_min)
                 {
-                    m_selected_entity = hit.m_entity;
-                    distance_min      = distance;
+                    selected     = entity;
+                    distance_min = distance;
+                }
+            };
+
+            if (!renderable->HasInstancing())
+            {
+                hit_test(entity->GetMatrix());
+            }
+            else
+            {
+                for (uint32_t i = 0; i < renderable->GetInstanceCount(); i++)
+                {
+                    if (ray.HitDistance(renderable->GetBoundingBox(BoundingBoxType::TransformedInstance, i)) < distance_min)
+                    {
+                        hit_test(entity->GetMatrix() * renderable->GetInstanceTransform(i));
+                    }
                 }
             }
         }
+
+        if (selected)
+        {
+            m_selected_entity = World::GetEntityById(selected->GetObjectId());
+        }
     }
 
     void Camera::WorldToScreenCoordinates(const Vector3& position_world, Vector2& position_screen) const
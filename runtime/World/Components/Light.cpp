@@ -481,6 +481,45 @@ namespace Spartan
         return IsInViewFrustum(box, index);
     }
 
+    Intersection Light::GetFrustumIntersection(const BoundingBox& bounding_box, const uint32_t index) const
+    {
+        SP_ASSERT(bounding_box != BoundingBox::Undefined);
+
+        if (m_light_type != LightType::Point)
+        {
+            const bool ignore_depth = m_light_type == LightType::Directional; // orthographic
+            return m_frustums[index].GetIntersection(bounding_box.GetCenter(), bounding_box.GetExtents(), ignore_depth);
+        }
+
+        return IsInViewFrustum(bounding_box, index) ? Intersection::Intersects : Intersection::Outside;
+    }
+
+    void Light::CullBoxes(const AabbSoA& boxes, uint8_t* out_masks) const
+    {
+        const uint32_t slice_count = (m_light_type == LightType::Spot) ? 1 : 2;
+
+        if (m_light_type != LightType::Point)
+        {
+            const bool ignore_depth = m_light_type == LightType::Directional; // orthographic
+            Frustum::CullBoxes(m_frustums.data(), slice_count, boxes, out_masks, ignore_depth);
+            return;
+        }
+
+        // paraboloid point light, a box is in a hemisphere if its nearest corner is in front of the light plane
+        const Vector3 position     = m_entity_ptr->GetPosition();
+        const Vector3 forward      = m_entity_ptr->GetForward();
+        const Vector3 forward_abs  = forward.Abs();
+        const float d              = -Vector3::Dot(forward, position);
+        for (uint32_t i = 0; i < boxes.GetCount(); i++)
+        {
+            const float distance = boxes.center_x[i] * forward.x + boxes.center_y[i] * forward.y + boxes.center_z[i] * forward.z + d;
+            const float radius   = boxes.extent_x[i] * forward_abs.x + boxes.extent_y[i] * forward_abs.y + boxes.extent_z[i] * forward_abs.z;
+
+            out_masks[i]  = (distance + radius >= 0.0f)  ? 1 : 0; // front
+            out_masks[i] |= (-distance + radius >= 0.0f) ? 2 : 0; // back
+        }
+    }
+
     void Light::RefreshShadowMap()
     {
         uint32_t resolution     = Renderer::GetOption<uint32_t>(Renderer_Option::ShadowResolution);
@@ -127,6 +127,12 @@ namespace Spartan
         bool IsInViewFrustum(const Math::BoundingBox& bounding_box, const uint32_t index) const;
         bool IsInViewFrustum(Renderable* renderable, const uint32_t index) const;
 
+        // like the above but distinguishes between fully inside and intersecting, point lights never report fully inside
+        Math::Intersection GetFrustumIntersection(const Math::BoundingBox& bounding_box, const uint32_t index) const;
+
+        // batched version of the above, bit i of out_masks[j] is set if box j is visible from slice i
+        void CullBoxes(const Math::AabbSoA& boxes, uint8_t* out_masks) const;
+
         // index
         void SetIndex(const uint32_t index) { m_index = index; }
         uint32_t GetIndex() const           { return m_index; }
@@ -32,6 +32,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Physics/Car.h"
 #include "../../Physics/Physics.h"
 #include "../../Physics/BulletPhysicsHelper.h"
+#include "../../Physics/MeshShapeCache.h"
 #include "../Rendering/Renderer.h"
 #include "ProgressTracker.h"
 SP_WARNINGS_OFF
@@ -42,9 +43,6 @@ SP_WARNINGS_OFF
 #include <BulletCollision/CollisionShapes/btCapsuleShape.h>
 #include <BulletCollision/CollisionShapes/btConeShape.h>
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
-#include <BulletCollision/CollisionShapes/btTriangleMesh.h>
-#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
-#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
 SP_WARNINGS_ON
 //====================================================================
 
@@ -62,6 +60,15 @@ namespace Spartan
         const float default_restitution       = 0.2f;
         const float default_friction          = 1.0f;
         const float default_friction_rolling  = 0.0f;
+
+        // ccd, relative to the half extent of the body's thinnest side
+        const float ccd_motion_threshold      = 0.5f; // moving more than this in a step engages the sweep
+        const float ccd_swept_sphere_radius   = 0.8f; // the sweep is a sphere that fits inside the body
+
+        // serialization, the version rides in the high bits of the shape type, which older files left at zero
+        const uint32_t serialization_version       = 1; // 1 added ccd
+        const uint32_t serialization_version_shift = 16;
+        const uint32_t serialization_shape_mask    = (1u << serialization_version_shift) - 1;
     }
 
     #define shape static_cast<btCollisionShape*>(m_shape)
@@ -83,17 +90,53 @@ namespace Spartan
             worldTrans.setRotation(ToBtQuaternion(last_rotation));
         }
 
-        // bullet -> engine
+        // bullet -> engine, this runs on the simulation thread so it only records the pose, the game thread applies it
         void setWorldTransform(const btTransform& worldTrans) override
         {
-            const Quaternion new_rotation = ToQuaternion(worldTrans.getRotation());
-            const Vector3 new_position    = ToVector3(worldTrans.getOrigin()) - new_rotation * m_rigidBody->GetCenterOfMass();
+            // substeps report a pose each, blending starts from the one that preceded the whole step
+            const uint64_t step = Physics::GetStepCount();
+            if (step != m_step)
+            {
+                m_position_previous = m_position_current;
+                m_rotation_previous = m_rotation_current;
+                m_step              = step;
+            }
+
+            m_rotation_current = ToQuaternion(worldTrans.getRotation());
+            m_position_current = ToVector3(worldTrans.getOrigin()) - m_rotation_current * m_rigidBody->GetCenterOfMass();
+        }
+
+        // teleports shouldn't be blended with the pose that preceded them
+        void Reset(const Vector3& position, const Quaternion& rotation)
+        {
+            m_position_previous = m_position_current = position;
+            m_rotation_previous = m_rotation_current = rotation;
+            m_step              = 0;
+        }
+
+        void Apply(float alpha) const
+        {
+            // not simulated since it was created or teleported
+            if (m_step == 0)
+                return;
 
-            m_rigidBody->GetEntity()->SetPosition(new_position);
-            m_rigidBody->GetEntity()->SetRotation(new_rotation);
+            // a body that wasn't moved by the last step is asleep, so show where it came to rest
+            if (m_step != Physics::GetStepCount())
+            {
+                alpha = 1.0f;
+            }
+
+            m_rigidBody->GetEntity()->SetPosition(Vector3::Lerp(m_position_previous, m_position_current, alpha));
+            m_rigidBody->GetEntity()->SetRotation(Quaternion::Lerp(m_rotation_previous, m_rotation_current, alpha));
         }
+
     private:
         PhysicsBody* m_rigidBody;
+        Vector3 m_position_previous    = Vector3::Zero;
+        Vector3 m_position_current     = Vector3::Zero;
+        Quaternion m_rotation_previous = Quaternion::Identity;
+        Quaternion m_rotation_current  = Quaternion::Identity;
+        uint64_t m_step                = 0;
     };
 
     PhysicsBody::PhysicsBody(Entity* entity) : Component(entity)
@@ -106,6 +149,7 @@ namespace Spartan
         m_use_gravity      = true;
         m_gravity          = Physics::GetGravity();
         m_is_kinematic     = false;
+        m_ccd              = true;
         m_position_lock    = Vector3::Zero;
         m_rotation_lock    = Vector3::Zero;
         m_rigid_body       = nullptr;
@@ -121,6 +165,7 @@ namespace Spartan
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_restitution, float);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_use_gravity, bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_is_kinematic, bool);
+        SP_REGISTER_ATTRIBUTE_VALUE_SET(m_ccd, SetCcd, bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_gravity, Vector3);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_position_lock, Vector3);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_rotation_lock, Vector3);
@@ -153,9 +198,7 @@ namespace Spartan
     void PhysicsBody::OnRemove()
     {
         RemoveBodyFromWorld();
-
-        delete static_cast<btCollisionShape*>(m_shape);
-        m_shape = nullptr;
+        ReleaseShape();
     }
 
     void PhysicsBody::OnStart()
@@ -201,9 +244,10 @@ namespace Spartan
         stream->Write(m_position_lock);
         stream->Write(m_rotation_lock);
         stream->Write(m_in_world);
-        stream->Write(uint32_t(m_shape_type));
+        stream->Write(uint32_t(m_shape_type) | (serialization_version << serialization_version_shift));
         stream->Write(m_size);
         stream->Write(m_center_of_mass);
+        stream->Write(m_ccd);
     }
 
     void PhysicsBody::Deserialize(FileStream* stream)
@@ -218,9 +262,15 @@ namespace Spartan
         stream->Read(&m_position_lock);
         stream->Read(&m_rotation_lock);
         stream->Read(&m_in_world);
-        m_shape_type = PhysicsShape(stream->ReadAs<uint32_t>());
+        const uint32_t shape_and_version = stream->ReadAs<uint32_t>();
+        const uint32_t version           = shape_and_version >> serialization_version_shift;
+        m_shape_type                     = PhysicsShape(shape_and_version & serialization_shape_mask);
         stream->Read(&m_size);
         stream->Read(&m_center_of_mass);
+        if (version >= 1)
+        {
+            stream->Read(&m_ccd);
+        }
 
         AddBodyToWorld();
         UpdateShape();
@@ -290,6 +340,15 @@ namespace Spartan
         AddBodyToWorld();
     }
 
+    void PhysicsBody::SetCcd(bool ccd)
+    {
+        if (ccd == m_ccd)
+            return;
+
+        m_ccd = ccd;
+        AddBodyToWorld();
+    }
+
     void PhysicsBody::SetLinearVelocity(const Vector3& velocity, const bool activate /*= true*/) const
     {
         if (!m_rigid_body)
@@ -436,6 +495,7 @@ namespace Spartan
         btTransform transform_world_interpolated = rigid_body->getInterpolationWorldTransform();
         transform_world_interpolated.setOrigin(transform_world.getOrigin());
         rigid_body->setInterpolationWorldTransform(transform_world_interpolated);
+        static_cast<MotionState*>(rigid_body->getMotionState())->Reset(position, GetRotation());
 
         if (activate)
         {
@@ -473,6 +533,7 @@ namespace Spartan
         rigid_body->setInterpolationWorldTransform(interpTrans);
 
         rigid_body->updateInertiaTensor();
+        static_cast<MotionState*>(rigid_body->getMotionState())->Reset(oldPosition, rotation);
 
         if (activate)
         {
@@ -480,6 +541,14 @@ namespace Spartan
         }
     }
 
+    void PhysicsBody::ApplySimulatedPose(const float alpha) const
+    {
+        if (m_rigid_body)
+        {
+            static_cast<MotionState*>(rigid_body->getMotionState())->Apply(alpha);
+        }
+    }
+
     void PhysicsBody::ClearForces() const
     {
         if (!m_rigid_body)
@@ -618,6 +687,18 @@ namespace Spartan
             }
         }
 
+        // continuous collision, bullet takes it from the motion of each step, so it only costs anything when the body is fast
+        if (m_ccd && m_mass > 0.0f && !m_is_kinematic)
+        {
+            btVector3 aabb_min, aabb_max;
+            shape->getAabb(btTransform::getIdentity(), aabb_min, aabb_max);
+            const btVector3 half_extents = (aabb_max - aabb_min) * 0.5f;
+            const float half_extent_min  = half_extents[half_extents.minAxis()];
+
+            rigid_body->setCcdMotionThreshold(half_extent_min * ccd_motion_threshold);
+            rigid_body->setCcdSweptSphereRadius(half_extent_min * ccd_swept_sphere_radius);
+        }
+
         // set transform
         {
             SetPosition(GetEntity()->GetPosition());
@@ -655,6 +736,9 @@ namespace Spartan
             constraint->ReleaseConstraint();
         }
 
+        // and the car that drives it
+        m_car->Destroy();
+
         if (m_rigid_body)
         {
             if (m_in_world)
@@ -720,16 +804,16 @@ namespace Spartan
         Vector3 ray_start = ToVector3(rigid_body->getWorldTransform().getOrigin());
         ray_start.y       = min_y + 0.1f; // offset of 0.1f to avoid starting inside/at the ground
 
-        // return the first hit
-        vector<btRigidBody*> hit_bodies = Physics::RayCast(ray_start, ray_start - Vector3(0.0f, 0.2f, 0.0f));
-        for (btRigidBody* hit_body : hit_bodies)
-        {
-            // ensure we are not hitting ourselves
-            if (hit_body != rigid_body)
-                return true;
-        }
+        // the closest hit that isn't ourselves
+        PhysicsRay ray;
+        ray.start  = ray_start;
+        ray.end    = ray_start - Vector3(0.0f, 0.2f, 0.0f);
+        ray.ignore = rigid_body;
 
-        return false;
+        PhysicsHit hit;
+        Physics::RayCast(span<const PhysicsRay>(&ray, 1), span<PhysicsHit>(&hit, 1));
+
+        return hit.body != nullptr;
     }
 
     Vector3 PhysicsBody::RayTraceIsNearStairStep(const Vector3& forward) const
@@ -790,35 +874,31 @@ namespace Spartan
         return capsule_shape->getRadius();
     }
     
-    void PhysicsBody::UpdateShape()
+    void PhysicsBody::ReleaseShape()
     {
-        if (shape)
+        // mesh shapes are shared, so they go back to the cache instead
+        if (!MeshShapeCache::Release(shape))
         {
             delete shape;
-            m_shape = nullptr;
         }
 
-        // get common prerequisites for certain shapes
-        vector<uint32_t> indices;
-        vector<RHI_Vertex_PosTexNorTan> vertices;
+        m_shape = nullptr;
+    }
+
+    void PhysicsBody::UpdateShape()
+    {
+        ReleaseShape();
+
+        // mesh shapes need a renderable with a mesh
         shared_ptr<Renderable> renderable = nullptr;
-        if (m_shape_type == PhysicsShape::Mesh || m_shape_type == PhysicsShape::MeshConvexHull)
+        if (m_shape_type == PhysicsShape::Mesh || m_shape_type == PhysicsShape::MeshConvexHull || m_shape_type == PhysicsShape::MeshConvexDecomposition)
         {
-            // get renderable
             renderable = GetEntity()->GetComponent<Renderable>();
             if (!renderable || !renderable->HasMesh())
             {
                 SP_LOG_WARNING("For a mesh shape to be constructed, there needs to be a Renderable component with a mesh");
                 return;
             }
-
-            // get geometry
-            renderable->GetGeometry(&indices, &vertices);
-            if (vertices.empty())
-            {
-                SP_LOG_WARNING("A shape can't be constructed without vertices");
-                return;
-            }
         }
 
         Vector3 size = m_size * GetEntity()->GetScale();
@@ -889,38 +969,36 @@ namespace Spartan
             }
 
             case PhysicsShape::Mesh:
-            {
-                btTriangleMesh* shape_local = new btTriangleMesh();
-                for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i += 3)
-                {
-                    btVector3 vertex0(vertices[indices[i]].pos[0],     vertices[indices[i]].pos[1],     vertices[indices[i]].pos[2]);
-                    btVector3 vertex1(vertices[indices[i + 1]].pos[0], vertices[indices[i + 1]].pos[1], vertices[indices[i + 1]].pos[2]);
-                    btVector3 vertex2(vertices[indices[i + 2]].pos[0], vertices[indices[i + 2]].pos[1], vertices[indices[i + 2]].pos[2]);
-                    shape_local->addTriangle(vertex0, vertex1, vertex2);
-                }
-                shape_local->setScaling(ToBtVector3(size));
-
-                m_shape = new btBvhTriangleMeshShape(shape_local, true);
-                break;
-            }
-
             case PhysicsShape::MeshConvexHull:
+            case PhysicsShape::MeshConvexDecomposition:
             {
-                btConvexHullShape* shape_approximated = new btConvexHullShape(
-                    (btScalar*)&vertices[0],                                 // points
-                    renderable->GetVertexCount(),                            // point count
-                    static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan))); // stride
+                const MeshShapeType mesh_shape_type =
+                    m_shape_type == PhysicsShape::Mesh           ? MeshShapeType::Triangles :
+                    m_shape_type == PhysicsShape::MeshConvexHull ? MeshShapeType::ConvexHull :
+                                                                   MeshShapeType::ConvexDecomposition;
+
+                m_shape = MeshShapeCache::Acquire(
+                    renderable->GetMesh(),
+                    renderable->GetIndexOffset(),
+                    renderable->GetIndexCount(),
+                    renderable->GetVertexOffset(),
+                    renderable->GetVertexCount(),
+                    size,
+                    mesh_shape_type
+                );
 
-                shape_approximated->setLocalScaling(ToBtVector3(size));
+                if (!m_shape)
+                    return;
 
-                // turn it into a proper convex hull since btConvexHullShape is an approximation
-                m_shape = static_cast<btConvexHullShape*>(shape_approximated);
-                static_cast<btConvexHullShape*>(m_shape)->optimizeConvexHull();
                 break;
             }
         }
 
-        static_cast<btCollisionShape*>(m_shape)->setUserPointer(this);
+        // mesh shapes are shared between bodies, so they can't point back to this one
+        if (!renderable)
+        {
+            static_cast<btCollisionShape*>(m_shape)->setUserPointer(this);
+        }
 
         // re-add the body to the world so it's re-created with the new shape
         AddBodyToWorld();
@@ -57,7 +57,8 @@ namespace Spartan
         Cone,
         Terrain,
         MeshConvexHull,
-        Mesh
+        Mesh,
+        MeshConvexDecomposition
     };
 
     class SP_CLASS PhysicsBody : public Component
@@ -100,6 +101,10 @@ namespace Spartan
         void SetIsKinematic(bool kinematic);
         bool GetIsKinematic() const { return m_is_kinematic; }
 
+        // continuous collision detection, fast bodies are swept so they can't pass through thin geometry
+        void SetCcd(bool ccd);
+        bool GetCcd() const { return m_ccd; }
+
         // forces
         void SetLinearVelocity(const Math::Vector3& velocity, const bool activate = true) const;
         Math::Vector3 GetLinearVelocity() const;
@@ -130,6 +135,9 @@ namespace Spartan
         Math::Quaternion GetRotation() const;
         void SetRotation(const Math::Quaternion& rotation, const bool activate = true) const;
 
+        // blends the last two simulated poses into the entity, alpha > 1 extrapolates
+        void ApplySimulatedPose(const float alpha) const;
+
         // constraint
         void AddConstraint(Constraint* constraint);
         void RemoveConstraint(Constraint* constraint);
@@ -166,6 +174,7 @@ namespace Spartan
         void AddBodyToWorld();
         void RemoveBodyFromWorld();
         void UpdateShape();
+        void ReleaseShape();
 
         float m_mass                   = 0.0f;
         float m_friction               = 0.0f;
@@ -173,6 +182,7 @@ namespace Spartan
         float m_restitution            = 0.0f;
         bool m_use_gravity             = false;
         bool m_is_kinematic            = false;
+        bool m_ccd                     = true;
         Math::Vector3 m_gravity        = Math::Vector3::Zero;
         Math::Vector3 m_position_lock  = Math::Vector3::Zero;
         Math::Vector3 m_rotation_lock  = Math::Vector3::Zero;
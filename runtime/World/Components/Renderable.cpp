@@ -27,7 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Buffer.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
-#include "../../Rendering/GridPartitioning.h"
+#include "../../Rendering/InstanceClustering.h"
 //===========================================
 
 //= NAMESPACES ===============
@@ -99,6 +99,8 @@ namespace Spartan
             SetGeometry(mesh_type);
         }
 
+        World::SetBoundsDirty(GetEntity());
+
         // material
         stream->Read(&m_flags);
         stream->Read(&m_material_default);
@@ -142,6 +144,8 @@ namespace Spartan
         {
             m_bounding_box = m_mesh->GetAabb();
         }
+        m_bounding_box_dirty = true;
+        World::SetBoundsDirty(GetEntity());
 
         SP_ASSERT(m_geometry_index_count       != 0);
         SP_ASSERT(m_geometry_vertex_count      != 0);
@@ -161,54 +165,49 @@ namespace Spartan
 
     const BoundingBox& Renderable::GetBoundingBox(const BoundingBoxType type, const uint32_t index)
     {
+        const Matrix& transform = GetEntity()->GetMatrix();
+
         // compute if dirty
-        if (m_bounding_box_dirty || m_transform_previous != GetEntity()->GetMatrix())
+        if (m_bounding_box_dirty || m_transform_previous != transform)
         {
-            Matrix transform = GetEntity()->GetMatrix();
-
             // bounding box that contains all instances
             if (m_instances.empty())
             {
                 m_bounding_box_transformed = m_bounding_box.Transform(transform);
             }
-            else // transformed instances
+            else // the entity transform is applied before the instance transform, so every instance has to be updated
             {
-                m_bounding_box_transformed = BoundingBox::Undefined;
-                m_bounding_box_instances.clear();
-                m_bounding_box_instances.reserve(m_instances.size());
-                m_bounding_box_instances.resize(m_instances.size());
-                for (uint32_t i = 0; i < static_cast<uint32_t>(m_instances.size()); i++)
-                {
-                    const Matrix& instance_transform = m_instances[i];
-                    m_bounding_box_instances[i]      = m_bounding_box.Transform(transform * instance_transform ); // 1. bounding box of the instance
-                    m_bounding_box_transformed.Merge(m_bounding_box_instances[i]);                                // 2. bounding box of all instances
-                }
-
-                // 3. bounding boxes of instance groups
-                {
-                    // loop through each group end index
-                    m_bounding_box_instance_group.clear();
-                    uint32_t start_index = 0;
-                    for (const uint32_t group_end_index : m_instance_group_end_indices)
-                    {
-                        // loop through the instances in this group
-                        BoundingBox bounding_box_group = BoundingBox::Undefined;
-                        for (uint32_t i = start_index; i < group_end_index; i++)
-                        {
-                            BoundingBox bounding_box_instance = m_bounding_box.Transform(transform * m_instances[i]);
-                            bounding_box_group.Merge(bounding_box_instance);
-                        }
-
-                        m_bounding_box_instance_group.push_back(bounding_box_group);
-                        start_index = group_end_index;
-                    }
-                }
+                m_instance_dirty_start = 0;
+                m_instance_dirty_end   = static_cast<uint32_t>(m_instances.size());
             }
 
             m_transform_previous = transform;
             m_bounding_box_dirty = false;
         }
 
+        // transformed instances, only the ones that changed since the last time
+        if (m_instance_dirty_start < m_instance_dirty_end)
+        {
+            // 1. bounding box of each instance
+            m_bounding_box_instances.resize(m_instances.size());
+            for (uint32_t i = m_instance_dirty_start; i < m_instance_dirty_end; i++)
+            {
+                m_bounding_box_instances[i] = m_bounding_box.Transform(transform * m_instances[i]);
+            }
+
+            // 2. bounding boxes of the instance groups, and 3. of all instances, merged from the above
+            m_bounding_box_transformed = instance_clustering::compute_group_bounds(
+                m_bounding_box_instances,
+                m_instance_group_end_indices,
+                m_bounding_box_instance_group,
+                m_instance_dirty_start,
+                m_instance_dirty_end
+            );
+
+            m_instance_dirty_start = 0;
+            m_instance_dirty_end   = 0;
+        }
+
         // return
         if (type == BoundingBoxType::Mesh)
         {
@@ -299,27 +298,203 @@ namespace Spartan
     {
         m_instances = instances;
 
-        grid_partitioning::reorder_instances_into_cell_chunks(m_instances, m_instance_group_end_indices);
+        instance_clustering::cluster(m_instances, m_instance_group_end_indices);
+
+        // re-create the buffer with the exact size
+        m_instance_buffer       = nullptr;
+        m_instance_upload_start = 0;
+        m_instance_upload_end   = 0;
+        MarkInstancesForUpload(0, static_cast<uint32_t>(m_instances.size()));
+
+        // every box is recomputed, so a pending range would only be out of bounds
+        m_instance_dirty_start = 0;
+        m_instance_dirty_end   = 0;
+        m_bounding_box_instance_group.clear();
+        m_bounding_box_dirty = true;
+        World::SetBoundsDirty(GetEntity());
+    }
+
+    void Renderable::AddInstances(const vector<Matrix>& instances)
+    {
+        if (instances.empty())
+            return;
+
+        // the new instances are clustered among themselves and appended as new groups
+        vector<Matrix> instances_clustered = instances;
+        vector<uint32_t> group_end_indices;
+        instance_clustering::cluster(instances_clustered, group_end_indices);
+
+        const uint32_t index = static_cast<uint32_t>(m_instances.size());
+        const uint32_t count = static_cast<uint32_t>(instances_clustered.size());
+        m_instances.insert(m_instances.end(), instances_clustered.begin(), instances_clustered.end());
+        for (const uint32_t group_end_index : group_end_indices)
+        {
+            m_instance_group_end_indices.push_back(index + group_end_index);
+        }
+
+        MarkInstancesForUpload(index, count);
+        MarkInstancesDirty(index, count);
+        World::SetBoundsDirty(GetEntity());
+    }
+
+    void Renderable::RemoveInstances(const uint32_t index, const uint32_t count)
+    {
+        SP_ASSERT(index + count <= m_instances.size());
+
+        if (count == 0)
+            return;
+
+        World::SetBoundsDirty(GetEntity());
+
+        const uint32_t end = index + count;
+        m_instances.erase(m_instances.begin() + index, m_instances.begin() + end);
+
+        // shift the group end indices and drop the groups that became empty
+        vector<uint32_t> group_end_indices;
+        group_end_indices.reserve(m_instance_group_end_indices.size());
+        for (const uint32_t group_end_index : m_instance_group_end_indices)
+        {
+            const uint32_t group_end_index_new = group_end_index <= index ? group_end_index : (group_end_index >= end ? group_end_index - count : index);
+            if (group_end_index_new > (group_end_indices.empty() ? 0 : group_end_indices.back()))
+            {
+                group_end_indices.push_back(group_end_index_new);
+            }
+        }
+        m_instance_group_end_indices = move(group_end_indices);
+
+        // everything after the removed range moved down
+        MarkInstancesForUpload(index, static_cast<uint32_t>(m_instances.size()) - index);
+
+        // nothing is left to shift or merge, the mesh bounding box applies again
+        if (m_instances.empty())
+        {
+            m_instance_buffer       = nullptr;
+            m_instance_upload_start = 0;
+            m_instance_upload_end   = 0;
+            m_instance_dirty_start  = 0;
+            m_instance_dirty_end    = 0;
+            m_bounding_box_instances.clear();
+            m_bounding_box_instance_group.clear();
+            m_bounding_box_dirty = true;
+        }
+        // the cached instance boxes are still valid, they just have to be shifted, but the groups changed so they are all re-merged
+        else if (m_instance_dirty_start == m_instance_dirty_end && m_bounding_box_instances.size() == m_instances.size() + count)
+        {
+            m_bounding_box_instances.erase(m_bounding_box_instances.begin() + index, m_bounding_box_instances.begin() + end);
+            m_bounding_box_instance_group.clear();
+            m_bounding_box_transformed = instance_clustering::compute_group_bounds(m_bounding_box_instances, m_instance_group_end_indices, m_bounding_box_instance_group);
+        }
+        else
+        {
+            m_bounding_box_instance_group.clear();
+            m_bounding_box_dirty = true;
+        }
+    }
+
+    void Renderable::UpdateInstances(const uint32_t index, const vector<Matrix>& instances)
+    {
+        const uint32_t count = static_cast<uint32_t>(instances.size());
+        SP_ASSERT(index + count <= m_instances.size());
+
+        copy(instances.begin(), instances.end(), m_instances.begin() + index);
+
+        MarkInstancesForUpload(index, count);
+        MarkInstancesDirty(index, count);
+        World::SetBoundsDirty(GetEntity());
+    }
+
+    RHI_Buffer* Renderable::GetInstanceBuffer()
+    {
+        // edits only record what changed, so several of them in a frame make a single upload, and none happens without a renderer
+        if (m_instance_upload_start < m_instance_upload_end)
+        {
+            const uint32_t end = min(m_instance_upload_end, static_cast<uint32_t>(m_instances.size()));
+            UpdateInstanceBuffer(m_instance_upload_start, end > m_instance_upload_start ? end - m_instance_upload_start : 0);
+
+            m_instance_upload_start = 0;
+            m_instance_upload_end   = 0;
+        }
+
+        return m_instance_buffer.get();
+    }
+
+    void Renderable::UpdateInstanceBuffer(const uint32_t index, const uint32_t count)
+    {
+        const uint32_t instance_count = static_cast<uint32_t>(m_instances.size());
+        if (instance_count == 0)
+        {
+            m_instance_buffer = nullptr;
+            return;
+        }
 
         // we are mapping 4 Vector4s as 4 rows (see vulkan_pipeline.cpp, line 246) in order to get 1 matrix (HLSL side)
         // but the matrix memory layout is column-major, so we need to transpose to get it as row-major
-        vector<Matrix> instances_transposed;
-        instances_transposed.reserve(m_instances.size());
-        for (const auto& instance : m_instances)
+
+        // grow with some headroom, so that consecutive additions don't re-create the buffer every time
+        if (!m_instance_buffer || m_instance_buffer->GetElementCount() < instance_count)
         {
-            instances_transposed.push_back(instance.Transposed());
+            const uint32_t capacity = m_instance_buffer ? max(instance_count, m_instance_buffer->GetElementCount() * 3 / 2) : instance_count;
+
+            vector<Matrix> instances_transposed(capacity, Matrix::Identity);
+            for (uint32_t i = 0; i < instance_count; i++)
+            {
+                instances_transposed[i] = m_instances[i].Transposed();
+            }
+
+            m_instance_buffer = make_shared<RHI_Buffer>(
+                RHI_Buffer_Type::Instance,
+                sizeof(instances_transposed[0]),
+                static_cast<uint32_t>(instances_transposed.size()),
+                static_cast<void*>(&instances_transposed[0]),
+                false,
+                "instance_buffer"
+            );
+
+            return;
         }
 
-        m_instance_buffer = make_shared<RHI_Buffer>(
-            RHI_Buffer_Type::Instance,
-            sizeof(instances_transposed[0]),
-            static_cast<uint32_t>(instances_transposed.size()),
-            static_cast<void*>(&instances_transposed[0]),
-            false,
-            "instance_buffer"
-        );
+        if (count == 0)
+            return;
 
-        m_bounding_box_dirty = true;
+        // upload only the range that changed
+        vector<Matrix> instances_transposed(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            instances_transposed[i] = m_instances[index + i].Transposed();
+        }
+
+        m_instance_buffer->UpdateRange(&instances_transposed[0], static_cast<uint64_t>(index) * sizeof(Matrix), static_cast<uint64_t>(count) * sizeof(Matrix));
+    }
+
+    void Renderable::MarkInstancesDirty(const uint32_t index, const uint32_t count)
+    {
+        if (m_instance_dirty_start == m_instance_dirty_end)
+        {
+            m_instance_dirty_start = index;
+            m_instance_dirty_end   = index + count;
+        }
+        else
+        {
+            m_instance_dirty_start = min(m_instance_dirty_start, index);
+            m_instance_dirty_end   = max(m_instance_dirty_end, index + count);
+        }
+    }
+
+    void Renderable::MarkInstancesForUpload(const uint32_t index, const uint32_t count)
+    {
+        if (count == 0)
+            return;
+
+        if (m_instance_upload_start == m_instance_upload_end)
+        {
+            m_instance_upload_start = index;
+            m_instance_upload_end   = index + count;
+        }
+        else
+        {
+            m_instance_upload_start = min(m_instance_upload_start, index);
+            m_instance_upload_end   = max(m_instance_upload_end, index + count);
+        }
     }
 
     void Renderable::SetFlag(const RenderableFlags flag, const bool enable /*= true*/)
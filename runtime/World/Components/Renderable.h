@@ -94,17 +94,24 @@ namespace Spartan
 
         // instancing
         bool HasInstancing() const                              { return !m_instances.empty(); }
-        RHI_Buffer* GetInstanceBuffer() const           { return m_instance_buffer.get(); }
+        RHI_Buffer* GetInstanceBuffer(); // uploads the instances that changed since the last call
         Math::Matrix GetInstanceTransform(const uint32_t index) { return m_instances[index]; }
         uint32_t GetInstanceCount()  const                      { return static_cast<uint32_t>(m_instances.size()); }
         void SetInstances(const std::vector<Math::Matrix>& instances);
 
+        // incremental edits, only the affected part of the instance buffer is uploaded and only the affected bounding boxes are recomputed
+        // instances keep their group when updated, call SetInstances() to re-cluster after large movements
+        void AddInstances(const std::vector<Math::Matrix>& instances);
+        void RemoveInstances(const uint32_t index, const uint32_t count);
+        void UpdateInstances(const uint32_t index, const std::vector<Math::Matrix>& instances);
+
         // misc
         uint32_t GetIndexOffset() const  { return m_geometry_index_offset; }
         uint32_t GetIndexCount() const   { return m_geometry_index_count; }
         uint32_t GetVertexOffset() const { return m_geometry_vertex_offset; }
         uint32_t GetVertexCount() const  { return m_geometry_vertex_count; }
         bool HasMesh() const             { return m_mesh != nullptr; }
+        Mesh* GetMesh() const            { return m_mesh; }
 
         // flags
         bool HasFlag(const RenderableFlags flag) { return m_flags & flag; }
@@ -112,6 +119,10 @@ namespace Spartan
         bool IsVisible() const { return !(m_flags & RenderableFlags::OccludedCpu) && !(m_flags & RenderableFlags::OccludedGpu); }
 
     private:
+        void UpdateInstanceBuffer(const uint32_t index, const uint32_t count);
+        void MarkInstancesDirty(const uint32_t index, const uint32_t count);
+        void MarkInstancesForUpload(const uint32_t index, const uint32_t count);
+
         // geometry/mesh
         uint32_t m_geometry_index_offset             = 0;
         uint32_t m_geometry_index_count              = 0;
@@ -132,6 +143,10 @@ namespace Spartan
         std::vector<Math::Matrix> m_instances;
         std::vector<uint32_t> m_instance_group_end_indices;
         std::shared_ptr<RHI_Buffer> m_instance_buffer;
+        uint32_t m_instance_dirty_start = 0; // range of instances whose bounding boxes are out of date
+        uint32_t m_instance_dirty_end   = 0;
+        uint32_t m_instance_upload_start = 0; // range of instances that the instance buffer doesn't have yet
+        uint32_t m_instance_upload_end   = 0;
 
         // misc
         Math::Matrix m_transform_previous = Math::Matrix::Identity;
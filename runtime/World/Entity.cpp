@@ -147,7 +147,7 @@ namespace Spartan
         }
     }
 
-    void Entity::Serialize(FileStream* stream)
+    void Entity::Serialize(FileStream* stream, const unordered_set<uint64_t>* excluded_descendants /*= nullptr*/)
     {
         // BASIC DATA
         {
@@ -186,7 +186,14 @@ namespace Spartan
 
         // CHILDREN
         {
-            vector<Entity*>& children = GetChildren();
+            vector<Entity*> children;
+            for (Entity* child : GetChildren())
+            {
+                if (child && (!excluded_descendants || excluded_descendants->count(child->GetObjectId()) == 0))
+                {
+                    children.emplace_back(child);
+                }
+            }
 
             // children count
             stream->Write(static_cast<uint32_t>(children.size()));
@@ -200,10 +207,7 @@ namespace Spartan
             // children
             for (Entity* child : children)
             {
-                if (child)
-                {
-                    child->Serialize(stream);
-                }
+                child->Serialize(stream, excluded_descendants);
             }
         }
     }
@@ -271,21 +275,22 @@ namespace Spartan
             // Children count
             const uint32_t children_count = stream->ReadAs<uint32_t>();
 
-            // Children IDs
-            vector<weak_ptr<Entity>> children;
+            // Children IDs, the world knows them by these from the start, so that their own children can find them
+            vector<shared_ptr<Entity>> children;
             for (uint32_t i = 0; i < children_count; i++)
             {
-                shared_ptr<Entity> child = World::CreateEntity();
-
+                shared_ptr<Entity> child = make_shared<Entity>();
                 child->SetObjectId(stream->ReadAs<uint64_t>());
+                child->Initialize();
 
                 children.emplace_back(child);
             }
+            World::AddEntities(children);
 
             // Children
-            for (const auto& child : children)
+            for (const shared_ptr<Entity>& child : children)
             {
-                child.lock()->Deserialize(stream, World::GetEntityById(m_object_id));
+                child->Deserialize(stream, World::GetEntityById(m_object_id));
             }
 
             AcquireChildren();
@@ -334,6 +339,11 @@ namespace Spartan
             {
                 if (id == component->GetObjectId())
                 {
+                    if (component->GetType() == ComponentType::Renderable)
+                    {
+                        World::SetBoundsDirty(this);
+                    }
+
                     component->OnRemove();
                     component = nullptr;
                     break;
@@ -365,16 +375,25 @@ namespace Spartan
             child->UpdateTransform();
         }
 
+        // the bvh refits what moved
+        if (m_components[static_cast<uint32_t>(ComponentType::Renderable)])
+        {
+            World::SetBoundsDirty(this);
+        }
+
         // update directions
         {
+            // extract the rotation once, it's a full decomposition of the world matrix
+            const Quaternion rotation = GetRotation();
+
             // z
-            m_forward  = GetRotation() * Vector3::Forward;
+            m_forward  = rotation * Vector3::Forward;
             m_backward = -m_forward;
             // y
-            m_up       = GetRotation() * Vector3::Up;
+            m_up       = rotation * Vector3::Up;
             m_down     = -m_up;
             // x
-            m_right    = GetRotation() * Vector3::Right;
+            m_right    = rotation * Vector3::Right;
             m_left     = -m_right;
         }
 
@@ -438,6 +457,19 @@ namespace Spartan
         UpdateTransform();
     }
 
+    void Entity::SetTransformLocal(const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+    {
+        m_position_local = position;
+        m_rotation_local = rotation;
+        m_scale_local    = Vector3(
+            scale.x == 0.0f ? Helper::SMALL_FLOAT : scale.x,
+            scale.y == 0.0f ? Helper::SMALL_FLOAT : scale.y,
+            scale.z == 0.0f ? Helper::SMALL_FLOAT : scale.z
+        );
+
+        UpdateTransform();
+    }
+
     void Entity::Translate(const Vector3& delta)
     {
         if (!HasParent())
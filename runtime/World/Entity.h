@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <atomic>
 #include <array>
 #include <mutex>
+#include <unordered_set>
 #include "World.h"
 #include "Components/Component.h"
 #include "../Math/Quaternion.h"
@@ -35,6 +36,7 @@ namespace Spartan
 {
     class FileStream;
     class Renderable;
+    class Prefab;
     
     class SP_CLASS Entity : public SpartanObject
     {
@@ -50,14 +52,20 @@ namespace Spartan
         void OnStop();  // runs once, after the simulation ends
         void Tick();    // runs every frame
 
-        // io
-        void Serialize(FileStream* stream);
+        // io, excluded descendants are left out of the hierarchy (they are saved elsewhere, e.g. in a streaming cell)
+        void Serialize(FileStream* stream, const std::unordered_set<uint64_t>* excluded_descendants = nullptr);
         void Deserialize(FileStream* stream, std::shared_ptr<Entity> parent);
 
         // active
         bool IsActive() const;
         void SetActive(const bool active) { m_is_active = active; }
 
+        // prefab, the entities of an instance know which prefab entity they came from, the root is the first one
+        void SetPrefab(const std::shared_ptr<Prefab>& prefab, const uint32_t index) { m_prefab = prefab; m_prefab_index = index; }
+        Prefab* GetPrefab() const                                                   { return m_prefab.get(); }
+        uint32_t GetPrefabIndex() const                      { return m_prefab_index; }
+        bool IsPrefabInstanceRoot() const                    { return m_prefab != nullptr && m_prefab_index == 0; }
+
         // adds a component of type T
         template <class T>
         std::shared_ptr<T> AddComponent()
@@ -78,6 +86,10 @@ namespace Spartan
             component->SetType(type);
             component->OnInitialize();
 
+            if (type == ComponentType::Renderable)
+            {
+                World::SetBoundsDirty(this);
+            }
             World::Resolve();
 
             return component;
@@ -101,6 +113,10 @@ namespace Spartan
             const ComponentType component_type = Component::TypeToEnum<T>();
             m_components[static_cast<uint32_t>(component_type)] = nullptr;
 
+            if (component_type == ComponentType::Renderable)
+            {
+                World::SetBoundsDirty(this);
+            }
             World::Resolve();
         }
 
@@ -128,6 +144,9 @@ namespace Spartan
         void SetScaleLocal(const Math::Vector3& scale);
         //========================================================================
 
+        // sets all three local components with a single transform update
+        void SetTransformLocal(const Math::Vector3& position, const Math::Quaternion& rotation, const Math::Vector3& scale);
+
         //= TRANSLATION/ROTATION ==================
         void Translate(const Math::Vector3& delta);
         void Rotate(const Math::Quaternion& delta);
@@ -193,6 +212,10 @@ namespace Spartan
         std::weak_ptr<Entity> m_parent;  // the parent of this entity
         std::vector<Entity*> m_children; // the children of this entity
 
+        // prefab
+        std::shared_ptr<Prefab> m_prefab; // instances keep their prefab alive, the resource cache can let go of it before they are gone
+        uint32_t m_prefab_index = 0;
+
         // misc
         std::mutex m_mutex_children;
         std::mutex m_mutex_parent;
@@ -0,0 +1,83 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =======================
+#include "pch.h"
+#include "Prefab.h"
+#include "../Resource/ResourceCache.h"
+//==================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    Prefab::Prefab() : IResource(ResourceType::Prefab)
+    {
+
+    }
+
+    bool Prefab::LoadFromFile(const string& file_path)
+    {
+        if (!m_file.Read(file_path))
+            return false;
+
+        SetResourceSize(m_file.GetMemoryUsage());
+        m_is_ready_for_use = true;
+
+        return true;
+    }
+
+    bool Prefab::SaveToFile(const string& file_path)
+    {
+        return m_file.Write(file_path);
+    }
+
+    shared_ptr<Prefab> Prefab::Create(Entity* root, const string& file_path)
+    {
+        SP_ASSERT(root != nullptr);
+
+        shared_ptr<Prefab> prefab = make_shared<Prefab>();
+        prefab->m_file.Capture({ root }, nullptr, true);
+        if (!prefab->SaveToFile(file_path))
+        {
+            SP_LOG_ERROR("Failed to save prefab \"%s\"", file_path.c_str());
+            return nullptr;
+        }
+
+        prefab->SetResourceFilePath(file_path);
+        prefab->SetResourceSize(prefab->m_file.GetMemoryUsage());
+        prefab->m_is_ready_for_use = true;
+
+        return ResourceCache::Cache(prefab);
+    }
+
+    vector<shared_ptr<Entity>> Prefab::Instantiate(const vector<Vector3>& positions, const vector<Quaternion>& rotations, const shared_ptr<Entity>& parent)
+    {
+        vector<shared_ptr<Entity>> roots;
+        m_file.Instantiate(shared_from_this(), positions, rotations, parent, &roots);
+
+        return roots;
+    }
+}
@@ -0,0 +1,60 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====================
+#include <memory>
+#include "WorldFile.h"
+#include "../Resource/IResource.h"
+//================================
+
+namespace Spartan
+{
+    // a reusable entity subtree, its serialized data is shared by all of its instances and never changes,
+    // instances remember which prefab entity they came from, so that a world only saves what they override
+    class SP_CLASS Prefab : public IResource, public std::enable_shared_from_this<Prefab>
+    {
+    public:
+        Prefab();
+        ~Prefab() = default;
+
+        // iresource
+        bool LoadFromFile(const std::string& file_path) override;
+        bool SaveToFile(const std::string& file_path) override;
+
+        // captures an entity and its descendants into a prefab file and caches it, prefab instances among them are expanded
+        static std::shared_ptr<Prefab> Create(Entity* root, const std::string& file_path);
+
+        // spawns an instance per position in one batch, without rotations the prefab's rotation is used
+        std::vector<std::shared_ptr<Entity>> Instantiate(
+            const std::vector<Math::Vector3>& positions,
+            const std::vector<Math::Quaternion>& rotations = {},
+            const std::shared_ptr<Entity>& parent          = nullptr
+        );
+
+        const WorldFile& GetFile() const { return m_file; }
+
+    private:
+        WorldFile m_file;
+    };
+}
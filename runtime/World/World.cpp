@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "World.h"
 #include "Entity.h"
+#include "WorldStreaming.h"
+#include "WorldFile.h"
 #include "ThreadPool.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
@@ -34,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/FileStream.h"
 #include "../Profiling/Profiler.h"
 #include "../Physics/Car.h"
+#include "../Math/Bvh.h"
 #include "../Rendering/Mesh.h"
 #include "../Rendering/Renderer.h"
 #include "../RHI/RHI_Texture.h"
@@ -55,6 +58,33 @@ namespace Spartan
         bool resolve            = false;
         bool was_in_editor_mode = false;
 
+        // spatial acceleration structure for renderables, keyed by entity id
+        Bvh bvh;
+        unordered_map<uint64_t, int32_t> bvh_proxies;
+        unordered_set<uint64_t> bvh_dirty; // entities whose renderable bounds may have changed since the last update
+        mutex bvh_dirty_mutex;
+
+        // streaming
+        const uint32_t cell_table_magic = 0x4C4C4543;         // "CELL", follows the resident entities of a partitioned world (older format)
+        WorldStreamingSettings streaming_settings;
+        WorldStreamingScheduler streaming;
+        vector<vector<shared_ptr<Entity>>> cell_entities;       // the streamed subtrees of each loaded cell
+        thread_local bool building_cell = false;                // what a worker builds isn't in the world, so there is nothing to resolve
+
+        // a cell built outside of the world, the main thread attaches it to its resident parents and adds it to the world
+        struct CellLoad
+        {
+            uint32_t cell_index = 0;
+            vector<shared_ptr<Entity>> entities; // all of them, units included
+            vector<shared_ptr<Entity>> units;
+            vector<uint64_t> unit_parent_ids;    // zero when a unit is a root
+            vector<std::byte> data;              // an older cell deserializes through the world, so only its bytes are read off the main thread
+        };
+        vector<CellLoad> cell_loads_completed;
+        uint64_t streaming_generation = 0;                      // bumped on clear, loads of an older world are dropped
+        mutex streaming_mutex;                                  // guards the completed loads and the generation
+        mutex streaming_load_mutex;                             // held while a cell deserializes, so that a clear waits for it
+
         // default worlds resources
         shared_ptr<Entity> m_default_terrain             = nullptr;
         shared_ptr<Entity> m_default_physics_body_camera = nullptr;
@@ -62,6 +92,434 @@ namespace Spartan
         shared_ptr<Entity> m_default_light_directional   = nullptr;
         shared_ptr<Mesh> m_default_model_car             = nullptr;
 
+        void bvh_update()
+        {
+            unordered_set<uint64_t> dirty;
+            {
+                lock_guard<mutex> lock(bvh_dirty_mutex);
+                dirty.swap(bvh_dirty);
+            }
+
+            for (const uint64_t id : dirty)
+            {
+                // a removed entity already left the tree, and one that isn't added yet is reported again when it is
+                auto it = entities.find(id);
+                if (it == entities.end())
+                    continue;
+
+                Entity* entity                    = it->second.get();
+                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+
+                // undefined or degenerate boxes (e.g. a mesh that is still loading) stay out of the tree
+                const BoundingBox* box = (renderable && renderable->HasMesh()) ? &renderable->GetBoundingBox(BoundingBoxType::Transformed) : nullptr;
+                const bool box_valid   = box && !box->GetCenter().IsNaN() && !box->GetExtents().IsNaN();
+
+                auto proxy = bvh_proxies.find(id);
+                if (proxy == bvh_proxies.end())
+                {
+                    if (box_valid)
+                    {
+                        bvh_proxies[id] = bvh.Insert(*box, entity);
+                    }
+                }
+                else if (!box_valid)
+                {
+                    bvh.Remove(proxy->second);
+                    bvh_proxies.erase(proxy);
+                }
+                else if (!(bvh.GetBox(proxy->second) == *box))
+                {
+                    bvh.Update(proxy->second, *box);
+                }
+            }
+        }
+
+        // removes an entity and its descendants, the caller holds the entity lock
+        void remove_entity(Entity* entity_to_remove)
+        {
+            // get the root entity and its descendants
+            vector<Entity*> entities_to_remove;
+            entities_to_remove.push_back(entity_to_remove);
+            entity_to_remove->GetDescendants(&entities_to_remove);
+
+            set<uint64_t> ids_to_remove;
+            for (Entity* entity : entities_to_remove)
+            {
+                ids_to_remove.insert(entity->GetObjectId());
+            }
+
+            // remove them from the bvh
+            for (uint64_t id : ids_to_remove)
+            {
+                auto proxy = bvh_proxies.find(id);
+                if (proxy != bvh_proxies.end())
+                {
+                    bvh.Remove(proxy->second);
+                    bvh_proxies.erase(proxy);
+                }
+            }
+
+            // remove entities using a single loop
+            for (auto it = entities.begin(); it != entities.end(); )
+            {
+                if (ids_to_remove.count(it->first) > 0)
+                {
+                    it = entities.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            // if there was a parent, update it
+            if (shared_ptr<Entity> parent = entity_to_remove->GetParent())
+            {
+                parent->AcquireChildren();
+            }
+        }
+
+        // an entity read from a file joins the world under its saved id, so that its children find it by that id as they load
+        shared_ptr<Entity> create_entity(const uint64_t id)
+        {
+            shared_ptr<Entity> entity = make_shared<Entity>();
+            entity->SetObjectId(id);
+            entity->Initialize();
+
+            return entity;
+        }
+
+        vector<shared_ptr<Entity>> deserialize_root_entities(FileStream* file, const bool track_progress)
+        {
+            const uint32_t root_entity_count = file->ReadAs<uint32_t>();
+
+            if (track_progress)
+            {
+                ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Loading world...");
+            }
+
+            vector<shared_ptr<Entity>> root_entities;
+            root_entities.reserve(root_entity_count);
+            for (uint32_t i = 0; i < root_entity_count; i++)
+            {
+                root_entities.emplace_back(create_entity(file->ReadAs<uint64_t>()));
+            }
+            World::AddEntities(root_entities);
+
+            for (shared_ptr<Entity>& entity : root_entities)
+            {
+                entity->Deserialize(file, nullptr);
+
+                if (track_progress)
+                {
+                    ProgressTracker::GetProgress(ProgressType::World).JobDone();
+                }
+            }
+
+            return root_entities;
+        }
+
+        // a cell holds subtrees whose parents (if any) stay resident, the older format stores each one with its parent id
+        vector<shared_ptr<Entity>> deserialize_cell(FileStream* file)
+        {
+            const uint32_t unit_count = file->ReadAs<uint32_t>();
+
+            vector<uint64_t> parent_ids(unit_count);
+            vector<shared_ptr<Entity>> units(unit_count);
+            for (uint32_t i = 0; i < unit_count; i++)
+            {
+                parent_ids[i] = file->ReadAs<uint64_t>();
+                units[i]      = create_entity(file->ReadAs<uint64_t>());
+            }
+            World::AddEntities(units);
+
+            for (uint32_t i = 0; i < unit_count; i++)
+            {
+                shared_ptr<Entity> parent = parent_ids[i] != 0 ? World::GetEntityById(parent_ids[i]) : nullptr;
+                units[i]->Deserialize(file, parent);
+            }
+
+            return units;
+        }
+
+        // runs on any thread, nothing it creates is visible to the world until attach_cell()
+        void build_cell(const string& file_path, CellLoad* load)
+        {
+            building_cell = true;
+
+            if (WorldFile::IsWorldFile(file_path))
+            {
+                WorldFile file;
+                if (file.Read(file_path))
+                {
+                    file.InstantiateDetached(&load->entities, &load->units, &load->unit_parent_ids);
+                }
+            }
+            else if (ifstream file = ifstream(file_path, ios::binary | ios::ate); file.is_open())
+            {
+                load->data.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(reinterpret_cast<char*>(load->data.data()), load->data.size());
+            }
+            else
+            {
+                SP_LOG_ERROR("Failed to open cell \"%s\"", file_path.c_str());
+            }
+
+            building_cell = false;
+        }
+
+        void get_entities_in_cell(const vector<shared_ptr<Entity>>& units, vector<shared_ptr<Entity>>* entities_in_cell)
+        {
+            for (const shared_ptr<Entity>& unit : units)
+            {
+                entities_in_cell->emplace_back(unit);
+
+                vector<Entity*> descendants;
+                unit->GetDescendants(&descendants);
+                for (Entity* descendant : descendants)
+                {
+                    if (const shared_ptr<Entity>& entity = World::GetEntityById(descendant->GetObjectId()))
+                    {
+                        entities_in_cell->emplace_back(entity);
+                    }
+                }
+            }
+        }
+
+        // runs on the main thread, returns the units of the cell
+        vector<shared_ptr<Entity>> attach_cell(CellLoad& load)
+        {
+            if (!load.data.empty())
+            {
+                FileStream file(load.data.data(), load.data.size());
+                vector<shared_ptr<Entity>> units = deserialize_cell(&file);
+
+                vector<shared_ptr<Entity>> entities_in_cell;
+                get_entities_in_cell(units, &entities_in_cell);
+                Renderer::AddEntities(entities_in_cell);
+
+                return units;
+            }
+
+            // without a resolve, the renderer is told about them incrementally
+            {
+                lock_guard<mutex> lock(entity_access_mutex);
+                entities.reserve(entities.size() + load.entities.size());
+                for (const shared_ptr<Entity>& entity : load.entities)
+                {
+                    entities[entity->GetObjectId()] = entity;
+                }
+            }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(load.units.size()); i++)
+            {
+                if (load.unit_parent_ids[i] == 0)
+                    continue;
+
+                const shared_ptr<Entity>& parent = World::GetEntityById(load.unit_parent_ids[i]);
+                if (!parent)
+                    continue;
+
+                load.units[i]->SetParent(parent);
+
+                // the bodies were placed before the unit had its parent
+                vector<Entity*> subtree = { load.units[i].get() };
+                load.units[i]->GetDescendants(&subtree);
+                for (Entity* entity : subtree)
+                {
+                    if (shared_ptr<PhysicsBody> physics_body = entity->GetComponent<PhysicsBody>())
+                    {
+                        physics_body->SetPosition(entity->GetPosition(), false);
+                        physics_body->SetRotation(entity->GetRotation(), false);
+                    }
+                }
+            }
+
+            Renderer::AddEntities(load.entities);
+
+            return move(load.units);
+        }
+
+        void load_cell(const uint32_t cell_index, const string& file_path, const uint64_t generation)
+        {
+            lock_guard<mutex> lock_load(streaming_load_mutex);
+
+            {
+                lock_guard<mutex> lock(streaming_mutex);
+                if (generation != streaming_generation)
+                    return;
+            }
+
+            // a missing cell still completes, so that it isn't retried every frame
+            CellLoad load;
+            load.cell_index = cell_index;
+            build_cell(file_path, &load);
+
+            lock_guard<mutex> lock(streaming_mutex);
+            cell_loads_completed.emplace_back(move(load));
+        }
+
+        void streaming_complete_loads()
+        {
+            vector<CellLoad> completed;
+            {
+                lock_guard<mutex> lock(streaming_mutex);
+                completed.swap(cell_loads_completed);
+            }
+
+            for (CellLoad& load : completed)
+            {
+                streaming.OnLoaded(load.cell_index);
+                cell_entities[load.cell_index] = attach_cell(load);
+            }
+        }
+
+        void streaming_unload(const uint32_t cell_index)
+        {
+            vector<shared_ptr<Entity>> entities_in_cell;
+            get_entities_in_cell(cell_entities[cell_index], &entities_in_cell);
+            Renderer::RemoveEntities(entities_in_cell);
+
+            lock_guard<mutex> lock(entity_access_mutex);
+            for (shared_ptr<Entity>& unit : cell_entities[cell_index])
+            {
+                remove_entity(unit.get());
+            }
+            cell_entities[cell_index].clear();
+        }
+
+        void streaming_tick()
+        {
+            if (streaming.GetCells().empty())
+                return;
+
+            streaming_complete_loads();
+
+            shared_ptr<Camera> camera = Renderer::GetCamera();
+            if (!camera)
+                return;
+
+            vector<uint32_t> cells_to_load;
+            vector<uint32_t> cells_to_unload;
+            streaming.Update(camera->GetEntity()->GetPosition(), &cells_to_load, &cells_to_unload);
+
+            for (const uint32_t cell_index : cells_to_unload)
+            {
+                streaming_unload(cell_index);
+            }
+
+            for (const uint32_t cell_index : cells_to_load)
+            {
+                const string file_path    = streaming.GetCells()[cell_index].file_path;
+                const uint64_t generation = streaming_generation;
+                auto load = [cell_index, file_path, generation]() { load_cell(cell_index, file_path, generation); };
+
+                // without worker threads the load happens here, it completes on the next tick either way
+                if (ThreadPool::GetThreadCount() > 0)
+                {
+                    ThreadPool::AddTask(load);
+                }
+                else
+                {
+                    load();
+                }
+            }
+        }
+
+        // saving partitions the world from scratch, so everything has to be in memory
+        void streaming_load_all()
+        {
+            while (streaming.GetLoadsInFlight() > 0)
+            {
+                streaming_complete_loads();
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+
+            vector<WorldCell> cells = move(streaming.GetCells());
+            for (uint32_t cell_index = 0; cell_index < static_cast<uint32_t>(cells.size()); cell_index++)
+            {
+                if (cells[cell_index].state != WorldCellState::Unloaded)
+                    continue;
+
+                CellLoad load;
+                build_cell(cells[cell_index].file_path, &load);
+                cell_entities[cell_index] = attach_cell(load);
+
+                cells[cell_index].state = WorldCellState::Loaded;
+            }
+            streaming.SetCells(move(cells));
+        }
+
+        // things which affect the whole world stay resident
+        bool is_global(Entity* entity)
+        {
+            if (entity->GetComponent<Camera>() || entity->GetComponent<AudioListener>() || entity->GetComponent<Terrain>())
+                return true;
+
+            if (shared_ptr<Light> light = entity->GetComponent<Light>())
+                return light->GetLightType() == LightType::Directional;
+
+            return false;
+        }
+
+        // bounds and estimated resident size of a subtree, false if it holds anything global
+        bool measure(Entity* entity, BoundingBox* bounds, uint64_t* size)
+        {
+            if (is_global(entity))
+                return false;
+
+            shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+            if (renderable && renderable->HasMesh())
+            {
+                bounds->Merge(renderable->GetBoundingBox(BoundingBoxType::Transformed));
+                *size += static_cast<uint64_t>(renderable->GetVertexCount()) * sizeof(RHI_Vertex_PosTexNorTan);
+                *size += static_cast<uint64_t>(renderable->GetIndexCount()) * sizeof(uint32_t);
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                if (!measure(child, bounds, size))
+                    return false;
+            }
+
+            return true;
+        }
+
+        struct CellBuild
+        {
+            BoundingBox bounds;
+            uint64_t size = 0;
+            vector<Entity*> units;
+        };
+
+        // the largest subtrees which fit in a cell stream as a unit, anything larger stays resident and lets its children try
+        void partition(Entity* entity, const float cell_size, map<pair<int32_t, int32_t>, CellBuild>* cells)
+        {
+            BoundingBox bounds;
+            uint64_t size = 0;
+            if (measure(entity, &bounds, &size) && bounds.GetMin().x <= bounds.GetMax().x)
+            {
+                const Vector3 extent = bounds.GetSize();
+                if (extent.x <= cell_size && extent.z <= cell_size)
+                {
+                    pair<int32_t, int32_t> coordinates;
+                    WorldStreamingScheduler::GetCellCoordinates(bounds.GetCenter(), cell_size, &coordinates.first, &coordinates.second);
+
+                    CellBuild& cell = (*cells)[coordinates];
+                    cell.bounds.Merge(bounds);
+                    cell.size += size;
+                    cell.units.emplace_back(entity);
+                    return;
+                }
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                partition(child, cell_size, cells);
+            }
+        }
+
         void create_default_world_common(
             const Math::Vector3& camera_position = Vector3(0.0f, 2.0f, -10.0f),
             const Math::Vector3& camera_rotation = Vector3(0.0f, 0.0f, 0.0f),
@@ -165,6 +623,9 @@ namespace Spartan
     {
         SP_PROFILE_CPU();
 
+        // bring cells in and out around the camera, this takes the entity lock itself
+        streaming_tick();
+
         lock_guard<mutex> lock(entity_access_mutex);
 
         // tick entities
@@ -199,6 +660,9 @@ namespace Spartan
             }
         }
 
+        // keep the bvh in sync with the renderables, before the renderer culls against it
+        bvh_update();
+
         // notify renderer
         if (resolve && !ProgressTracker::IsLoading())
         {
@@ -229,45 +693,103 @@ namespace Spartan
         // Notify subsystems that need to save data
         SP_FIRE_EVENT(EventType::WorldSaveStart);
 
-        // Create a prefab file
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
-        if (!file->IsOpen())
-        {
-            SP_LOG_ERROR("Failed to open file.");
-            return false;
-        }
+        // A streamed world is partitioned again from scratch, so bring in the cells which aren't loaded
+        streaming_load_all();
 
         // Only save root entities as they will also save their descendants
         vector<shared_ptr<Entity>> root_actors = GetRootEntities();
-        const uint32_t root_entity_count = static_cast<uint32_t>(root_actors.size());
+
+        // Split off what can stream, it's saved in cells instead of with its resident ancestors
+        map<pair<int32_t, int32_t>, CellBuild> cells;
+        unordered_set<uint64_t> streamed_ids;
+        if (streaming_settings.partition_on_save)
+        {
+            for (shared_ptr<Entity>& root : root_actors)
+            {
+                partition(root.get(), streaming_settings.cell_size, &cells);
+            }
+
+            for (auto& it : cells)
+            {
+                for (Entity* unit : it.second.units)
+                {
+                    streamed_ids.insert(unit->GetObjectId());
+                }
+            }
+
+            root_actors.erase(remove_if(root_actors.begin(), root_actors.end(), [&streamed_ids](const shared_ptr<Entity>& root) { return streamed_ids.count(root->GetObjectId()) != 0; }), root_actors.end());
+        }
 
         // Start progress tracking and timing
         const Stopwatch timer;
-        ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Saving world...");
+        ProgressTracker::GetProgress(ProgressType::World).Start(1 + static_cast<uint32_t>(cells.size()), "Saving world...");
+
+        // Save cells, a file per cell next to the world file, which keeps a table of them
+        vector<WorldCell> cell_table;
+        vector<WorldCell> cells_saved;
+        cell_entities.clear();
+        bool saved = true;
+        if (!cells.empty())
+        {
+            const string cell_directory_name = name + "_cells/";
+            const string cell_directory      = FileSystem::GetDirectoryFromFilePath(file_path) + cell_directory_name;
+            FileSystem::CreateDirectory(cell_directory);
+
+            for (auto& [coordinates, cell_build] : cells)
+            {
+                const string cell_file_name = to_string(coordinates.first) + "_" + to_string(coordinates.second) + EXTENSION_WORLD_CELL;
+
+                if (!WorldFile::Save(cell_directory + cell_file_name, cell_build.units))
+                {
+                    SP_LOG_ERROR("Failed to save \"%s\"", (cell_directory + cell_file_name).c_str());
+                    saved = false;
+                }
 
-        // Save root entity count
-        file->Write(root_entity_count);
+                // everything is in memory after a save, the next tick unloads what's out of range
+                WorldCell& cell = cells_saved.emplace_back();
+                cell.x          = coordinates.first;
+                cell.z          = coordinates.second;
+                cell.bounds     = cell_build.bounds;
+                cell.size       = cell_build.size;
+                cell.file_path  = cell_directory + cell_file_name;
+                cell.state      = WorldCellState::Loaded;
 
-        // Save root entity IDs
+                // the table refers to cells relative to the world file
+                cell_table.emplace_back(cell).file_path = cell_directory_name + cell_file_name;
+
+                vector<shared_ptr<Entity>>& units = cell_entities.emplace_back();
+                for (Entity* unit : cell_build.units)
+                {
+                    units.emplace_back(GetEntityById(unit->GetObjectId()));
+                }
+
+                ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            }
+        }
+        streaming.SetSettings(streaming_settings);
+        streaming.SetCells(move(cells_saved));
+
+        // Save the resident entities and the cell table
+        vector<Entity*> roots;
         for (shared_ptr<Entity>& root : root_actors)
         {
-            file->Write(root->GetObjectId());
+            roots.emplace_back(root.get());
         }
 
-        // Save root entities
-        for (shared_ptr<Entity>& root : root_actors)
+        if (!WorldFile::Save(file_path, roots, &streamed_ids, &cell_table))
         {
-            root->Serialize(file.get());
-            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            SP_LOG_ERROR("Failed to save \"%s\"", file_path.c_str());
+            saved = false;
         }
+        ProgressTracker::GetProgress(ProgressType::World).JobDone();
 
         // Report time
-        SP_LOG_INFO("World \"%s\" has been saved. Duration %.2f ms", file_path.c_str(), timer.GetElapsedTimeMs());
+        SP_LOG_INFO("World \"%s\" has been saved (%u cells). Duration %.2f ms", file_path.c_str(), static_cast<uint32_t>(cells.size()), timer.GetElapsedTimeMs());
 
         // Notify subsystems waiting for us to finish
         SP_FIRE_EVENT(EventType::WorldSavedEnd);
 
-        return true;
+        return saved;
     }
 
     bool World::LoadFromFile(const string& file_path_)
@@ -280,49 +802,74 @@ namespace Spartan
             return false;
         }
 
-        // open file
-        unique_ptr<FileStream> file = make_unique<FileStream>(file_path, FileStream_Read);
-        if (!file->IsOpen())
-        {
-            SP_LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
-            return false;
-        }
-
-        // clear existing entities
+        // clear existing entities, which forgets the file path as well
         Clear();
 
-        name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
+        file_path = file_path_;
+        name      = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
 
         // notify subsystems that need to load data
         SP_FIRE_EVENT(EventType::WorldLoadStart);
 
-        // load root entity count
-        const uint32_t root_entity_count = file->ReadAs<uint32_t>();
-
-        // start progress tracking and timing
-        ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Loading world...");
+        // load the resident entities, a partitioned world also has a table of cells, which stream in around the camera from the next tick
         const Stopwatch timer;
+        vector<WorldCell> cells;
+        bool loaded = true;
+        if (WorldFile::IsWorldFile(file_path))
+        {
+            ProgressTracker::GetProgress(ProgressType::World).Start(1, "Loading world...");
+
+            vector<shared_ptr<Entity>> roots;
+            loaded = WorldFile::Load(file_path, &roots, &cells);
 
-        // load root entity IDs
-        for (uint32_t i = 0; i < root_entity_count; i++)
+            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+        }
+        else // older format
         {
-            shared_ptr<Entity> entity = CreateEntity();
-            entity->SetObjectId(file->ReadAs<uint64_t>());
+            FileStream file(file_path, FileStream_Read);
+            if (!file.IsOpen())
+            {
+                SP_LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
+                return false;
+            }
+
+            deserialize_root_entities(&file, true);
+
+            uint32_t magic = 0;
+            file.Read(&magic);
+            if (magic == cell_table_magic)
+            {
+                cells.resize(file.ReadAs<uint32_t>());
+                for (WorldCell& cell : cells)
+                {
+                    file.Read(&cell.x);
+                    file.Read(&cell.z);
+                    file.Read(&cell.bounds);
+                    file.Read(&cell.size);
+                    cell.file_path = file.ReadAs<string>();
+                }
+            }
         }
 
-        // serialize root entities
-        for (uint32_t i = 0; i < root_entity_count; i++)
+        if (!cells.empty())
         {
-            entities[i]->Deserialize(file.get(), nullptr);
-            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            const string directory = FileSystem::GetDirectoryFromFilePath(file_path);
+            for (WorldCell& cell : cells)
+            {
+                cell.file_path = directory + cell.file_path;
+            }
+
+            cell_entities.resize(cells.size());
+            streaming.SetSettings(streaming_settings);
+            streaming.SetCells(move(cells));
         }
 
         // report time
-        SP_LOG_INFO("World \"%s\" has been loaded. Duration %.2f ms", file_path.c_str(), timer.GetElapsedTimeMs());
+        SP_LOG_INFO("World \"%s\" has been loaded (%u cells). Duration %.2f ms", file_path.c_str(), static_cast<uint32_t>(streaming.GetCells().size()), timer.GetElapsedTimeMs());
 
         SP_FIRE_EVENT(EventType::WorldLoadEnd);
 
-        return true;
+        return loaded;
     }
 
     void World::LoadDefaultWorld(DefaultWorld default_world)
@@ -353,6 +900,9 @@ namespace Spartan
 
     void World::Resolve()
     {
+        if (building_cell)
+            return;
+
         resolve = true;
     }
 
@@ -367,6 +917,28 @@ namespace Spartan
         return entity;
     }
 
+    void World::AddEntities(const vector<shared_ptr<Entity>>& entities_to_add)
+    {
+        lock_guard lock(entity_access_mutex);
+
+        entities.reserve(entities.size() + entities_to_add.size());
+        for (const shared_ptr<Entity>& entity : entities_to_add)
+        {
+            entities[entity->GetObjectId()] = entity;
+        }
+
+        // their renderables were set up before they were in the world
+        {
+            lock_guard<mutex> lock_dirty(bvh_dirty_mutex);
+            for (const shared_ptr<Entity>& entity : entities_to_add)
+            {
+                bvh_dirty.insert(entity->GetObjectId());
+            }
+        }
+
+        resolve = true;
+    }
+
     bool World::EntityExists(Entity* entity)
     {
         SP_ASSERT_MSG(entity != nullptr, "Entity is null");
@@ -378,39 +950,7 @@ namespace Spartan
         SP_ASSERT_MSG(entity_to_remove != nullptr, "Entity is null");
 
         lock_guard<mutex> lock(entity_access_mutex);
-
-        // Remove the entity and all of its children
-        {
-            // Get the root entity and its descendants
-            std::vector<Entity*> entities_to_remove;
-            entities_to_remove.push_back(entity_to_remove);        // Add the root entity
-            entity_to_remove->GetDescendants(&entities_to_remove); // Get descendants 
-
-            // Create a set containing the object IDs of entities to remove
-            std::set<uint64_t> ids_to_remove;
-            for (Entity* entity : entities_to_remove) {
-                ids_to_remove.insert(entity->GetObjectId());
-            }
-
-            // Remove entities using a single loop
-            for (auto it = entities.begin(); it != entities.end(); )
-            {
-                if (ids_to_remove.count(it->first) > 0)
-                {
-                    it = entities.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-
-            // If there was a parent, update it
-            if (std::shared_ptr<Entity> parent = entity_to_remove->GetParent())
-            {
-                parent->AcquireChildren();
-            }
-        }
+        remove_entity(entity_to_remove);
 
         resolve = true;
     }
@@ -448,13 +988,56 @@ namespace Spartan
         return entities;
     }
 
+    const Bvh& World::GetBvh()
+    {
+        return bvh;
+    }
+
+    void World::SetBoundsDirty(Entity* entity)
+    {
+        lock_guard<mutex> lock(bvh_dirty_mutex);
+        bvh_dirty.insert(entity->GetObjectId());
+    }
+
+    void World::SetStreamingSettings(const WorldStreamingSettings& settings)
+    {
+        streaming_settings = settings;
+        streaming.SetSettings(settings);
+    }
+
+    const WorldStreamingSettings& World::GetStreamingSettings()
+    {
+        return streaming_settings;
+    }
+
+    const WorldStreamingScheduler& World::GetStreamingScheduler()
+    {
+        return streaming;
+    }
+
     void World::Clear()
     {
         // fire event
         SP_FIRE_EVENT(EventType::WorldClear);
 
+        // stop streaming, a cell which is deserializing right now finishes first and queued ones are dropped
+        {
+            lock_guard<mutex> lock_load(streaming_load_mutex);
+            lock_guard<mutex> lock(streaming_mutex);
+            streaming_generation++;
+            cell_loads_completed.clear();
+            streaming.Clear();
+            cell_entities.clear();
+        }
+
         // clear
         entities.clear();
+        bvh.Clear();
+        bvh_proxies.clear();
+        {
+            lock_guard<mutex> lock(bvh_dirty_mutex);
+            bvh_dirty.clear();
+        }
         name.clear();
         file_path.clear();
 
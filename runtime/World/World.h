@@ -28,6 +28,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    namespace Math
+    {
+        class Bvh;
+    }
+
+    struct WorldStreamingSettings;
+    class WorldStreamingScheduler;
+
     enum class DefaultWorld
     {
         Objects,
@@ -55,12 +63,22 @@ namespace Spartan
 
         // entities
         static std::shared_ptr<Entity> CreateEntity();
+        static void AddEntities(const std::vector<std::shared_ptr<Entity>>& entities); // entities created elsewhere (e.g. decoded in parallel), keyed by their id
         static bool EntityExists(Entity* entity);
         static void RemoveEntity(Entity* entity);
         static std::vector<std::shared_ptr<Entity>> GetRootEntities();
         static const std::shared_ptr<Entity>& GetEntityById(uint64_t id);
         static const std::unordered_map<uint64_t, std::shared_ptr<Entity>>& GetAllEntities();
 
+        // spatial queries, the user data of each proxy is the Entity* of a renderable
+        static const Math::Bvh& GetBvh();
+        static void SetBoundsDirty(Entity* entity); // the bvh only refits the entities reported here (by transforms and renderables, from any thread)
+
+        // streaming, a world saved with partitioning keeps only what's global resident and streams cells in and out around the camera
+        static void SetStreamingSettings(const WorldStreamingSettings& settings);
+        static const WorldStreamingSettings& GetStreamingSettings();
+        static const WorldStreamingScheduler& GetStreamingScheduler();
+
         // misc
         static void New();
         static void Resolve();
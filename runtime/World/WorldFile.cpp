@@ -0,0 +1,1148 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "WorldFile.h"
+#include "Entity.h"
+#include "Prefab.h"
+#include "WorldStreaming.h"
+#include "ThreadPool.h"
+#include "../IO/AssetContainer.h"
+#include "../IO/Compression.h"
+#include "../IO/FileStream.h"
+#include "../Resource/ResourceCache.h"
+//================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    namespace
+    {
+        const uint32_t chunk_header        = asset_chunk_id("WHDR");
+        const uint32_t chunk_entities      = asset_chunk_id("WENT");
+        const uint32_t chunk_transforms    = asset_chunk_id("WXFM");
+        const uint32_t chunk_strings       = asset_chunk_id("WSTR"); // characters
+        const uint32_t chunk_string_end    = asset_chunk_id("WSTE"); // where each string ends
+        const uint32_t chunk_components    = asset_chunk_id("WCMI"); // indexed by component type
+        const uint32_t chunk_payloads      = asset_chunk_id("WCMD"); // indexed by component type
+        const uint32_t chunk_prefabs       = asset_chunk_id("WPFB");
+        const uint32_t chunk_overrides     = asset_chunk_id("WOVR");
+        const uint32_t chunk_override_data = asset_chunk_id("WOVD");
+        const uint32_t chunk_cells         = asset_chunk_id("WCEL");
+
+        const uint32_t codec_none = 0;
+        const uint32_t codec_lz   = 1;
+
+        const uint32_t entity_flag_active          = 1 << 0;
+        const uint32_t entity_flag_prefab_instance = 1 << 1;
+
+        const uint32_t override_entity            = 0; // name, active state and local transform
+        const uint32_t override_component         = 1; // a changed or an added component
+        const uint32_t override_component_removed = 2;
+        const uint32_t override_entity_removed    = 3;
+
+        const uint32_t index_none           = numeric_limits<uint32_t>::max();
+        const uint32_t component_type_count = static_cast<uint32_t>(ComponentType::Max);
+
+        // precedes the data of every chunk
+        struct ChunkHeader
+        {
+            uint64_t size    = 0; // decompressed
+            uint32_t codec   = codec_none;
+            uint32_t padding = 0;
+        };
+
+        struct Header
+        {
+            uint32_t version      = 0;
+            uint32_t entity_count = 0;
+            uint32_t cell_count   = 0;
+            uint32_t padding      = 0;
+        };
+
+        // the payload of an entity override
+        struct EntityOverride
+        {
+            float transform[10] = {}; // position, rotation, scale
+            uint32_t name       = 0;  // string index
+            uint32_t flags      = 0;
+        };
+
+        // a chunk before it's written, the data is referenced until it's encoded
+        struct ChunkSource
+        {
+            uint32_t id      = 0;
+            uint32_t index   = 0;
+            const void* data = nullptr;
+            uint64_t size    = 0;
+            vector<std::byte> encoded;
+        };
+
+        void encode(ChunkSource* chunk)
+        {
+            vector<std::byte> compressed;
+            Compression::Compress(chunk->data, chunk->size, &compressed);
+
+            // incompressible data is stored as is
+            ChunkHeader header;
+            header.size         = chunk->size;
+            header.codec        = compressed.size() < chunk->size ? codec_lz : codec_none;
+            const void* payload = header.codec == codec_lz ? static_cast<const void*>(compressed.data()) : chunk->data;
+            const uint64_t size = header.codec == codec_lz ? compressed.size() : chunk->size;
+
+            chunk->encoded.resize(sizeof(ChunkHeader) + size);
+            memcpy(chunk->encoded.data(), &header, sizeof(ChunkHeader));
+            if (size != 0)
+            {
+                memcpy(chunk->encoded.data() + sizeof(ChunkHeader), payload, size);
+            }
+        }
+
+        bool decode(const std::byte* data, const uint64_t size, vector<std::byte>* decoded)
+        {
+            ChunkHeader header;
+            if (size < sizeof(ChunkHeader))
+                return false;
+            memcpy(&header, data, sizeof(ChunkHeader));
+
+            decoded->resize(header.size);
+            const std::byte* payload    = data + sizeof(ChunkHeader);
+            const uint64_t payload_size = size - sizeof(ChunkHeader);
+
+            if (header.codec == codec_lz)
+                return Compression::Decompress(payload, payload_size, decoded->data(), header.size);
+
+            if (header.codec != codec_none || payload_size != header.size)
+                return false;
+
+            if (header.size != 0)
+            {
+                memcpy(decoded->data(), payload, header.size);
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        bool to_array(const vector<std::byte>& bytes, vector<T>* values)
+        {
+            static_assert(is_trivially_copyable_v<T>, "Records must be trivially copyable");
+
+            if (bytes.size() % sizeof(T) != 0)
+                return false;
+
+            values->resize(bytes.size() / sizeof(T));
+            if (!bytes.empty())
+            {
+                memcpy(values->data(), bytes.data(), bytes.size());
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        void append(vector<std::byte>* bytes, const T* data, const uint64_t size)
+        {
+            const std::byte* begin = reinterpret_cast<const std::byte*>(data);
+            bytes->insert(bytes->end(), begin, begin + size);
+        }
+
+        string serialize(Component* component)
+        {
+            FileStream stream;
+            component->Serialize(&stream);
+            return stream.GetWrittenData();
+        }
+
+        void get_transform(Entity* entity, float transform[10])
+        {
+            const Vector3& position    = entity->GetPositionLocal();
+            const Quaternion& rotation = entity->GetRotationLocal();
+            const Vector3& scale       = entity->GetScaleLocal();
+            const float values[10]     = { position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z };
+            memcpy(transform, values, sizeof(values));
+        }
+
+        void set_transform(Entity* entity, const float transform[10])
+        {
+            entity->SetTransformLocal(
+                Vector3(transform[0], transform[1], transform[2]),
+                Quaternion(transform[3], transform[4], transform[5], transform[6]),
+                Vector3(transform[7], transform[8], transform[9])
+            );
+        }
+
+        // a free list of equally sized slots, carved out of blocks which are never returned to the system,
+        // so that entities (which can be released from any thread, and after any static is destroyed) always have a pool to go back to
+        template<size_t size, size_t alignment>
+        class SlotPool
+        {
+        public:
+            static SlotPool& Get()
+            {
+                static SlotPool* pool = new SlotPool();
+                return *pool;
+            }
+
+            void* Allocate()
+            {
+                lock_guard<mutex> lock(m_mutex);
+
+                if (!m_free)
+                {
+                    byte* block = static_cast<byte*>(::operator new(slot_size * slots_per_block, align_val_t(slot_alignment)));
+                    for (size_t i = 0; i < slots_per_block; i++)
+                    {
+                        Push(block + i * slot_size);
+                    }
+                }
+
+                Slot* slot = m_free;
+                m_free     = slot->next;
+                return slot;
+            }
+
+            void Free(void* pointer)
+            {
+                lock_guard<mutex> lock(m_mutex);
+                Push(pointer);
+            }
+
+        private:
+            struct Slot
+            {
+                Slot* next = nullptr;
+            };
+
+            void Push(void* pointer)
+            {
+                Slot* slot = static_cast<Slot*>(pointer);
+                slot->next = m_free;
+                m_free     = slot;
+            }
+
+            static constexpr size_t slot_alignment  = alignment > alignof(Slot) ? alignment : alignof(Slot);
+            static constexpr size_t slot_size       = (max(size, sizeof(Slot)) + slot_alignment - 1) / slot_alignment * slot_alignment;
+            static constexpr size_t slots_per_block = 1024;
+
+            Slot* m_free = nullptr;
+            mutex m_mutex;
+        };
+
+        // hands out single objects from a slot pool, allocate_shared() rebinds it to its control block (which holds the entity as well)
+        template<typename T>
+        struct PoolAllocator
+        {
+            using value_type = T;
+
+            PoolAllocator() = default;
+            template<typename U> PoolAllocator(const PoolAllocator<U>&) { }
+
+            T* allocate(const size_t count)
+            {
+                if (count != 1)
+                    return static_cast<T*>(::operator new(count * sizeof(T), align_val_t(alignof(T))));
+
+                return static_cast<T*>(SlotPool<sizeof(T), alignof(T)>::Get().Allocate());
+            }
+
+            void deallocate(T* pointer, const size_t count)
+            {
+                if (count != 1)
+                {
+                    ::operator delete(pointer, align_val_t(alignof(T)));
+                    return;
+                }
+
+                SlotPool<sizeof(T), alignof(T)>::Get().Free(pointer);
+            }
+
+            template<typename U> bool operator==(const PoolAllocator<U>&) const { return true; }
+            template<typename U> bool operator!=(const PoolAllocator<U>&) const { return false; }
+        };
+
+        // loads and instantiations create entities by the thousands, so they come from a pool instead of a heap allocation each,
+        // each one is still released on its own, so that a removed entity takes its components (bodies, sounds) with it
+        vector<shared_ptr<Entity>> allocate_entities(const uint32_t count)
+        {
+            vector<shared_ptr<Entity>> entities(count);
+            for (shared_ptr<Entity>& entity : entities)
+            {
+                entity = allocate_shared<Entity>(PoolAllocator<Entity>());
+            }
+
+            return entities;
+        }
+
+        // the entities of an instance derive their ids from its root, so that they are the same every time the instance is loaded
+        uint64_t get_instance_entity_id(const uint64_t root_id, const uint32_t index)
+        {
+            uint64_t id = root_id ^ (static_cast<uint64_t>(index) * 0x9E3779B97F4A7C15ull);
+            id ^= id >> 33;
+            id *= 0xFF51AFD7ED558CCDull;
+            id ^= id >> 33;
+            return id;
+        }
+
+        // component types which only touch their own state and thread safe caches, the rest talk to
+        // systems which are not thread safe (physics, audio, gpu resources) and are decoded serially
+        bool can_decode_in_parallel(const ComponentType type)
+        {
+            return type == ComponentType::Renderable;
+        }
+    }
+
+    bool WorldFile::Save(const string& file_path, const vector<Entity*>& roots, const unordered_set<uint64_t>* excluded_descendants, const vector<WorldCell>* cells)
+    {
+        WorldFile file;
+        file.Capture(roots, excluded_descendants);
+        if (cells)
+        {
+            file.SetCells(*cells);
+        }
+
+        return file.Write(file_path);
+    }
+
+    bool WorldFile::Load(const string& file_path, vector<shared_ptr<Entity>>* roots, vector<WorldCell>* cells)
+    {
+        SP_ASSERT(roots != nullptr);
+
+        WorldFile file;
+        if (!file.Read(file_path))
+            return false;
+
+        file.Instantiate(roots);
+        if (cells)
+        {
+            file.GetCells(cells);
+        }
+
+        return true;
+    }
+
+    bool WorldFile::IsWorldFile(const string& file_path)
+    {
+        return AssetContainer::IsContainer(file_path);
+    }
+
+    void WorldFile::Capture(const vector<Entity*>& roots, const unordered_set<uint64_t>* excluded_descendants, const bool expand_prefab_instances)
+    {
+        *this = WorldFile();
+        m_components.resize(component_type_count);
+        m_payloads.resize(component_type_count);
+
+        for (Entity* root : roots)
+        {
+            CaptureEntity(root, excluded_descendants, expand_prefab_instances);
+        }
+
+        ComputeLookups();
+    }
+
+    void WorldFile::CaptureEntity(Entity* entity, const unordered_set<uint64_t>* excluded_descendants, const bool expand_prefab_instances)
+    {
+        const uint32_t index      = static_cast<uint32_t>(m_entities.size());
+        shared_ptr<Entity> parent = entity->GetParent();
+        const bool is_instance    = !expand_prefab_instances && entity->IsPrefabInstanceRoot();
+
+        EntityRecord& record = m_entities.emplace_back();
+        record.id            = entity->GetObjectId();
+        record.parent_id     = parent ? parent->GetObjectId() : 0;
+        record.name          = AddString(entity->GetObjectName());
+        record.flags         = (entity->IsActive() ? entity_flag_active : 0) | (is_instance ? entity_flag_prefab_instance : 0);
+        get_transform(entity, reinterpret_cast<float*>(&m_transforms.emplace_back()));
+
+        if (is_instance)
+        {
+            CaptureInstance(entity, index, excluded_descendants);
+            return;
+        }
+
+        // components, each one is serialized as before, but appended to the payload of its type
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            if (Component* component = entity->GetAllComponents()[type].get())
+            {
+                const string data = serialize(component);
+
+                ComponentRecord& component_record = m_components[type].emplace_back();
+                component_record.entity           = index;
+                component_record.id               = component->GetObjectId();
+                component_record.offset           = m_payloads[type].size();
+                component_record.size             = data.size();
+                append(&m_payloads[type], data.data(), data.size());
+            }
+        }
+
+        for (Entity* child : entity->GetChildren())
+        {
+            if (child && (!excluded_descendants || excluded_descendants->count(child->GetObjectId()) == 0))
+            {
+                CaptureEntity(child, excluded_descendants, expand_prefab_instances);
+            }
+        }
+    }
+
+    void WorldFile::CaptureInstance(Entity* root, const uint32_t root_index, const unordered_set<uint64_t>* excluded_descendants)
+    {
+        Prefab* prefab          = root->GetPrefab();
+        const WorldFile& source = prefab->GetFile();
+        const uint32_t instance = static_cast<uint32_t>(m_prefabs.size());
+        m_prefabs.push_back({ root_index, AddString(prefab->GetResourceFilePathNative()) });
+
+        // walk the instance, what came from the prefab is compared against it, anything else is captured as usual
+        vector<bool> visited(source.GetEntityCount(), false);
+        vector<Entity*> stack = { root };
+        while (!stack.empty())
+        {
+            Entity* entity       = stack.back();
+            const uint32_t index = entity->GetPrefabIndex();
+            visited[index]       = true;
+            stack.pop_back();
+
+            // name, active state and transform, the root has its own entity record
+            if (entity != root)
+            {
+                EntityOverride entity_override;
+                get_transform(entity, entity_override.transform);
+                entity_override.flags = entity->IsActive() ? entity_flag_active : 0;
+
+                const EntityRecord& record = source.m_entities[index];
+                if (memcmp(entity_override.transform, &source.m_transforms[index], sizeof(entity_override.transform)) != 0 ||
+                    entity_override.flags != (record.flags & entity_flag_active) ||
+                    entity->GetObjectName() != source.GetString(record.name))
+                {
+                    entity_override.name = AddString(entity->GetObjectName());
+                    AddOverride(override_entity, instance, index, 0, &entity_override, sizeof(entity_override));
+                }
+            }
+
+            // components
+            for (uint32_t type = 0; type < component_type_count; type++)
+            {
+                Component* component        = entity->GetAllComponents()[type].get();
+                const uint32_t record_index = source.m_component_lookup[index * component_type_count + type];
+
+                if (!component)
+                {
+                    if (record_index != index_none)
+                    {
+                        AddOverride(override_component_removed, instance, index, type, nullptr, 0);
+                    }
+                    continue;
+                }
+
+                const string data = serialize(component);
+                if (record_index != index_none)
+                {
+                    const ComponentRecord& record = source.m_components[type][record_index];
+                    if (record.size == data.size() && memcmp(source.m_payloads[type].data() + record.offset, data.data(), data.size()) == 0)
+                        continue;
+                }
+
+                AddOverride(override_component, instance, index, type, data.data(), data.size());
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                if (!child || (excluded_descendants && excluded_descendants->count(child->GetObjectId()) != 0))
+                    continue;
+
+                const uint32_t child_index = child->GetPrefabIndex();
+                if (child->GetPrefab() == prefab && child_index != 0 && child_index < visited.size() && !visited[child_index])
+                {
+                    stack.emplace_back(child);
+                }
+                else
+                {
+                    CaptureEntity(child, excluded_descendants, false);
+                }
+            }
+        }
+
+        // what was deleted from the instance
+        for (uint32_t index = 0; index < static_cast<uint32_t>(visited.size()); index++)
+        {
+            if (!visited[index])
+            {
+                AddOverride(override_entity_removed, instance, index, 0, nullptr, 0);
+            }
+        }
+    }
+
+    void WorldFile::AddOverride(const uint32_t kind, const uint32_t instance, const uint32_t entity, const uint32_t type, const void* data, const uint64_t size)
+    {
+        OverrideRecord& record = m_overrides.emplace_back();
+        record.instance        = instance;
+        record.entity          = entity;
+        record.kind            = kind;
+        record.type            = type;
+        record.offset          = m_override_payload.size();
+        record.size            = size;
+
+        if (size != 0)
+        {
+            append(&m_override_payload, static_cast<const std::byte*>(data), size);
+        }
+    }
+
+    uint32_t WorldFile::AddString(const string& text)
+    {
+        auto it = m_string_indices.find(text);
+        if (it != m_string_indices.end())
+            return it->second;
+
+        const uint32_t index = static_cast<uint32_t>(m_string_ends.size());
+        m_characters.insert(m_characters.end(), text.begin(), text.end());
+        m_string_ends.emplace_back(static_cast<uint32_t>(m_characters.size()));
+        m_string_indices[text] = index;
+
+        return index;
+    }
+
+    string WorldFile::GetString(const uint32_t index) const
+    {
+        const uint32_t begin = index == 0 ? 0 : m_string_ends[index - 1];
+        return string(m_characters.data() + begin, m_string_ends[index] - begin);
+    }
+
+    void WorldFile::ComputeLookups()
+    {
+        const uint32_t entity_count = GetEntityCount();
+
+        unordered_map<uint64_t, uint32_t> entity_indices;
+        entity_indices.reserve(entity_count);
+        for (uint32_t i = 0; i < entity_count; i++)
+        {
+            entity_indices[m_entities[i].id] = i;
+        }
+
+        m_parents.assign(entity_count, index_none);
+        for (uint32_t i = 0; i < entity_count; i++)
+        {
+            auto it = entity_indices.find(m_entities[i].parent_id);
+            if (m_entities[i].parent_id != 0 && it != entity_indices.end())
+            {
+                m_parents[i] = it->second;
+            }
+        }
+
+        m_component_lookup.assign(static_cast<size_t>(entity_count) * component_type_count, index_none);
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_components[type].size()); i++)
+            {
+                m_component_lookup[m_components[type][i].entity * component_type_count + type] = i;
+            }
+        }
+    }
+
+    void WorldFile::SetCells(const vector<WorldCell>& cells)
+    {
+        m_cells.clear();
+        for (const WorldCell& cell : cells)
+        {
+            const Vector3& min = cell.bounds.GetMin();
+            const Vector3& max = cell.bounds.GetMax();
+
+            CellRecord& record = m_cells.emplace_back();
+            record.x           = cell.x;
+            record.z           = cell.z;
+            record.min[0]      = min.x; record.min[1] = min.y; record.min[2] = min.z;
+            record.max[0]      = max.x; record.max[1] = max.y; record.max[2] = max.z;
+            record.size        = cell.size;
+            record.path        = AddString(cell.file_path);
+        }
+    }
+
+    void WorldFile::GetCells(vector<WorldCell>* cells) const
+    {
+        cells->clear();
+        for (const CellRecord& record : m_cells)
+        {
+            WorldCell& cell = cells->emplace_back();
+            cell.x          = record.x;
+            cell.z          = record.z;
+            cell.bounds     = BoundingBox(Vector3(record.min[0], record.min[1], record.min[2]), Vector3(record.max[0], record.max[1], record.max[2]));
+            cell.size       = record.size;
+            cell.file_path  = GetString(record.path);
+        }
+    }
+
+    bool WorldFile::Write(const string& file_path) const
+    {
+        Header header;
+        header.version      = version;
+        header.entity_count = GetEntityCount();
+        header.cell_count   = static_cast<uint32_t>(m_cells.size());
+
+        // gather the columns
+        vector<ChunkSource> chunks;
+        auto add_chunk = [&chunks](const uint32_t id, const uint32_t index, const void* data, const uint64_t size)
+        {
+            ChunkSource& chunk = chunks.emplace_back();
+            chunk.id           = id;
+            chunk.index        = index;
+            chunk.data         = data;
+            chunk.size         = size;
+        };
+        add_chunk(chunk_header,        0, &header,                    sizeof(Header));
+        add_chunk(chunk_entities,      0, m_entities.data(),          m_entities.size() * sizeof(EntityRecord));
+        add_chunk(chunk_transforms,    0, m_transforms.data(),        m_transforms.size() * sizeof(TransformRecord));
+        add_chunk(chunk_strings,       0, m_characters.data(),        m_characters.size());
+        add_chunk(chunk_string_end,    0, m_string_ends.data(),       m_string_ends.size() * sizeof(uint32_t));
+        add_chunk(chunk_prefabs,       0, m_prefabs.data(),           m_prefabs.size() * sizeof(PrefabRecord));
+        add_chunk(chunk_overrides,     0, m_overrides.data(),         m_overrides.size() * sizeof(OverrideRecord));
+        add_chunk(chunk_override_data, 0, m_override_payload.data(),  m_override_payload.size());
+        add_chunk(chunk_cells,         0, m_cells.data(),             m_cells.size() * sizeof(CellRecord));
+        for (uint32_t type = 0; type < static_cast<uint32_t>(m_components.size()); type++)
+        {
+            if (m_components[type].empty())
+                continue;
+
+            add_chunk(chunk_components, type, m_components[type].data(), m_components[type].size() * sizeof(ComponentRecord));
+            add_chunk(chunk_payloads,   type, m_payloads[type].data(),   m_payloads[type].size());
+        }
+
+        // compress them in parallel
+        ThreadPool::ParallelLoop([&chunks](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                encode(&chunks[i]);
+            }
+        }, static_cast<uint32_t>(chunks.size()));
+
+        AssetContainerWriter writer;
+        for (const ChunkSource& chunk : chunks)
+        {
+            writer.AddChunk(chunk.id, chunk.index, chunk.encoded);
+        }
+
+        return writer.Write(file_path);
+    }
+
+    bool WorldFile::Read(const string& file_path)
+    {
+        *this = WorldFile();
+
+        AssetContainer container;
+        if (!container.Open(file_path))
+            return false;
+
+        // decompress all the chunks in parallel
+        const vector<AssetChunk>& chunks = container.GetChunks();
+        vector<vector<std::byte>> decoded(chunks.size());
+        atomic<bool> decoded_all = true;
+        ThreadPool::ParallelLoop([&](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                uint64_t size = 0;
+                const std::byte* data = container.GetChunkData(chunks[i].id, chunks[i].index, &size);
+                if (!data || !decode(data, size, &decoded[i]))
+                {
+                    decoded_all = false;
+                }
+            }
+        }, static_cast<uint32_t>(chunks.size()));
+
+        if (!decoded_all)
+        {
+            SP_LOG_ERROR("\"%s\" is corrupted", file_path.c_str());
+            return false;
+        }
+
+        // chunks which don't exist (e.g. prefabs in a file of version 1) are empty
+        vector<std::byte> empty;
+        auto get_chunk = [&chunks, &decoded, &empty](const uint32_t id, const uint32_t index) -> vector<std::byte>&
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(chunks.size()); i++)
+            {
+                if (chunks[i].id == id && chunks[i].index == index)
+                    return decoded[i];
+            }
+
+            return empty;
+        };
+
+        // columns
+        vector<Header> header;
+        bool valid =
+            to_array(get_chunk(chunk_header, 0), &header) && header.size() == 1 && header[0].version >= 1 && header[0].version <= version &&
+            to_array(get_chunk(chunk_entities, 0), &m_entities) && m_entities.size() == header[0].entity_count &&
+            to_array(get_chunk(chunk_transforms, 0), &m_transforms) && m_transforms.size() == m_entities.size() &&
+            to_array(get_chunk(chunk_strings, 0), &m_characters) &&
+            to_array(get_chunk(chunk_string_end, 0), &m_string_ends) &&
+            to_array(get_chunk(chunk_prefabs, 0), &m_prefabs) &&
+            to_array(get_chunk(chunk_overrides, 0), &m_overrides) &&
+            to_array(get_chunk(chunk_cells, 0), &m_cells) && m_cells.size() == header[0].cell_count;
+        m_override_payload = move(get_chunk(chunk_override_data, 0));
+
+        m_components.resize(component_type_count);
+        m_payloads.resize(component_type_count);
+        for (uint32_t type = 0; valid && type < component_type_count; type++)
+        {
+            valid            = to_array(get_chunk(chunk_components, type), &m_components[type]);
+            m_payloads[type] = move(get_chunk(chunk_payloads, type));
+
+            for (const ComponentRecord& record : m_components[type])
+            {
+                valid = valid && record.entity < m_entities.size() && record.offset + record.size <= m_payloads[type].size();
+            }
+        }
+
+        // everything that indexes something else
+        const uint32_t string_count = static_cast<uint32_t>(m_string_ends.size());
+        for (uint32_t i = 0; valid && i < string_count; i++)
+        {
+            valid = m_string_ends[i] <= m_characters.size() && (i == 0 || m_string_ends[i - 1] <= m_string_ends[i]);
+        }
+
+        for (const EntityRecord& record : m_entities)
+        {
+            valid = valid && record.name < string_count;
+        }
+
+        for (const PrefabRecord& record : m_prefabs)
+        {
+            valid = valid && record.entity < m_entities.size() && record.path < string_count;
+        }
+
+        for (const OverrideRecord& record : m_overrides)
+        {
+            valid = valid && record.instance < m_prefabs.size() && record.type < component_type_count && record.offset + record.size <= m_override_payload.size();
+
+            // an entity override refers to its name in the string table
+            if (valid && record.kind == override_entity && record.size == sizeof(EntityOverride))
+            {
+                EntityOverride entity_override;
+                memcpy(&entity_override, m_override_payload.data() + record.offset, sizeof(EntityOverride));
+                valid = entity_override.name < string_count;
+            }
+        }
+
+        for (const CellRecord& record : m_cells)
+        {
+            valid = valid && record.path < string_count;
+        }
+
+        if (!valid)
+        {
+            SP_LOG_ERROR("\"%s\" is not a valid world file", file_path.c_str());
+            *this = WorldFile();
+            return false;
+        }
+
+        ComputeLookups();
+
+        return true;
+    }
+
+    void WorldFile::Expand(const shared_ptr<Prefab>& prefab, const vector<shared_ptr<Entity>>& roots, vector<shared_ptr<Entity>>* entities, vector<ComponentJob>* jobs) const
+    {
+        // the layout of the output is what overrides rely on, per copy: entities 1 to n, and the jobs in type and record order
+        const uint32_t entity_count = GetEntityCount();
+        const uint32_t copy_count   = static_cast<uint32_t>(roots.size());
+        if (entity_count == 0 || copy_count == 0)
+            return;
+
+        uint32_t component_count = 0;
+        for (const vector<ComponentRecord>& records : m_components)
+        {
+            component_count += static_cast<uint32_t>(records.size());
+        }
+
+        const size_t entity_start = entities->size();
+        const size_t job_start    = jobs->size();
+        vector<shared_ptr<Entity>> allocated = allocate_entities(copy_count * (entity_count - 1));
+        entities->insert(entities->end(), allocated.begin(), allocated.end());
+        jobs->resize(job_start + static_cast<size_t>(copy_count) * component_count);
+
+        // copies are independent of each other, so they are built in parallel
+        ThreadPool::ParallelLoop([&](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t copy = work_index_start; copy < work_index_end; copy++)
+            {
+                const shared_ptr<Entity>* copy_entities = entities->data() + entity_start + static_cast<size_t>(copy) * (entity_count - 1);
+                auto get_entity = [&](const uint32_t index) -> const shared_ptr<Entity>& { return index == 0 ? roots[copy] : copy_entities[index - 1]; };
+
+                const shared_ptr<Entity>& root = roots[copy];
+                root->SetPrefab(prefab, 0);
+
+                for (uint32_t index = 1; index < entity_count; index++)
+                {
+                    const EntityRecord& record       = m_entities[index];
+                    const shared_ptr<Entity>& entity = get_entity(index);
+
+                    entity->SetObjectId(get_instance_entity_id(root->GetObjectId(), index));
+                    entity->SetObjectName(GetString(record.name));
+                    entity->SetActive((record.flags & entity_flag_active) != 0);
+                    entity->SetPrefab(prefab, index);
+                    entity->SetParent(get_entity(m_parents[index] != index_none ? m_parents[index] : 0));
+                    set_transform(entity.get(), reinterpret_cast<const float*>(&m_transforms[index]));
+                }
+
+                ComponentJob* job = jobs->data() + job_start + static_cast<size_t>(copy) * component_count;
+                for (uint32_t type = 0; type < component_type_count; type++)
+                {
+                    for (const ComponentRecord& record : m_components[type])
+                    {
+                        job->entity = get_entity(record.entity).get();
+                        job->type   = type;
+                        job->data   = m_payloads[type].data() + record.offset;
+                        job->size   = record.size;
+                        job++;
+                    }
+                }
+            }
+        }, copy_count);
+    }
+
+    void WorldFile::RunComponentJobs(vector<ComponentJob>& jobs)
+    {
+        vector<vector<ComponentJob*>> jobs_by_type(component_type_count);
+        for (ComponentJob& job : jobs)
+        {
+            if (job.entity)
+            {
+                jobs_by_type[job.type].emplace_back(&job);
+            }
+        }
+
+        // create all the components before any of them deserializes, they can depend on each other (e.g. a constraint on a body)
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            for (ComponentJob* job : jobs_by_type[type])
+            {
+                shared_ptr<Component> component = job->entity->AddComponent(static_cast<ComponentType>(type));
+                if (job->id != 0)
+                {
+                    component->SetObjectId(job->id);
+                }
+            }
+        }
+
+        // decode the component arrays, in type order like before
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            const vector<ComponentJob*>& jobs_of_type = jobs_by_type[type];
+            auto decode_components = [&jobs_of_type, type](uint32_t work_index_start, uint32_t work_index_end)
+            {
+                for (uint32_t i = work_index_start; i < work_index_end; i++)
+                {
+                    const ComponentJob* job = jobs_of_type[i];
+                    FileStream stream(job->data, job->size);
+                    job->entity->GetAllComponents()[type]->Deserialize(&stream);
+                }
+            };
+
+            if (can_decode_in_parallel(static_cast<ComponentType>(type)))
+            {
+                ThreadPool::ParallelLoop(decode_components, static_cast<uint32_t>(jobs_of_type.size()));
+            }
+            else
+            {
+                decode_components(0, static_cast<uint32_t>(jobs_of_type.size()));
+            }
+        }
+    }
+
+    void WorldFile::Build(vector<shared_ptr<Entity>>* entities_all, vector<shared_ptr<Entity>>* roots, vector<uint64_t>* root_parent_ids, vector<ComponentJob>* jobs) const
+    {
+        // create the entities in parallel, with their final ids
+        const uint32_t entity_count         = GetEntityCount();
+        vector<shared_ptr<Entity>> entities = allocate_entities(entity_count);
+        ThreadPool::ParallelLoop([&](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                const EntityRecord& record = m_entities[i];
+                entities[i]->SetObjectId(record.id);
+                entities[i]->SetObjectName(GetString(record.name));
+                entities[i]->SetActive((record.flags & entity_flag_active) != 0);
+            }
+        }, entity_count);
+        entities_all->insert(entities_all->end(), entities.begin(), entities.end());
+
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            for (const ComponentRecord& record : m_components[type])
+            {
+                jobs->push_back({ entities[record.entity].get(), type, record.id, m_payloads[type].data() + record.offset, record.size });
+            }
+        }
+
+        // expand the prefab instances, grouped by prefab so that each one expands all of its instances at once
+        vector<vector<uint32_t>> overrides_by_instance(m_prefabs.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_overrides.size()); i++)
+        {
+            overrides_by_instance[m_overrides[i].instance].emplace_back(i);
+        }
+
+        map<uint32_t, vector<uint32_t>> instances_by_prefab;
+        for (uint32_t instance = 0; instance < static_cast<uint32_t>(m_prefabs.size()); instance++)
+        {
+            instances_by_prefab[m_prefabs[instance].path].emplace_back(instance);
+        }
+
+        unordered_map<uint64_t, shared_ptr<Entity>> instance_entities;
+        vector<Entity*> removed;
+        for (const auto& [path, instances] : instances_by_prefab)
+        {
+            shared_ptr<Prefab> prefab = ResourceCache::Load<Prefab>(GetString(path));
+            if (!prefab || prefab->GetFile().GetEntityCount() == 0)
+            {
+                SP_LOG_ERROR("Failed to load prefab \"%s\", its instances will be empty", GetString(path).c_str());
+                continue;
+            }
+
+            const WorldFile& source = prefab->GetFile();
+            vector<shared_ptr<Entity>> instance_roots;
+            for (const uint32_t instance : instances)
+            {
+                instance_roots.emplace_back(entities[m_prefabs[instance].entity]);
+            }
+
+            vector<shared_ptr<Entity>> created;
+            const size_t job_start = jobs->size();
+            source.Expand(prefab, instance_roots, &created, jobs);
+            entities_all->insert(entities_all->end(), created.begin(), created.end());
+            for (const shared_ptr<Entity>& entity : created)
+            {
+                instance_entities[entity->GetObjectId()] = entity;
+            }
+
+            // overrides
+            const uint32_t source_entity_count = source.GetEntityCount();
+            const size_t jobs_per_copy         = (jobs->size() - job_start) / instances.size();
+            vector<uint32_t> job_type_start(component_type_count, 0);
+            for (uint32_t type = 1; type < component_type_count; type++)
+            {
+                job_type_start[type] = job_type_start[type - 1] + static_cast<uint32_t>(source.m_components[type - 1].size());
+            }
+
+            for (uint32_t copy = 0; copy < static_cast<uint32_t>(instances.size()); copy++)
+            {
+                for (const uint32_t override_index : overrides_by_instance[instances[copy]])
+                {
+                    const OverrideRecord& record = m_overrides[override_index];
+                    if (record.entity >= source_entity_count)
+                        continue; // the prefab changed since the instance was saved
+
+                    Entity* entity           = record.entity == 0 ? instance_roots[copy].get() : created[copy * (source_entity_count - 1) + record.entity - 1].get();
+                    const std::byte* data    = m_override_payload.data() + record.offset;
+                    const uint32_t component = source.m_component_lookup[record.entity * component_type_count + record.type];
+                    ComponentJob* job        = component != index_none ? &(*jobs)[job_start + copy * jobs_per_copy + job_type_start[record.type] + component] : nullptr;
+
+                    if (record.kind == override_entity && record.size == sizeof(EntityOverride))
+                    {
+                        EntityOverride entity_override;
+                        memcpy(&entity_override, data, sizeof(EntityOverride));
+                        entity->SetObjectName(GetString(entity_override.name));
+                        entity->SetActive((entity_override.flags & entity_flag_active) != 0);
+                        set_transform(entity, entity_override.transform);
+                    }
+                    else if (record.kind == override_component && job)
+                    {
+                        job->data = data;
+                        job->size = record.size;
+                    }
+                    else if (record.kind == override_component)
+                    {
+                        jobs->push_back({ entity, record.type, 0, data, record.size });
+                    }
+                    else if (record.kind == override_component_removed && job)
+                    {
+                        job->entity = nullptr;
+                    }
+                    else if (record.kind == override_entity_removed)
+                    {
+                        removed.emplace_back(entity);
+                    }
+                }
+            }
+        }
+
+        // hierarchy and transforms, parents come first so their transforms are final by the time a child needs them
+        for (uint32_t i = 0; i < entity_count; i++)
+        {
+            shared_ptr<Entity> parent = nullptr;
+            if (m_parents[i] != index_none)
+            {
+                parent = entities[m_parents[i]];
+            }
+            else if (m_entities[i].parent_id != 0 && instance_entities.count(m_entities[i].parent_id) != 0)
+            {
+                // a parent outside of the file's records, which is part of a prefab instance in it
+                parent = instance_entities[m_entities[i].parent_id];
+            }
+            else
+            {
+                // a parent outside of the file makes this a root of the file, the caller attaches it
+                roots->emplace_back(entities[i]);
+                root_parent_ids->emplace_back(m_entities[i].parent_id);
+            }
+
+            entities[i]->SetParent(parent);
+            set_transform(entities[i].get(), reinterpret_cast<const float*>(&m_transforms[i]));
+        }
+
+        // what instances deleted goes away before its components are created
+        unordered_set<Entity*> removed_all;
+        for (Entity* entity : removed)
+        {
+            vector<Entity*> descendants;
+            entity->GetDescendants(&descendants);
+            removed_all.insert(entity);
+            removed_all.insert(descendants.begin(), descendants.end());
+        }
+
+        if (removed_all.empty())
+            return;
+
+        for (ComponentJob& job : *jobs)
+        {
+            if (removed_all.count(job.entity) != 0)
+            {
+                job.entity = nullptr;
+            }
+        }
+
+        for (Entity* entity : removed)
+        {
+            entity->SetParent(shared_ptr<Entity>());
+        }
+
+        auto is_removed = [&removed_all](const shared_ptr<Entity>& entity) { return removed_all.count(entity.get()) != 0; };
+        for (uint32_t i = 0; i < static_cast<uint32_t>(roots->size()); )
+        {
+            if (is_removed((*roots)[i]))
+            {
+                roots->erase(roots->begin() + i);
+                root_parent_ids->erase(root_parent_ids->begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        entities_all->erase(remove_if(entities_all->begin(), entities_all->end(), is_removed), entities_all->end());
+    }
+
+    void WorldFile::Instantiate(vector<shared_ptr<Entity>>* roots) const
+    {
+        SP_ASSERT(roots != nullptr);
+        roots->clear();
+
+        vector<shared_ptr<Entity>> entities;
+        vector<uint64_t> root_parent_ids;
+        vector<ComponentJob> jobs;
+        Build(&entities, roots, &root_parent_ids, &jobs);
+
+        // attach the roots whose parent lives in another file (e.g. a cell), before the components see their transforms
+        for (uint32_t i = 0; i < static_cast<uint32_t>(roots->size()); i++)
+        {
+            if (root_parent_ids[i] != 0)
+            {
+                (*roots)[i]->SetParent(World::GetEntityById(root_parent_ids[i]));
+            }
+        }
+
+        // add them to the world under a single lock
+        World::AddEntities(entities);
+
+        RunComponentJobs(jobs);
+    }
+
+    void WorldFile::InstantiateDetached(vector<shared_ptr<Entity>>* entities, vector<shared_ptr<Entity>>* roots, vector<uint64_t>* root_parent_ids) const
+    {
+        SP_ASSERT(entities != nullptr && roots != nullptr && root_parent_ids != nullptr);
+        entities->clear();
+        roots->clear();
+        root_parent_ids->clear();
+
+        vector<ComponentJob> jobs;
+        Build(entities, roots, root_parent_ids, &jobs);
+        RunComponentJobs(jobs);
+    }
+
+    void WorldFile::Instantiate(const shared_ptr<Prefab>& prefab, const vector<Vector3>& positions, const vector<Quaternion>& rotations, const shared_ptr<Entity>& parent, vector<shared_ptr<Entity>>* roots) const
+    {
+        SP_ASSERT(roots != nullptr);
+        SP_ASSERT(rotations.empty() || rotations.size() == positions.size());
+
+        const uint32_t count = static_cast<uint32_t>(positions.size());
+        *roots = allocate_entities(count);
+        if (count == 0 || GetEntityCount() == 0)
+            return;
+
+        // place the roots first, so that the rest of each copy computes its transforms once
+        const EntityRecord& record       = m_entities[0];
+        const TransformRecord& transform = m_transforms[0];
+        const string name                = GetString(record.name);
+        const Vector3 scale              = Vector3(transform.scale[0], transform.scale[1], transform.scale[2]);
+        const Quaternion rotation        = Quaternion(transform.rotation[0], transform.rotation[1], transform.rotation[2], transform.rotation[3]);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Entity* root = (*roots)[i].get();
+            root->SetObjectName(name);
+            root->SetActive((record.flags & entity_flag_active) != 0);
+            root->SetParent(parent);
+            root->SetTransformLocal(positions[i], rotations.empty() ? rotation : rotations[i], scale);
+        }
+
+        vector<shared_ptr<Entity>> entities;
+        vector<ComponentJob> jobs;
+        Expand(prefab, *roots, &entities, &jobs);
+
+        World::AddEntities(*roots);
+        World::AddEntities(entities);
+
+        RunComponentJobs(jobs);
+    }
+
+    uint64_t WorldFile::GetMemoryUsage() const
+    {
+        uint64_t size = 0;
+        size += m_entities.size() * sizeof(EntityRecord);
+        size += m_transforms.size() * sizeof(TransformRecord);
+        size += m_characters.size() + m_string_ends.size() * sizeof(uint32_t);
+        size += m_prefabs.size() * sizeof(PrefabRecord);
+        size += m_overrides.size() * sizeof(OverrideRecord) + m_override_payload.size();
+        size += m_cells.size() * sizeof(CellRecord);
+        size += m_component_lookup.size() * sizeof(uint32_t) + m_parents.size() * sizeof(uint32_t);
+
+        for (uint32_t type = 0; type < static_cast<uint32_t>(m_components.size()); type++)
+        {
+            size += m_components[type].size() * sizeof(ComponentRecord) + m_payloads[type].size();
+        }
+
+        return size;
+    }
+}
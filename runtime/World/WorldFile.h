@@ -0,0 +1,186 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
+#include "../Core/Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    class Entity;
+    class Prefab;
+    struct WorldCell;
+
+    // a columnar world format, stored in an asset container with a compressed chunk per column:
+    // an entity table, a transform array, a string table and, per component type, a record array and a payload blob.
+    // loading decompresses the chunks and decodes the component arrays in parallel, without per entity map lookups.
+    // the columns can also be kept in memory and instantiated any number of times, which is what a prefab is
+    class SP_CLASS WorldFile
+    {
+    public:
+        static constexpr uint32_t version = 2; // 2 added prefab instances
+
+        // saves the roots and their descendants, excluded descendants are left out (they are saved elsewhere, e.g. in a streaming cell)
+        static bool Save(
+            const std::string& file_path,
+            const std::vector<Entity*>& roots,
+            const std::unordered_set<uint64_t>* excluded_descendants = nullptr,
+            const std::vector<WorldCell>* cells                      = nullptr
+        );
+
+        // adds the entities to the world and returns the roots, a root whose parent lives in another file (e.g. a cell) is attached to it
+        static bool Load(const std::string& file_path, std::vector<std::shared_ptr<Entity>>* roots, std::vector<WorldCell>* cells = nullptr);
+
+        // files written before this format are plain streams
+        static bool IsWorldFile(const std::string& file_path);
+
+        // prefab instances are captured as a reference to their prefab plus what they override, unless they are expanded
+        void Capture(const std::vector<Entity*>& roots, const std::unordered_set<uint64_t>* excluded_descendants = nullptr, const bool expand_prefab_instances = false);
+        bool Write(const std::string& file_path) const;
+        bool Read(const std::string& file_path);
+
+        // cells
+        void SetCells(const std::vector<WorldCell>& cells);
+        void GetCells(std::vector<WorldCell>* cells) const;
+
+        // creates the entities with their saved ids and adds them to the world
+        void Instantiate(std::vector<std::shared_ptr<Entity>>* roots) const;
+
+        // same, but without touching the world, so that it can run on a worker: entities gets all of them, and a root
+        // whose parent is outside of the file is left unattached, with the id of that parent in root_parent_ids (zero if none)
+        void InstantiateDetached(std::vector<std::shared_ptr<Entity>>* entities, std::vector<std::shared_ptr<Entity>>* roots, std::vector<uint64_t>* root_parent_ids) const;
+
+        // creates a copy of the entities per position with new ids, the file has to hold a single tree (as prefabs do)
+        void Instantiate(
+            const std::shared_ptr<Prefab>& prefab,
+            const std::vector<Math::Vector3>& positions,
+            const std::vector<Math::Quaternion>& rotations,
+            const std::shared_ptr<Entity>& parent,
+            std::vector<std::shared_ptr<Entity>>* roots
+        ) const;
+
+        uint32_t GetEntityCount() const { return static_cast<uint32_t>(m_entities.size()); }
+        uint64_t GetMemoryUsage() const;
+
+    private:
+        // entities are stored parents first, so a parent is always created before its children
+        struct EntityRecord
+        {
+            uint64_t id        = 0;
+            uint64_t parent_id = 0; // can be outside of the file, e.g. a resident parent of a cell
+            uint32_t name      = 0; // string index
+            uint32_t flags     = 0;
+        };
+
+        struct TransformRecord
+        {
+            float position[3] = {};
+            float rotation[4] = {};
+            float scale[3]    = {};
+        };
+
+        struct ComponentRecord
+        {
+            uint32_t entity  = 0; // entity index
+            uint32_t padding = 0;
+            uint64_t id      = 0;
+            uint64_t offset  = 0; // into the payload of the component type
+            uint64_t size    = 0;
+        };
+
+        // the root of a prefab instance, the rest of the instance comes from the prefab
+        struct PrefabRecord
+        {
+            uint32_t entity = 0; // entity index
+            uint32_t path   = 0; // string index
+        };
+
+        // what an instance changed, relative to the entity of the same index in its prefab
+        struct OverrideRecord
+        {
+            uint32_t instance = 0; // prefab record index
+            uint32_t entity   = 0; // entity index in the prefab
+            uint32_t kind     = 0;
+            uint32_t type     = 0; // component type
+            uint64_t offset   = 0; // into the override payload
+            uint64_t size     = 0;
+        };
+
+        struct CellRecord
+        {
+            int32_t x        = 0;
+            int32_t z        = 0;
+            float min[3]     = {};
+            float max[3]     = {};
+            uint64_t size    = 0;
+            uint32_t path    = 0; // string index
+            uint32_t padding = 0;
+        };
+
+        // a component to create and deserialize
+        struct ComponentJob
+        {
+            Entity* entity        = nullptr; // null when it's skipped
+            uint32_t type         = 0;
+            uint64_t id           = 0;       // zero keeps a generated id
+            const std::byte* data = nullptr;
+            uint64_t size         = 0;
+        };
+
+        uint32_t AddString(const std::string& text);
+        std::string GetString(const uint32_t index) const;
+        void CaptureEntity(Entity* entity, const std::unordered_set<uint64_t>* excluded_descendants, const bool expand_prefab_instances);
+        void CaptureInstance(Entity* root, const uint32_t root_index, const std::unordered_set<uint64_t>* excluded_descendants);
+        void AddOverride(const uint32_t kind, const uint32_t instance, const uint32_t entity, const uint32_t type, const void* data, const uint64_t size);
+        void ComputeLookups();
+        // creates the entities, their hierarchy and their component jobs, without touching the world
+        void Build(std::vector<std::shared_ptr<Entity>>* entities, std::vector<std::shared_ptr<Entity>>* roots, std::vector<uint64_t>* root_parent_ids, std::vector<ComponentJob>* jobs) const;
+        void Expand(const std::shared_ptr<Prefab>& prefab, const std::vector<std::shared_ptr<Entity>>& roots, std::vector<std::shared_ptr<Entity>>* entities, std::vector<ComponentJob>* jobs) const;
+        static void RunComponentJobs(std::vector<ComponentJob>& jobs);
+
+        // columns
+        std::vector<EntityRecord> m_entities;
+        std::vector<TransformRecord> m_transforms;
+        std::vector<char> m_characters;
+        std::vector<uint32_t> m_string_ends;
+        std::vector<std::vector<ComponentRecord>> m_components; // per component type
+        std::vector<std::vector<std::byte>> m_payloads;         // per component type
+        std::vector<PrefabRecord> m_prefabs;
+        std::vector<OverrideRecord> m_overrides;
+        std::vector<std::byte> m_override_payload;
+        std::vector<CellRecord> m_cells;
+
+        // derived
+        std::unordered_map<std::string, uint32_t> m_string_indices;
+        std::vector<uint32_t> m_parents;          // parent entity index, or none when the parent is outside of the file
+        std::vector<uint32_t> m_component_lookup; // entity index * component type count + type, to the component record
+    };
+}
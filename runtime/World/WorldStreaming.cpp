@@ -0,0 +1,162 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===========
+#include "pch.h"
+#include "WorldStreaming.h"
+//======================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    void WorldStreamingScheduler::SetCells(vector<WorldCell>&& cells)
+    {
+        m_cells           = move(cells);
+        m_resident_size   = 0;
+        m_loads_in_flight = 0;
+
+        for (const WorldCell& cell : m_cells)
+        {
+            if (cell.state != WorldCellState::Unloaded)
+            {
+                m_resident_size += cell.size;
+            }
+
+            if (cell.state == WorldCellState::Loading)
+            {
+                m_loads_in_flight++;
+            }
+        }
+    }
+
+    void WorldStreamingScheduler::Clear()
+    {
+        m_cells.clear();
+        m_resident_size   = 0;
+        m_loads_in_flight = 0;
+    }
+
+    void WorldStreamingScheduler::Update(const Vector3& position, vector<uint32_t>* cells_to_load, vector<uint32_t>* cells_to_unload)
+    {
+        SP_ASSERT(cells_to_load != nullptr && cells_to_unload != nullptr);
+        SP_ASSERT_MSG(m_settings.unload_distance >= m_settings.load_distance, "The unload distance can't be smaller than the load distance");
+
+        cells_to_load->clear();
+        cells_to_unload->clear();
+
+        vector<float> distances(m_cells.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_cells.size()); i++)
+        {
+            distances[i] = GetDistance(m_cells[i], position);
+        }
+
+        auto unload = [this, cells_to_unload](const uint32_t index)
+        {
+            m_cells[index].state  = WorldCellState::Unloaded;
+            m_resident_size      -= m_cells[index].size;
+            cells_to_unload->emplace_back(index);
+        };
+
+        // unload what's out of range, and keep the rest around in case a nearer cell needs the space
+        vector<uint32_t> candidates;
+        vector<uint32_t> evictable;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_cells.size()); i++)
+        {
+            const WorldCell& cell = m_cells[i];
+            if (cell.state == WorldCellState::Loaded)
+            {
+                if (distances[i] > m_settings.unload_distance)
+                {
+                    unload(i);
+                }
+                else
+                {
+                    evictable.emplace_back(i);
+                }
+            }
+            else if (cell.state == WorldCellState::Unloaded && distances[i] <= m_settings.load_distance)
+            {
+                candidates.emplace_back(i);
+            }
+        }
+
+        // nearest cells load first, furthest cells get evicted first
+        sort(candidates.begin(), candidates.end(), [&distances](uint32_t a, uint32_t b) { return distances[a] < distances[b]; });
+        sort(evictable.begin(), evictable.end(),   [&distances](uint32_t a, uint32_t b) { return distances[a] > distances[b]; });
+
+        size_t evict_index = 0;
+        for (const uint32_t index : candidates)
+        {
+            if (m_loads_in_flight >= m_settings.max_loads_in_flight)
+                break;
+
+            WorldCell& cell = m_cells[index];
+
+            // only make space with cells which are further away than the one that needs it
+            while (m_resident_size + cell.size > m_settings.memory_budget && evict_index < evictable.size() && distances[evictable[evict_index]] > distances[index])
+            {
+                unload(evictable[evict_index++]);
+            }
+
+            // a smaller cell further down the list might still fit
+            if (m_resident_size + cell.size > m_settings.memory_budget)
+                continue;
+
+            cell.state       = WorldCellState::Loading;
+            m_resident_size += cell.size;
+            m_loads_in_flight++;
+            cells_to_load->emplace_back(index);
+        }
+    }
+
+    void WorldStreamingScheduler::OnLoaded(const uint32_t cell_index)
+    {
+        SP_ASSERT(cell_index < m_cells.size());
+        SP_ASSERT(m_cells[cell_index].state == WorldCellState::Loading);
+
+        m_cells[cell_index].state = WorldCellState::Loaded;
+        m_loads_in_flight--;
+    }
+
+    void WorldStreamingScheduler::GetCellCoordinates(const Vector3& position, const float cell_size, int32_t* x, int32_t* z)
+    {
+        SP_ASSERT(cell_size > 0.0f);
+
+        *x = static_cast<int32_t>(floor(position.x / cell_size));
+        *z = static_cast<int32_t>(floor(position.z / cell_size));
+    }
+
+    float WorldStreamingScheduler::GetDistance(const WorldCell& cell, const Vector3& position) const
+    {
+        // on the horizontal plane, to the closest point of the cell's bounds
+        const Vector3& box_min = cell.bounds.GetMin();
+        const Vector3& box_max = cell.bounds.GetMax();
+        const float dx         = max(max(box_min.x - position.x, 0.0f), position.x - box_max.x);
+        const float dz         = max(max(box_min.z - position.z, 0.0f), position.z - box_max.z);
+
+        return sqrt(dx * dx + dz * dz);
+    }
+}
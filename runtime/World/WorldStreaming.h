@@ -0,0 +1,94 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==================
+#include "Definitions.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Vector3.h"
+#include <vector>
+//=============================
+
+namespace Spartan
+{
+    struct WorldStreamingSettings
+    {
+        bool partition_on_save       = false;          // save worlds as a persistent part plus cells which stream in and out
+        float cell_size              = 64.0f;          // in meters, along x and z
+        float load_distance          = 128.0f;         // cells closer than this to the camera get loaded
+        float unload_distance        = 192.0f;         // cells further than this get unloaded, the gap avoids thrashing at the edge
+        uint64_t memory_budget       = 1ull << 30;     // bytes of cell data which can be resident at once
+        uint32_t max_loads_in_flight = 2;
+    };
+
+    enum class WorldCellState : uint8_t
+    {
+        Unloaded,
+        Loading,
+        Loaded
+    };
+
+    struct WorldCell
+    {
+        int32_t x              = 0;
+        int32_t z              = 0;
+        Math::BoundingBox bounds;
+        uint64_t size          = 0; // estimated resident size in bytes
+        std::string file_path;
+        WorldCellState state   = WorldCellState::Unloaded;
+    };
+
+    // decides which cells should be resident around a position, it doesn't do any io or touch
+    // the renderer, so it can be driven by a scripted camera path without a device
+    class SP_CLASS WorldStreamingScheduler
+    {
+    public:
+        void SetSettings(const WorldStreamingSettings& settings) { m_settings = settings; }
+        const WorldStreamingSettings& GetSettings() const        { return m_settings; }
+
+        void SetCells(std::vector<WorldCell>&& cells);
+        std::vector<WorldCell>& GetCells() { return m_cells; }
+        void Clear();
+
+        // returns the cells to start loading (now marked as loading) and to unload (now marked as unloaded)
+        void Update(const Math::Vector3& position, std::vector<uint32_t>* cells_to_load, std::vector<uint32_t>* cells_to_unload);
+
+        // called once the loading of a cell has completed
+        void OnLoaded(const uint32_t cell_index);
+
+        // bytes of loaded and loading cells
+        uint64_t GetResidentSize() const { return m_resident_size; }
+        uint32_t GetLoadsInFlight() const { return m_loads_in_flight; }
+
+        // the cell a position falls into
+        static void GetCellCoordinates(const Math::Vector3& position, const float cell_size, int32_t* x, int32_t* z);
+
+    private:
+        float GetDistance(const WorldCell& cell, const Math::Vector3& position) const;
+
+        WorldStreamingSettings m_settings;
+        std::vector<WorldCell> m_cells;
+        uint64_t m_resident_size   = 0;
+        uint32_t m_loads_in_flight = 0;
+    };
+}
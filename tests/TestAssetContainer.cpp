@@ -0,0 +1,140 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "pch.h"
+#include "Tests.h"
+#include "IO/AssetContainer.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    struct Properties
+    {
+        uint32_t width  = 0;
+        uint32_t height = 0;
+        float scale     = 0.0f;
+    };
+
+    const uint32_t chunk_properties = asset_chunk_id("TPRP");
+    const uint32_t chunk_mip        = asset_chunk_id("TMIP");
+    const uint32_t chunk_source     = asset_chunk_id("TSRC");
+    const uint32_t chunk_empty      = asset_chunk_id("NONE");
+}
+
+SP_TEST(asset_container_round_trip)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_tests" / "asset_container").generic_string() + "/";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    const string file_path = directory + "texture.texture";
+
+    Properties properties = { 256, 128, 0.5f };
+    const string source   = "data/textures/brick.png";
+
+    // mips of odd sizes, so that the chunks after them need padding
+    vector<vector<uint8_t>> mips;
+    for (uint32_t level = 0; level < 4; level++)
+    {
+        vector<uint8_t> mip((1000 >> level) + 3);
+        for (size_t i = 0; i < mip.size(); i++)
+        {
+            mip[i] = static_cast<uint8_t>(i * 31 + level);
+        }
+        mips.push_back(move(mip));
+    }
+
+    // written out of order, the table of contents is sorted when opened
+    {
+        AssetContainerWriter writer;
+        for (uint32_t level = static_cast<uint32_t>(mips.size()); level-- > 0;)
+        {
+            writer.AddChunk(chunk_mip, level, mips[level]);
+        }
+        writer.AddChunk(chunk_source, 0, source);
+        writer.AddChunk(chunk_properties, 0, &properties, sizeof(properties));
+        writer.AddChunk(chunk_empty, 0, nullptr, 0);
+        SP_CHECK(writer.Write(file_path));
+    }
+
+    SP_CHECK(AssetContainer::IsContainer(file_path));
+
+    AssetContainer container;
+    SP_CHECK(container.Open(file_path));
+    SP_CHECK(container.IsOpen());
+    SP_CHECK(container.GetChunks().size() == mips.size() + 3);
+    SP_CHECK(container.GetChunkCount(chunk_mip) == mips.size());
+
+    // every chunk is aligned and reads back as written
+    for (const AssetChunk& chunk : container.GetChunks())
+    {
+        SP_CHECK(chunk.offset % AssetContainer::alignment == 0);
+    }
+
+    Properties properties_read;
+    SP_CHECK(container.ReadChunk(chunk_properties, 0, &properties_read));
+    SP_CHECK(properties_read.width == properties.width && properties_read.height == properties.height && properties_read.scale == properties.scale);
+
+    string source_read;
+    SP_CHECK(container.ReadChunk(chunk_source, 0, &source_read));
+    SP_CHECK(source_read == source);
+
+    for (uint32_t level = 0; level < static_cast<uint32_t>(mips.size()); level++)
+    {
+        uint64_t size = 0;
+        const std::byte* data = container.GetChunkData(chunk_mip, level, &size);
+        SP_CHECK(data != nullptr && size == mips[level].size());
+        SP_CHECK(data != nullptr && memcmp(data, mips[level].data(), mips[level].size()) == 0);
+    }
+
+    uint64_t size_empty = 1;
+    SP_CHECK(container.GetChunkData(chunk_empty, 0, &size_empty) != nullptr && size_empty == 0);
+
+    // what isn't there, or is read as the wrong type, fails
+    SP_CHECK(container.GetChunk(chunk_mip, static_cast<uint32_t>(mips.size())) == nullptr);
+    SP_CHECK(!container.ReadChunk(chunk_source, 0, &properties_read));
+    container.Close();
+    SP_CHECK(!container.IsOpen());
+
+    // a truncated file is rejected
+    {
+        const string file_path_truncated = directory + "truncated.texture";
+        filesystem::copy_file(file_path, file_path_truncated);
+        filesystem::resize_file(file_path_truncated, filesystem::file_size(file_path) - sizeof(AssetChunk));
+        SP_CHECK(!container.Open(file_path_truncated));
+        SP_CHECK(!container.IsOpen());
+    }
+
+    // and so is a foreign one
+    {
+        const string file_path_foreign = directory + "foreign.texture";
+        ofstream(file_path_foreign, ios::binary) << string(256, 'x');
+        SP_CHECK(!AssetContainer::IsContainer(file_path_foreign));
+        SP_CHECK(!container.Open(file_path_foreign));
+    }
+
+    filesystem::remove_all(directory);
+}
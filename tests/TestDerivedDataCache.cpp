@@ -0,0 +1,84 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES ===================
+#include "pch.h"
+#include "Tests.h"
+#include "Resource/DerivedDataCache.h"
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    void write_file(const string& file_path, const string& text)
+    {
+        ofstream file(file_path, ios::binary | ios::trunc);
+        file << text;
+    }
+}
+
+SP_TEST(derived_data_cache_dependencies)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_tests" / "derived_data").generic_string() + "/";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    DerivedDataCache::SetDirectory(directory);
+
+    // a model and the buffer it reads
+    const string file_path_model  = directory + "model.gltf";
+    const string file_path_buffer = directory + "model.bin";
+    write_file(file_path_model, "model");
+    write_file(file_path_buffer, "buffer");
+
+    const uint64_t key_source = DerivedDataCache::ComputeKey(file_path_model, 0, 1);
+    SP_CHECK(key_source != 0);
+
+    // nothing is recorded before the first import
+    vector<string> dependencies;
+    SP_CHECK(!DerivedDataCache::ReadDependencies(key_source, &dependencies));
+
+    DerivedDataCache::WriteDependencies(key_source, { file_path_buffer });
+    SP_CHECK(DerivedDataCache::ReadDependencies(key_source, &dependencies));
+    SP_CHECK(dependencies == vector<string>{ file_path_buffer });
+
+    const uint64_t key = DerivedDataCache::ComputeKey(key_source, dependencies);
+    SP_CHECK(key != 0 && key != key_source);
+    SP_CHECK(DerivedDataCache::ComputeKey(key_source, dependencies) == key);
+
+    // editing the buffer alone changes the key, while the model's own key stays the same
+    write_file(file_path_buffer, "buffer, edited");
+    filesystem::last_write_time(file_path_buffer, filesystem::last_write_time(file_path_buffer) + chrono::seconds(1));
+    SP_CHECK(DerivedDataCache::ComputeKey(file_path_model, 0, 1) == key_source);
+    SP_CHECK(DerivedDataCache::ComputeKey(key_source, dependencies) != key);
+
+    // and so does losing it
+    filesystem::remove(file_path_buffer);
+    SP_CHECK(DerivedDataCache::ComputeKey(key_source, dependencies) != key);
+
+    filesystem::remove_all(directory);
+}
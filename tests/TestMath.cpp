@@ -0,0 +1,260 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES ==========
+#include "pch.h"
+#include "Tests.h"
+#include "Math/Simd.h"
+//=====================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+// the simd backend against per lane scalar math, the matrix and quaternion math on top of it against the textbook formulas
+namespace
+{
+    const float tolerance = 1e-5f;
+
+    mt19937& random_engine()
+    {
+        static mt19937 engine(1337);
+        return engine;
+    }
+
+    float random_float(const float min = -10.0f, const float max = 10.0f)
+    {
+        return uniform_real_distribution<float>(min, max)(random_engine());
+    }
+
+    Matrix random_matrix()
+    {
+        Matrix matrix;
+        float* data = &matrix.m00;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            data[i] = random_float();
+        }
+
+        return matrix;
+    }
+
+    Matrix random_transform()
+    {
+        const Quaternion rotation = Quaternion::FromEulerAngles(random_float(-180.0f, 180.0f), random_float(-180.0f, 180.0f), random_float(-180.0f, 180.0f));
+        return Matrix(Vector3(random_float(), random_float(), random_float()), rotation, Vector3(random_float(0.1f, 4.0f), random_float(0.1f, 4.0f), random_float(0.1f, 4.0f)));
+    }
+
+    // element at row, column, the memory layout is column major
+    float at(const Matrix& matrix, const uint32_t row, const uint32_t column)
+    {
+        return matrix.Data()[column * 4 + row];
+    }
+
+    // vectors are rows, so a vector times a matrix is a linear combination of the rows
+    void transform_reference(const Matrix& matrix, const float* vector, float* result)
+    {
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            result[column] = 0.0f;
+            for (uint32_t row = 0; row < 4; row++)
+            {
+                result[column] += vector[row] * at(matrix, row, column);
+            }
+        }
+    }
+
+    bool lanes_equal(const Simd::vec4 v, const float x, const float y, const float z, const float w)
+    {
+        float lanes[4];
+        Simd::store(lanes, v);
+        return lanes[0] == x && lanes[1] == y && lanes[2] == z && lanes[3] == w;
+    }
+}
+
+SP_TEST(simd_lanes)
+{
+    const float a[4] = { 1.5f, -2.0f, 3.25f, -4.75f };
+    const float b[4] = { -0.5f, 8.0f, 3.25f, 2.0f };
+    const Simd::vec4 va = Simd::load(a);
+    const Simd::vec4 vb = Simd::load(b);
+
+    SP_CHECK(lanes_equal(va, a[0], a[1], a[2], a[3]));
+    SP_CHECK(lanes_equal(Simd::load3(a, 7.0f), a[0], a[1], a[2], 7.0f));
+    SP_CHECK(lanes_equal(Simd::set(a[0], a[1], a[2], a[3]), a[0], a[1], a[2], a[3]));
+    SP_CHECK(lanes_equal(Simd::splat(a[2]), a[2], a[2], a[2], a[2]));
+    SP_CHECK(lanes_equal(Simd::splat_lane<1>(va), a[1], a[1], a[1], a[1]));
+    SP_CHECK(lanes_equal(Simd::splat_lane<3>(va), a[3], a[3], a[3], a[3]));
+    SP_CHECK(Simd::get_lane<0>(va) == a[0] && Simd::get_lane<3>(va) == a[3]);
+    SP_CHECK(lanes_equal(Simd::swizzle<3, 2, 1, 0>(va), a[3], a[2], a[1], a[0]));
+    SP_CHECK(lanes_equal(Simd::swizzle<1, 0, 3, 2>(va), a[1], a[0], a[3], a[2]));
+
+    SP_CHECK(lanes_equal(Simd::add(va, vb), a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3]));
+    SP_CHECK(lanes_equal(Simd::sub(va, vb), a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3]));
+    SP_CHECK(lanes_equal(Simd::mul(va, vb), a[0] * b[0], a[1] * b[1], a[2] * b[2], a[3] * b[3]));
+    SP_CHECK(lanes_equal(Simd::div(va, vb), a[0] / b[0], a[1] / b[1], a[2] / b[2], a[3] / b[3]));
+    SP_CHECK(lanes_equal(Simd::min(va, vb), min(a[0], b[0]), min(a[1], b[1]), min(a[2], b[2]), min(a[3], b[3])));
+    SP_CHECK(lanes_equal(Simd::max(va, vb), max(a[0], b[0]), max(a[1], b[1]), max(a[2], b[2]), max(a[3], b[3])));
+    SP_CHECK(lanes_equal(Simd::abs(va), fabs(a[0]), fabs(a[1]), fabs(a[2]), fabs(a[3])));
+
+    // these inputs are exact in float, so a fused multiply-add rounds the same as a separate one
+    SP_CHECK(lanes_equal(Simd::madd(va, vb, va), a[0] * b[0] + a[0], a[1] * b[1] + a[1], a[2] * b[2] + a[2], a[3] * b[3] + a[3]));
+
+    // lane i of the mask is set if a >= b
+    SP_CHECK(Simd::move_mask(Simd::greater_equal(va, vb)) == 0b0101);
+    SP_CHECK(Simd::move_mask(Simd::bit_and(Simd::greater_equal(va, vb), Simd::greater_equal(vb, va))) == 0b0100);
+
+    const float m[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    Simd::vec4 r0 = Simd::load(m + 0);
+    Simd::vec4 r1 = Simd::load(m + 4);
+    Simd::vec4 r2 = Simd::load(m + 8);
+    Simd::vec4 r3 = Simd::load(m + 12);
+    Simd::transpose(r0, r1, r2, r3);
+    SP_CHECK(lanes_equal(r0, 0, 4, 8, 12));
+    SP_CHECK(lanes_equal(r1, 1, 5, 9, 13));
+    SP_CHECK(lanes_equal(r2, 2, 6, 10, 14));
+    SP_CHECK(lanes_equal(r3, 3, 7, 11, 15));
+}
+
+SP_TEST(matrix_multiply)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const Matrix a      = random_matrix();
+        const Matrix b      = random_matrix();
+        const Matrix result = a * b;
+
+        for (uint32_t row = 0; row < 4; row++)
+        {
+            for (uint32_t column = 0; column < 4; column++)
+            {
+                float expected = 0.0f;
+                for (uint32_t k = 0; k < 4; k++)
+                {
+                    expected += at(a, row, k) * at(b, k, column);
+                }
+
+                SP_CHECK(Tests::near(at(result, row, column), expected, tolerance * 10.0f));
+            }
+        }
+    }
+}
+
+SP_TEST(matrix_transform)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const Matrix matrix = random_transform();
+        const Vector4 v4    = Vector4(random_float(), random_float(), random_float(), random_float());
+        const Vector3 v3    = Vector3(v4.x, v4.y, v4.z);
+
+        const float point[4]     = { v3.x, v3.y, v3.z, 1.0f };
+        const float direction[4] = { v3.x, v3.y, v3.z, 0.0f };
+        const float vector[4]    = { v4.x, v4.y, v4.z, v4.w };
+        float point_expected[4];
+        float direction_expected[4];
+        float vector_expected[4];
+        transform_reference(matrix, point, point_expected);
+        transform_reference(matrix, direction, direction_expected);
+        transform_reference(matrix, vector, vector_expected);
+
+        const Vector3 point_result     = matrix.TransformPoint(v3);
+        const Vector3 direction_result = matrix.TransformDirection(v3);
+        const Vector3 point_divided    = matrix * v3;
+        const Vector4 vector_result    = matrix * v4;
+        SP_CHECK(Tests::near(point_result.x, point_expected[0], tolerance) && Tests::near(point_result.y, point_expected[1], tolerance) && Tests::near(point_result.z, point_expected[2], tolerance));
+        SP_CHECK(Tests::near(point_divided.x, point_expected[0], tolerance) && Tests::near(point_divided.y, point_expected[1], tolerance) && Tests::near(point_divided.z, point_expected[2], tolerance));
+        SP_CHECK(Tests::near(direction_result.x, direction_expected[0], tolerance) && Tests::near(direction_result.y, direction_expected[1], tolerance) && Tests::near(direction_result.z, direction_expected[2], tolerance));
+        SP_CHECK(Tests::near(vector_result.x, vector_expected[0], tolerance) && Tests::near(vector_result.y, vector_expected[1], tolerance) && Tests::near(vector_result.z, vector_expected[2], tolerance) && Tests::near(vector_result.w, vector_expected[3], tolerance));
+    }
+
+    // a projection has a w other than one, so the point gets divided by it
+    const Matrix projection = Matrix::CreatePerspectiveFieldOfViewLH(1.0f, 1.5f, 0.1f, 100.0f);
+    const float point[4]    = { 1.0f, 2.0f, 10.0f, 1.0f };
+    float expected[4];
+    transform_reference(projection, point, expected);
+    const Vector3 result = projection * Vector3(point[0], point[1], point[2]);
+    SP_CHECK(Tests::near(result.x, expected[0] / expected[3], tolerance) && Tests::near(result.y, expected[1] / expected[3], tolerance) && Tests::near(result.z, expected[2] / expected[3], tolerance));
+}
+
+SP_TEST(matrix_invert)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const Matrix matrix   = random_transform();
+        const Matrix inverse  = matrix.Inverted();
+        const Matrix scalar   = Matrix::InvertScalar(matrix);
+        const Matrix identity = matrix * inverse;
+
+        for (uint32_t j = 0; j < 16; j++)
+        {
+            SP_CHECK(Tests::near(inverse.Data()[j], scalar.Data()[j], tolerance * 10.0f));
+            SP_CHECK(fabs(identity.Data()[j] - Matrix::Identity.Data()[j]) < tolerance * 100.0f);
+        }
+    }
+}
+
+SP_TEST(quaternion_multiply)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const Quaternion a = Quaternion(random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f));
+        const Quaternion b = Quaternion(random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f));
+        const Quaternion result = a * b;
+
+        // hamilton product
+        const float x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+        const float y = a.w * b.y + a.y * b.w + a.z * b.x - a.x * b.z;
+        const float z = a.w * b.z + a.z * b.w + a.x * b.y - a.y * b.x;
+        const float w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+        SP_CHECK(Tests::near(result.x, x, tolerance) && Tests::near(result.y, y, tolerance) && Tests::near(result.z, z, tolerance) && Tests::near(result.w, w, tolerance));
+    }
+}
+
+SP_TEST(bounding_box_transform)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const Vector3 min        = Vector3(random_float(), random_float(), random_float());
+        const Vector3 max        = min + Vector3(random_float(0.1f, 5.0f), random_float(0.1f, 5.0f), random_float(0.1f, 5.0f));
+        const Matrix transform   = random_transform();
+        const BoundingBox result = BoundingBox(min, max).Transform(transform);
+
+        // the bounds of the eight transformed corners
+        Vector3 corners[8];
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            const float point[4] = { (corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z, 1.0f };
+            float transformed[4];
+            transform_reference(transform, point, transformed);
+            corners[corner] = Vector3(transformed[0], transformed[1], transformed[2]);
+        }
+        const BoundingBox expected = BoundingBox(corners, 8);
+        const float tolerance_box  = tolerance * 10.0f;
+
+        SP_CHECK(Tests::near(result.GetMin().x, expected.GetMin().x, tolerance_box) && Tests::near(result.GetMin().y, expected.GetMin().y, tolerance_box) && Tests::near(result.GetMin().z, expected.GetMin().z, tolerance_box));
+        SP_CHECK(Tests::near(result.GetMax().x, expected.GetMax().x, tolerance_box) && Tests::near(result.GetMax().y, expected.GetMax().y, tolerance_box) && Tests::near(result.GetMax().z, expected.GetMax().z, tolerance_box));
+    }
+}
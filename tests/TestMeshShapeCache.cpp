@@ -0,0 +1,104 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES ====================================================================
+#include "pch.h"
+#include "Tests.h"
+#include "Physics/MeshShapeCache.h"
+#include "Rendering/Mesh.h"
+SP_WARNINGS_OFF
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+SP_WARNINGS_ON
+//===============================================================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    struct TriangleGatherer : public btTriangleCallback
+    {
+        void processTriangle(btVector3* triangle, int, int) override
+        {
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                corners.emplace_back(triangle[i].x(), triangle[i].y(), triangle[i].z());
+            }
+        }
+
+        vector<Vector3> corners;
+    };
+
+    // what the shape collides with, read through the arrays it references
+    vector<Vector3> gather_triangles(btCollisionShape* shape)
+    {
+        TriangleGatherer gatherer;
+        const btVector3 extent(1000.0f, 1000.0f, 1000.0f);
+        static_cast<btScaledBvhTriangleMeshShape*>(shape)->processAllTriangles(&gatherer, -extent, extent);
+        return gatherer.corners;
+    }
+
+    void add_quad(Mesh* mesh, const float height)
+    {
+        const vector<RHI_Vertex_PosTexNorTan> vertices =
+        {
+            RHI_Vertex_PosTexNorTan(Vector3(0.0f, height, 0.0f), Vector2::Zero),
+            RHI_Vertex_PosTexNorTan(Vector3(1.0f, height, 0.0f), Vector2::Zero),
+            RHI_Vertex_PosTexNorTan(Vector3(0.0f, height, 1.0f), Vector2::Zero),
+            RHI_Vertex_PosTexNorTan(Vector3(1.0f, height, 1.0f), Vector2::Zero)
+        };
+
+        mesh->AddVertices(vertices);
+        mesh->AddIndices({ 0, 2, 1, 1, 2, 3 });
+    }
+}
+
+SP_TEST(mesh_shape_cache_invalidate)
+{
+    unique_ptr<Mesh> mesh = make_unique<Mesh>();
+    add_quad(mesh.get(), 0.0f);
+
+    btCollisionShape* shape = MeshShapeCache::Acquire(mesh.get(), 0, 6, 0, 4, Vector3::One, MeshShapeType::Triangles);
+    SP_CHECK(shape != nullptr);
+    SP_CHECK(MeshShapeCache::Acquire(mesh.get(), 0, 6, 0, 4, Vector3::One, MeshShapeType::Triangles) == shape);
+    const vector<Vector3> triangles = gather_triangles(shape);
+    SP_CHECK(triangles.size() == 6);
+
+    // growing the mesh can move its arrays, the next acquire builds a new shape
+    add_quad(mesh.get(), 1.0f);
+    btCollisionShape* shape_rebuilt = MeshShapeCache::Acquire(mesh.get(), 0, 6, 0, 4, Vector3::One, MeshShapeType::Triangles);
+    SP_CHECK(shape_rebuilt != nullptr && shape_rebuilt != shape);
+
+    // while the bodies which hold the old one keep colliding with the geometry it was built from, even once the mesh is gone
+    mesh = nullptr;
+    SP_CHECK(gather_triangles(shape) == triangles);
+
+    SP_CHECK(MeshShapeCache::Release(shape));
+    SP_CHECK(MeshShapeCache::Release(shape));
+    SP_CHECK(MeshShapeCache::Release(shape_rebuilt));
+    SP_CHECK(MeshShapeCache::GetMemoryUsage() == 0);
+}
@@ -0,0 +1,172 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================================
+#include "pch.h"
+#include "Tests.h"
+#include "Resource/Import/MipGenerator.h"
+//============================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    const uint32_t image_size = 256;
+    const uint32_t channels   = 4;
+
+    // smooth color gradients with a soft alpha, close to what a photo looks like at this scale
+    vector<std::byte> create_image()
+    {
+        vector<std::byte> image(image_size * image_size * channels);
+        for (uint32_t y = 0; y < image_size; y++)
+        {
+            for (uint32_t x = 0; x < image_size; x++)
+            {
+                const float u = static_cast<float>(x) / image_size;
+                const float v = static_cast<float>(y) / image_size;
+                const float values[channels] =
+                {
+                    0.5f + 0.5f * sinf(u * 6.0f),
+                    0.5f + 0.5f * cosf(v * 5.0f),
+                    0.5f + 0.5f * sinf((u + v) * 4.0f),
+                    u * v
+                };
+
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    image[(y * image_size + x) * channels + c] = static_cast<std::byte>(lroundf(values[c] * 255.0f));
+                }
+            }
+        }
+
+        return image;
+    }
+
+    // each texel of a mip is the average of the top mip texels it covers, computed directly instead of through the chain
+    vector<std::byte> create_reference(const vector<std::byte>& image, const uint32_t mip_index)
+    {
+        const uint32_t footprint = 1u << mip_index;
+        const uint32_t mip_size  = image_size >> mip_index;
+
+        vector<std::byte> mip(mip_size * mip_size * channels);
+        for (uint32_t y = 0; y < mip_size; y++)
+        {
+            for (uint32_t x = 0; x < mip_size; x++)
+            {
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    double sum = 0.0;
+                    for (uint32_t j = 0; j < footprint; j++)
+                    {
+                        for (uint32_t i = 0; i < footprint; i++)
+                        {
+                            sum += static_cast<double>(image[((y * footprint + j) * image_size + x * footprint + i) * channels + c]);
+                        }
+                    }
+
+                    mip[(y * mip_size + x) * channels + c] = static_cast<std::byte>(lround(sum / (footprint * footprint)));
+                }
+            }
+        }
+
+        return mip;
+    }
+
+    float compute_psnr(const vector<std::byte>& a, const vector<std::byte>& b, const uint32_t mip_index)
+    {
+        return MipGenerator::ComputePsnr(a.data(), b.data(), image_size >> mip_index, image_size >> mip_index, channels, 8);
+    }
+}
+
+SP_TEST(mip_generator_psnr)
+{
+    // a known error, every value off by 0.2 is 10 * log10(1 / 0.04)
+    {
+        const vector<std::byte> a(16, std::byte{ 0 });
+        const vector<std::byte> b(16, std::byte{ 51 });
+        SP_CHECK(Tests::near(MipGenerator::ComputePsnr(a.data(), b.data(), 2, 2, 4, 8), 13.979f, 0.001f));
+        SP_CHECK(isinf(MipGenerator::ComputePsnr(a.data(), a.data(), 2, 2, 4, 8)));
+    }
+
+    const vector<std::byte> image = create_image();
+    const uint32_t mip_count      = 6;
+
+    vector<vector<std::byte>> references;
+    for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+    {
+        references.push_back(create_reference(image, mip_index));
+    }
+
+    // the box chain matches the direct average up to rounding, the wider kernels stay close to it on smooth content
+    const pair<MipFilter, float> filters[] =
+    {
+        { MipFilter::Box,     60.0f },
+        { MipFilter::Kaiser,  40.0f },
+        { MipFilter::Lanczos, 40.0f }
+    };
+
+    for (const auto& [filter, psnr_min] : filters)
+    {
+        MipSettings settings;
+        settings.filter = filter;
+
+        vector<vector<std::byte>> mips;
+        MipGenerator::Generate(image.data(), image_size, image_size, image_size * channels, channels, 8, mip_count, settings, &mips);
+        SP_CHECK(mips.size() == mip_count);
+        SP_CHECK(mips[0] == image);
+
+        for (uint32_t mip_index = 1; mip_index < mip_count; mip_index++)
+        {
+            SP_CHECK(mips[mip_index].size() == references[mip_index].size());
+            SP_CHECK(compute_psnr(mips[mip_index], references[mip_index], mip_index) >= psnr_min);
+        }
+    }
+}
+
+SP_TEST(mip_generator_srgb)
+{
+    // a black and white checkerboard is half as bright once averaged in linear space, which is 188 in srgb, not 128
+    vector<std::byte> image(4 * 4 * channels);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        const std::byte value = ((i % 4 + i / 4) % 2) ? std::byte{ 255 } : std::byte{ 0 };
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            image[i * channels + c] = value;
+        }
+        image[i * channels + 3] = std::byte{ 255 };
+    }
+
+    MipSettings settings;
+    settings.filter = MipFilter::Box;
+    settings.srgb   = true;
+
+    vector<vector<std::byte>> mips;
+    MipGenerator::Generate(image.data(), 4, 4, 4 * channels, channels, 8, 2, settings, &mips);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        SP_CHECK(abs(static_cast<int>(mips[1][i * channels + 0]) - 188) <= 1);
+        SP_CHECK(static_cast<int>(mips[1][i * channels + 3]) == 255);
+    }
+}
@@ -0,0 +1,180 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "pch.h"
+#include "Tests.h"
+#include "Resource/DerivedDataCache.h"
+#include "Resource/Import/ModelImporter.h"
+//==============================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace
+{
+    const uint32_t texture_count  = 4;
+    const uint32_t material_count = 8; // more materials than textures, so that textures are shared
+
+    template<typename T>
+    void write(ofstream& file, const T value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // a 4x4, 24 bit bmp in a single color
+    void write_bmp(const string& file_path, const uint8_t r, const uint8_t g, const uint8_t b)
+    {
+        const uint32_t size_pixels = 4 * 4 * 3;
+
+        ofstream file(file_path, ios::binary | ios::trunc);
+        file.write("BM", 2);
+        write<uint32_t>(file, 54 + size_pixels); // file size
+        write<uint32_t>(file, 0);                // reserved
+        write<uint32_t>(file, 54);               // pixel offset
+        write<uint32_t>(file, 40);               // info header size
+        write<int32_t>(file, 4);                 // width
+        write<int32_t>(file, 4);                 // height
+        write<uint16_t>(file, 1);                // planes
+        write<uint16_t>(file, 24);               // bits per pixel
+        write<uint32_t>(file, 0);                // no compression
+        write<uint32_t>(file, size_pixels);
+        write<int32_t>(file, 2835);              // 72 dpi
+        write<int32_t>(file, 2835);
+        write<uint32_t>(file, 0);                // palette
+        write<uint32_t>(file, 0);
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            write<uint8_t>(file, b);
+            write<uint8_t>(file, g);
+            write<uint8_t>(file, r);
+        }
+    }
+
+    // one triangle per material, every material samples one of the textures, the geometry lives in an external buffer
+    void write_gltf(const string& directory)
+    {
+        const float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+        const float uvs[]       = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f };
+        {
+            ofstream file(directory + "model.bin", ios::binary | ios::trunc);
+            file.write(reinterpret_cast<const char*>(positions), sizeof(positions));
+            file.write(reinterpret_cast<const char*>(uvs), sizeof(uvs));
+        }
+
+        string images;
+        string textures;
+        for (uint32_t i = 0; i < texture_count; i++)
+        {
+            const string name = "texture_" + to_string(i) + ".bmp";
+            write_bmp(directory + name, static_cast<uint8_t>(i * 60), 128, static_cast<uint8_t>(255 - i * 60));
+
+            images   += (i ? "," : "") + string("{ \"uri\": \"") + name + "\" }";
+            textures += (i ? "," : "") + string("{ \"source\": ") + to_string(i) + " }";
+        }
+
+        string materials;
+        string meshes;
+        string nodes;
+        string node_indices;
+        for (uint32_t i = 0; i < material_count; i++)
+        {
+            const string index = to_string(i);
+            materials    += (i ? "," : "") + string("{ \"name\": \"material_") + index + "\", \"pbrMetallicRoughness\": { \"baseColorTexture\": { \"index\": " + to_string(i % texture_count) + " } } }";
+            meshes       += (i ? "," : "") + string("{ \"primitives\": [ { \"attributes\": { \"POSITION\": 0, \"TEXCOORD_0\": 1 }, \"material\": ") + index + " } ] }";
+            nodes        += (i ? "," : "") + string("{ \"mesh\": ") + index + ", \"translation\": [ " + to_string(i * 2) + ", 0, 0 ] }";
+            node_indices += (i ? "," : "") + index;
+        }
+
+        ofstream file(directory + "model.gltf", ios::trunc);
+        file << "{\n"
+             << "  \"asset\": { \"version\": \"2.0\" },\n"
+             << "  \"scene\": 0,\n"
+             << "  \"scenes\": [ { \"nodes\": [ " << node_indices << " ] } ],\n"
+             << "  \"nodes\": [ " << nodes << " ],\n"
+             << "  \"meshes\": [ " << meshes << " ],\n"
+             << "  \"materials\": [ " << materials << " ],\n"
+             << "  \"textures\": [ " << textures << " ],\n"
+             << "  \"images\": [ " << images << " ],\n"
+             << "  \"buffers\": [ { \"uri\": \"model.bin\", \"byteLength\": " << sizeof(positions) + sizeof(uvs) << " } ],\n"
+             << "  \"bufferViews\": [ { \"buffer\": 0, \"byteOffset\": 0, \"byteLength\": " << sizeof(positions) << " },"
+             << " { \"buffer\": 0, \"byteOffset\": " << sizeof(positions) << ", \"byteLength\": " << sizeof(uvs) << " } ],\n"
+             << "  \"accessors\": [ { \"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"min\": [ 0, 0, 0 ], \"max\": [ 1, 1, 0 ] },"
+             << " { \"bufferView\": 1, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC2\" } ]\n"
+             << "}\n";
+    }
+
+    uint32_t count_files(const string& directory, const string& extension)
+    {
+        uint32_t count = 0;
+        for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directory))
+        {
+            count += entry.path().extension() == extension ? 1 : 0;
+        }
+
+        return count;
+    }
+}
+
+SP_TEST(model_importer_concurrent_textures)
+{
+    const string directory       = (filesystem::temp_directory_path() / "spartan_tests" / "model_importer").generic_string() + "/";
+    const string directory_cache = directory + "derived/";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory_cache);
+    DerivedDataCache::SetDirectory(directory_cache);
+
+    write_gltf(directory);
+
+    // the textures cook on the thread pool, each one once no matter how many materials share it
+    vector<string> texture_file_paths;
+    SP_CHECK(ModelImporter::Cook(directory + "model.gltf", 0, &texture_file_paths));
+    SP_CHECK(texture_file_paths.size() == texture_count);
+    SP_CHECK(set<string>(texture_file_paths.begin(), texture_file_paths.end()).size() == texture_count);
+    SP_CHECK(count_files(directory_cache, EXTENSION_TEXTURE) == texture_count);
+
+    // the buffer is recorded as something the model depends on
+    SP_CHECK(count_files(directory_cache, ".dependencies") == 1);
+
+    // a second import finds everything in the cache
+    texture_file_paths.clear();
+    SP_CHECK(ModelImporter::Cook(directory + "model.gltf", 0, &texture_file_paths));
+    SP_CHECK(texture_file_paths.size() == texture_count);
+    SP_CHECK(count_files(directory_cache, EXTENSION_TEXTURE) == texture_count);
+
+    // and so do several running at the same time
+    atomic<uint32_t> failures = 0;
+    vector<thread> threads;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&directory, &failures]() { failures += ModelImporter::Cook(directory + "model.gltf", 0) ? 0 : 1; });
+    }
+    for (thread& thread : threads)
+    {
+        thread.join();
+    }
+    SP_CHECK(failures == 0);
+    SP_CHECK(count_files(directory_cache, EXTENSION_TEXTURE) == texture_count);
+
+    filesystem::remove_all(directory);
+}
@@ -0,0 +1,294 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES =============================
+#include "pch.h"
+#include "Tests.h"
+#include "Physics/Physics.h"
+#include "Physics/ConvexDecomposition.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Components/PhysicsBody.h"
+//========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const float step_rate = 60.0f;
+
+    // the world owns the entity, holding on to a shared pointer would keep the body simulating past World::New()
+    PhysicsBody* create_body(const Vector3& position, const Quaternion& rotation, const Vector3& scale, const PhysicsShape shape, const float mass)
+    {
+        // the shape is sized by the scale of the entity, so the transform goes first
+        shared_ptr<Entity> entity = World::CreateEntity();
+        entity->SetPosition(position);
+        entity->SetRotation(rotation);
+        entity->SetScale(scale);
+
+        PhysicsBody* body = entity->AddComponent<PhysicsBody>().get();
+        body->SetShapeType(shape);
+        body->SetMass(mass);
+
+        return body;
+    }
+
+    vector<float> capture_state(const vector<PhysicsBody*>& bodies)
+    {
+        vector<float> state;
+        for (const PhysicsBody* body : bodies)
+        {
+            const Vector3 position    = body->GetPosition();
+            const Quaternion rotation = body->GetRotation();
+            const Vector3 velocity    = body->GetLinearVelocity();
+            state.insert(state.end(), { position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, velocity.x, velocity.y, velocity.z });
+        }
+
+        return state;
+    }
+
+    // a pile of boxes with a ball about to knock it over
+    vector<PhysicsBody*> create_pile()
+    {
+        World::New();
+        Physics::SetStepRate(step_rate);
+
+        vector<PhysicsBody*> bodies;
+        bodies.emplace_back(create_body(Vector3(0.0f, -0.5f, 0.0f), Quaternion::Identity, Vector3(50.0f, 1.0f, 50.0f), PhysicsShape::Box, 0.0f));
+        for (uint32_t i = 0; i < 30; i++)
+        {
+            const Vector3 position    = Vector3(static_cast<float>(i % 3) * 1.1f, 0.5f + static_cast<float>(i / 3) * 1.05f, static_cast<float>(i % 2) * 0.2f);
+            const Quaternion rotation = Quaternion::FromEulerAngles(0.0f, static_cast<float>(i) * 7.0f, 0.0f);
+            bodies.emplace_back(create_body(position, rotation, Vector3::One, PhysicsShape::Box, 1.0f));
+        }
+
+        PhysicsBody* ball = create_body(Vector3(1.1f, 3.0f, -10.0f), Quaternion::Identity, Vector3(0.5f), PhysicsShape::Sphere, 5.0f);
+        ball->SetLinearVelocity(Vector3(0.0f, 0.0f, 30.0f));
+        ball->SetAngularVelocity(Vector3(5.0f, 0.0f, 0.0f));
+        bodies.emplace_back(ball);
+
+        return bodies;
+    }
+
+    // records the pile as it's knocked over, a frame per step count, returns every pose and velocity at the end
+    vector<float> record_pile(const string& recording_file_path, const vector<PhysicsBody*>& bodies)
+    {
+        // recording is what makes the stepping deterministic
+        Physics::Record(recording_file_path);
+        for (uint32_t frame = 0; frame < 90; frame++)
+        {
+            Physics::Step(frame % 3);
+        }
+        Physics::StopPlayback();
+
+        return capture_state(bodies);
+    }
+
+    bool states_equal(const vector<float>& a, const vector<float>& b)
+    {
+        // bit for bit, a replay can't tolerate any difference since it grows every step
+        return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+
+    // a small ball fired at a thin wall, fast enough to cross it in less than a step, returns true if it ends up behind it
+    bool fire_through_wall(const bool ccd)
+    {
+        World::New();
+        Physics::SetStepRate(step_rate);
+
+        create_body(Vector3::Zero, Quaternion::Identity, Vector3(10.0f, 10.0f, 0.1f), PhysicsShape::Box, 0.0f);
+
+        PhysicsBody* ball = create_body(Vector3(0.0f, 0.0f, -3.0f), Quaternion::Identity, Vector3(0.1f), PhysicsShape::Sphere, 1.0f);
+        ball->SetUseGravity(false);
+        ball->SetCcd(ccd);
+        ball->SetLinearVelocity(Vector3(0.0f, 0.0f, 400.0f));
+
+        Physics::Step(static_cast<uint32_t>(step_rate));
+        const bool through = ball->GetPosition().z > 0.0f;
+
+        World::New();
+
+        return through;
+    }
+
+    struct MeshData
+    {
+        vector<float> positions;
+        vector<uint32_t> indices;
+    };
+
+    // a closed box, boxes which only touch add up to a closed mesh with the volume of their union
+    void add_box(MeshData* mesh, const Vector3& min, const Vector3& max)
+    {
+        const uint32_t index_start = static_cast<uint32_t>(mesh->positions.size() / 3);
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            mesh->positions.insert(mesh->positions.end(), { (corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z });
+        }
+
+        static const uint32_t faces[36] =
+        {
+            0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6,
+            0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7,
+            0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5
+        };
+        for (uint32_t index : faces)
+        {
+            mesh->indices.emplace_back(index_start + index);
+        }
+    }
+
+    float decomposed_volume(const MeshData& mesh, uint32_t* hull_count)
+    {
+        const uint32_t stride = sizeof(float) * 3;
+        const vector<vector<Vector3>> hulls = ConvexDecomposition::Compute(mesh.positions.data(), stride, static_cast<uint32_t>(mesh.positions.size() / 3), mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()));
+
+        float volume = 0.0f;
+        for (const vector<Vector3>& hull : hulls)
+        {
+            volume += ConvexDecomposition::ComputeHullVolume(hull);
+        }
+        *hull_count = static_cast<uint32_t>(hulls.size());
+
+        return volume;
+    }
+}
+
+SP_TEST(physics_pose_interpolation)
+{
+    World::New();
+    Physics::SetStepRate(step_rate);
+
+    // a falling box, the entity shows a blend of the last two steps while the body holds the latest one
+    PhysicsBody* body = create_body(Vector3(0.0f, 10.0f, 0.0f), Quaternion::Identity, Vector3::One, PhysicsShape::Box, 1.0f);
+    Physics::Step(2);
+    const float height_current = body->GetPosition().y;
+
+    body->ApplySimulatedPose(0.0f);
+    const float height_previous = body->GetEntity()->GetPosition().y;
+    SP_CHECK(height_previous > height_current);
+
+    body->ApplySimulatedPose(0.5f);
+    SP_CHECK(Tests::near(body->GetEntity()->GetPosition().y, (height_previous + height_current) * 0.5f, 1e-5f));
+
+    body->ApplySimulatedPose(1.0f);
+    SP_CHECK(Tests::near(body->GetEntity()->GetPosition().y, height_current, 1e-5f));
+
+    World::New();
+}
+
+SP_TEST(physics_deterministic_step)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_tests").generic_string() + "/";
+    FileSystem::CreateDirectory(directory);
+
+    vector<PhysicsBody*> bodies = create_pile();
+    const vector<float> state_start        = capture_state(bodies);
+    const vector<float> state_a            = record_pile(directory + "a.physics", bodies);
+
+    bodies                      = create_pile();
+    const vector<float> state_b = record_pile(directory + "b.physics", bodies);
+    SP_CHECK(states_equal(state_a, state_b));
+
+    // and something did happen, the positions are the first three floats of each body
+    bool moved = false;
+    for (size_t i = 0; i < state_a.size() && i < state_start.size(); i += 10)
+    {
+        moved |= (Vector3(state_a[i], state_a[i + 1], state_a[i + 2]) - Vector3(state_start[i], state_start[i + 1], state_start[i + 2])).Length() > 0.1f;
+    }
+    SP_CHECK(moved);
+
+    World::New();
+    FileSystem::Delete(directory);
+}
+
+SP_TEST(physics_record_and_replay)
+{
+    const string directory = (filesystem::temp_directory_path() / "spartan_tests").generic_string() + "/";
+    FileSystem::CreateDirectory(directory);
+    const string file_path = directory + "replay.physics";
+
+    vector<PhysicsBody*> bodies = create_pile();
+    const vector<float> state_recorded     = record_pile(file_path, bodies);
+
+    // the same world replays bit exact, every frame's state hash matches the recorded one
+    bodies = create_pile();
+    SP_CHECK(Physics::ReplayHeadless(file_path));
+    SP_CHECK(Physics::GetPlayback() == PhysicsPlayback::Off);
+    SP_CHECK(states_equal(capture_state(bodies), state_recorded));
+
+    // a different one doesn't
+    bodies = create_pile();
+    bodies.back()->SetLinearVelocity(Vector3(0.0f, 0.0f, 20.0f));
+    SP_CHECK(!Physics::ReplayHeadless(file_path));
+
+    World::New();
+    FileSystem::Delete(directory);
+}
+
+SP_TEST(physics_convex_decomposition_volume)
+{
+    // a cube is already convex, it stays a single hull
+    {
+        MeshData cube;
+        add_box(&cube, Vector3::Zero, Vector3::One);
+
+        uint32_t hull_count = 0;
+        const float volume  = decomposed_volume(cube, &hull_count);
+        SP_CHECK(hull_count == 1);
+        SP_CHECK(Tests::near(volume, 1.0f, 1e-3f));
+    }
+
+    // an l shape, a single hull fills in the corner, the decomposition shouldn't
+    {
+        MeshData l_shape;
+        add_box(&l_shape, Vector3(0.0f, 0.0f, 0.0f), Vector3(4.0f, 1.0f, 1.0f));
+        add_box(&l_shape, Vector3(0.0f, 1.0f, 0.0f), Vector3(1.0f, 4.0f, 1.0f));
+
+        const float mesh_volume = ConvexDecomposition::ComputeMeshVolume(l_shape.positions.data(), sizeof(float) * 3, l_shape.indices.data(), static_cast<uint32_t>(l_shape.indices.size()));
+        SP_CHECK(Tests::near(mesh_volume, 7.0f, 1e-4f));
+
+        vector<Vector3> points;
+        for (size_t i = 0; i < l_shape.positions.size(); i += 3)
+        {
+            points.emplace_back(l_shape.positions[i], l_shape.positions[i + 1], l_shape.positions[i + 2]);
+        }
+        SP_CHECK(ConvexDecomposition::ComputeHullVolume(points) > mesh_volume * 1.5f);
+
+        uint32_t hull_count = 0;
+        const float volume  = decomposed_volume(l_shape, &hull_count);
+        SP_CHECK(hull_count > 1);
+        SP_CHECK(fabs(volume - mesh_volume) < mesh_volume * 0.05f);
+    }
+}
+
+SP_TEST(physics_ccd_tunnelling)
+{
+    // without ccd it goes through, which shows that the scene tests something
+    SP_CHECK(fire_through_wall(false));
+    SP_CHECK(!fire_through_wall(true));
+}
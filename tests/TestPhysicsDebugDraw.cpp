@@ -0,0 +1,134 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES ===================================================
+#include "pch.h"
+#include "Tests.h"
+#include "Physics/PhysicsDebugDraw.h"
+SP_WARNINGS_OFF
+#include <btBulletDynamicsCommon.h>
+SP_WARNINGS_ON
+//==============================================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    // a bare bullet world, the debug draw only needs its collision objects
+    struct DebugWorld
+    {
+        DebugWorld()
+        {
+            dispatcher = make_unique<btCollisionDispatcher>(&configuration);
+            world      = make_unique<btDiscreteDynamicsWorld>(dispatcher.get(), &broadphase, &solver, &configuration);
+            world->setDebugDrawer(&debug_draw);
+        }
+
+        ~DebugWorld()
+        {
+            for (unique_ptr<btCollisionObject>& object : objects)
+            {
+                world->removeCollisionObject(object.get());
+            }
+        }
+
+        btCollisionObject* add(btCollisionShape* shape, const Vector3& position, const btVector3& color)
+        {
+            unique_ptr<btCollisionObject>& object = objects.emplace_back(make_unique<btCollisionObject>());
+            object->setCollisionShape(shape);
+            object->setWorldTransform(btTransform(btQuaternion::getIdentity(), btVector3(position.x, position.y, position.z)));
+            object->setCustomDebugColor(color);
+            world->addCollisionObject(object.get());
+
+            return object.get();
+        }
+
+        btDefaultCollisionConfiguration configuration;
+        btDbvtBroadphase broadphase;
+        btSequentialImpulseConstraintSolver solver;
+        unique_ptr<btCollisionDispatcher> dispatcher;
+        unique_ptr<btDiscreteDynamicsWorld> world;
+        vector<unique_ptr<btCollisionObject>> objects;
+        PhysicsDebugDraw debug_draw;
+    };
+
+    // the lines bullet draws for a shape, in its local space
+    struct LineCounter : public btIDebugDraw
+    {
+        void drawLine(const btVector3&, const btVector3&, const btVector3&) override { vertex_count += 2; }
+        void drawContactPoint(const btVector3&, const btVector3&, btScalar, int, const btVector3&) override {}
+        void reportErrorWarning(const char*) override {}
+        void draw3dText(const btVector3&, const char*) override {}
+        void setDebugMode(const int) override {}
+        int getDebugMode() const override { return DBG_DrawWireframe; }
+
+        uint32_t vertex_count = 0;
+    };
+
+    uint32_t count_shape_vertices(btDiscreteDynamicsWorld* world, btCollisionShape* shape)
+    {
+        btIDebugDraw* debug_draw = world->getDebugDrawer();
+        LineCounter counter;
+        world->setDebugDrawer(&counter);
+        world->debugDrawObject(btTransform::getIdentity(), shape, btVector3(1.0f, 1.0f, 1.0f));
+        world->setDebugDrawer(debug_draw);
+
+        return counter.vertex_count;
+    }
+}
+
+SP_TEST(physics_debug_draw_shape_lines_shared_across_colors)
+{
+    DebugWorld debug_world;
+    btBoxShape box(btVector3(0.5f, 0.5f, 0.5f));
+    btSphereShape sphere(0.5f);
+    const uint32_t vertex_count_box    = count_shape_vertices(debug_world.world.get(), &box);
+    const uint32_t vertex_count_sphere = count_shape_vertices(debug_world.world.get(), &sphere);
+    const uint32_t vertex_count_frame  = 6; // three axes
+    SP_CHECK(vertex_count_box > 0 && vertex_count_sphere > 0);
+
+    // two bodies of one shape, in different colors, far enough apart to not touch
+    btCollisionObject* red = debug_world.add(&box, Vector3(0.0f, 0.0f, 5.0f), btVector3(1.0f, 0.0f, 0.0f));
+    debug_world.add(&box, Vector3(5.0f, 0.0f, 5.0f), btVector3(0.0f, 0.0f, 1.0f));
+    debug_world.debug_draw.Draw(debug_world.world.get(), Vector3::Zero);
+    SP_CHECK(debug_world.debug_draw.GetVertexCountCached() == vertex_count_box + vertex_count_frame);
+    SP_CHECK(debug_world.debug_draw.GetInstanceCount() == 4); // a box and the axes, per body
+    SP_CHECK(debug_world.debug_draw.GetVertexCountInstanced() == 2 * (vertex_count_box + vertex_count_frame));
+    SP_CHECK(debug_world.debug_draw.GetVertexCountEmitted() == 0);
+
+    // a color change is a per instance change, the lines are not made again
+    red->setCustomDebugColor(btVector3(0.0f, 1.0f, 0.0f));
+    debug_world.debug_draw.Draw(debug_world.world.get(), Vector3::Zero);
+    SP_CHECK(debug_world.debug_draw.GetVertexCountCached() == vertex_count_box + vertex_count_frame);
+
+    // while a new shape is
+    debug_world.add(&sphere, Vector3(-5.0f, 0.0f, 5.0f), btVector3(1.0f, 1.0f, 0.0f));
+    debug_world.debug_draw.Draw(debug_world.world.get(), Vector3::Zero);
+    SP_CHECK(debug_world.debug_draw.GetVertexCountCached() == vertex_count_box + vertex_count_sphere + vertex_count_frame);
+    SP_CHECK(debug_world.debug_draw.GetInstanceCount() == 6);
+}
@@ -0,0 +1,148 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+//= INCLUDES ==========================
+#include "pch.h"
+#include "Tests.h"
+#include "Math/Bvh.h"
+#include "Core/ProgressTracker.h"
+#include "Rendering/Mesh.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Components/Renderable.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    const BoundingBox mesh_box = BoundingBox(Vector3(-0.5f), Vector3(0.5f));
+
+    vector<Matrix> create_instances(const uint32_t count)
+    {
+        vector<Matrix> instances;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            instances.emplace_back(Matrix::CreateTranslation(Vector3(static_cast<float>(i) * 2.0f, 0.0f, static_cast<float>(i % 4))));
+        }
+
+        return instances;
+    }
+
+    // the boxes of whichever instances are left, clustering reorders them so they are read back
+    BoundingBox compute_instances_box(Renderable* renderable)
+    {
+        BoundingBox box = BoundingBox::Undefined;
+        for (uint32_t i = 0; i < renderable->GetInstanceCount(); i++)
+        {
+            box.Merge(mesh_box.Transform(renderable->GetInstanceTransform(i)));
+        }
+
+        return box;
+    }
+}
+
+SP_TEST(renderable_remove_instances)
+{
+    World::New();
+
+    // no gpu is involved, the instance buffer is only uploaded when the renderer asks for it
+    Mesh mesh;
+    Renderable* renderable = World::CreateEntity()->AddComponent<Renderable>().get();
+    renderable->SetGeometry(&mesh, mesh_box, 0, 3, 0, 3);
+
+    // removing all of them while the boxes of the added ones are still pending
+    renderable->AddInstances(create_instances(64));
+    renderable->RemoveInstances(0, 64);
+    SP_CHECK(!renderable->HasInstancing());
+    SP_CHECK(renderable->GetBoundingBox(BoundingBoxType::Transformed) == mesh_box);
+
+    // removing all of them once the boxes are cached
+    renderable->AddInstances(create_instances(64));
+    SP_CHECK(renderable->GetBoundingBox(BoundingBoxType::Transformed) == compute_instances_box(renderable));
+    renderable->RemoveInstances(0, 64);
+    SP_CHECK(renderable->GetBoundingBox(BoundingBoxType::Transformed) == mesh_box);
+
+    // removing some of them, with and without pending boxes
+    renderable->AddInstances(create_instances(64));
+    renderable->RemoveInstances(16, 16);
+    SP_CHECK(renderable->GetInstanceCount() == 48);
+    SP_CHECK(renderable->GetBoundingBox(BoundingBoxType::Transformed) == compute_instances_box(renderable));
+    renderable->RemoveInstances(0, 40);
+    SP_CHECK(renderable->GetBoundingBox(BoundingBoxType::Transformed) == compute_instances_box(renderable));
+
+    World::New();
+}
+
+SP_TEST(renderable_bvh_follows_changes)
+{
+    World::New();
+
+    Mesh mesh;
+    shared_ptr<Entity> entity = World::CreateEntity();
+    Renderable* renderable    = entity->AddComponent<Renderable>().get();
+    renderable->SetGeometry(&mesh, mesh_box, 0, 3, 0, 3);
+
+    auto find = [&entity](const BoundingBox& box)
+    {
+        bool found = false;
+        World::GetBvh().QueryBox(box, [&](void* user_data) { found |= user_data == entity.get(); });
+        return found;
+    };
+    const BoundingBox around_origin = BoundingBox(Vector3(-1.0f), Vector3(1.0f));
+    const BoundingBox around_target = BoundingBox(Vector3(9.0f, -1.0f, -1.0f), Vector3(11.0f, 1.0f, 1.0f));
+
+    // keep the renderer, which needs a device, from picking up the entities
+    ProgressTracker::SetLoadingStateGlobal(true);
+
+    // added with its renderable
+    World::Tick();
+    SP_CHECK(find(around_origin));
+
+    // refitted once it moves
+    entity->SetPosition(Vector3(10.0f, 0.0f, 0.0f));
+    World::Tick();
+    SP_CHECK(!find(around_origin));
+    SP_CHECK(find(around_target));
+
+    // and so is its parent's move
+    shared_ptr<Entity> parent = World::CreateEntity();
+    entity->SetParent(parent);
+    parent->SetPosition(Vector3(-10.0f, 0.0f, 0.0f));
+    World::Tick();
+    SP_CHECK(find(around_origin));
+
+    // gone with its renderable
+    entity->RemoveComponent<Renderable>();
+    World::Tick();
+    SP_CHECK(!find(around_origin));
+    SP_CHECK(World::GetBvh().GetProxyCount() == 0);
+
+    ProgressTracker::SetLoadingStateGlobal(false);
+    World::New();
+}
@@ -0,0 +1,279 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES =============================
+#include "pch.h"
+#include "Tests.h"
+#include "IO/Compression.h"
+#include "IO/FileStream.h"
+#include "World/World.h"
+#include "World/WorldFile.h"
+#include "World/Entity.h"
+#include "World/Prefab.h"
+#include "World/Components/PhysicsBody.h"
+#include "Resource/ResourceCache.h"
+//========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    bool round_trip(const vector<byte>& data)
+    {
+        vector<byte> compressed;
+        Compression::Compress(data.data(), data.size(), &compressed);
+
+        vector<byte> decompressed(data.size());
+        if (!Compression::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()))
+            return false;
+
+        return decompressed == data;
+    }
+
+    // what is compared between a saved world and the same world loaded back
+    struct EntityState
+    {
+        string name;
+        uint64_t parent_id  = 0;
+        Vector3 position    = Vector3::Zero;
+        Quaternion rotation = Quaternion::Identity;
+        Vector3 scale       = Vector3::One;
+        bool has_body       = false;
+        float mass          = 0.0f;
+        bool ccd            = false;
+        PhysicsShape shape  = PhysicsShape::Box;
+        Vector3 body_size   = Vector3::One;
+    };
+
+    unordered_map<uint64_t, EntityState> capture_world()
+    {
+        unordered_map<uint64_t, EntityState> states;
+        for (const auto& [id, entity] : World::GetAllEntities())
+        {
+            EntityState& state = states[id];
+            state.name         = entity->GetObjectName();
+            state.parent_id    = entity->GetParent() ? entity->GetParent()->GetObjectId() : 0;
+            state.position     = entity->GetPositionLocal();
+            state.rotation     = entity->GetRotationLocal();
+            state.scale        = entity->GetScaleLocal();
+
+            if (shared_ptr<PhysicsBody> body = entity->GetComponent<PhysicsBody>())
+            {
+                state.has_body  = true;
+                state.mass      = body->GetMass();
+                state.ccd       = body->GetCcd();
+                state.shape     = body->GetShapeType();
+                state.body_size = body->GetBoundingBox();
+            }
+        }
+
+        return states;
+    }
+
+    bool states_equal(const EntityState& a, const EntityState& b)
+    {
+        return a.name      == b.name      &&
+               a.parent_id == b.parent_id &&
+               a.position  == b.position  &&
+               a.rotation  == b.rotation  &&
+               a.scale     == b.scale     &&
+               a.has_body  == b.has_body  &&
+               a.mass      == b.mass      &&
+               a.ccd       == b.ccd       &&
+               a.shape     == b.shape     &&
+               a.body_size == b.body_size;
+    }
+
+    void check_world(const unordered_map<uint64_t, EntityState>& expected)
+    {
+        const unordered_map<uint64_t, EntityState> loaded = capture_world();
+        SP_CHECK(loaded.size() == expected.size());
+
+        for (const auto& [id, state] : expected)
+        {
+            const auto it = loaded.find(id);
+            SP_CHECK(it != loaded.end() && states_equal(it->second, state));
+        }
+    }
+
+    // a small hierarchy which covers local transforms and a component with non-default values
+    vector<shared_ptr<Entity>> create_world()
+    {
+        World::New();
+
+        shared_ptr<Entity> root = World::CreateEntity();
+        root->SetObjectName("root");
+        root->SetPosition(Vector3(1.0f, 2.0f, 3.0f));
+        root->SetRotation(Quaternion::FromEulerAngles(10.0f, 20.0f, 30.0f));
+
+        shared_ptr<Entity> child = World::CreateEntity();
+        child->SetObjectName("child");
+        child->SetParent(root);
+        child->SetPositionLocal(Vector3(0.0f, 5.0f, 0.0f));
+        child->SetScaleLocal(Vector3(2.0f, 1.0f, 0.5f));
+
+        shared_ptr<Entity> body = World::CreateEntity();
+        body->SetObjectName("body");
+        body->SetParent(child);
+        body->SetPositionLocal(Vector3(-1.0f, 0.0f, 4.0f));
+        {
+            shared_ptr<PhysicsBody> physics_body = body->AddComponent<PhysicsBody>();
+            physics_body->SetMass(12.5f);
+            physics_body->SetBoundingBox(Vector3(0.5f, 1.5f, 2.5f));
+            physics_body->SetCcd(false); // the default is true, so this catches a load that drops it
+        }
+
+        shared_ptr<Entity> root_other = World::CreateEntity();
+        root_other->SetObjectName("root_other");
+        root_other->SetScale(Vector3(3.0f));
+
+        return { root, root_other };
+    }
+}
+
+SP_TEST(compression_round_trip)
+{
+    SP_CHECK(round_trip({}));
+
+    // incompressible
+    mt19937 engine(7);
+    vector<byte> random(100000);
+    for (byte& value : random)
+    {
+        value = static_cast<byte>(engine() & 0xFF);
+    }
+    SP_CHECK(round_trip(random));
+
+    // runs and repeats of every length, like serialized components are
+    vector<byte> repetitive;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        const uint32_t length = engine() % 300;
+        const byte value      = static_cast<byte>(engine() % 4);
+        for (uint32_t j = 0; j < length; j++)
+        {
+            repetitive.emplace_back(static_cast<byte>(static_cast<uint32_t>(value) + (j % 3)));
+        }
+    }
+    SP_CHECK(round_trip(repetitive));
+
+    vector<byte> compressed;
+    Compression::Compress(repetitive.data(), repetitive.size(), &compressed);
+    SP_CHECK(compressed.size() < repetitive.size() / 4);
+
+    // a truncated stream or a wrong size is reported instead of read past
+    vector<byte> decompressed(repetitive.size());
+    for (uint64_t size : { uint64_t(0), uint64_t(1), compressed.size() / 2, compressed.size() - 1 })
+    {
+        SP_CHECK(!Compression::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+    }
+    SP_CHECK(!Compression::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+}
+
+SP_TEST(world_load_legacy_and_current)
+{
+    const string directory        = (filesystem::temp_directory_path() / "spartan_tests").generic_string() + "/";
+    const string file_path_legacy = directory + "legacy" + EXTENSION_WORLD;
+    const string file_path        = directory + "current" + EXTENSION_WORLD;
+    FileSystem::CreateDirectory(directory);
+
+    vector<shared_ptr<Entity>> roots                    = create_world();
+    const unordered_map<uint64_t, EntityState> expected = capture_world();
+    SP_CHECK(expected.size() == 4);
+
+    // the format before world files, written the way it was: the root count, their ids and then each root with its descendants
+    {
+        FileStream file(file_path_legacy, FileStream_Write);
+        SP_CHECK(file.IsOpen());
+
+        file.Write(static_cast<uint32_t>(roots.size()));
+        for (shared_ptr<Entity>& root : roots)
+        {
+            file.Write(root->GetObjectId());
+        }
+
+        for (shared_ptr<Entity>& root : roots)
+        {
+            root->Serialize(&file);
+        }
+    }
+
+    vector<Entity*> roots_raw;
+    for (shared_ptr<Entity>& root : roots)
+    {
+        roots_raw.emplace_back(root.get());
+    }
+    SP_CHECK(WorldFile::Save(file_path, roots_raw));
+    roots.clear();
+    roots_raw.clear();
+
+    SP_CHECK(!WorldFile::IsWorldFile(file_path_legacy));
+    SP_CHECK(World::LoadFromFile(file_path_legacy));
+    check_world(expected);
+
+    SP_CHECK(WorldFile::IsWorldFile(file_path));
+    SP_CHECK(World::LoadFromFile(file_path));
+    check_world(expected);
+
+    World::New();
+    FileSystem::Delete(directory);
+}
+
+SP_TEST(world_prefab_outlives_resource_cache)
+{
+    const string directory        = (filesystem::temp_directory_path() / "spartan_tests").generic_string() + "/";
+    const string file_path_prefab = directory + "prop" + EXTENSION_PREFAB;
+    const string file_path        = directory + "instances" + EXTENSION_WORLD;
+    FileSystem::CreateDirectory(directory);
+    World::New();
+
+    vector<shared_ptr<Entity>> roots;
+    {
+        shared_ptr<Entity> root = World::CreateEntity();
+        shared_ptr<Entity> part = World::CreateEntity();
+        part->SetParent(root);
+
+        shared_ptr<Prefab> prefab = Prefab::Create(root.get(), file_path_prefab);
+        SP_CHECK(prefab != nullptr);
+        World::RemoveEntity(root.get());
+
+        roots = prefab->Instantiate({ Vector3::Zero, Vector3::One });
+        SP_CHECK(roots.size() == 2);
+    }
+
+    // what a world clear does, the instances are all that hold on to the prefab now
+    ResourceCache::Shutdown();
+    SP_CHECK(roots[0]->GetPrefab() != nullptr);
+    SP_CHECK(roots[0]->GetPrefab()->GetResourceFilePathNative() == FileSystem::GetRelativePath(file_path_prefab));
+
+    // and saving them still finds it
+    SP_CHECK(WorldFile::Save(file_path, { roots[0].get(), roots[1].get() }));
+
+    roots.clear();
+    World::New();
+    FileSystem::Delete(directory);
+}
@@ -0,0 +1,201 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "pch.h"
+#include "Tests.h"
+#include "World/WorldStreaming.h"
+//===============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+namespace
+{
+    // a row of cells along x, each one 64 meters wide
+    vector<WorldCell> create_cells(const uint32_t count, const uint64_t size)
+    {
+        vector<WorldCell> cells(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            cells[i].x      = static_cast<int32_t>(i);
+            cells[i].bounds = BoundingBox(Vector3(i * 64.0f, 0.0f, 0.0f), Vector3((i + 1) * 64.0f, 10.0f, 64.0f));
+            cells[i].size   = size;
+        }
+
+        return cells;
+    }
+
+    float get_distance(const WorldCell& cell, const Vector3& position)
+    {
+        const float dx = max(max(cell.bounds.GetMin().x - position.x, 0.0f), position.x - cell.bounds.GetMax().x);
+        const float dz = max(max(cell.bounds.GetMin().z - position.z, 0.0f), position.z - cell.bounds.GetMax().z);
+        return sqrt(dx * dx + dz * dz);
+    }
+
+    // moves along the path like a camera would, loads complete on the tick after they are issued
+    void follow_path(WorldStreamingScheduler& scheduler, const vector<Vector3>& path, const function<void(const Vector3&)>& on_tick)
+    {
+        vector<uint32_t> cells_to_load;
+        vector<uint32_t> cells_to_unload;
+        vector<uint32_t> cells_in_flight;
+
+        for (const Vector3& position : path)
+        {
+            for (const uint32_t cell_index : cells_in_flight)
+            {
+                scheduler.OnLoaded(cell_index);
+            }
+
+            scheduler.Update(position, &cells_to_load, &cells_to_unload);
+            cells_in_flight = cells_to_load;
+
+            on_tick(position);
+        }
+    }
+
+    vector<Vector3> create_path(const float from, const float to, const float step)
+    {
+        vector<Vector3> path;
+        const float direction = to > from ? 1.0f : -1.0f;
+        for (float x = from; direction * (to - x) >= 0.0f; x += direction * step)
+        {
+            path.emplace_back(x, 2.0f, 32.0f);
+        }
+
+        return path;
+    }
+}
+
+SP_TEST(world_streaming_follows_camera_path)
+{
+    WorldStreamingSettings settings;
+    settings.load_distance       = 64.0f;
+    settings.unload_distance     = 128.0f;
+    settings.max_loads_in_flight = 2;
+
+    WorldStreamingScheduler scheduler;
+    scheduler.SetSettings(settings);
+    scheduler.SetCells(create_cells(16, 1024));
+
+    // there and back again
+    vector<Vector3> path = create_path(0.0f, 1024.0f, 8.0f);
+    vector<Vector3> back = create_path(1024.0f, 0.0f, 8.0f);
+    path.insert(path.end(), back.begin(), back.end());
+
+    follow_path(scheduler, path, [&](const Vector3& position)
+    {
+        uint64_t resident_size = 0;
+        uint32_t in_flight     = 0;
+        for (const WorldCell& cell : scheduler.GetCells())
+        {
+            const float distance = get_distance(cell, position);
+
+            // nothing outside of the unload distance stays resident
+            if (cell.state != WorldCellState::Unloaded)
+            {
+                SP_CHECK(distance <= settings.unload_distance);
+                resident_size += cell.size;
+            }
+
+            in_flight += cell.state == WorldCellState::Loading ? 1 : 0;
+        }
+
+        SP_CHECK(in_flight <= settings.max_loads_in_flight);
+        SP_CHECK(in_flight == scheduler.GetLoadsInFlight());
+        SP_CHECK(resident_size == scheduler.GetResidentSize());
+    });
+
+    // once it settles, everything within the load distance is resident
+    const Vector3 position = path.back();
+    follow_path(scheduler, vector<Vector3>(4, position), [](const Vector3&) {});
+    for (const WorldCell& cell : scheduler.GetCells())
+    {
+        if (get_distance(cell, position) <= settings.load_distance)
+        {
+            SP_CHECK(cell.state == WorldCellState::Loaded);
+        }
+    }
+}
+
+SP_TEST(world_streaming_hysteresis)
+{
+    WorldStreamingSettings settings;
+    settings.load_distance   = 64.0f;
+    settings.unload_distance = 128.0f;
+
+    WorldStreamingScheduler scheduler;
+    scheduler.SetSettings(settings);
+    scheduler.SetCells(create_cells(8, 1024));
+
+    // cell 2 spans [128, 192], it loads when the camera is 64 meters away, after the two nearer ones
+    follow_path(scheduler, vector<Vector3>(3, Vector3(64.0f, 0.0f, 32.0f)), [](const Vector3&) {});
+    SP_CHECK(scheduler.GetCells()[2].state == WorldCellState::Loaded);
+
+    // jittering around the load distance doesn't unload it
+    uint32_t unloads = 0;
+    vector<Vector3> path;
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        path.emplace_back((i % 2) ? 60.0f : 20.0f, 0.0f, 32.0f);
+    }
+    follow_path(scheduler, path, [&](const Vector3&) { unloads += scheduler.GetCells()[2].state == WorldCellState::Unloaded ? 1 : 0; });
+    SP_CHECK(unloads == 0);
+
+    // moving beyond the unload distance does
+    follow_path(scheduler, { Vector3(-8.0f, 0.0f, 32.0f) }, [](const Vector3&) {});
+    SP_CHECK(scheduler.GetCells()[2].state == WorldCellState::Unloaded);
+}
+
+SP_TEST(world_streaming_memory_budget)
+{
+    WorldStreamingSettings settings;
+    settings.load_distance       = 128.0f;
+    settings.unload_distance     = 256.0f;
+    settings.memory_budget       = 3 * 1024;
+    settings.max_loads_in_flight = 8;
+
+    WorldStreamingScheduler scheduler;
+    scheduler.SetSettings(settings);
+    scheduler.SetCells(create_cells(16, 1024));
+
+    // five cells are in range but only three fit, the nearest ones win
+    const Vector3 start = Vector3(160.0f, 0.0f, 32.0f);
+    follow_path(scheduler, vector<Vector3>(2, start), [](const Vector3&) {});
+    SP_CHECK(scheduler.GetResidentSize() <= settings.memory_budget);
+    SP_CHECK(scheduler.GetCells()[2].state == WorldCellState::Loaded);
+    SP_CHECK(scheduler.GetCells()[0].state == WorldCellState::Unloaded);
+
+    // walking on, cells behind the camera make space for the ones ahead of it
+    follow_path(scheduler, create_path(160.0f, 800.0f, 16.0f), [&](const Vector3& position)
+    {
+        SP_CHECK(scheduler.GetResidentSize() <= settings.memory_budget);
+
+        // the cell under the camera always gets its space
+        int32_t x = 0;
+        int32_t z = 0;
+        WorldStreamingScheduler::GetCellCoordinates(position, 64.0f, &x, &z);
+        SP_CHECK(scheduler.GetCells()[x].state != WorldCellState::Unloaded);
+    });
+}
@@ -0,0 +1,65 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====
+#include <vector>
+#include <cmath>
+//================
+
+// a minimal test harness, each test registers itself and reports failed checks, so one run sees every failure
+namespace Spartan::Tests
+{
+    struct Test
+    {
+        const char* name   = nullptr;
+        void (*function)() = nullptr;
+    };
+
+    std::vector<Test>& get_tests();
+    void report_failure(const char* expression, const char* file, const int line);
+
+    struct Registration
+    {
+        Registration(const char* name, void (*function)()) { get_tests().push_back({ name, function }); }
+    };
+
+    inline bool near(const float a, const float b, const float tolerance)
+    {
+        return std::fabs(a - b) <= tolerance * std::fmax(1.0f, std::fmax(std::fabs(a), std::fabs(b)));
+    }
+}
+
+#define SP_TEST(name)                                                                   \
+    static void test_##name();                                                          \
+    static const Spartan::Tests::Registration registration_##name(#name, test_##name);  \
+    static void test_##name()
+
+#define SP_CHECK(expression)                                                            \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(expression))                                                              \
+        {                                                                               \
+            Spartan::Tests::report_failure(#expression, __FILE__, __LINE__);            \
+        }                                                                               \
+    } while (false)
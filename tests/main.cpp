@@ -0,0 +1,89 @@
+/*
+Copyright(c) 2016-2024 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES =====================
+#include "pch.h"
+#include "Tests.h"
+#include "Core/ThreadPool.h"
+#include "Physics/Physics.h"
+#include "World/World.h"
+//================================
+
+//= NAMESPACES ========
+using namespace std;
+using namespace Spartan;
+//=====================
+
+namespace
+{
+    uint32_t failure_count = 0;
+}
+
+namespace Spartan::Tests
+{
+    vector<Test>& get_tests()
+    {
+        static vector<Test> tests;
+        return tests;
+    }
+
+    void report_failure(const char* expression, const char* file, const int line)
+    {
+        printf("    failed: %s (%s:%d)\n", expression, file, line);
+        failure_count++;
+    }
+}
+
+// a headless tool which runs the tests of the runtime, it initializes only what they need, no window and no device
+// usage: tests [name filter], a test runs if its name contains the filter
+int main(int argc, char** argv)
+{
+    const string filter = argc > 1 ? argv[1] : "";
+
+    Log::Initialize();
+    ThreadPool::Initialize();
+    Physics::Initialize();
+
+    uint32_t test_count        = 0;
+    uint32_t test_failed_count = 0;
+    for (const Tests::Test& test : Tests::get_tests())
+    {
+        if (!filter.empty() && string(test.name).find(filter) == string::npos)
+            continue;
+
+        printf("%s\n", test.name);
+
+        const uint32_t failure_count_before = failure_count;
+        test.function();
+        test_count++;
+        test_failed_count += failure_count != failure_count_before ? 1 : 0;
+    }
+
+    printf("%u tests ran, %u failed\n", test_count, test_failed_count);
+
+    World::Shutdown();
+    Physics::Shutdown();
+    ThreadPool::Shutdown();
+
+    return test_failed_count == 0 ? 0 : 1;
+}